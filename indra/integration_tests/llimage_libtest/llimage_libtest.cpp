@@ -38,14 +38,19 @@
 #include "llimagebmp.h"
 #include "llimagetga.h"
 #include "llimagej2c.h"
+#include "llimagedxt.h"
 #include "lldir.h"
 #include "lldiriterator.h"
 #include "v4coloru.h"
 #include "llsdserialize.h"
 #include "llcleanup.h"
+#include "threadpool.h"
 
 // system libraries
 #include <iostream>
+#include <algorithm>
+#include <map>
+#include <thread>
 
 // doc string provided when invoking the program with --help
 static const char USAGE[] = "\n"
@@ -89,6 +94,10 @@ static const char USAGE[] = "\n"
 "        Only valid for output j2c images.\n"
 " -f, --filter <file>\n"
 "        Apply the filter <file> to the input images.\n"
+" -ft, --filter_timing <runs>\n"
+"        Time <runs> applications of the filter to each input image, single threaded\n"
+"        then with all cores, and output the average time per run for each.\n"
+"        Only valid with --filter.\n"
 " -log, --logmetrics <metric>\n"
 "        Log performance data for <metric>. Results in <metric>.slp\n"
 "        Note: so far, only ImageCompressionTester has been tested.\n"
@@ -97,11 +106,49 @@ static const char USAGE[] = "\n"
 "        Results in <metric>_report.csv\n"
 " -s, --image-stats\n"
 "        Output stats for each input and output image.\n"
+" -bench, --benchmark <dir>\n"
+"        Benchmark the texture pipeline on all j2c files in <dir> instead of converting:\n"
+"        load, decode at each discard level, half size scaling and mip chain generation.\n"
+"        Outputs latency percentiles and throughput (MB/s of decoded pixels, file bytes for load)\n"
+"        per stage.\n"
+" -runs, --bench_runs <n>\n"
+"        Number of times each file goes through each benchmark stage. Default is 3.\n"
+" -bc, --bench_bc <quality>\n"
+"        Add a CPU block compression (BC1/BC3) stage to the benchmark.\n"
+"        1 is fast, 2 is high quality. Default is no compression stage.\n"
+" -csv, --bench_csv <file>\n"
+"        Also write the benchmark results to <file>, one line per stage.\n"
 "\n";
 
 // true when all image loading is done. Used by metric logging thread to know when to stop the thread.
 static bool sAllDone = false;
 
+// Run the filter on fresh copies of raw_image, single threaded then on all cores, and output the time per run
+void time_filter(LLImageFilter& filter, LLPointer<LLImageRaw> raw_image, int runs)
+{
+    LL::ThreadPool pool("ImageFilter", llmax((S32)std::thread::hardware_concurrency() - 1, 1));
+    pool.start();
+
+    LL::ThreadPool* const pools[] = { NULL, &pool };
+    for (LL::ThreadPool* filter_pool : pools)
+    {
+        LLImageFilter::setThreadPool(filter_pool);
+        F64 elapsed = 0.0;
+        for (int i = 0; i < runs; ++i)
+        {
+            LLPointer<LLImageRaw> copy = new LLImageRaw(raw_image->getData(), raw_image->getWidth(), raw_image->getHeight(), raw_image->getComponents());
+            LLTimer timer;
+            filter.executeFilter(copy);
+            elapsed += timer.getElapsedTimeF64();
+        }
+        std::cout << "Filter " << (filter_pool ? "all cores" : "single thread") << " : "
+                  << raw_image->getWidth() << "x" << raw_image->getHeight() << ", "
+                  << (elapsed * 1000.0 / runs) << " ms per run" << std::endl;
+    }
+    LLImageFilter::setThreadPool(NULL);
+    pool.close();
+}
+
 // Create an empty formatted image instance of the correct type from the filename
 LLPointer<LLImageFormatted> create_image(const std::string &filename)
 {
@@ -313,6 +360,188 @@ void store_output_file(std::list<std::string> &output_filenames, std::list<std::
     }
 }
 
+// Timings gathered by the benchmark, per stage of the texture pipeline
+class BenchmarkStats
+{
+public:
+    void add(const std::string& stage, F64 seconds, S64 bytes)
+    {
+        Stage& entry = mStages[stage];
+        if (entry.mSeconds.empty())
+        {
+            mOrder.push_back(stage);
+        }
+        entry.mSeconds.push_back(seconds);
+        entry.mBytes += bytes;
+    }
+
+    // Human readable when csv is false, one comma separated line per stage otherwise
+    void report(std::ostream& os, bool csv) const
+    {
+        if (csv)
+        {
+            os << "stage,samples,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,mb_per_s" << std::endl;
+        }
+        for (const std::string& name : mOrder)
+        {
+            const Stage& stage = mStages.at(name);
+            std::vector<F64> sorted = stage.mSeconds;
+            std::sort(sorted.begin(), sorted.end());
+            F64 total = 0.0;
+            for (F64 seconds : sorted)
+            {
+                total += seconds;
+            }
+            F64 mean_ms = total * 1000.0 / sorted.size();
+            F64 mb_per_s = (total > 0.0 ? (F64)stage.mBytes / (1024.0 * 1024.0) / total : 0.0);
+            if (csv)
+            {
+                os << name << "," << sorted.size() << "," << mean_ms << ","
+                   << percentile(sorted, 0.5) << "," << percentile(sorted, 0.9) << ","
+                   << percentile(sorted, 0.99) << "," << sorted.back() * 1000.0 << ","
+                   << mb_per_s << std::endl;
+            }
+            else
+            {
+                os << llformat("%-12s n = %5d, mean = %8.3f ms, p50 = %8.3f ms, p90 = %8.3f ms, p99 = %8.3f ms, max = %8.3f ms, %9.2f MB/s",
+                               name.c_str(), (S32)sorted.size(), mean_ms,
+                               percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99),
+                               sorted.back() * 1000.0, mb_per_s) << std::endl;
+            }
+        }
+    }
+
+private:
+    // Nearest rank percentile in ms of sorted samples
+    static F64 percentile(const std::vector<F64>& sorted, F64 fraction)
+    {
+        size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[llmin(index, sorted.size() - 1)] * 1000.0;
+    }
+
+    struct Stage
+    {
+        std::vector<F64> mSeconds;
+        S64 mBytes = 0;
+    };
+    std::map<std::string, Stage> mStages;
+    std::vector<std::string> mOrder;
+};
+
+// Run one j2c file through the stages of the texture pipeline, runs times each
+void benchmark_image(const std::string& filename, int runs, S32 bc_quality, BenchmarkStats& stats)
+{
+    for (int run = 0; run < runs; ++run)
+    {
+        LLTimer timer;
+        LLPointer<LLImageJ2C> image = new LLImageJ2C;
+        if (!image->load(filename))
+        {
+            std::cout << "Error: Image " << filename << " could not be loaded" << std::endl;
+            return;
+        }
+        stats.add("load", timer.getElapsedTimeF64(), image->getDataSize());
+
+        // Decode at each discard level the codestream holds, keeping the full resolution one
+        LLPointer<LLImageRaw> full_image;
+        S32 max_discard = llclamp((S32)image->getLevels(), 0, MAX_DISCARD_LEVEL);
+        for (S32 discard = 0; discard <= max_discard; ++discard)
+        {
+            if ((image->getWidth() >> discard) < 1 || (image->getHeight() >> discard) < 1)
+            {
+                break;
+            }
+            LLPointer<LLImageRaw> raw_image = new LLImageRaw;
+            image->setDiscardLevel(discard);
+            timer.reset();
+            if (!image->decode(raw_image, 0.0f))
+            {
+                std::cout << "Error: Image " << filename << " could not be decoded at discard " << discard << std::endl;
+                break;
+            }
+            stats.add(llformat("decode_d%d", discard), timer.getElapsedTimeF64(), raw_image->getDataSize());
+            if (discard == 0)
+            {
+                full_image = raw_image;
+            }
+        }
+        if (full_image.isNull())
+        {
+            return;
+        }
+        S32 width = full_image->getWidth();
+        S32 height = full_image->getHeight();
+        S32 components = full_image->getComponents();
+
+        // Scale to half size, on a copy so that the next stages see the full image
+        LLPointer<LLImageRaw> scaled = new LLImageRaw(full_image->getData(), width, height, components);
+        timer.reset();
+        if (scaled->scale(llmax(width / 2, 1), llmax(height / 2, 1)))
+        {
+            stats.add("scale", timer.getElapsedTimeF64(), full_image->getDataSize());
+        }
+
+        // Box filtered mip chain, the way LLImageGL builds it. That needs power of 2 sizes.
+        if (width > 1 && height > 1 && !(width & (width - 1)) && !(height & (height - 1)))
+        {
+            std::vector<U8> mips[2];
+            const U8* prev_mip_data = full_image->getData();
+            S32 w = width;
+            S32 h = height;
+            S32 level = 0;
+            timer.reset();
+            while (w > 1 && h > 1)
+            {
+                w /= 2;
+                h /= 2;
+                std::vector<U8>& mip = mips[level++ % 2];
+                mip.resize(w * h * components);
+                LLImageBase::generateMip(prev_mip_data, mip.data(), w, h, components);
+                prev_mip_data = mip.data();
+            }
+            stats.add("mips", timer.getElapsedTimeF64(), full_image->getDataSize());
+        }
+
+        if (bc_quality > LLImageDXT::COMPRESS_NONE && LLImageDXT::canCompress(full_image))
+        {
+            timer.reset();
+            LLPointer<LLImageDXT> compressed = LLImageDXT::createCompressed(full_image, bc_quality);
+            if (compressed.notNull())
+            {
+                stats.add("bc_compress", timer.getElapsedTimeF64(), full_image->getDataSize());
+            }
+        }
+    }
+}
+
+void run_benchmark(const std::list<std::string>& input_filenames, int runs, S32 bc_quality, const std::string& csv_filename)
+{
+    BenchmarkStats stats;
+    for (const std::string& filename : input_filenames)
+    {
+        if (LLImageBase::getCodecFromExtension(gDirUtilp->getExtension(filename)) != IMG_CODEC_J2C)
+        {
+            continue;
+        }
+        std::cout << "Benchmarking " << filename << std::endl;
+        benchmark_image(filename, runs, bc_quality, stats);
+    }
+
+    stats.report(std::cout, false);
+    if (!csv_filename.empty())
+    {
+        std::ofstream os(csv_filename.c_str());
+        if (os.is_open())
+        {
+            stats.report(os, true);
+        }
+        else
+        {
+            std::cout << "Error: Benchmark results could not be written to " << csv_filename << std::endl;
+        }
+    }
+}
+
 // Holds the metric gathering output in a thread safe way
 class LogThread : public LLThread
 {
@@ -357,6 +586,11 @@ int main(int argc, char** argv)
     int levels = 0;
     bool reversible = false;
     std::string filter_name = "";
+    int filter_timing_runs = 0;
+    bool benchmark = false;
+    int benchmark_runs = 3;
+    S32 benchmark_bc_quality = LLImageDXT::COMPRESS_NONE;
+    std::string benchmark_csv = "";
 
     // Init whatever is necessary
     ll_init_apr();
@@ -549,6 +783,75 @@ int main(int argc, char** argv)
                     break;
             }
         }
+        else if (!strcmp(argv[arg], "--filter_timing") || !strcmp(argv[arg], "-ft"))
+        {
+            std::string value_str;
+            if ((arg + 1) < argc)
+            {
+                value_str = argv[arg+1];
+            }
+            if (((arg + 1) >= argc) || (value_str[0] == '-'))
+            {
+                std::cout << "No valid --filter_timing argument given, filter timing ignored" << std::endl;
+            }
+            else
+            {
+                filter_timing_runs = llmax(atoi(value_str.c_str()), 0);
+            }
+        }
+        else if ((!strcmp(argv[arg], "--benchmark") || !strcmp(argv[arg], "-bench")) && arg < argc-1)
+        {
+            std::string dir = argv[arg+1];
+            if (dir[0] == '-')
+            {
+                std::cout << "No --benchmark directory given, benchmark ignored" << std::endl;
+            }
+            else
+            {
+                benchmark = true;
+                store_input_file(input_filenames, gDirUtilp->add(dir, "*.j2c"));
+                arg += 1;
+            }
+        }
+        else if (!strcmp(argv[arg], "--bench_runs") || !strcmp(argv[arg], "-runs"))
+        {
+            std::string value_str;
+            if ((arg + 1) < argc)
+            {
+                value_str = argv[arg+1];
+            }
+            if (((arg + 1) >= argc) || (value_str[0] == '-'))
+            {
+                std::cout << "No valid --bench_runs argument given, bench_runs ignored" << std::endl;
+            }
+            else
+            {
+                benchmark_runs = llmax(atoi(value_str.c_str()), 1);
+                arg += 1;
+            }
+        }
+        else if (!strcmp(argv[arg], "--bench_bc") || !strcmp(argv[arg], "-bc"))
+        {
+            std::string value_str;
+            if ((arg + 1) < argc)
+            {
+                value_str = argv[arg+1];
+            }
+            if (((arg + 1) >= argc) || (value_str[0] == '-'))
+            {
+                std::cout << "No valid --bench_bc argument given, compression stage ignored" << std::endl;
+            }
+            else
+            {
+                benchmark_bc_quality = llclamp(atoi(value_str.c_str()), (S32)LLImageDXT::COMPRESS_NONE, (S32)LLImageDXT::COMPRESS_HIGH);
+                arg += 1;
+            }
+        }
+        else if ((!strcmp(argv[arg], "--bench_csv") || !strcmp(argv[arg], "-csv")) && arg < argc-1)
+        {
+            benchmark_csv = argv[arg+1];
+            arg += 1;
+        }
         else if (!strcmp(argv[arg], "--analyzeperformance") || !strcmp(argv[arg], "-a"))
         {
             analyze_performance = true;
@@ -580,6 +883,12 @@ int main(int argc, char** argv)
         fast_timer_log_thread->start();
     }
 
+    if (benchmark)
+    {
+        run_benchmark(input_filenames, benchmark_runs, benchmark_bc_quality, benchmark_csv);
+        input_filenames.clear();
+    }
+
     // Load the filter once and for all
     LLImageFilter filter(filter_name);
 
@@ -598,6 +907,12 @@ int main(int argc, char** argv)
             continue;
         }
 
+        // Time the filter on copies of the image, keeping the original for the real run
+        if (filter_timing_runs > 0 && !filter_name.empty())
+        {
+            time_filter(filter, raw_image, filter_timing_runs);
+        }
+
         // Apply the filter
         filter.executeFilter(raw_image);
 
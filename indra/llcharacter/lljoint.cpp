@@ -965,13 +965,42 @@ void LLJoint::updateWorldMatrixChildren()
 {
     if (!this->mUpdateXform) return;
 
-    if (mDirtyFlags & MATRIX_DIRTY)
+    // One level of the hierarchy at a time, so each parent is up to date
+    // before its children and the dirty joints of a level can go through
+    // LLXformMatrix::updateMatrices() together
+    static thread_local std::vector<LLJoint*> level;
+    static thread_local std::vector<LLJoint*> next_level;
+    static thread_local std::vector<LLXformMatrix*> xforms;
+    static thread_local std::vector<LLMatrix4a*> matrices;
+
+    level.clear();
+    level.push_back(this);
+    while (!level.empty())
     {
-        updateWorldMatrix();
-    }
-    for (LLJoint* joint : mChildren)
-    {
-        joint->updateWorldMatrixChildren();
+        next_level.clear();
+        xforms.clear();
+        matrices.clear();
+        for (LLJoint* joint : level)
+        {
+            if (joint->mDirtyFlags & MATRIX_DIRTY)
+            {
+                xforms.push_back(&joint->mXform);
+                matrices.push_back(&joint->mWorldMatrix);
+                joint->mDirtyFlags = 0x0;
+            }
+            for (LLJoint* child : joint->mChildren)
+            {
+                if (child->mUpdateXform)
+                {
+                    next_level.push_back(child);
+                }
+            }
+        }
+
+        LLXformMatrix::updateMatrices(xforms.data(), matrices.data(), (U32)xforms.size());
+        sNumUpdates += (S32)xforms.size();
+
+        level.swap(next_level);
     }
 }
 
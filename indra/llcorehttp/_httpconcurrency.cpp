@@ -0,0 +1,193 @@
+/**
+ * @file _httpconcurrency.cpp
+ * @brief Internal definitions of the adaptive request concurrency controller
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpconcurrency.h"
+
+#include "_httpinternal.h"
+#include "llhttpconstants.h"
+
+
+namespace
+{
+
+// Throughput in the window before more requests
+// count as still filling the pipe
+const double STARTUP_GROWTH = 1.25;
+
+// Multipliers applied to the limit
+const double STARTUP_INCREASE = 1.5;
+const double THROTTLED_DECREASE = 0.5;
+const double LATENCY_DECREASE = 0.85;
+
+// Time to first byte, relative to the recent minimum,
+// counted as requests queueing
+const double LATENCY_QUEUEING = 2.0;
+
+bool is_congestion(const LLCore::HttpStatus & status)
+{
+    static const LLCore::HttpStatus unavailable(HTTP_SERVICE_UNAVAILABLE);
+    static const LLCore::HttpStatus too_many(429);
+    static const LLCore::HttpStatus timed_out(LLCore::HttpStatus::EXT_CURL_EASY, CURLE_OPERATION_TIMEDOUT);
+
+    return status == unavailable || status == too_many || status == timed_out;
+}
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+HttpConcurrencyController::HttpConcurrencyController()
+    : mLimit(double(HTTP_ADAPTIVE_LIMIT_MIN)),
+      mCeiling(0L),
+      mStarting(true),
+      mLastThroughput(0.0),
+      mBaseLatency(0),
+      mBaseLatencyEnd(0)
+{
+    startWindow(0);
+}
+
+
+void HttpConcurrencyController::configure(long initial, long ceiling)
+{
+    mCeiling = ceiling;
+    mLimit = double(llclamp(initial, HTTP_ADAPTIVE_LIMIT_MIN, llmax(ceiling, HTTP_ADAPTIVE_LIMIT_MIN)));
+    mStarting = true;
+    mLastThroughput = 0.0;
+    mBaseLatency = 0;
+    mBaseLatencyEnd = 0;
+    startWindow(0);
+}
+
+
+void HttpConcurrencyController::noteActive(int active)
+{
+    mWindowPeakActive = llmax(mWindowPeakActive, active);
+}
+
+
+void HttpConcurrencyController::noteCompletion(const HttpStatus & status, HttpTime latency, size_t bytes)
+{
+    if (is_congestion(status))
+    {
+        ++mWindowThrottles;
+        return;
+    }
+
+    mWindowBytes += bytes;
+    if (latency)
+    {
+        ++mWindowLatencyCount;
+        mWindowLatencySum += latency;
+        mWindowMinLatency = mWindowMinLatency ? llmin(mWindowMinLatency, latency) : latency;
+    }
+}
+
+
+HttpConcurrencyController::EDecision HttpConcurrencyController::update(HttpTime now)
+{
+    if (! isEnabled() || (mWindowStart && now < mWindowStart + HTTP_ADAPTIVE_WINDOW_USECS))
+    {
+        return HOLD;
+    }
+    if (! mWindowStart || now >= mWindowStart + 2 * HTTP_ADAPTIVE_WINDOW_USECS)
+    {
+        // First window or the class sat idle, nothing to judge
+        startWindow(now);
+        return HOLD;
+    }
+
+    const double throughput(double(mWindowBytes) * 1000000.0 / double(now - mWindowStart));
+    const HttpTime latency(mWindowLatencyCount ? mWindowLatencySum / mWindowLatencyCount : 0);
+    const double old_limit(mLimit);
+    EDecision decision(HOLD);
+
+    if (mWindowThrottles)
+    {
+        mLimit = llmax(mLimit * THROTTLED_DECREASE, double(HTTP_ADAPTIVE_LIMIT_MIN));
+        mStarting = false;
+        decision = DECREASE_THROTTLED;
+    }
+    else if (mBaseLatency
+             && latency > HttpTime(double(mBaseLatency) * LATENCY_QUEUEING)
+             && throughput <= mLastThroughput)
+    {
+        mLimit = llmax(mLimit * LATENCY_DECREASE, double(HTTP_ADAPTIVE_LIMIT_MIN));
+        mStarting = false;
+        decision = DECREASE_LATENCY;
+    }
+    else if (mWindowPeakActive >= getLimit())
+    {
+        if (mStarting && mLastThroughput > 0.0 && throughput < mLastThroughput * STARTUP_GROWTH)
+        {
+            // More requests stopped paying off, pipe is full
+            mStarting = false;
+        }
+        mLimit = llmin(mStarting ? mLimit * STARTUP_INCREASE : mLimit + 1.0, double(mCeiling));
+        decision = INCREASE;
+    }
+    if (decision != HOLD && getLimit() == long(old_limit))
+    {
+        decision = HOLD;
+    }
+
+    // Minimum latency is remembered for a while so that a route
+    // change can raise it
+    if (mWindowMinLatency && (! mBaseLatency || now >= mBaseLatencyEnd))
+    {
+        mBaseLatency = mWindowMinLatency;
+        mBaseLatencyEnd = now + HTTP_ADAPTIVE_BASE_LATENCY_USECS;
+    }
+    else if (mWindowMinLatency)
+    {
+        mBaseLatency = llmin(mBaseLatency, mWindowMinLatency);
+    }
+    if (mWindowBytes)
+    {
+        mLastThroughput = throughput;
+    }
+
+    startWindow(now);
+    return decision;
+}
+
+
+void HttpConcurrencyController::startWindow(HttpTime now)
+{
+    mWindowStart = now;
+    mWindowBytes = 0;
+    mWindowThrottles = 0;
+    mWindowLatencyCount = 0;
+    mWindowLatencySum = 0;
+    mWindowMinLatency = 0;
+    mWindowPeakActive = 0;
+}
+
+
+}  // end namespace LLCore
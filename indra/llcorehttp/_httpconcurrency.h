@@ -0,0 +1,126 @@
+/**
+ * @file _httpconcurrency.h
+ * @brief Internal declarations of the adaptive request concurrency controller
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef _LLCORE_HTTP_CONCURRENCY_H_
+#define _LLCORE_HTTP_CONCURRENCY_H_
+
+
+#include "linden_common.h"      // Modifies curl/curl.h interfaces
+
+#include "httpcommon.h"
+
+
+namespace LLCore
+{
+
+
+/// Adjusts the in-flight request limit of a policy class to
+/// what the network path is currently delivering.  Additive
+/// increase, multiplicative decrease, decided once per
+/// HTTP_ADAPTIVE_WINDOW_USECS from what completed in that window:
+///
+/// - Any 503, 429 or timeout halves the limit.  Servers and
+///   routers throttling us want fewer requests, not retries.
+/// - Time to first byte well over the recent minimum without
+///   any gain in throughput means requests are only queueing
+///   somewhere.  The limit is cut back a little.
+/// - Otherwise, if the limit was actually reached, it grows.
+///   Starting out it grows by half each window as long as
+///   throughput keeps up, then by one request per window.
+///
+/// The limit stays between HTTP_ADAPTIVE_LIMIT_MIN and the
+/// ceiling given by PO_ADAPTIVE_LIMIT.
+///
+/// Threading:  called by worker thread only.
+class HttpConcurrencyController
+{
+public:
+    HttpConcurrencyController();
+
+    enum EDecision
+    {
+        HOLD,
+        INCREASE,
+        DECREASE_THROTTLED,
+        DECREASE_LATENCY
+    };
+
+    /// Start over from an initial limit.  A ceiling of zero
+    /// disables the controller.
+    void configure(long initial, long ceiling);
+
+    bool isEnabled() const
+        {
+            return mCeiling > 0L;
+        }
+
+    long getCeiling() const
+        {
+            return mCeiling;
+        }
+
+    long getLimit() const
+        {
+            return long(mLimit);
+        }
+
+    /// Requests in flight on the class after staging new ones.
+    void noteActive(int active);
+
+    /// A request of the class finished.  Latency is its time
+    /// to first byte, zero if unknown.
+    void noteCompletion(const HttpStatus & status, HttpTime latency, size_t bytes);
+
+    /// Close the current window if it's over and adjust the
+    /// limit.  HOLD when nothing changed.
+    EDecision update(HttpTime now);
+
+protected:
+    void startWindow(HttpTime now);
+
+protected:
+    double              mLimit;
+    long                mCeiling;
+    bool                mStarting;              // Growing by half each window
+    double              mLastThroughput;        // Bytes per second, previous window
+    HttpTime            mBaseLatency;           // Lowest time to first byte lately
+    HttpTime            mBaseLatencyEnd;        // When mBaseLatency is forgotten
+
+    // Current window
+    HttpTime            mWindowStart;
+    size_t              mWindowBytes;
+    int                 mWindowThrottles;
+    int                 mWindowLatencyCount;
+    HttpTime            mWindowLatencySum;
+    HttpTime            mWindowMinLatency;
+    int                 mWindowPeakActive;
+};  // end class HttpConcurrencyController
+
+
+}  // end namespace LLCore
+
+
+#endif  // _LLCORE_HTTP_CONCURRENCY_H_
@@ -44,7 +44,9 @@
 //   components that share a class.  Changing priority across threads
 //   is slightly expensive (relative to gain) and hasn't been completely
 //   implemented.  And the major user of priority, texture fetches,
-//   may not really need it.
+//   may not really need it.  [Priority and deadline are now only
+//   set on queued requests via requestSetPriority(), the default
+//   is first-come-first-served.]
 // - Set/get for global policy and policy classes is clumsy.  Rework
 //   it heading in a direction that allows for more dynamic behavior.
 //   [Mostly fixed]
@@ -92,14 +94,6 @@
 // --------------------------------------------------------------------
 
 
-// If '1', internal ready queues will not order ready
-// requests by priority, instead it's first-come-first-served.
-// Reprioritization requests have the side-effect of then
-// putting the modified request at the back of the ready queue.
-
-#define LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY        1
-
-
 namespace LLCore
 {
 
@@ -153,6 +147,20 @@ constexpr int HTTP_CONNECTION_LIMIT_MAX = 256;
 constexpr long HTTP_PIPELINING_DEFAULT = 0L;
 constexpr long HTTP_PIPELINING_MAX = 20L;
 
+// HTTP/2 stream limits.  Servers commonly advertise 100
+// concurrent streams per connection.
+constexpr long HTTP_HTTP2_STREAMS_DEFAULT = 0L;
+constexpr long HTTP_HTTP2_STREAMS_MAX = 100L;
+
+// Adaptive concurrency limits, see PO_ADAPTIVE_LIMIT.  A
+// class's in-flight limit is reconsidered once per window
+// and the lowest time to first byte is kept for several.
+constexpr long HTTP_ADAPTIVE_LIMIT_DEFAULT = 0L;
+constexpr long HTTP_ADAPTIVE_LIMIT_MIN = 2L;
+constexpr long HTTP_ADAPTIVE_LIMIT_MAX = 256L;
+constexpr HttpTime HTTP_ADAPTIVE_WINDOW_USECS = 1000000UL;
+constexpr HttpTime HTTP_ADAPTIVE_BASE_LATENCY_USECS = 10000000UL;
+
 // Miscellaneous defaults
 constexpr bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
@@ -163,6 +171,21 @@ constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 // request, ready and active queues.
 constexpr int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
 
+// Longest the worker thread waits on libcurl's sockets
+// when nothing else needs servicing.  libcurl's own
+// timeouts and queued requests end the wait sooner.
+constexpr int HTTP_SERVICE_LOOP_WAIT_MAX_MS = 100;
+
+// Multiplexed requests whose first response byte arrives
+// this long after the request was sent are counted as
+// head-of-line stalls in the transport statistics.
+constexpr double HTTP_HTTP2_STALL_SECS = 0.5;
+
+// Largest response body received into a single caller
+// allocated region, see HttpOptions::setBodyAllocator().
+// Guards against absurd Content-Length values.
+constexpr size_t HTTP_CONTIGUOUS_BODY_MAX = 64 * 1024 * 1024;
+
 // Block allocation size (a tuning parameter) is found
 // in bufferarray.h.
 
@@ -30,8 +30,11 @@
 #include "bufferarray.h"
 #include "_httpoprequest.h"
 #include "_httppolicy.h"
+#include "_httprequestqueue.h"
 
 #include "llhttpconstants.h"
+#include "lltimer.h"
+#include "httpstats.h"
 
 namespace
 {
@@ -211,12 +214,101 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
     if (! mActiveOps.empty())
     {
-        ret = HttpService::NORMAL;
+        ret = (std::min)(ret, HttpService::TRANSPORT_WAIT);
     }
     return ret;
 }
 
 
+void HttpLibcurl::waitForActivity(int max_ms)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    HttpWakeup & wakeup(mService->getRequestQueue().getWakeup());
+    if (CURL_SOCKET_BAD == wakeup.getSocket() || ! mPolicyCount)
+    {
+        ms_sleep((std::min)(max_ms, HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS));
+        return;
+    }
+
+    // libcurl waits on the sockets of one multi handle.  Those
+    // of the other active classes and the wakeup socket are
+    // handed to it as extra descriptors.
+    mWaitFds.clear();
+    curl_waitfd wakeup_fd = { wakeup.getSocket(), CURL_WAIT_POLLIN, 0 };
+    mWaitFds.push_back(wakeup_fd);
+
+    CURLM * wait_handle(NULL);
+    long timeout(max_ms);
+    for (unsigned int policy_class(0); policy_class < mPolicyCount; ++policy_class)
+    {
+        CURLM * multi_handle(mMultiHandles[policy_class]);
+        if (! multi_handle || ! mActiveHandles[policy_class])
+        {
+            continue;
+        }
+
+        long curl_timeout(-1);
+        curl_multi_timeout(multi_handle, &curl_timeout);
+        if (curl_timeout >= 0)
+        {
+            timeout = (std::min)(timeout, curl_timeout);
+        }
+
+        if (! wait_handle)
+        {
+            wait_handle = multi_handle;
+            continue;
+        }
+
+        fd_set read_fds, write_fds, exc_fds;
+        FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
+        FD_ZERO(&exc_fds);
+        int max_fd(-1);
+        check_curl_multi_code(curl_multi_fdset(multi_handle, &read_fds, &write_fds, &exc_fds, &max_fd));
+#if LL_WINDOWS
+        for (u_int i(0); i < read_fds.fd_count; ++i)
+        {
+            curl_waitfd fd = { read_fds.fd_array[i], CURL_WAIT_POLLIN, 0 };
+            mWaitFds.push_back(fd);
+        }
+        for (u_int i(0); i < write_fds.fd_count; ++i)
+        {
+            curl_waitfd fd = { write_fds.fd_array[i], CURL_WAIT_POLLOUT, 0 };
+            mWaitFds.push_back(fd);
+        }
+#else
+        for (int sock(0); sock <= max_fd; ++sock)
+        {
+            short events((FD_ISSET(sock, &read_fds) ? CURL_WAIT_POLLIN : 0)
+                         | (FD_ISSET(sock, &write_fds) ? CURL_WAIT_POLLOUT : 0));
+            if (events)
+            {
+                curl_waitfd fd = { sock, events, 0 };
+                mWaitFds.push_back(fd);
+            }
+        }
+#endif
+    }
+
+    if (timeout > 0)
+    {
+        // A multi handle without transfers still waits on the extra
+        // descriptors, so the wakeup socket is always watched.
+        LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("httppt - curl_multi_wait");
+        int ready(0);
+        check_curl_multi_code(curl_multi_wait(wait_handle ? wait_handle : mMultiHandles[0],
+                                              &mWaitFds[0],
+                                              (unsigned int) mWaitFds.size(),
+                                              (int) timeout,
+                                              &ready));
+    }
+
+    // Requests queued up to here are picked up by the next pass
+    wakeup.drain();
+}
+
+
 // Caller has provided us with a ref count on op.
 void HttpLibcurl::addOp(const HttpOpRequest::ptr_t &op)
 {
@@ -409,6 +501,18 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
         }
     }
 
+    if (handle && mService->getPolicy().getClassOptions(op->mReqPolicy).mHttp2Streams > 0)
+    {
+        recordMultiplexedTransfer(handle, op->mReqPolicy);
+    }
+
+    double starttransfer(0.0);
+    if (handle && CURLE_OK == curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &starttransfer))
+    {
+        // Feeds the adaptive concurrency controller
+        op->mReplyLatency = HttpTime(starttransfer * 1000000.0);
+    }
+
     if (multi_handle && handle)
     {
         // Detach from multi and recycle handle
@@ -440,6 +544,27 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
 }
 
 
+void HttpLibcurl::recordMultiplexedTransfer(CURL * handle, unsigned int policy_class)
+{
+    long http_version(CURL_HTTP_VERSION_NONE);
+    long new_connections(0);
+    double pretransfer(0.0), starttransfer(0.0);
+    if (CURLE_OK != curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &http_version)
+        || CURLE_OK != curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections)
+        || CURLE_OK != curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME, &pretransfer)
+        || CURLE_OK != curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &starttransfer))
+    {
+        return;
+    }
+
+    // A stream waiting long for its first byte once sent is
+    // usually stuck behind its siblings on a lossy connection.
+    const bool http2(CURL_HTTP_VERSION_2_0 == http_version);
+    const bool stalled(http2 && starttransfer - pretransfer > HTTP_HTTP2_STALL_SECS);
+    HTTPStats::instance().recordMultiplexedTransfer(S32(policy_class), http2, 0 == new_connections, stalled);
+}
+
+
 int HttpLibcurl::getActiveCount() const
 {
     return static_cast<int>(mActiveOps.size());
@@ -487,7 +612,24 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
         policy.stallPolicy(policy_class, false);
         mDirtyPolicy[policy_class] = false;
 
-        if (options.mPipelining > 1)
+        if (options.mHttp2Streams > 0)
+        {
+            // HTTP/2 streams share the class's few connections.  Our
+            // libcurl has no per-connection stream limit, the policy
+            // layer holds in-flight requests to streams * per-host
+            // connections instead.  HTTP/1.1 servers get one request
+            // per connection.
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_PIPELINING,
+                                     CURLPIPE_MULTIPLEX);
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_HOST_CONNECTIONS,
+                                     long(options.mPerHostConnectionLimit));
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                                     long(options.mConnectionLimit));
+        }
+        else if (options.mPipelining > 1)
         {
             // We'll try to do pipelining on this multihandle
             check_curl_multi_setopt(multi_handle,
@@ -505,6 +647,8 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
         }
         else
         {
+            // Each request in flight needs its own connection, leave
+            // room for the adaptive limit to grow into.
             check_curl_multi_setopt(multi_handle,
                                      CURLMOPT_PIPELINING,
                                      0L);
@@ -513,7 +657,7 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
                                      0L);
             check_curl_multi_setopt(multi_handle,
                                      CURLMOPT_MAX_TOTAL_CONNECTIONS,
-                                     long(options.mConnectionLimit));
+                                     (std::max)(long(options.mConnectionLimit), options.mAdaptiveLimit));
         }
     }
     else if (! mDirtyPolicy[policy_class])
@@ -33,6 +33,7 @@
 #include <curl/multi.h>
 
 #include <set>
+#include <vector>
 
 #include "httprequest.h"
 #include "_httpservice.h"
@@ -77,6 +78,14 @@ class HttpLibcurl
     /// Threading:  called by worker thread.
     HttpService::ELoopSpeed processTransport();
 
+    /// Block until any policy class has socket activity or a
+    /// libcurl timeout is due, a request is queued or max_ms
+    /// elapses.  Without a wakeup socket, simply sleeps a
+    /// short while.
+    ///
+    /// Threading:  called by worker thread.
+    void waitForActivity(int max_ms);
+
     /// Add request to the active list.  Caller is expected to have
     /// provided us with a reference count on the op to hold the
     /// request.  (No additional references will be added.)
@@ -152,6 +161,10 @@ class HttpLibcurl
     /// and destroy.
     void cancelRequest(const opReqPtr_t &op);
 
+    /// Record stream, connection reuse and stall statistics for
+    /// a completed request on an HTTP/2-enabled class.
+    void recordMultiplexedTransfer(CURL * handle, unsigned int policy_class);
+
 protected:
     typedef std::set<opReqPtr_t> active_set_t;
 
@@ -215,6 +228,7 @@ class HttpLibcurl
     CURLM **            mMultiHandles;      // One handle per policy class
     int *               mActiveHandles;     // Active count per policy class
     bool *              mDirtyPolicy;       // Dirty policy update waiting for stall (per pc)
+    std::vector<curl_waitfd> mWaitFds;      // Scratch for waitForActivity()
 
 }; // end class HttpLibcurl
 
@@ -135,6 +135,8 @@ HttpOpRequest::HttpOpRequest()
       mReqLength(0),
       mReqHeaders(),
       mReqOptions(),
+      mReqPriority(0U),
+      mReqDeadline(HttpTime(0)),
       mCurlActive(false),
       mCurlHandle(NULL),
       mCurlService(NULL),
@@ -147,12 +149,14 @@ HttpOpRequest::HttpOpRequest()
       mReplyLength(0),
       mReplyFullLength(0),
       mReplyHeaders(),
+      mReplyLatency(0),
       mPolicyRetries(0),
       mPolicy503Retries(0),
       mPolicyRetryAt(HttpTime(0)),
       mPolicyRetryLimit(HTTP_RETRY_COUNT_DEFAULT),
       mPolicyMinRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MIN_DEFAULT)),
       mPolicyMaxRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MAX_DEFAULT)),
+      mPolicySequence(0U),
       mCallbackSSLVerify(NULL)
 {
     // *NOTE:  As members are added, retry initialization/cleanup
@@ -491,6 +495,7 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
     mReplyFullLength = 0;
     mReplyHeaders.reset();
     mReplyConType.clear();
+    mReplyLatency = 0;
 
     // *FIXME:  better error handling later
     HttpStatus status;
@@ -652,9 +657,20 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
     }
 
 
-    // *TODO: Should this be 'Keep-Alive' ?
-    mCurlHeaders = curl_slist_append(mCurlHeaders, "Connection: keep-alive");
-    mCurlHeaders = curl_slist_append(mCurlHeaders, "Keep-alive: 300");
+    if (cpolicy.mHttp2Streams > 0L)
+    {
+        // Negotiate HTTP/2 via ALPN and wait for an existing connection
+        // to take the stream rather than opening another.  Connection
+        // headers are forbidden in HTTP/2.
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+    }
+    else
+    {
+        // *TODO: Should this be 'Keep-Alive' ?
+        mCurlHeaders = curl_slist_append(mCurlHeaders, "Connection: keep-alive");
+        mCurlHeaders = curl_slist_append(mCurlHeaders, "Keep-alive: 300");
+    }
 
     // Tracing
     if (mTracing >= HTTP_TRACE_CURL_HEADERS)
@@ -710,9 +726,10 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
     {
         xfer_timeout = timeout;
     }
-    if (cpolicy.mPipelining > 1L)
+    if (cpolicy.mPipelining > 1L || cpolicy.mHttp2Streams > 0L)
     {
         // Pipelining affects both connection and transfer timeout values.
+        // Multiplexed streams share their connection the same way.
         // Requests that are added to a pipeling immediately have completed
         // their connection so the connection delay tends to be less than
         // the non-pipelined value.  Transfers are the opposite.  Transfer
@@ -738,13 +755,6 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
         //
         // xfer_timeout *= cpolicy.mPipelining;
         xfer_timeout *= 2L;
-
-        // Also try requesting HTTP/2.
-/******************************/
-        // but for test purposes, only if overriding VIEWERASSET
-        if (getenv("VIEWERASSET"))
-/******************************/
-        check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
     }
     // *DEBUG:  Enable following override for timeout handling and "[curl:bugs] #1420" tests
     //if (cpolicy.mPipelining)
@@ -785,6 +795,20 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
     if (! op->mReplyBody)
     {
         op->mReplyBody = new BufferArray();
+        if (op->mReqOptions && op->mReqOptions->getBodyAllocator())
+        {
+            // Headers are in.  If the body size is known, receive it
+            // straight into memory the consumer can take over.
+            double content_length(-1.0);
+            curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length);
+            const size_t expected(content_length > 0.0 ? size_t(content_length) : op->mReqLength);
+            if (expected && expected <= HTTP_CONTIGUOUS_BODY_MAX)
+            {
+                op->mReplyBody->reserveContiguous(expected,
+                                                  op->mReqOptions->getBodyAllocator(),
+                                                  op->mReqOptions->getBodyDeallocator());
+            }
+        }
     }
     const size_t req_size(size * nmemb);
     const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
@@ -199,6 +199,8 @@ class HttpOpRequest : public HttpOperation
     size_t              mReqLength;
     HttpHeaders::ptr_t  mReqHeaders;
     HttpOptions::ptr_t  mReqOptions;
+    HttpRequest::priority_t mReqPriority;
+    HttpTime            mReqDeadline;           // 0 if none
 
     // Transport data
     bool                mCurlActive;
@@ -218,6 +220,7 @@ class HttpOpRequest : public HttpOperation
     HttpHeaders::ptr_t  mReplyHeaders;
     std::string         mReplyConType;
     int                 mReplyRetryAfter;
+    HttpTime            mReplyLatency;          // Time to first byte (mcs), 0 if unknown
 
     // Policy data
     int                 mPolicyRetries;
@@ -226,9 +229,30 @@ class HttpOpRequest : public HttpOperation
     int                 mPolicyRetryLimit;
     HttpTime            mPolicyMinRetryBackoff; // initial delay between retries (mcs)
     HttpTime            mPolicyMaxRetryBackoff;
+    U64                 mPolicySequence;        // Arrival order on the ready queue
 };  // end class HttpOpRequest
 
 
+/// Ready queue ordering.  Higher priority first, then earlier
+/// deadline with requests having none last, then arrival order.
+/// Returns true if 'lhs' is to be served after 'rhs'.
+struct HttpOpRequestCompare
+{
+    bool operator()(const HttpOpRequest::ptr_t & lhs, const HttpOpRequest::ptr_t & rhs) const
+        {
+            if (lhs->mReqPriority != rhs->mReqPriority)
+            {
+                return lhs->mReqPriority < rhs->mReqPriority;
+            }
+            if (lhs->mReqDeadline != rhs->mReqDeadline)
+            {
+                return ! lhs->mReqDeadline || (rhs->mReqDeadline && lhs->mReqDeadline > rhs->mReqDeadline);
+            }
+            return lhs->mPolicySequence > rhs->mPolicySequence;
+        }
+};
+
+
 
 // ---------------------------------------
 // Free functions
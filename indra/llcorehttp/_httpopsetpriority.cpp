@@ -24,7 +24,6 @@
  * $/LicenseInfo$
  */
 
-#if 0 // DEPRECATED
 #include "_httpopsetpriority.h"
 
 #include "httpresponse.h"
@@ -36,10 +35,11 @@ namespace LLCore
 {
 
 
-HttpOpSetPriority::HttpOpSetPriority(HttpHandle handle, HttpRequest::priority_t priority)
+HttpOpSetPriority::HttpOpSetPriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline)
     : HttpOperation(),
       mHandle(handle),
-      mPriority(priority)
+      mPriority(priority),
+      mDeadline(deadline)
 {}
 
 
@@ -50,7 +50,7 @@ HttpOpSetPriority::~HttpOpSetPriority()
 void HttpOpSetPriority::stageFromRequest(HttpService * service)
 {
     // Do operations
-    if (! service->changePriority(mHandle, mPriority))
+    if (! service->changePriority(mHandle, mPriority, mDeadline))
     {
         // Request not found, fail the final status
         mStatus = HttpStatus(HttpStatus::LLCORE, HE_HANDLE_NOT_FOUND);
@@ -62,5 +62,3 @@ void HttpOpSetPriority::stageFromRequest(HttpService * service)
 
 
 }   // end namespace LLCore
-
-#endif
@@ -1,6 +1,6 @@
 /**
- * @file _httpsetpriority.h
- * @brief Internal declarations for HttpSetPriority
+ * @file _httpopsetpriority.h
+ * @brief Internal declarations for HttpOpSetPriority
  *
  * $LicenseInfo:firstyear=2012&license=viewerlgpl$
  * Second Life Viewer Source Code
@@ -27,7 +27,7 @@
 #ifndef _LLCORE_HTTP_SETPRIORITY_H_
 #define _LLCORE_HTTP_SETPRIORITY_H_
 
-#if 0 // DEPRECATED
+
 #include "httpcommon.h"
 #include "httprequest.h"
 #include "_httpoperation.h"
@@ -39,17 +39,16 @@ namespace LLCore
 
 
 /// HttpOpSetPriority is an immediate request that
-/// searches the various queues looking for a given
-/// request handle and changing it's priority if
-/// found.
-///
-/// *NOTE:  This will very likely be removed in the near future
-/// when priority is removed from the library.
+/// searches the ready queues looking for a given
+/// request handle and changing its priority and
+/// deadline if found.  Requests already handed to
+/// the transport can't be changed and *this* request
+/// then completes with an HE_HANDLE_NOT_FOUND error.
 
 class HttpOpSetPriority : public HttpOperation
 {
 public:
-    HttpOpSetPriority(HttpHandle handle);
+    HttpOpSetPriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline);
 
     virtual ~HttpOpSetPriority();
 
@@ -63,10 +62,10 @@ class HttpOpSetPriority : public HttpOperation
 protected:
     // Request Data
     HttpHandle                  mHandle;
+    HttpRequest::priority_t     mPriority;
+    HttpTime                    mDeadline;
 }; // end class HttpOpSetPriority
 
 }  // end namespace LLCore
-#endif
 
 #endif  // _LLCORE_HTTP_SETPRIORITY_H_
-
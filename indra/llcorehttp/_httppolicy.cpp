@@ -34,8 +34,11 @@
 #include "_httppolicyclass.h"
 
 #include "lltimer.h"
+#include "bufferarray.h"
 #include "httpstats.h"
 
+#include <atomic>
+
 namespace
 {
 
@@ -60,7 +63,8 @@ struct HttpPolicy::ClassState
         : mThrottleEnd(0),
           mThrottleLeft(0L),
           mRequestCount(0L),
-          mStallStaging(false)
+          mStallStaging(false),
+          mActiveLimit(0L)
         {}
 
     HttpReadyQueue      mReadyQueue;
@@ -71,6 +75,9 @@ struct HttpPolicy::ClassState
     long                mThrottleLeft;
     long                mRequestCount;
     bool                mStallStaging;
+
+    HttpConcurrencyController   mConcurrency;
+    std::atomic<long>           mActiveLimit;       // Published for getActiveLimit()
 };
 
 
@@ -223,6 +230,16 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
         HttpRetryQueue & retryq(state.mRetryQueue);
         HttpReadyQueue & readyq(state.mReadyQueue);
 
+        // Requests nobody wants anymore shouldn't take a connection
+        readyq.removeExpired(now, mExpired);
+        for (const HttpOpRequest::ptr_t & op : mExpired)
+        {
+            LL_DEBUGS(LOG_CORE) << "HTTP request " << op->getHandle()
+                                << " passed its deadline before starting, canceling." << LL_ENDL;
+            op->cancel();
+        }
+        mExpired.clear();
+
         if (state.mStallStaging)
         {
             // Stalling but don't sleep.  Need to complete operations
@@ -232,6 +249,42 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
             result = HttpService::NORMAL;
             continue;
         }
+
+        int active(transport.getActiveCountInClass(policy_class));
+        int active_limit(state.mOptions.mHttp2Streams > 0L
+                         ? (state.mOptions.mPerHostConnectionLimit
+                            * state.mOptions.mHttp2Streams)
+                         : state.mOptions.mPipelining > 1L
+                         ? (state.mOptions.mPerHostConnectionLimit
+                            * state.mOptions.mPipelining)
+                         : state.mOptions.mConnectionLimit);
+
+        HttpConcurrencyController & concurrency(state.mConcurrency);
+        if (concurrency.getCeiling() != state.mOptions.mAdaptiveLimit)
+        {
+            // Enabled, disabled or moved, start over from the static limit
+            concurrency.configure(active_limit, state.mOptions.mAdaptiveLimit);
+        }
+        if (concurrency.isEnabled())
+        {
+            // Windows close even while the queues are empty
+            const long old_limit(concurrency.getLimit());
+            const HttpConcurrencyController::EDecision decision(concurrency.update(now));
+            if (HttpConcurrencyController::HOLD != decision)
+            {
+                LL_DEBUGS(LOG_CORE) << "Policy class " << policy_class
+                                    << " request limit " << old_limit
+                                    << " -> " << concurrency.getLimit()
+                                    << LL_ENDL;
+                HTTPStats::instance().recordConcurrencyChange(policy_class,
+                                                              S32(old_limit),
+                                                              S32(concurrency.getLimit()),
+                                                              HttpConcurrencyController::DECREASE_THROTTLED == decision);
+            }
+            active_limit = int(concurrency.getLimit());
+        }
+        state.mActiveLimit = active_limit;
+
         if (retryq.empty() && readyq.empty())
         {
             continue;
@@ -247,11 +300,6 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
             continue;
         }
 
-        int active(transport.getActiveCountInClass(policy_class));
-        int active_limit(state.mOptions.mPipelining > 1L
-                         ? (state.mOptions.mPerHostConnectionLimit
-                            * state.mOptions.mPipelining)
-                         : state.mOptions.mConnectionLimit);
         int needed(active_limit - active);      // Expect negatives here
 
         if (needed > 0)
@@ -320,6 +368,12 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 
     throttle_on:
 
+        if (concurrency.isEnabled())
+        {
+            // Limit is only raised when requests actually pressed on it
+            concurrency.noteActive(active_limit - needed);
+        }
+
         if (! readyq.empty() || ! retryq.empty())
         {
             // If anything is ready, continue looping...
@@ -361,6 +415,7 @@ bool HttpPolicy::cancel(HttpHandle handle)
             {
                 HttpOpRequest::ptr_t op(*cur);
                 c2.erase(cur);                                  // All iterators are now invalidated
+                state.mReadyQueue.reorder();
                 op->cancel();
                 return true;
             }
@@ -371,8 +426,38 @@ bool HttpPolicy::cancel(HttpHandle handle)
 }
 
 
+bool HttpPolicy::changePriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline)
+{
+    for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+    {
+        ClassState & state(*mClasses[policy_class]);
+
+        for (const HttpOpRequest::ptr_t & op : state.mReadyQueue.get_container())
+        {
+            if (op->getHandle() == handle)
+            {
+                op->mReqPriority = priority;
+                op->mReqDeadline = deadline;
+                state.mReadyQueue.reorder();
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
 bool HttpPolicy::stageAfterCompletion(const HttpOpRequest::ptr_t &op)
 {
+    HttpConcurrencyController & concurrency(mClasses[op->mReqPolicy]->mConcurrency);
+    if (concurrency.isEnabled())
+    {
+        concurrency.noteCompletion(op->mStatus,
+                                   op->mReplyLatency,
+                                   op->mReplyBody ? op->mReplyBody->size() : 0);
+    }
+
     // Retry or finalize
     if (! op->mStatus)
     {
@@ -439,6 +524,16 @@ int HttpPolicy::getReadyCount(HttpRequest::policy_t policy_class) const
 }
 
 
+long HttpPolicy::getActiveLimit(HttpRequest::policy_t policy_class) const
+{
+    if (policy_class < mClasses.size())
+    {
+        return mClasses[policy_class]->mActiveLimit;
+    }
+    return 0L;
+}
+
+
 bool HttpPolicy::stallPolicy(HttpRequest::policy_t policy_class, bool stall)
 {
     bool ret(false);
@@ -34,6 +34,7 @@
 #include "_httpretryqueue.h"
 #include "_httppolicyglobal.h"
 #include "_httppolicyclass.h"
+#include "_httpconcurrency.h"
 #include "_httpinternal.h"
 
 
@@ -116,6 +117,12 @@ class HttpPolicy
     /// Threading:  called by worker thread
     bool cancel(HttpHandle handle);
 
+    /// Change priority and deadline of a request on a ready
+    /// queue, reordering the queue.
+    ///
+    /// Threading:  called by worker thread
+    bool changePriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline);
+
     /// When transport is finished with an op and takes it off the
     /// active queue, it is delivered here for dispatch.  Policy
     /// may send it back to the ready/retry queues if it needs another
@@ -154,6 +161,12 @@ class HttpPolicy
     /// Threading:  called by worker thread
     int getReadyCount(HttpRequest::policy_t policy_class) const;
 
+    /// Get the in-flight request limit a class was last
+    /// served with, adaptive or not.
+    ///
+    /// Threading:  called by any thread
+    long getActiveLimit(HttpRequest::policy_t policy_class) const;
+
     /// Stall (or unstall) a policy class preventing requests from
     /// transitioning to an active state.  Used to allow an HTTP
     /// request policy to empty prior to changing settings or state
@@ -169,6 +182,7 @@ class HttpPolicy
     HttpPolicyGlobal                    mGlobalOptions;
     class_list_t                        mClasses;
     HttpService *                       mService;               // Naked pointer, not refcounted, not owner
+    std::vector<opReqPtr_t>             mExpired;               // Scratch for processReadyQueue()
 };  // end class HttpPolicy
 
 }  // end namespace LLCore
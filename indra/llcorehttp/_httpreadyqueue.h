@@ -28,7 +28,9 @@
 #define _LLCORE_HTTP_READY_QUEUE_H_
 
 
+#include <algorithm>
 #include <queue>
+#include <vector>
 
 #include "_httpinternal.h"
 #include "_httpoprequest.h"
@@ -43,34 +45,28 @@ namespace LLCore
 /// as well as the ordering scheme while allowing us access to the
 /// raw container if we follow a few simple rules.  One of the more
 /// important of those rules is that any iterator becomes invalid
-/// on element erasure.  So pay attention.
+/// on element erasure.  So pay attention.  The other is that the
+/// container is a heap:  after erasing elements or changing the
+/// priority or deadline of queued requests, call reorder().
 ///
-/// If LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY tests true, the class
-/// implements a std::priority_queue interface but on std::deque
-/// behavior to eliminate sensitivity to priority.  In the future,
-/// this will likely become the only behavior or it may become
-/// a run-time election.
+/// Requests are ordered by @see HttpOpRequestCompare.  Requests
+/// never given a priority or deadline are served first-come-
+/// first-served.
 ///
 /// Threading:  not thread-safe.  Expected to be used entirely by
 /// a single thread, typically a worker thread of some sort.
 
-#if LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-
-typedef std::deque<HttpOpRequest::ptr_t> HttpReadyQueueBase;
-
-#else
-
 typedef std::priority_queue<HttpOpRequest::ptr_t,
                             std::deque<HttpOpRequest::ptr_t>,
                             LLCore::HttpOpRequestCompare> HttpReadyQueueBase;
 
-#endif // LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-
 class HttpReadyQueue : public HttpReadyQueueBase
 {
 public:
     HttpReadyQueue()
-        : HttpReadyQueueBase()
+        : HttpReadyQueueBase(),
+          mSequence(0U),
+          mNextDeadline(HttpTime(0))
         {}
 
     ~HttpReadyQueue()
@@ -81,40 +77,65 @@ class HttpReadyQueue : public HttpReadyQueueBase
     void operator=(const HttpReadyQueue &);     // Not defined
 
 public:
-
-#if LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-    // Types and methods needed to make a std::deque look
-    // more like a std::priority_queue, at least for our
-    // purposes.
-    typedef HttpReadyQueueBase container_type;
-
-    const_reference top() const
+    void push(const value_type & v)
         {
-            return front();
+            v->mPolicySequence = ++mSequence;
+            noteDeadline(v->mReqDeadline);
+            HttpReadyQueueBase::push(v);
         }
 
-    void pop()
+    /// Restore queue order after changes to the container
+    /// or to queued requests.
+    void reorder()
         {
-            pop_front();
+            std::make_heap(c.begin(), c.end(), comp);
+            mNextDeadline = HttpTime(0);
+            for (const value_type & op : c)
+            {
+                noteDeadline(op->mReqDeadline);
+            }
         }
 
-    void push(const value_type & v)
+    /// Move requests whose deadline has passed to 'expired'.
+    /// Cheap when no deadline is due.
+    void removeExpired(HttpTime now, std::vector<value_type> & expired)
         {
-            push_back(v);
+            if (! mNextDeadline || now < mNextDeadline)
+            {
+                return;
+            }
+            container_type::iterator keep(std::stable_partition(c.begin(), c.end(),
+                                                                [now](const value_type & op)
+                                                                {
+                                                                    return ! op->mReqDeadline || now < op->mReqDeadline;
+                                                                }));
+            expired.insert(expired.end(), keep, c.end());
+            c.erase(keep, c.end());
+            reorder();
         }
 
-#endif // LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-
     const container_type & get_container() const
         {
-            return *this;
+            return c;
         }
 
     container_type & get_container()
         {
-            return *this;
+            return c;
         }
 
+protected:
+    void noteDeadline(HttpTime deadline)
+        {
+            if (deadline && (! mNextDeadline || deadline < mNextDeadline))
+            {
+                mNextDeadline = deadline;
+            }
+        }
+
+    U64                 mSequence;
+    HttpTime            mNextDeadline;          // Earliest queued deadline, 0 if none
+
 }; // end class HttpReadyQueue
 
 
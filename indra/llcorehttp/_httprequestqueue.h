@@ -33,6 +33,7 @@
 #include "httpcommon.h"
 #include "_refcounted.h"
 #include "_mutex.h"
+#include "_httpwakeup.h"
 
 
 namespace LLCore
@@ -116,6 +117,16 @@ class HttpRequestQueue : public LLCoreInt::RefCounted
     /// Threading:  callable by any thread.
     void wakeAll();
 
+    /// Signaled whenever the queue goes non-empty so that the
+    /// worker thread can wait on libcurl's sockets and still
+    /// see new requests immediately.
+    ///
+    /// Threading:  callable by worker thread.
+    HttpWakeup & getWakeup()
+        {
+            return mWakeup;
+        }
+
     /// Disallow further request queuing.  Callers to @addOp will
     /// get a failure status (LLCORE, HE_SHUTTING_DOWN).  Callers
     /// to @fetchAll or @fetchOp will get requests that are on the
@@ -134,6 +145,7 @@ class HttpRequestQueue : public LLCoreInt::RefCounted
     LLCoreInt::HttpMutex                mQueueMutex;
     LLCoreInt::HttpConditionVariable    mQueueCV;
     bool                                mQueueStopped;
+    HttpWakeup                          mWakeup;
 
 }; // end class HttpRequestQueue
 
@@ -63,6 +63,8 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
     {   true,       true,       true,       false,      false   },      // PO_TRACE
     {   true,       true,       false,      true,       false   },      // PO_ENABLE_PIPELINING
     {   true,       true,       false,      true,       false   },      // PO_THROTTLE_RATE
+    {   true,       true,       false,      true,       false   },      // PO_HTTP2_STREAMS
+    {   true,       true,       false,      true,       false   },      // PO_ADAPTIVE_LIMIT
     {   false,      false,      true,       false,      true    }       // PO_SSL_VERIFY_CALLBACK
 };
 HttpService * HttpService::sInstance(NULL);
@@ -250,6 +252,15 @@ bool HttpService::cancel(HttpHandle handle)
 }
 
 
+bool HttpService::changePriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    // Only waiting requests have a priority to change
+    return mPolicy->changePriority(handle, priority, deadline);
+}
+
+
 /// Threading:  callable by worker thread.
 void HttpService::shutdown()
 {
@@ -278,7 +289,7 @@ void HttpService::shutdown()
 
 // Working thread loop-forever method.  Gives time to
 // each of the request queue, policy layer and transport
-// layer pieces and then either sleeps for a small time
+// layer pieces and then either waits on libcurl's sockets
 // or waits for a request to come in.  Repeats until
 // requested to stop.
 void HttpService::threadRun(LLCoreInt::HttpThread * thread)
@@ -305,10 +316,13 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
             new_loop = mTransport->processTransport();
             loop = (std::min)(loop, new_loop);
 
-            // Determine whether to spin, sleep briefly or sleep for next request
+            // Determine whether to wait briefly, wait on libcurl or sleep for
+            // next request.  Waits on libcurl also end when a request is queued.
             if (REQUEST_SLEEP != loop)
             {
-                ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+                mTransport->waitForActivity(NORMAL == loop
+                                            ? HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS
+                                            : HTTP_SERVICE_LOOP_WAIT_MAX_MS);
             }
         }
         catch (const LLContinueError&)
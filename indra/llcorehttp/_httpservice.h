@@ -105,6 +105,7 @@ class HttpService
     enum ELoopSpeed
     {
         NORMAL,                 ///< continuous polling of request, ready, active queues
+        TRANSPORT_WAIT,         ///< can wait for libcurl socket activity or request queue write
         REQUEST_SLEEP           ///< can sleep indefinitely waiting for request queue write
     };
 
@@ -154,6 +155,14 @@ class HttpService
     /// Threading:  callable by worker thread.
     bool cancel(HttpHandle handle);
 
+    /// Try to find the given request handle on the ready queues
+    /// and change its priority and deadline.
+    ///
+    /// @return         True if the request was found and changed.
+    ///
+    /// Threading:  callable by worker thread.
+    bool changePriority(HttpHandle handle, HttpRequest::priority_t priority, HttpTime deadline);
+
     /// Threading:  callable by worker thread.
     HttpPolicy & getPolicy()
         {
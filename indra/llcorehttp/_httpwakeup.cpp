@@ -0,0 +1,149 @@
+/**
+ * @file _httpwakeup.cpp
+ * @brief Internal definitions for the worker thread wakeup socket
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpwakeup.h"
+
+#if LL_WINDOWS
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+static const char * const LOG_CORE("CoreHttp");
+
+#if LL_WINDOWS
+typedef int addr_len_t;
+#else
+typedef socklen_t addr_len_t;
+#endif
+
+void close_socket(curl_socket_t sock)
+{
+#if LL_WINDOWS
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+bool set_non_blocking(curl_socket_t sock)
+{
+#if LL_WINDOWS
+    u_long non_blocking(1);
+    return 0 == ioctlsocket(sock, FIONBIO, &non_blocking);
+#else
+    int flags(fcntl(sock, F_GETFL, 0));
+    return flags >= 0 && 0 == fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+HttpWakeup::HttpWakeup()
+    : mSocket(CURL_SOCKET_BAD),
+      mSignaled(false)
+{
+    curl_socket_t sock(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (CURL_SOCKET_BAD == sock)
+    {
+        LL_WARNS(LOG_CORE) << "Unable to create HTTP service wakeup socket, polling instead." << LL_ENDL;
+        return;
+    }
+
+    // Bind to an ephemeral loopback port and connect to ourselves
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    addr_len_t addr_len(sizeof(addr));
+    if (bind(sock, (const sockaddr *) &addr, sizeof(addr))
+        || getsockname(sock, (sockaddr *) &addr, &addr_len)
+        || connect(sock, (const sockaddr *) &addr, sizeof(addr))
+        || ! set_non_blocking(sock))
+    {
+        LL_WARNS(LOG_CORE) << "Unable to set up HTTP service wakeup socket, polling instead." << LL_ENDL;
+        close_socket(sock);
+        return;
+    }
+
+    mSocket = sock;
+}
+
+
+HttpWakeup::~HttpWakeup()
+{
+    if (CURL_SOCKET_BAD != mSocket)
+    {
+        close_socket(mSocket);
+        mSocket = CURL_SOCKET_BAD;
+    }
+}
+
+
+void HttpWakeup::signal()
+{
+    if (CURL_SOCKET_BAD != mSocket && ! mSignaled.exchange(true))
+    {
+        const char byte(0);
+        send(mSocket, &byte, 1, 0);
+    }
+}
+
+
+void HttpWakeup::drain()
+{
+    if (CURL_SOCKET_BAD == mSocket)
+    {
+        return;
+    }
+
+    // Empty the socket before allowing new signals.  A signal
+    // landing in between is lost but whatever it announced is
+    // already queued for the caller.
+    char buffer[64];
+    while (recv(mSocket, buffer, sizeof(buffer), 0) > 0)
+    {
+        ;
+    }
+    mSignaled = false;
+}
+
+
+}  // end namespace LLCore
@@ -0,0 +1,86 @@
+/**
+ * @file _httpwakeup.h
+ * @brief Internal declarations for the worker thread wakeup socket
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef _LLCORE_HTTP_WAKEUP_H_
+#define _LLCORE_HTTP_WAKEUP_H_
+
+
+#include "linden_common.h"      // Modifies curl/curl.h interfaces
+
+#include <atomic>
+
+#include <curl/curl.h>
+
+
+namespace LLCore
+{
+
+
+/// Socket the worker thread can wait on alongside libcurl's
+/// own sockets so that it wakes as soon as a request is queued.
+/// Stands in for curl_multi_wakeup() which our libcurl predates.
+///
+/// A UDP socket bound to the loopback interface and connected
+/// to itself, which works the same on all platforms.  Signals
+/// are coalesced:  only the first after a drain() sends a datagram.
+///
+/// Threading:  signal() callable by any thread, the rest by
+/// the worker thread.
+class HttpWakeup
+{
+public:
+    HttpWakeup();
+    ~HttpWakeup();
+
+private:
+    HttpWakeup(const HttpWakeup &);                 // Not defined
+    void operator=(const HttpWakeup &);             // Not defined
+
+public:
+    /// Socket to wait for readability on, CURL_SOCKET_BAD if it
+    /// couldn't be created.  Waiters then have to poll.
+    curl_socket_t getSocket() const
+        {
+            return mSocket;
+        }
+
+    /// Make the socket readable.
+    void signal();
+
+    /// Consume pending signals.  Anything queued before this
+    /// returns must be picked up by the caller afterwards.
+    void drain();
+
+protected:
+    curl_socket_t       mSocket;
+    std::atomic<bool>   mSignaled;
+}; // end class HttpWakeup
+
+
+}  // end namespace LLCore
+
+
+#endif  // _LLCORE_HTTP_WAKEUP_H_
@@ -71,9 +71,15 @@ class BufferArray::Block
     // Only public entry to get a block.
     static Block * alloc(size_t len);
 
+    // Block wrapping caller-allocated memory, freed with 'dealloc'
+    // unless the caller takes it back.
+    static Block * allocExternal(void * mem, size_t len, deallocator_t dealloc);
+
 public:
     size_t mUsed;
     size_t mAlloced;
+    char * mBuffer;                 // mData or external memory
+    deallocator_t mDealloc;         // Non-NULL for external memory
 
     // *NOTE:  Must be last member of the object.  We'll
     // overallocate as requested via operator new and index
@@ -124,7 +130,7 @@ size_t BufferArray::append(const void * src, size_t len)
             // Some will fit...
             const size_t copy_len((std::min)(len, (last.mAlloced - last.mUsed)));
 
-            memcpy(&last.mData[last.mUsed], c_src, copy_len);
+            memcpy(&last.mBuffer[last.mUsed], c_src, copy_len);
             last.mUsed += copy_len;
             llassert_always(last.mUsed <= last.mAlloced);
             mLen += copy_len;
@@ -157,7 +163,7 @@ size_t BufferArray::append(const void * src, size_t len)
             LL_WARNS() << "Bad memory allocation in thrown by Block::alloc in read!" << LL_ENDL;
             break;
         }
-        memcpy(block->mData, c_src, copy_len);
+        memcpy(block->mBuffer, c_src, copy_len);
         block->mUsed = copy_len;
         llassert_always(block->mUsed <= block->mAlloced);
         mBlocks.push_back(block);
@@ -180,7 +186,44 @@ void * BufferArray::appendBufferAlloc(size_t len)
     block->mUsed = len;
     mBlocks.push_back(block);
     mLen += len;
-    return block->mData;
+    return block->mBuffer;
+}
+
+
+bool BufferArray::reserveContiguous(size_t len, allocator_t alloc, deallocator_t dealloc)
+{
+    if (! mBlocks.empty() || ! len || ! alloc || ! dealloc)
+    {
+        return false;
+    }
+
+    void * mem(alloc(len));
+    if (! mem)
+    {
+        return false;
+    }
+    mBlocks.push_back(Block::allocExternal(mem, len, dealloc));
+    return true;
+}
+
+
+void * BufferArray::detachContiguous(size_t * len)
+{
+    if (1 != mBlocks.size() || ! mBlocks.front()->mDealloc || ! mLen)
+    {
+        return NULL;
+    }
+
+    Block * block(mBlocks.front());
+    void * mem(block->mBuffer);
+    *len = block->mUsed;
+
+    // Caller owns the memory now
+    block->mBuffer = NULL;
+    delete block;
+    mBlocks.clear();
+    mLen = 0;
+    return mem;
 }
 
 
@@ -207,7 +250,7 @@ size_t BufferArray::read(size_t pos, void * dst, size_t len)
         size_t block_limit(block.mUsed - offset);
         size_t block_len((std::min)(block_limit, len));
 
-        memcpy(c_dst, &block.mData[offset], block_len);
+        memcpy(c_dst, &block.mBuffer[offset], block_len);
         result += block_len;
         len -= block_len;
         c_dst += block_len;
@@ -241,7 +284,7 @@ size_t BufferArray::write(size_t pos, const void * src, size_t len)
             size_t block_limit(block.mUsed - offset);
             size_t block_len((std::min)(block_limit, len));
 
-            memcpy(&block.mData[offset], c_src, block_len);
+            memcpy(&block.mBuffer[offset], c_src, block_len);
             result += block_len;
             c_src += block_len;
             len -= block_len;
@@ -261,7 +304,7 @@ size_t BufferArray::write(size_t pos, const void * src, size_t len)
             // Some will fit...
             const size_t copy_len((std::min)(len, (last.mAlloced - last.mUsed)));
 
-            memcpy(&last.mData[last.mUsed], c_src, copy_len);
+            memcpy(&last.mBuffer[last.mUsed], c_src, copy_len);
             last.mUsed += copy_len;
             result += copy_len;
             llassert_always(last.mUsed <= last.mAlloced);
@@ -312,8 +355,8 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
     }
 
     const Block & b(*mBlocks[block]);
-    *start = &b.mData[0];
-    *end = &b.mData[b.mUsed];
+    *start = &b.mBuffer[0];
+    *end = &b.mBuffer[b.mUsed];
     return true;
 }
 
@@ -325,7 +368,9 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 
 BufferArray::Block::Block(size_t len)
     : mUsed(0),
-      mAlloced(len)
+      mAlloced(len),
+      mBuffer(mData),
+      mDealloc(NULL)
 {
     memset(mData, 0, len);
 }
@@ -333,6 +378,11 @@ BufferArray::Block::Block(size_t len)
 
 BufferArray::Block::~Block()
 {
+    if (mDealloc && mBuffer)
+    {
+        mDealloc(mBuffer);
+    }
+    mBuffer = NULL;
     mUsed = 0;
     mAlloced = 0;
 }
@@ -365,4 +415,14 @@ BufferArray::Block * BufferArray::Block::alloc(size_t len)
 }
 
 
+BufferArray::Block * BufferArray::Block::allocExternal(void * mem, size_t len, deallocator_t dealloc)
+{
+    Block * block = new (0) Block(0);
+    block->mBuffer = static_cast<char *>(mem);
+    block->mAlloced = len;
+    block->mDealloc = dealloc;
+    return block;
+}
+
+
 }  // end namespace LLCore
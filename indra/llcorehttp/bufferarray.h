@@ -86,6 +86,29 @@ class BufferArray : public LLCoreInt::RefCounted
     // Internal magic number, may be used by unit tests.
     static const size_t BLOCK_ALLOC_SIZE = 65540;
 
+    typedef void * (*allocator_t)(size_t len);
+    typedef void (*deallocator_t)(void * mem);
+
+    /// Allocates a single region of 'len' bytes with the caller's
+    /// allocator for following appends to fill.  Anything past
+    /// 'len' goes into ordinary blocks.  Used to receive bodies
+    /// of known size directly in the consumer's own memory,
+    /// @see detachContiguous().  Only valid on an empty instance.
+    ///
+    /// @return         True if the region was allocated.
+    bool reserveContiguous(size_t len, allocator_t alloc, deallocator_t dealloc);
+
+    /// Hands the region from @see reserveContiguous() to the
+    /// caller if it holds all of the data, emptying the instance.
+    /// Caller frees it with the matching deallocator.  The region
+    /// may be larger than the returned length if less data than
+    /// reserved arrived.
+    ///
+    /// @return         The region or NULL if the data isn't
+    ///                 contiguous in caller memory, in which
+    ///                 case use @see read() as usual.
+    void * detachContiguous(size_t * len);
+
     /// Appends the indicated data to the BufferArray
     /// modifying current position and total size.  New
     /// position is one beyond the final byte of the buffer.
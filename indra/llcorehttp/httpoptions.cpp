@@ -47,7 +47,9 @@ HttpOptions::HttpOptions() :
     mVerifyPeer(sDefaultVerifyPeer),
     mVerifyHost(false),
     mDNSCacheTimeout(-1L),
-    mNoBody(false)
+    mNoBody(false),
+    mBodyAlloc(NULL),
+    mBodyDealloc(NULL)
 {}
 
 
@@ -129,6 +131,12 @@ void HttpOptions::setHeadersOnly(bool nobody)
     }
 }
 
+void HttpOptions::setBodyAllocator(BufferArray::allocator_t alloc, BufferArray::deallocator_t dealloc)
+{
+    mBodyAlloc = alloc;
+    mBodyDealloc = dealloc;
+}
+
 void HttpOptions::setDefaultSSLVerifyPeer(bool verify)
 {
     sDefaultVerifyPeer = verify;
@@ -29,6 +29,7 @@
 
 
 #include "httpcommon.h"
+#include "bufferarray.h"
 #include "_refcounted.h"
 
 
@@ -178,6 +179,21 @@ class HttpOptions : private boost::noncopyable
         return mNoBody;
     }
 
+    /// Receive bodies of known size (from Content-Length or the
+    /// requested range) into one region allocated with 'alloc'.
+    /// The consumer may then take it over with
+    /// BufferArray::detachContiguous() rather than copying it out.
+    /// Default: NULL, bodies are collected in library blocks
+    void                setBodyAllocator(BufferArray::allocator_t alloc, BufferArray::deallocator_t dealloc);
+    BufferArray::allocator_t getBodyAllocator() const
+    {
+        return mBodyAlloc;
+    }
+    BufferArray::deallocator_t getBodyDeallocator() const
+    {
+        return mBodyDealloc;
+    }
+
     /// Sets default behavior for verifying that the name in the
     /// security certificate matches the name of the host contacted.
     /// Defaults false if not set, but should be set according to
@@ -199,6 +215,8 @@ class HttpOptions : private boost::noncopyable
     bool                mVerifyHost;
     int                 mDNSCacheTimeout;
     bool                mNoBody;
+    BufferArray::allocator_t mBodyAlloc;
+    BufferArray::deallocator_t mBodyDealloc;
 
     static bool         sDefaultVerifyPeer;
 }; // end class HttpOptions
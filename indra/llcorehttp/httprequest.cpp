@@ -33,6 +33,7 @@
 #include "_httpoperation.h"
 #include "_httpoprequest.h"
 #include "_httpopcancel.h"
+#include "_httpopsetpriority.h"
 #include "_httpopsetget.h"
 
 #include "lltimer.h"
@@ -124,6 +125,13 @@ HttpStatus HttpRequest::setStaticPolicyOption(EPolicyOption opt, policy_t pclass
     return HttpService::instanceOf()->setPolicyOption(opt, pclass, value, ret_value);
 }
 
+
+long HttpRequest::getActiveLimit(policy_t pclass)
+{
+    HttpService * service(HttpService::instanceOf());
+    return service ? service->getPolicy().getActiveLimit(pclass) : 0L;
+}
+
 HttpHandle HttpRequest::setPolicyOption(EPolicyOption opt, policy_t pclass,
                                         long value, HttpHandler::ptr_t handler)
 {
@@ -214,7 +222,8 @@ HttpHandle HttpRequest::requestGetByteRange(policy_t policy_id,
                                             size_t len,
                                             const HttpOptions::ptr_t & options,
                                             const HttpHeaders::ptr_t & headers,
-                                            HttpHandler::ptr_t user_handler)
+                                            HttpHandler::ptr_t user_handler,
+                                            priority_t priority)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     HttpStatus status;
@@ -225,6 +234,7 @@ HttpHandle HttpRequest::requestGetByteRange(policy_t policy_id,
         mLastReqStatus = status;
         return LLCORE_HTTP_HANDLE_INVALID;
     }
+    op->mReqPriority = priority;
     op->setReplyPath(mReplyQueue, user_handler);
     if (! (status = mRequestQueue->addOp(op)))          // transfers refcount
     {
@@ -476,6 +486,24 @@ HttpHandle HttpRequest::requestCancel(HttpHandle request, HttpHandler::ptr_t use
 }
 
 
+HttpHandle HttpRequest::requestSetPriority(HttpHandle request, priority_t priority, HttpTime deadline,
+                                           HttpHandler::ptr_t user_handler)
+{
+    HttpStatus status;
+
+    HttpOperation::ptr_t op(new HttpOpSetPriority(request, priority, deadline));
+    op->setReplyPath(mReplyQueue, user_handler);
+    if (! (status = mRequestQueue->addOp(op)))          // transfers refcount
+    {
+        mLastReqStatus = status;
+        return LLCORE_HTTP_HANDLE_INVALID;
+    }
+
+    mLastReqStatus = status;
+    return op->getHandle();
+}
+
+
 // ====================================
 // Utility Methods
 // ====================================
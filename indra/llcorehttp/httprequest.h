@@ -96,6 +96,9 @@ class HttpRequest
 public:
     typedef unsigned int policy_t;
 
+    /// Queued requests with higher values are started first.
+    typedef unsigned int priority_t;
+
     typedef std::shared_ptr<HttpRequest> ptr_t;
     typedef std::weak_ptr<HttpRequest>   wptr_t;
 public:
@@ -226,6 +229,35 @@ class HttpRequest
         /// Per-class only
         PO_THROTTLE_RATE,
 
+        /// If greater than 0, requests on this policy class ask
+        /// for HTTP/2 over TLS and are multiplexed as streams on
+        /// shared connections.  Value gives the maximum number of
+        /// concurrent streams on a connection.  Servers that only
+        /// speak HTTP/1.1 are still served, one request at a time
+        /// per connection.
+        ///
+        /// When enabled, this replaces PO_PIPELINING_DEPTH and
+        /// libcurl performs connection management as it does for
+        /// pipelining.  PO_PER_HOST_CONNECTION_LIMIT should then
+        /// be small (1 or 2) and the in-flight request limit
+        /// becomes PO_PER_HOST_CONNECTION_LIMIT times this value.
+        /// A value of zero, the default, disables HTTP/2.
+        ///
+        /// Per-class only
+        PO_HTTP2_STREAMS,
+
+        /// If greater than 0, the in-flight request limit of
+        /// the class is adjusted while running to the observed
+        /// throughput, time to first byte and 503/429 responses.
+        /// It starts from the limit the options above give and
+        /// stays at or below this value.  Connection limits
+        /// still apply, libcurl queues requests beyond them.
+        /// @see getActiveLimit() for the current value.  A value
+        /// of zero, the default, keeps the limit fixed.
+        ///
+        /// Per-class only
+        PO_ADAPTIVE_LIMIT,
+
         /// Controls the callback function used to control SSL CTX
         /// certificate verification.
         ///
@@ -273,6 +305,17 @@ class HttpRequest
     HttpHandle setPolicyOption(EPolicyOption opt, policy_t pclass, const std::string & value,
                                HttpHandler::ptr_t handler);
 
+    /// Get the number of requests a policy class may currently
+    /// have in flight.  Changes over time for classes with
+    /// PO_ADAPTIVE_LIMIT set.
+    ///
+    /// @param pclass       Policy class ID.
+    /// @return             Current limit or 0 if the class or
+    ///                     service doesn't exist.
+    ///
+    /// Threading:  callable by any thread.
+    static long getActiveLimit(policy_t pclass);
+
     /// @}
 
     /// @name RequestMethods
@@ -379,6 +422,9 @@ class HttpRequest
     /// @param  options         @see requestGet()
     /// @param  headers         "
     /// @param  handler         "
+    /// @param  priority        Initial priority, higher values first.
+    ///                         Saves a requestSetPriority() right
+    ///                         after the request is issued.
     /// @return                 "
     ///
     HttpHandle requestGetByteRange(policy_t policy_id,
@@ -387,7 +433,8 @@ class HttpRequest
                                    size_t len,
                                    const HttpOptions::ptr_t & options,
                                    const HttpHeaders::ptr_t & headers,
-                                   HttpHandler::ptr_t handler);
+                                   HttpHandler::ptr_t handler,
+                                   priority_t priority = 0U);
 
 
     /// Queue a full HTTP POST.  Query arguments and body may
@@ -575,6 +622,26 @@ class HttpRequest
 
     HttpHandle requestCancel(HttpHandle request, HttpHandler::ptr_t);
 
+    /// Change the priority and deadline of a request still waiting
+    /// for a connection.  Requests start out at priority 0 with no
+    /// deadline and are served in order of priority, then earliest
+    /// deadline, then arrival.  A request whose deadline passes
+    /// before it is started is canceled and completes with an
+    /// HE_OP_CANCELED status.  Requests already started or waiting
+    /// to retry are unaffected and this request completes with an
+    /// HE_HANDLE_NOT_FOUND status.
+    ///
+    /// @param  request         Handle of a previously issued request.
+    /// @param  priority        New priority, higher values first.
+    /// @param  deadline        Time, as from totalTime(), after which
+    ///                         the request is no longer wanted, or 0
+    ///                         for none.
+    /// @param  handler         (optional)
+    /// @return                 Standard handle return cases.
+    ///
+    HttpHandle requestSetPriority(HttpHandle request, priority_t priority, HttpTime deadline,
+                                  HttpHandler::ptr_t handler);
+
     /// @}
 
     /// @name UtilityMethods
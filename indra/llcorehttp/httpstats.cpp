@@ -42,6 +42,8 @@ HTTPStats::~HTTPStats()
 void HTTPStats::resetStats()
 {
     mResutCodes.clear();
+    mMultiplexCounts.clear();
+    mConcurrencyCounts.clear();
     mDataDown.reset();
     mDataUp.reset();
     mRequests = 0;
@@ -61,6 +63,43 @@ void HTTPStats::recordResultCode(S32 code)
 
 }
 
+
+void HTTPStats::recordMultiplexedTransfer(S32 policy_class, bool http2, bool reused_connection, bool stalled)
+{
+    MultiplexCounts& counts = mMultiplexCounts[policy_class];
+    ++counts.mTransfers;
+    counts.mHttp2Streams += http2 ? 1 : 0;
+    counts.mReusedConnections += reused_connection ? 1 : 0;
+    counts.mStalls += stalled ? 1 : 0;
+}
+
+
+HTTPStats::MultiplexCounts HTTPStats::getMultiplexCounts(S32 policy_class) const
+{
+    std::map<S32, MultiplexCounts>::const_iterator it = mMultiplexCounts.find(policy_class);
+    return it == mMultiplexCounts.end() ? MultiplexCounts() : it->second;
+}
+
+
+void HTTPStats::recordConcurrencyChange(S32 policy_class, S32 old_limit, S32 new_limit, bool throttled)
+{
+    ConcurrencyCounts& counts = mConcurrencyCounts[policy_class];
+    if (new_limit > old_limit)
+    {
+        ++counts.mIncreases;
+    }
+    else if (throttled)
+    {
+        ++counts.mThrottledDecreases;
+    }
+    else
+    {
+        ++counts.mLatencyDecreases;
+    }
+    counts.mLimit = new_limit;
+    counts.mPeakLimit = llmax(counts.mPeakLimit, new_limit);
+}
+
 namespace
 {
     std::string byte_count_converter(F32 bytes)
@@ -101,6 +140,28 @@ void HTTPStats::dumpStats()
         out << (*it).first << " " << (*it).second << std::endl;
     }
 
+    if (!mMultiplexCounts.empty())
+    {
+        out << std::endl;
+        out << "HTTP/2 classes:" << std::endl << "Class Transfers Streams Reused Stalls" << std::endl;
+        for (const auto& [policy_class, counts] : mMultiplexCounts)
+        {
+            out << policy_class << " " << counts.mTransfers << " " << counts.mHttp2Streams
+                << " " << counts.mReusedConnections << " " << counts.mStalls << std::endl;
+        }
+    }
+
+    if (!mConcurrencyCounts.empty())
+    {
+        out << std::endl;
+        out << "Adaptive classes:" << std::endl << "Class Limit Peak Increases Throttled Queueing" << std::endl;
+        for (const auto& [policy_class, counts] : mConcurrencyCounts)
+        {
+            out << policy_class << " " << counts.mLimit << " " << counts.mPeakLimit << " " << counts.mIncreases
+                << " " << counts.mThrottledDecreases << " " << counts.mLatencyDecreases << std::endl;
+        }
+    }
+
     LL_WARNS("HTTPCore") << out.str() << LL_ENDL;
 }
 
@@ -59,7 +59,25 @@ namespace LLCore
 
         void    recordResultCode(S32 code);
 
+        // Transfer on a policy class with HTTP/2 enabled
+        void    recordMultiplexedTransfer(S32 policy_class, bool http2, bool reused_connection, bool stalled);
+
+        // Adaptive request limit of a policy class moved
+        void    recordConcurrencyChange(S32 policy_class, S32 old_limit, S32 new_limit, bool throttled);
+
         void    dumpStats();
+
+        struct MultiplexCounts
+        {
+            S32 mTransfers = 0;
+            S32 mHttp2Streams = 0;      // Transfers actually served over HTTP/2
+            S32 mReusedConnections = 0; // Transfers that didn't open a connection
+            S32 mStalls = 0;            // Slow first byte while multiplexed
+        };
+
+        // All zero for classes with no multiplexed transfers
+        MultiplexCounts getMultiplexCounts(S32 policy_class) const;
+
     private:
         StatsAccumulator mDataDown;
         StatsAccumulator mDataUp;
@@ -67,6 +85,18 @@ namespace LLCore
         S32              mRequests;
 
         std::map<S32, S32> mResutCodes;
+
+        std::map<S32, MultiplexCounts> mMultiplexCounts;
+
+        struct ConcurrencyCounts
+        {
+            S32 mIncreases = 0;
+            S32 mThrottledDecreases = 0;    // After 503, 429 or timeouts
+            S32 mLatencyDecreases = 0;      // Requests queueing without gain
+            S32 mLimit = 0;
+            S32 mPeakLimit = 0;
+        };
+        std::map<S32, ConcurrencyCounts> mConcurrencyCounts;
     };
 
 
@@ -374,6 +374,77 @@ void BufferArrayTestObjectType::test<8>()
     ba->release();
 }
 
+namespace
+{
+int contiguous_frees(0);
+
+void * contiguous_alloc(size_t len)
+{
+    return new char[len];
+}
+
+void contiguous_free(void * mem)
+{
+    ++contiguous_frees;
+    delete [] static_cast<char *>(mem);
+}
+}
+
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+    set_test_name("BufferArray contiguous reserve and detach");
+
+    contiguous_frees = 0;
+
+    // create a new ref counted object with an implicit reference
+    BufferArray * ba = new BufferArray();
+
+    char str1[] = "abcdefghij";
+    size_t str1_len(strlen(str1));
+    char buffer[256];
+
+    // Fill the reserved region with two appends
+    ensure("Reserve on empty BA", ba->reserveContiguous(2 * str1_len, contiguous_alloc, contiguous_free));
+    ensure("Nothing in BA after reserve", 0 == ba->size());
+    ba->append(str1, str1_len);
+    ba->append(str1, str1_len);
+    ensure("Recorded size correct", (2 * str1_len) == ba->size());
+
+    memset(buffer, 'X', sizeof(buffer));
+    size_t len = ba->read(str1_len - 2, buffer, 4);
+    ensure("Read across appends", 4 == len && 0 == strncmp(buffer, "ijab", 4));
+
+    // Take the region, BA is left empty
+    size_t detached_len(0);
+    char * detached(static_cast<char *>(ba->detachContiguous(&detached_len)));
+    ensure("Detached region", NULL != detached);
+    ensure("Detached length correct", (2 * str1_len) == detached_len);
+    ensure("Detached content correct", 0 == strncmp(detached, str1, str1_len)
+           && 0 == strncmp(detached + str1_len, str1, str1_len));
+    ensure("BA empty after detach", 0 == ba->size());
+    ensure("Detached region not freed", 0 == contiguous_frees);
+    contiguous_free(detached);
+
+    // release the implicit reference, causing the object to be released
+    ba->release();
+
+    // Overflowing the region falls back to blocks and can't be detached
+    ba = new BufferArray();
+    ensure("Reserve on empty BA.2", ba->reserveContiguous(str1_len, contiguous_alloc, contiguous_free));
+    ensure("Reserve only once", ! ba->reserveContiguous(str1_len, contiguous_alloc, contiguous_free));
+    ba->append(str1, str1_len);
+    ba->append(str1, str1_len);
+    len = ba->read(0, buffer, sizeof(buffer));
+    ensure("Overflow read length correct", (2 * str1_len) == len);
+    ensure("Overflow content correct", 0 == strncmp(buffer + str1_len, str1, str1_len));
+    ensure("No detach after overflow", NULL == ba->detachContiguous(&detached_len));
+
+    contiguous_frees = 0;
+    ba->release();
+    ensure("Region freed with BA", 1 == contiguous_frees);
+}
+
 }  // end namespace tut
 
 
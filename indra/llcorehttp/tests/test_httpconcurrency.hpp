@@ -0,0 +1,192 @@
+/**
+ * @file test_httpconcurrency.hpp
+ * @brief unit tests for the adaptive request concurrency controller
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#ifndef TEST_LLCORE_HTTP_CONCURRENCY_H_
+#define TEST_LLCORE_HTTP_CONCURRENCY_H_
+
+#include "_httpconcurrency.h"
+#include "_httpinternal.h"
+#include "llhttpconstants.h"
+
+#include <iostream>
+
+
+using namespace LLCore;
+
+
+namespace tut
+{
+
+struct HttpConcurrencyTestData
+{
+    // the test objects inherit from this so the member functions and variables
+    // can be referenced directly inside of the test functions.
+
+    HttpConcurrencyTestData()
+        : mNow(HTTP_ADAPTIVE_WINDOW_USECS)
+        {}
+
+    // Run one window in which the class kept 'active' requests in
+    // flight and completed 'count' of them, each of 'bytes' after
+    // 'latency' microseconds.
+    HttpConcurrencyController::EDecision window(HttpConcurrencyController & controller,
+                                                int active, int count, size_t bytes,
+                                                HttpTime latency,
+                                                const HttpStatus & status = HttpStatus(HTTP_PARTIAL_CONTENT))
+        {
+            controller.noteActive(active);
+            for (int i(0); i < count; ++i)
+            {
+                controller.noteCompletion(status, latency, bytes);
+            }
+            mNow += HTTP_ADAPTIVE_WINDOW_USECS;
+            return controller.update(mNow);
+        }
+
+    HttpTime mNow;
+};
+
+typedef test_group<HttpConcurrencyTestData> HttpConcurrencyTestGroupType;
+typedef HttpConcurrencyTestGroupType::object HttpConcurrencyTestObjectType;
+HttpConcurrencyTestGroupType HttpConcurrencyTestGroup("HttpConcurrency Tests");
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<1>()
+{
+    set_test_name("HttpConcurrencyController configuration");
+
+    HttpConcurrencyController controller;
+    ensure("Disabled by default", ! controller.isEnabled());
+    ensure("Never changes when disabled", HttpConcurrencyController::HOLD == window(controller, 100, 100, 1000, 1000));
+
+    controller.configure(8, 32);
+    ensure("Enabled with a ceiling", controller.isEnabled());
+    ensure_equals("Starts from the static limit", controller.getLimit(), 8L);
+
+    controller.configure(64, 32);
+    ensure_equals("Starts at or below the ceiling", controller.getLimit(), 32L);
+
+    controller.configure(0, 32);
+    ensure_equals("Starts at or above the minimum", controller.getLimit(), HTTP_ADAPTIVE_LIMIT_MIN);
+}
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<2>()
+{
+    set_test_name("HttpConcurrencyController growth");
+
+    HttpConcurrencyController controller;
+    controller.configure(4, 40);
+    ensure("First window only starts timing", HttpConcurrencyController::HOLD == controller.update(mNow));
+
+    // Throughput follows the limit, as on a fast idle link
+    long limit(controller.getLimit());
+    for (int i(0); i < 4; ++i)
+    {
+        ensure("Grows while the limit is reached",
+               HttpConcurrencyController::INCREASE == window(controller, int(limit), int(limit), 100000, 50000));
+        ensure("Grows quickly when starting", controller.getLimit() > limit + 1);
+        limit = controller.getLimit();
+    }
+
+    // Throughput stops following, additive growth from then on
+    window(controller, int(limit), int(limit), 100000 * 4 / limit, 50000);
+    limit = controller.getLimit();
+    ensure("Grows by one past the knee",
+           HttpConcurrencyController::INCREASE == window(controller, int(limit), 4, 100000, 50000));
+    ensure_equals("Grows by one", controller.getLimit(), limit + 1);
+
+    // Not using the room it has
+    limit = controller.getLimit();
+    ensure("Holds when the limit isn't reached",
+           HttpConcurrencyController::HOLD == window(controller, int(limit) / 2, 4, 100000, 50000));
+    ensure_equals("Holds", controller.getLimit(), limit);
+
+    for (int i(0); i < 100; ++i)
+    {
+        window(controller, int(controller.getLimit()), 4, 100000, 50000);
+    }
+    ensure_equals("Stops at the ceiling", controller.getLimit(), 40L);
+}
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<3>()
+{
+    set_test_name("HttpConcurrencyController throttling");
+
+    HttpConcurrencyController controller;
+    controller.configure(32, 64);
+    controller.update(mNow);
+
+    ensure("Backs off on 503",
+           HttpConcurrencyController::DECREASE_THROTTLED == window(controller, 32, 1, 0, 0, HttpStatus(HTTP_SERVICE_UNAVAILABLE)));
+    ensure_equals("Halves on 503", controller.getLimit(), 16L);
+
+    ensure("Backs off on 429",
+           HttpConcurrencyController::DECREASE_THROTTLED == window(controller, 16, 1, 0, 0, HttpStatus(429)));
+    ensure_equals("Halves on 429", controller.getLimit(), 8L);
+
+    for (int i(0); i < 10; ++i)
+    {
+        window(controller, 8, 1, 0, 0, HttpStatus(HttpStatus::EXT_CURL_EASY, CURLE_OPERATION_TIMEDOUT));
+    }
+    ensure_equals("Stops at the minimum", controller.getLimit(), HTTP_ADAPTIVE_LIMIT_MIN);
+
+    // After throttling, growth is additive
+    window(controller, 2, 2, 100000, 50000);
+    ensure_equals("Grows by one after throttling", controller.getLimit(), HTTP_ADAPTIVE_LIMIT_MIN + 1);
+}
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<4>()
+{
+    set_test_name("HttpConcurrencyController queueing");
+
+    HttpConcurrencyController controller;
+    controller.configure(20, 40);
+    controller.update(mNow);
+
+    // Establish the unloaded latency
+    window(controller, 10, 20, 100000, 100000);
+    const long limit(controller.getLimit());
+
+    // Same throughput, three times the latency
+    ensure("Backs off when only latency grows",
+           HttpConcurrencyController::DECREASE_LATENCY == window(controller, int(limit), 20, 100000, 300000));
+    ensure("Backs off gently", controller.getLimit() < limit && controller.getLimit() > limit / 2);
+
+    // Slower but gaining throughput isn't queueing
+    const long reduced(controller.getLimit());
+    ensure("Keeps latency that pays off",
+           HttpConcurrencyController::DECREASE_LATENCY != window(controller, int(reduced), 40, 100000, 300000));
+
+    // An idle class isn't judged on the idle time
+    mNow += 10 * HTTP_ADAPTIVE_WINDOW_USECS;
+    ensure("Idle time restarts the window", HttpConcurrencyController::HOLD == controller.update(mNow));
+}
+
+}  // end namespace tut
+
+#endif  // TEST_LLCORE_HTTP_CONCURRENCY_H_
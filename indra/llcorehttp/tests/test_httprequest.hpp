@@ -32,12 +32,18 @@
 #include "httpheaders.h"
 #include "httpresponse.h"
 #include "httpoptions.h"
+#include "httpstats.h"
+#include "_httpinternal.h"
 #include "_httpservice.h"
 #include "_httprequestqueue.h"
+#include "lltimer.h"
 
 #include <curl/curl.h>
 #include <boost/regex.hpp>
+#include <iostream>
+#include <map>
 #include <sstream>
+#include <vector>
 
 #include "llcorehttp_test.h"
 
@@ -3036,6 +3042,343 @@ void HttpRequestTestObjectType::test<23>()
 }
 
 
+template <> template <>
+void HttpRequestTestObjectType::test<24>()
+{
+    ScopedCurlInit ready;
+
+    std::string url_base(get_base_url());
+
+    set_test_name("HttpRequest GET latency to real service");
+
+    // Timing only, the other GET tests already check requests complete
+    if (!getenv("LL_TEST_BENCHMARKS"))
+    {
+        skip("set LL_TEST_BENCHMARKS to time GET latency");
+    }
+
+    // Handler can be stack-allocated *if* there are no dangling
+    // references to it after completion of this method.
+    TestHandler2 handler(this, "handler");
+    LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+    mHandlerCalls = 0;
+
+    HttpRequest * req = NULL;
+
+    try
+    {
+        // Get singletons created
+        HttpRequest::createService();
+
+        // Start threading early so that thread memory is invariant
+        // over the test.
+        HttpRequest::startThread();
+
+        // create a new ref counted object with an implicit reference
+        req = new HttpRequest();
+
+        // Issue GETs one at a time, each only once the previous one
+        // completed, so each measures a full submit to completion trip
+        // through the worker thread.  Keep the pump tight so that it
+        // doesn't dominate.
+        mStatus = HttpStatus(200);
+        const int request_count(50);
+        F64 total_seconds(0.0);
+        F64 worst_seconds(0.0);
+        for (int i(0); i < request_count; ++i)
+        {
+            LLTimer timer;
+            HttpHandle handle = req->requestGet(HttpRequest::DEFAULT_POLICY_ID,
+                                                url_base,
+                                                HttpOptions::ptr_t(),
+                                                HttpHeaders::ptr_t(),
+                                                handlerp);
+            ensure("Valid handle returned for request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+            int count(0);
+            int limit(LOOP_COUNT_LONG * 100);
+            while (count++ < limit && mHandlerCalls < i + 1)
+            {
+                req->update(0);
+                usleep(LOOP_SLEEP_INTERVAL / 100);
+            }
+            ensure("Request executed in reasonable time", count < limit);
+
+            F64 seconds(timer.getElapsedTimeF64());
+            total_seconds += seconds;
+            worst_seconds = (std::max)(worst_seconds, seconds);
+        }
+        ensure("One handler invocation per request", mHandlerCalls == request_count);
+        std::cout << "\nHttpRequest GET latency over " << request_count << " requests:  "
+                  << (total_seconds * 1000.0 / request_count) << "ms mean, "
+                  << (worst_seconds * 1000.0) << "ms worst" << std::endl;
+
+        // Okay, request a shutdown of the servicing thread
+        mStatus = HttpStatus();
+        HttpHandle handle = req->requestStopThread(handlerp);
+        ensure("Valid handle returned for stop request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+        // Run the notification pump again
+        int count(0);
+        int limit(LOOP_COUNT_LONG);
+        while (count++ < limit && mHandlerCalls < request_count + 1)
+        {
+            req->update(1000000);
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Stop request executed in reasonable time", count < limit);
+
+        // See that we actually shutdown the thread
+        count = 0;
+        limit = LOOP_COUNT_SHORT;
+        while (count++ < limit && ! HttpService::isStopped())
+        {
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Thread actually stopped running", HttpService::isStopped());
+
+        // release the request object
+        delete req;
+        req = NULL;
+
+        // Shut down service
+        HttpRequest::destroyService();
+    }
+    catch (...)
+    {
+        stop_thread(req);
+        delete req;
+        HttpRequest::destroyService();
+        throw;
+    }
+}
+
+
+template <> template <>
+void HttpRequestTestObjectType::test<25>()
+{
+    ScopedCurlInit ready;
+
+    std::string url_base(get_base_url());
+
+    set_test_name("HttpRequest priority and deadlines against real service");
+
+    // Records completion order of each request
+    class PriorityHandler : public LLCore::HttpHandler
+    {
+    public:
+        virtual void onCompleted(HttpHandle handle, HttpResponse * response)
+            {
+                if (response->getStatus() == HttpStatus(HttpStatus::LLCORE, HE_OP_CANCELED))
+                {
+                    ++mCanceled;
+                }
+                mDone[handle] = int(mDone.size());
+            }
+
+        std::map<HttpHandle, int> mDone;
+        int mCanceled = 0;
+    };
+
+    PriorityHandler handler;
+    LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+
+    HttpRequest * req = NULL;
+
+    try
+    {
+        // Get singletons created
+        HttpRequest::createService();
+
+        // One connection so that requests queue up behind each other
+        HttpRequest::setStaticPolicyOption(HttpRequest::PO_CONNECTION_LIMIT, HttpRequest::DEFAULT_POLICY_ID, 1, NULL);
+
+        HttpRequest::startThread();
+
+        req = new HttpRequest();
+
+        // Off-screen requests queued first, then on-screen ones.  The
+        // on-screen requests' priority is then raised and half of the
+        // off-screen ones get a deadline that has already passed.
+        const int offscreen_count(40);
+        const int onscreen_count(20);
+        std::vector<HttpHandle> offscreen, onscreen;
+        for (int i(0); i < offscreen_count + onscreen_count; ++i)
+        {
+            HttpHandle handle = req->requestGet(HttpRequest::DEFAULT_POLICY_ID,
+                                                url_base,
+                                                HttpOptions::ptr_t(),
+                                                HttpHeaders::ptr_t(),
+                                                handlerp);
+            ensure("Valid handle returned for request", handle != LLCORE_HTTP_HANDLE_INVALID);
+            (i < offscreen_count ? offscreen : onscreen).push_back(handle);
+        }
+        for (HttpHandle handle : onscreen)
+        {
+            req->requestSetPriority(handle, 100, HttpTime(0), HttpHandler::ptr_t());
+        }
+        for (int i(offscreen_count / 2); i < offscreen_count; ++i)
+        {
+            req->requestSetPriority(offscreen[i], 0, totalTime(), HttpHandler::ptr_t());
+        }
+
+        int count(0);
+        int limit(LOOP_COUNT_LONG * 100);
+        while (count++ < limit && handler.mDone.size() < offscreen.size() + onscreen.size())
+        {
+            req->update(0);
+            usleep(LOOP_SLEEP_INTERVAL / 100);
+        }
+        ensure("Requests executed in reasonable time", count < limit);
+
+        // The worker may have started a few before the changes arrived
+        ensure("Stale requests canceled", handler.mCanceled > 0 && handler.mCanceled <= offscreen_count / 2);
+
+        int last_onscreen(0), first_kept_offscreen(offscreen_count + onscreen_count);
+        for (HttpHandle handle : onscreen)
+        {
+            last_onscreen = (std::max)(last_onscreen, handler.mDone[handle]);
+        }
+        for (int i(offscreen_count / 4); i < offscreen_count / 2; ++i)
+        {
+            first_kept_offscreen = (std::min)(first_kept_offscreen, handler.mDone[offscreen[i]]);
+        }
+        ensure("On-screen requests served before later off-screen ones", last_onscreen < first_kept_offscreen);
+
+        // Okay, request a shutdown of the servicing thread
+        TestHandler2 stop_handler(this, "handler");
+        LLCore::HttpHandler::ptr_t stop_handlerp(&stop_handler, NoOpDeletor);
+        mHandlerCalls = 0;
+        mStatus = HttpStatus();
+        HttpHandle handle = req->requestStopThread(stop_handlerp);
+        ensure("Valid handle returned for stop request", handle != LLCORE_HTTP_HANDLE_INVALID);
+
+        // Run the notification pump again
+        count = 0;
+        limit = LOOP_COUNT_LONG;
+        while (count++ < limit && mHandlerCalls < 1)
+        {
+            req->update(1000000);
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Stop request executed in reasonable time", count < limit);
+
+        // See that we actually shutdown the thread
+        count = 0;
+        limit = LOOP_COUNT_SHORT;
+        while (count++ < limit && ! HttpService::isStopped())
+        {
+            usleep(LOOP_SLEEP_INTERVAL);
+        }
+        ensure("Thread actually stopped running", HttpService::isStopped());
+
+        // release the request object
+        delete req;
+        req = NULL;
+
+        // Shut down service
+        HttpRequest::destroyService();
+    }
+    catch (...)
+    {
+        stop_thread(req);
+        delete req;
+        HttpRequest::destroyService();
+        throw;
+    }
+}
+
+
+template <> template <>
+void HttpRequestTestObjectType::test<26>()
+{
+    ScopedCurlInit ready;
+
+    set_test_name("HttpRequest PO_HTTP2_STREAMS option");
+
+    try
+    {
+        // Get singletons created
+        HttpRequest::createService();
+
+        HttpRequest::policy_t pclass(HttpRequest::createPolicyClass());
+        ensure("Policy class created", pclass != HttpRequest::INVALID_POLICY_ID);
+
+        // Off until asked for
+        long value(-1);
+        HttpStatus status(HttpService::instanceOf()->getPolicyOption(HttpRequest::PO_HTTP2_STREAMS, pclass, &value));
+        ensure("Get succeeded", bool(status));
+        ensure_equals("Default is off", value, HTTP_HTTP2_STREAMS_DEFAULT);
+
+        value = -1;
+        status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS, pclass, 16, &value);
+        ensure("Set succeeded", bool(status));
+        ensure_equals("Set value returned", value, 16L);
+        value = -1;
+        HttpService::instanceOf()->getPolicyOption(HttpRequest::PO_HTTP2_STREAMS, pclass, &value);
+        ensure_equals("Set value kept", value, 16L);
+
+        value = -1;
+        HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS, pclass, HTTP_HTTP2_STREAMS_MAX + 1, &value);
+        ensure_equals("Clamped to maximum", value, HTTP_HTTP2_STREAMS_MAX);
+
+        // Class option only
+        status = HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAMS, HttpRequest::GLOBAL_POLICY_ID, 16, NULL);
+        ensure("Global set refused", ! status);
+
+        HttpRequest::destroyService();
+    }
+    catch (...)
+    {
+        HttpRequest::destroyService();
+        throw;
+    }
+}
+
+template <> template <>
+void HttpRequestTestObjectType::test<27>()
+{
+    ScopedCurlInit ready;
+
+    set_test_name("HTTPStats multiplexed transfer counts");
+
+    try
+    {
+        // Get singletons created
+        HttpRequest::createService();
+
+        HTTPStats & stats(HTTPStats::instance());
+        stats.recordMultiplexedTransfer(2, true, false, false);
+        stats.recordMultiplexedTransfer(2, true, true, false);
+        stats.recordMultiplexedTransfer(2, true, true, true);
+        stats.recordMultiplexedTransfer(2, false, false, false);
+        stats.recordMultiplexedTransfer(3, true, true, false);
+
+        HTTPStats::MultiplexCounts counts(stats.getMultiplexCounts(2));
+        ensure_equals("Transfers", counts.mTransfers, 4);
+        ensure_equals("HTTP/2 streams", counts.mHttp2Streams, 3);
+        ensure_equals("Reused connections", counts.mReusedConnections, 2);
+        ensure_equals("Stalls", counts.mStalls, 1);
+
+        counts = stats.getMultiplexCounts(3);
+        ensure_equals("Other class transfers", counts.mTransfers, 1);
+        ensure_equals("Other class streams", counts.mHttp2Streams, 1);
+
+        ensure_equals("Unused class", stats.getMultiplexCounts(4).mTransfers, 0);
+
+        stats.resetStats();
+        ensure_equals("Reset", stats.getMultiplexCounts(2).mTransfers, 0);
+
+        HttpRequest::destroyService();
+    }
+    catch (...)
+    {
+        HttpRequest::destroyService();
+        throw;
+    }
+}
+
+
 }  // end namespace tut
 
 namespace
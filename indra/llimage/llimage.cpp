@@ -2538,6 +2538,20 @@ bool LLImageFormatted::save(const std::string &filename)
     return (result != 0);
 }
 
+// virtual
+bool LLImageFormatted::encodeToFile(const LLImageRaw* raw_image, const std::string& filename, const encode_progress_callback_t& progress)
+{
+    if (!encode(raw_image, 0.f))
+    {
+        return false;
+    }
+    if (progress)
+    {
+        progress(1.f);
+    }
+    return save(filename);
+}
+
 S8 LLImageFormatted::getCodec() const
 {
     return mCodec;
@@ -32,6 +32,8 @@
 #include "llpointer.h"
 #include "lltrace.h"
 
+#include <functional>
+
 constexpr S32 MIN_IMAGE_MIP =  2; // 4x4, only used for expand/contract power of 2
 constexpr S32 MAX_IMAGE_MIP = 12; // 4096x4096
 
@@ -368,6 +370,14 @@ class LLImageFormatted : public LLImageBase
 
     virtual bool encode(const LLImageRaw* raw_image, F32 encode_time) = 0;
 
+    // Called with the fraction of the image written so far, from the encoding thread.
+    typedef std::function<void(F32 progress)> encode_progress_callback_t;
+    // Encodes raw_image straight into filename. Codecs able to stream their output override
+    // this so that the whole compressed image is never held in memory. Safe to call from a
+    // worker thread as long as nobody writes raw_image meanwhile.
+    virtual bool encodeToFile(const LLImageRaw* raw_image, const std::string& filename,
+                              const encode_progress_callback_t& progress = encode_progress_callback_t());
+
     S8 getCodec() const;
     bool isDecoding() const { return mDecoding; }
     bool isDecoded()  const { return mDecoded; }
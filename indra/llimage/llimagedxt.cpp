@@ -26,8 +26,11 @@
 #include "linden_common.h"
 
 #include "llimagedxt.h"
+#include "llmath.h"
 #include "llmemory.h"
 
+#include <climits>
+
 //static
 void LLImageDXT::checkMinWidthHeight(EFileFormat format, S32& width, S32& height)
 {
@@ -265,7 +268,9 @@ bool LLImageDXT::decode(LLImageRaw* raw_image, F32 time)
     //  but we don't use it any more!
     llassert_always(raw_image);
 
-    if (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR5)
+    // Only the formats encodeCompressed() writes can be decompressed
+    const bool decompress = (mFileFormat == FORMAT_DXR1 || mFileFormat == FORMAT_DXR5);
+    if (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR5 && !decompress)
     {
         LL_WARNS() << "Attempt to decode compressed LLImageDXT to Raw (unsupported)" << LL_ENDL;
         return false;
@@ -299,7 +304,14 @@ bool LLImageDXT::decode(LLImageRaw* raw_image, F32 time)
         setLastError("llImageDXT failed to resize image!");
         return false;
     }
-    memcpy(raw_image->getData(), data, image_size); /* Flawfinder: ignore */
+    if (decompress)
+    {
+        decompressMip(data, raw_image->getData(), width, height, ncomponents, mFileFormat);
+    }
+    else
+    {
+        memcpy(raw_image->getData(), data, image_size); /* Flawfinder: ignore */
+    }
 
     return true;
 }
@@ -418,6 +430,124 @@ bool LLImageDXT::encode(const LLImageRaw* raw_image, F32 time)
     return encodeDXT(raw_image, time, false);
 }
 
+//static
+bool LLImageDXT::canCompress(const LLImageRaw* raw_image)
+{
+    if (!raw_image || raw_image->isBufferInvalid())
+    {
+        return false;
+    }
+    S32 width = raw_image->getWidth();
+    S32 height = raw_image->getHeight();
+    S32 ncomponents = raw_image->getComponents();
+    // Block layout of the smaller mips only matches formatBytes() for power of two sizes
+    return (ncomponents == 3 || ncomponents == 4)
+        && width >= 4 && height >= 4
+        && !(width & (width - 1)) && !(height & (height - 1));
+}
+
+//static
+LLPointer<LLImageDXT> LLImageDXT::createCompressed(const LLImageRaw* raw_image, S32 quality)
+{
+    if (quality <= COMPRESS_NONE || !canCompress(raw_image))
+    {
+        return NULL;
+    }
+    LLPointer<LLImageDXT> compressed = new LLImageDXT();
+    if (!compressed->encodeCompressed(raw_image, quality))
+    {
+        return NULL;
+    }
+    return compressed;
+}
+
+bool LLImageDXT::encodeCompressed(const LLImageRaw* raw_image, S32 quality)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert_always(raw_image);
+
+    if (!canCompress(raw_image))
+    {
+        setLastError("LLImageDXT can not compress image of this size or format");
+        return false;
+    }
+
+    LLImageDataSharedLock lockIn(raw_image);
+    LLImageDataLock lockOut(this);
+
+    S32 width = raw_image->getWidth();
+    S32 height = raw_image->getHeight();
+    S32 ncomponents = raw_image->getComponents();
+    const U8* rawdata = raw_image->getData();
+
+    // Opaque RGBA images fit in BC1 at half the size of BC3
+    EFileFormat format = FORMAT_DXR1;
+    if (ncomponents == 4)
+    {
+        const S32 data_size = width * height * 4;
+        for (S32 i = 3; i < data_size; i += 4)
+        {
+            if (rawdata[i] != 255)
+            {
+                format = FORMAT_DXR5;
+                break;
+            }
+        }
+    }
+
+    setSize(width, height, formatComponents(format));
+    mHeaderSize = sizeof(dxtfile_header_t);
+    mFileFormat = format;
+
+    S32 nmips = calcNumMips(width, height);
+    S32 w = width;
+    S32 h = height;
+
+    S32 totbytes = mHeaderSize;
+    for (S32 mip=0; mip<nmips; mip++)
+    {
+        totbytes += formatBytes(format,w,h);
+        w >>= 1;
+        h >>= 1;
+    }
+
+    U8* data = allocateData(totbytes);
+    if (!data)
+    {
+        setLastError("LLImageDXT failed to allocate compressed image");
+        return false;
+    }
+
+    dxtfile_header_t* header = (dxtfile_header_t*)data;
+    memset(header, 0, mHeaderSize);
+    header->fourcc = 0x20534444;
+    header->pixel_fmt.fourcc = getFourCC(format);
+    header->num_mips = nmips;
+    header->maxwidth = width;
+    header->maxheight = height;
+
+    // Each mip is box filtered from the previous uncompressed level, never
+    // from compressed data, so block errors do not accumulate down the chain.
+    std::vector<U8> mip_buffers[2];
+    const U8* prev_mipdata = rawdata;
+    w = width, h = height;
+    for (S32 mip=0; mip<nmips; mip++)
+    {
+        if (mip > 0)
+        {
+            std::vector<U8>& mip_buffer = mip_buffers[mip & 1];
+            mip_buffer.resize(w * h * ncomponents);
+            generateMip(prev_mipdata, mip_buffer.data(), w, h, ncomponents);
+            prev_mipdata = mip_buffer.data();
+        }
+        compressMip(prev_mipdata, data + getMipOffset(mip), w, h, ncomponents, format, quality);
+        w >>= 1;
+        h >>= 1;
+    }
+
+    return true;
+}
+
 // virtual
 bool LLImageDXT::convertToDXR()
 {
@@ -522,3 +652,478 @@ void LLImageDXT::extractMip(const U8 *indata, U8* mipdata, int width, int height
 }
 
 //============================================================================
+
+// CPU block encoder. Color blocks are always written in four color mode
+// (color0 > color1), which BC1 and BC3 decode identically.
+
+namespace
+{
+    // Expands 565 to 888, replicating the high bits like the hardware does
+    void unpack565(U16 color, S32* rgb)
+    {
+        S32 r = (color >> 11) & 0x1f;
+        S32 g = (color >> 5) & 0x3f;
+        S32 b = color & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    U16 pack565(F32 r, F32 g, F32 b)
+    {
+        S32 ir = llclamp(ll_round(r * 31.f / 255.f), 0, 31);
+        S32 ig = llclamp(ll_round(g * 63.f / 255.f), 0, 63);
+        S32 ib = llclamp(ll_round(b * 31.f / 255.f), 0, 31);
+        return (U16)((ir << 11) | (ig << 5) | ib);
+    }
+
+    // Picks the closest palette entry for every texel of an RGBA block,
+    // returns the packed 2 bit indices and the total squared error.
+    U32 match_colors(const U8* block, U16 color0, U16 color1, S32& error)
+    {
+        S32 palette[4][3];
+        unpack565(color0, palette[0]);
+        unpack565(color1, palette[1]);
+        for (S32 c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        U32 indices = 0;
+        error = 0;
+        for (S32 t = 0; t < 16; ++t)
+        {
+            const U8* texel = block + t * 4;
+            S32 best_index = 0;
+            S32 best_dist = INT_MAX;
+            for (S32 p = 0; p < 4; ++p)
+            {
+                S32 dr = texel[0] - palette[p][0];
+                S32 dg = texel[1] - palette[p][1];
+                S32 db = texel[2] - palette[p][2];
+                S32 dist = dr * dr + dg * dg + db * db;
+                if (dist < best_dist)
+                {
+                    best_dist = dist;
+                    best_index = p;
+                }
+            }
+            indices |= (U32)best_index << (t * 2);
+            error += best_dist;
+        }
+        return indices;
+    }
+
+    // Least squares fit of both endpoints to the current index assignment
+    bool refine_endpoints(const U8* block, U32 indices, U16& color0, U16& color1)
+    {
+        static const F32 weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+        F32 aa = 0.f, ab = 0.f, bb = 0.f;
+        F32 ax[3] = { 0.f, 0.f, 0.f };
+        F32 bx[3] = { 0.f, 0.f, 0.f };
+        for (S32 t = 0; t < 16; ++t)
+        {
+            const U8* texel = block + t * 4;
+            F32 a = weights[(indices >> (t * 2)) & 3];
+            F32 b = 1.f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (S32 c = 0; c < 3; ++c)
+            {
+                ax[c] += a * texel[c];
+                bx[c] += b * texel[c];
+            }
+        }
+
+        F32 det = aa * bb - ab * ab;
+        if (fabsf(det) < F_APPROXIMATELY_ZERO)
+        {
+            return false;
+        }
+        F32 inv_det = 1.f / det;
+        F32 c0[3], c1[3];
+        for (S32 c = 0; c < 3; ++c)
+        {
+            c0[c] = (ax[c] * bb - bx[c] * ab) * inv_det;
+            c1[c] = (bx[c] * aa - ax[c] * ab) * inv_det;
+        }
+        color0 = pack565(c0[0], c0[1], c0[2]);
+        color1 = pack565(c1[0], c1[1], c1[2]);
+        return true;
+    }
+
+    // Inset bounding box of the block, with the diagonal flipped for
+    // channels that are anti-correlated with red.
+    void bbox_endpoints(const U8* block, U16& color0, U16& color1)
+    {
+        F32 lo[3] = { 255.f, 255.f, 255.f };
+        F32 hi[3] = { 0.f, 0.f, 0.f };
+        F32 mean[3] = { 0.f, 0.f, 0.f };
+        for (S32 t = 0; t < 16; ++t)
+        {
+            for (S32 c = 0; c < 3; ++c)
+            {
+                F32 v = block[t * 4 + c];
+                lo[c] = llmin(lo[c], v);
+                hi[c] = llmax(hi[c], v);
+                mean[c] += v;
+            }
+        }
+        for (S32 c = 0; c < 3; ++c)
+        {
+            mean[c] *= 1.f / 16.f;
+            F32 inset = (hi[c] - lo[c]) / 16.f;
+            lo[c] += inset;
+            hi[c] -= inset;
+        }
+
+        for (S32 c = 1; c < 3; ++c)
+        {
+            F32 cov = 0.f;
+            for (S32 t = 0; t < 16; ++t)
+            {
+                cov += (block[t * 4] - mean[0]) * (block[t * 4 + c] - mean[c]);
+            }
+            if (cov < 0.f)
+            {
+                std::swap(lo[c], hi[c]);
+            }
+        }
+
+        color0 = pack565(hi[0], hi[1], hi[2]);
+        color1 = pack565(lo[0], lo[1], lo[2]);
+    }
+
+    // Extremes of the block along its principal axis
+    void pca_endpoints(const U8* block, U16& color0, U16& color1)
+    {
+        F32 mean[3] = { 0.f, 0.f, 0.f };
+        for (S32 t = 0; t < 16; ++t)
+        {
+            for (S32 c = 0; c < 3; ++c)
+            {
+                mean[c] += block[t * 4 + c];
+            }
+        }
+        for (S32 c = 0; c < 3; ++c)
+        {
+            mean[c] *= 1.f / 16.f;
+        }
+
+        F32 cov[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }; // rr rg rb gg gb bb
+        for (S32 t = 0; t < 16; ++t)
+        {
+            F32 r = block[t * 4] - mean[0];
+            F32 g = block[t * 4 + 1] - mean[1];
+            F32 b = block[t * 4 + 2] - mean[2];
+            cov[0] += r * r;
+            cov[1] += r * g;
+            cov[2] += r * b;
+            cov[3] += g * g;
+            cov[4] += g * b;
+            cov[5] += b * b;
+        }
+
+        // Power iteration converges quickly enough for 16 samples
+        F32 axis[3] = { 1.f, 1.f, 1.f };
+        for (S32 iter = 0; iter < 4; ++iter)
+        {
+            F32 x = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+            F32 y = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+            F32 z = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+            F32 len = llmax(llmax(fabsf(x), fabsf(y)), fabsf(z));
+            if (len < F_APPROXIMATELY_ZERO)
+            {
+                // flat block
+                break;
+            }
+            F32 inv_len = 1.f / len;
+            axis[0] = x * inv_len;
+            axis[1] = y * inv_len;
+            axis[2] = z * inv_len;
+        }
+
+        F32 min_dot = F32_MAX, max_dot = -F32_MAX;
+        S32 min_texel = 0, max_texel = 0;
+        for (S32 t = 0; t < 16; ++t)
+        {
+            const U8* texel = block + t * 4;
+            F32 dot = texel[0] * axis[0] + texel[1] * axis[1] + texel[2] * axis[2];
+            if (dot < min_dot)
+            {
+                min_dot = dot;
+                min_texel = t;
+            }
+            if (dot > max_dot)
+            {
+                max_dot = dot;
+                max_texel = t;
+            }
+        }
+
+        const U8* hi = block + max_texel * 4;
+        const U8* lo = block + min_texel * 4;
+        color0 = pack565(hi[0], hi[1], hi[2]);
+        color1 = pack565(lo[0], lo[1], lo[2]);
+    }
+
+    void write_color_block(U8* dest, U16 color0, U16 color1, U32 indices)
+    {
+        if (color0 < color1)
+        {
+            // swapping the endpoints swaps index 0 with 1 and 2 with 3
+            std::swap(color0, color1);
+            indices ^= 0x55555555;
+        }
+        else if (color0 == color1)
+        {
+            indices = 0;
+        }
+        dest[0] = (U8)(color0 & 0xff);
+        dest[1] = (U8)(color0 >> 8);
+        dest[2] = (U8)(color1 & 0xff);
+        dest[3] = (U8)(color1 >> 8);
+        for (S32 i = 0; i < 4; ++i)
+        {
+            dest[4 + i] = (U8)(indices >> (i * 8));
+        }
+    }
+
+    void compress_color_block(const U8* block, U8* dest, S32 quality)
+    {
+        U16 color0, color1;
+        S32 error;
+        if (quality >= LLImageDXT::COMPRESS_HIGH)
+        {
+            pca_endpoints(block, color0, color1);
+        }
+        else
+        {
+            bbox_endpoints(block, color0, color1);
+        }
+        U32 indices = match_colors(block, color0, color1, error);
+
+        if (quality >= LLImageDXT::COMPRESS_HIGH && error > 0)
+        {
+            U16 refined0 = color0, refined1 = color1;
+            if (refine_endpoints(block, indices, refined0, refined1))
+            {
+                S32 refined_error;
+                U32 refined_indices = match_colors(block, refined0, refined1, refined_error);
+                if (refined_error < error)
+                {
+                    color0 = refined0;
+                    color1 = refined1;
+                    indices = refined_indices;
+                }
+            }
+        }
+
+        write_color_block(dest, color0, color1, indices);
+    }
+
+    // BC3 alpha block in eight value mode (alpha0 > alpha1)
+    void compress_alpha_block(const U8* block, U8* dest)
+    {
+        S32 alpha0 = 0, alpha1 = 255;
+        for (S32 t = 0; t < 16; ++t)
+        {
+            alpha0 = llmax(alpha0, (S32)block[t * 4 + 3]);
+            alpha1 = llmin(alpha1, (S32)block[t * 4 + 3]);
+        }
+        dest[0] = (U8)alpha0;
+        dest[1] = (U8)alpha1;
+
+        U64 bits = 0;
+        if (alpha0 > alpha1)
+        {
+            S32 palette[8];
+            palette[0] = alpha0;
+            palette[1] = alpha1;
+            for (S32 i = 2; i < 8; ++i)
+            {
+                palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+            }
+            for (S32 t = 0; t < 16; ++t)
+            {
+                S32 alpha = block[t * 4 + 3];
+                S32 best_index = 0;
+                S32 best_dist = INT_MAX;
+                for (S32 p = 0; p < 8; ++p)
+                {
+                    S32 dist = llabs(alpha - palette[p]);
+                    if (dist < best_dist)
+                    {
+                        best_dist = dist;
+                        best_index = p;
+                    }
+                }
+                bits |= (U64)best_index << (t * 3);
+            }
+        }
+        for (S32 i = 0; i < 6; ++i)
+        {
+            dest[2 + i] = (U8)(bits >> (i * 8));
+        }
+    }
+
+    // Inverse of the above, following the decoding rules of the format so
+    // the result matches what the GPU samples.  BC3 color blocks are
+    // always in four color mode.
+    void decompress_color_block(const U8* src, U8* block, bool four_color)
+    {
+        U16 color0 = (U16)(src[0] | (src[1] << 8));
+        U16 color1 = (U16)(src[2] | (src[3] << 8));
+        S32 palette[4][4];
+        unpack565(color0, palette[0]);
+        unpack565(color1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+        for (S32 c = 0; c < 3; ++c)
+        {
+            if (four_color || color0 > color1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        if (!four_color && color0 <= color1)
+        {
+            palette[3][3] = 0;
+        }
+
+        U32 indices = src[4] | (src[5] << 8) | (src[6] << 16) | ((U32)src[7] << 24);
+        for (S32 t = 0; t < 16; ++t)
+        {
+            const S32* color = palette[(indices >> (t * 2)) & 3];
+            for (S32 c = 0; c < 4; ++c)
+            {
+                block[t * 4 + c] = (U8)color[c];
+            }
+        }
+    }
+
+    void decompress_alpha_block(const U8* src, U8* block)
+    {
+        S32 palette[8];
+        palette[0] = src[0];
+        palette[1] = src[1];
+        if (palette[0] > palette[1])
+        {
+            for (S32 i = 2; i < 8; ++i)
+            {
+                palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7;
+            }
+        }
+        else
+        {
+            for (S32 i = 2; i < 6; ++i)
+            {
+                palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1]) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        U64 bits = 0;
+        for (S32 i = 0; i < 6; ++i)
+        {
+            bits |= (U64)src[2 + i] << (i * 8);
+        }
+        for (S32 t = 0; t < 16; ++t)
+        {
+            block[t * 4 + 3] = (U8)palette[(bits >> (t * 3)) & 7];
+        }
+    }
+}
+
+//static
+void LLImageDXT::compressMip(const U8* indata, U8* mipdata, S32 width, S32 height,
+                             S32 ncomponents, EFileFormat format, S32 quality)
+{
+    const bool has_alpha_block = (format == FORMAT_DXR5);
+    const S32 block_bytes = has_alpha_block ? 16 : 8;
+
+    U8 block[16 * 4];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            // Mips smaller than a block repeat their edge texels
+            for (S32 y = 0; y < 4; ++y)
+            {
+                const S32 src_y = llmin(by + y, height - 1);
+                for (S32 x = 0; x < 4; ++x)
+                {
+                    const S32 src_x = llmin(bx + x, width - 1);
+                    const U8* src = indata + (src_y * width + src_x) * ncomponents;
+                    U8* dst = block + (y * 4 + x) * 4;
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = (ncomponents == 4) ? src[3] : 255;
+                }
+            }
+
+            if (has_alpha_block)
+            {
+                compress_alpha_block(block, mipdata);
+                compress_color_block(block, mipdata + 8, quality);
+            }
+            else
+            {
+                compress_color_block(block, mipdata, quality);
+            }
+            mipdata += block_bytes;
+        }
+    }
+}
+
+//static
+void LLImageDXT::decompressMip(const U8* mipdata, U8* outdata, S32 width, S32 height,
+                               S32 ncomponents, EFileFormat format)
+{
+    const bool has_alpha_block = (format == FORMAT_DXR5);
+    const S32 block_bytes = has_alpha_block ? 16 : 8;
+
+    U8 block[16 * 4];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            if (has_alpha_block)
+            {
+                decompress_color_block(mipdata + 8, block, true);
+                decompress_alpha_block(mipdata, block);
+            }
+            else
+            {
+                decompress_color_block(mipdata, block, false);
+            }
+
+            // Mips smaller than a block only keep their own texels
+            for (S32 y = 0; y < 4 && by + y < height; ++y)
+            {
+                for (S32 x = 0; x < 4 && bx + x < width; ++x)
+                {
+                    const U8* src = block + (y * 4 + x) * 4;
+                    U8* dst = outdata + ((by + y) * width + bx + x) * ncomponents;
+                    for (S32 c = 0; c < ncomponents; ++c)
+                    {
+                        dst[c] = src[c];
+                    }
+                }
+            }
+            mipdata += block_bytes;
+        }
+    }
+}
+
+//============================================================================
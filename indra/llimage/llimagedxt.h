@@ -54,6 +54,14 @@ class LLImageDXT : public LLImageFormatted
         FORMAT_NOFILE = 0xff,
     };
 
+    // Quality/speed trade-off for the CPU block encoder (encodeCompressed())
+    enum ECompressionQuality
+    {
+        COMPRESS_NONE = 0,
+        COMPRESS_FAST,  // bounding box endpoints, nearest palette entry
+        COMPRESS_HIGH,  // principal axis endpoints refined by least squares
+    };
+
     struct dxtfile_header_old_t
     {
         S32 format;
@@ -101,9 +109,19 @@ class LLImageDXT : public LLImageFormatted
     /*virtual*/ std::string getExtension() { return std::string("dxt"); }
     /*virtual*/ bool updateData();
 
+    // DXR1 and DXR5 are decompressed, other compressed formats fail
     /*virtual*/ bool decode(LLImageRaw* raw_image, F32 decode_time);
     /*virtual*/ bool encode(const LLImageRaw* raw_image, F32 encode_time);
 
+    // Builds a block compressed DXR1 (BC1, 3 components) or DXR5 (BC3, 4
+    // components) mip chain from raw_image. Dimensions must be multiples of 4.
+    // Does not touch any shared state, so it is safe to call from the
+    // ImageDecode pool.
+    bool encodeCompressed(const LLImageRaw* raw_image, S32 quality);
+    static bool canCompress(const LLImageRaw* raw_image);
+    // Returns NULL if raw_image can not be compressed
+    static LLPointer<LLImageDXT> createCompressed(const LLImageRaw* raw_image, S32 quality);
+
     /*virtual*/ S32 calcHeaderSize();
     /*virtual*/ S32 calcDataSize(S32 discard_level = 0);
 
@@ -132,6 +150,10 @@ class LLImageDXT : public LLImageFormatted
 private:
     static void extractMip(const U8 *indata, U8* mipdata, int width, int height,
                            int mip_width, int mip_height, EFileFormat format);
+    static void compressMip(const U8* indata, U8* mipdata, S32 width, S32 height,
+                            S32 ncomponents, EFileFormat format, S32 quality);
+    static void decompressMip(const U8* mipdata, U8* outdata, S32 width, S32 height,
+                              S32 ncomponents, EFileFormat format);
 
 private:
     EFileFormat mFileFormat;
@@ -35,6 +35,12 @@
 #include "v3math.h"
 #include "llsdserialize.h"
 #include "llstring.h"
+#include "llvector4a.h"
+#include "threadpool.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 //---------------------------------------------------------------------------
 // LLImageFilter
@@ -46,12 +52,7 @@ LLImageFilter::LLImageFilter(const std::string& file_path) :
     mHistoRed(NULL),
     mHistoGreen(NULL),
     mHistoBlue(NULL),
-    mHistoBrightness(NULL),
-    mStencilBlendMode(STENCIL_BLEND_MODE_BLEND),
-    mStencilShape(STENCIL_SHAPE_UNIFORM),
-    mStencilGamma(1.0),
-    mStencilMin(0.0),
-    mStencilMax(1.0)
+    mHistoBrightness(NULL)
 {
     // Load filter description from file
     llifstream filter_xml(file_path.c_str());
@@ -271,91 +272,148 @@ void LLImageFilter::executeFilter(LLPointer<LLImageRaw> raw_image)
             LL_WARNS() << "Filter unknown, cannot execute filter command : " << filter_name << LL_ENDL;
         }
     }
+
+    flushPixelOps();
 }
 
 //============================================================================
 // Filter Primitives
 //============================================================================
 
-void LLImageFilter::blendStencil(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue)
+// Per-pixel primitives don't touch the image right away: they are queued with
+// the stencil in effect and flushPixelOps() applies the whole run of them in a
+// single pass, one pixel at a time. Since each of them only reads the pixel it
+// writes, this gives the same result as one pass per primitive.
+
+void LLImageFilter::colorCorrect(const U8* lut_red, const U8* lut_green, const U8* lut_blue)
 {
-    F32 inv_alpha = 1.0f - alpha;
-    switch (mStencilBlendMode)
-    {
-        case STENCIL_BLEND_MODE_BLEND:
-            // Classic blend of incoming color with the background image
-            pixel[VRED]   = (U8)(inv_alpha * pixel[VRED]   + alpha * red);
-            pixel[VGREEN] = (U8)(inv_alpha * pixel[VGREEN] + alpha * green);
-            pixel[VBLUE]  = (U8)(inv_alpha * pixel[VBLUE]  + alpha * blue);
-            break;
-        case STENCIL_BLEND_MODE_ADD:
-            // Add incoming color to the background image
-            pixel[VRED]   = (U8)llclampb(pixel[VRED]   + alpha * red);
-            pixel[VGREEN] = (U8)llclampb(pixel[VGREEN] + alpha * green);
-            pixel[VBLUE]  = (U8)llclampb(pixel[VBLUE]  + alpha * blue);
-            break;
-        case STENCIL_BLEND_MODE_ABACK:
-            // Add back background image to the incoming color
-            pixel[VRED]   = (U8)llclampb(inv_alpha * pixel[VRED]   + red);
-            pixel[VGREEN] = (U8)llclampb(inv_alpha * pixel[VGREEN] + green);
-            pixel[VBLUE]  = (U8)llclampb(inv_alpha * pixel[VBLUE]  + blue);
-            break;
-        case STENCIL_BLEND_MODE_FADE:
-            // Fade incoming color to black
-            pixel[VRED]   = (U8)(alpha * red);
-            pixel[VGREEN] = (U8)(alpha * green);
-            pixel[VBLUE]  = (U8)(alpha * blue);
-            break;
-    }
+    PixelOp& op = queuePixelOp(PixelOp::LUT);
+    memcpy(op.mLUT[VRED], lut_red, 256);        /* Flawfinder: ignore */
+    memcpy(op.mLUT[VGREEN], lut_green, 256);    /* Flawfinder: ignore */
+    memcpy(op.mLUT[VBLUE], lut_blue, 256);      /* Flawfinder: ignore */
 }
 
-void LLImageFilter::colorCorrect(const U8* lut_red, const U8* lut_green, const U8* lut_blue)
+void LLImageFilter::colorTransform(const LLMatrix3 &transform)
 {
-    const S32 components = mImage->getComponents();
-    llassert( components >= 1 && components <= 4 );
+    PixelOp& op = queuePixelOp(PixelOp::TRANSFORM);
+    op.mTransform = transform;
+}
 
-    S32 width  = mImage->getWidth();
-    S32 height = mImage->getHeight();
+void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const F32 angle)
+{
+    PixelOp& op = queuePixelOp(PixelOp::SCREEN);
+    op.mScreenMode = mode;
+    op.mWavelength = wave_length * (F32)(mImage->getHeight()) / 2.0f;
+    op.mSine = sinf(angle*DEG_TO_RAD);
+    op.mCosine = cosf(angle*DEG_TO_RAD);
 
-    U8* dst_data = mImage->getData();
-    for (S32 j = 0; j < height; j++)
+    // Precompute the gamma table : gives us the gray level to use when cutting outside the screen (prevents strong aliasing on the screen)
+    for (S32 i = 0; i < 256; i++)
     {
-        for (S32 i = 0; i < width; i++)
-        {
-            // Blend LUT value
-            blendStencil(getStencilAlpha(i,j), dst_data, lut_red[dst_data[VRED]], lut_green[dst_data[VGREEN]], lut_blue[dst_data[VBLUE]]);
-            dst_data += components;
-        }
+        F32 gamma_i = llclampf((float)(powf((float)(i)/255.0f,1.0f/4.0f)));
+        op.mLUT[0][i] = (U8)(255.0 * gamma_i);
     }
 }
 
-void LLImageFilter::colorTransform(const LLMatrix3 &transform)
+LLImageFilter::PixelOp& LLImageFilter::queuePixelOp(PixelOp::EType type)
 {
+    mPixelOps.emplace_back();
+    PixelOp& op = mPixelOps.back();
+    op.mType = type;
+    op.mStencil = mStencil;
+    return op;
+}
+
+void LLImageFilter::flushPixelOps()
+{
+    if (mPixelOps.empty())
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
     const S32 components = mImage->getComponents();
     llassert( components >= 1 && components <= 4 );
 
     S32 width  = mImage->getWidth();
     S32 height = mImage->getHeight();
+    U8* data = mImage->getData();
 
-    U8* dst_data = mImage->getData();
-    for (S32 j = 0; j < height; j++)
+    forEachRowBand(height, width * (S32)mPixelOps.size(),
+        [&](S32 first_row, S32 end_row)
+        {
+            for (S32 j = first_row; j < end_row; j++)
+            {
+                U8* dst_data = data + (j * width * components);
+                for (S32 i = 0; i < width; i++)
+                {
+                    for (const PixelOp& op : mPixelOps)
+                    {
+                        op.apply(i, j, dst_data);
+                    }
+                    dst_data += components;
+                }
+            }
+        });
+
+    mPixelOps.clear();
+}
+
+void LLImageFilter::PixelOp::apply(S32 i, S32 j, U8* pixel) const
+{
+    switch (mType)
     {
-        for (S32 i = 0; i < width; i++)
+        case LUT:
+        {
+            // Blend LUT value
+            mStencil.blend(mStencil.getAlpha(i,j), pixel, mLUT[VRED][pixel[VRED]], mLUT[VGREEN][pixel[VGREEN]], mLUT[VBLUE][pixel[VBLUE]]);
+            break;
+        }
+        case TRANSFORM:
         {
             // Compute transform
-            LLVector3 src((F32)(dst_data[VRED]),(F32)(dst_data[VGREEN]),(F32)(dst_data[VBLUE]));
-            LLVector3 dst = src * transform;
+            LLVector3 src((F32)(pixel[VRED]),(F32)(pixel[VGREEN]),(F32)(pixel[VBLUE]));
+            LLVector3 dst = src * mTransform;
             dst.clamp(0.0f,255.0f);
 
             // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, (U8)dst.mV[VRED], (U8)dst.mV[VGREEN], (U8)dst.mV[VBLUE]);
-            dst_data += components;
+            mStencil.blend(mStencil.getAlpha(i,j), pixel, (U8)dst.mV[VRED], (U8)dst.mV[VGREEN], (U8)dst.mV[VBLUE]);
+            break;
+        }
+        case SCREEN:
+        {
+            // Compute screen value
+            F32 value = 0.0;
+            F32 di = 0.0;
+            F32 dj = 0.0;
+            switch (mScreenMode)
+            {
+                case SCREEN_MODE_2DSINE:
+                    di =  mCosine*i + mSine*j;
+                    dj = -mSine*i + mCosine*j;
+                    value = (sinf(2*F_PI*di/mWavelength)*sinf(2*F_PI*dj/mWavelength)+1.0f)*255.0f/2.0f;
+                    break;
+                case SCREEN_MODE_LINE:
+                    dj = mSine*i - mCosine*j;
+                    value = (sinf(2*F_PI*dj/mWavelength)+1.0f)*255.0f/2.0f;
+                    break;
+            }
+            U8 dst_value = (pixel[VRED] >= (U8)(value) ? mLUT[0][pixel[VRED] - (U8)(value)] : 0);
+
+            // Blend result
+            mStencil.blend(mStencil.getAlpha(i,j), pixel, dst_value, dst_value, dst_value);
+            break;
         }
     }
 }
 
 void LLImageFilter::convolve(const LLMatrix3 &kernel, bool normalize, bool abs_value)
 {
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    // Neighbouring pixels must be read before the ops queued so far wrote them
+    flushPixelOps();
+
     const S32 components = mImage->getComponents();
     llassert( components >= 1 && components <= 4 );
 
@@ -381,164 +439,208 @@ void LLImageFilter::convolve(const LLMatrix3 &kernel, bool normalize, bool abs_v
     }
     F32 kernel_range = kernel_max - kernel_min;
 
-    // Allocate temporary buffers and initialize algorithm's data
     S32 width  = mImage->getWidth();
     S32 height = mImage->getHeight();
-
-    U8* dst_data = mImage->getData();
+    U8* data = mImage->getData();
 
     S32 buffer_size = width * components;
     llassert_always(buffer_size > 0);
-    std::vector<U8> even_buffer(buffer_size);
-    std::vector<U8> odd_buffer(buffer_size);
-
-    U8* south_data = dst_data + buffer_size;
-    U8* east_west_data;
-    U8* north_data;
 
-    // Line 0 : we set the line to 0 (debatable)
-    memcpy( &even_buffer[0], dst_data, buffer_size );   /* Flawfinder: ignore */
-    for (S32 i = 0; i < width; i++)
-    {
-        blendStencil(getStencilAlpha(i,0), dst_data, 0, 0, 0);
-        dst_data += components;
-    }
-    south_data += buffer_size;
+    // Bands write in place, so they all read from an untouched copy
+    std::vector<U8> src_image(data, data + buffer_size * height);
 
-    // All other lines
-    for (S32 j = 1; j < (height-1); j++)
+    LLVector4a taps[NUM_VALUES_IN_MAT3][NUM_VALUES_IN_MAT3];
+    for (S32 k = 0; k < NUM_VALUES_IN_MAT3; k++)
     {
-        // We need to buffer 2 lines. We flip north and east-west (current) to avoid moving too much memory around
-        if (j % 2)
+        for (S32 l = 0; l < NUM_VALUES_IN_MAT3; l++)
         {
-            memcpy( &odd_buffer[0], dst_data, buffer_size );    /* Flawfinder: ignore */
-            east_west_data = &odd_buffer[0];
-            north_data = &even_buffer[0];
+            taps[k][l].splat(kernel.mMatrix[k][l]);
         }
-        else
+    }
+
+    forEachRowBand(height, width * NUM_VALUES_IN_MAT3,
+        [&](S32 first_row, S32 end_row)
         {
-            memcpy( &even_buffer[0], dst_data, buffer_size );   /* Flawfinder: ignore */
-            east_west_data = &even_buffer[0];
-            north_data = &odd_buffer[0];
-        }
-        // First pixel : set to 0
-        blendStencil(getStencilAlpha(0,j), dst_data, 0, 0, 0);
-        dst_data += components;
-        // Set pointers to kernel
-        U8* NW = north_data;
-        U8* N = NW+components;
-        U8* NE = N+components;
-        U8* W = east_west_data;
-        U8* C = W+components;
-        U8* E = C+components;
-        U8* SW = south_data;
-        U8* S = SW+components;
-        U8* SE = S+components;
-        // All other pixels
-        for (S32 i = 1; i < (width-1); i++)
-        {
-            // Compute convolution
-            LLVector3 dst;
-            dst.mV[VRED] = (kernel.mMatrix[0][0]*NW[VRED] + kernel.mMatrix[0][1]*N[VRED] + kernel.mMatrix[0][2]*NE[VRED] +
-                            kernel.mMatrix[1][0]*W[VRED]  + kernel.mMatrix[1][1]*C[VRED] + kernel.mMatrix[1][2]*E[VRED] +
-                            kernel.mMatrix[2][0]*SW[VRED] + kernel.mMatrix[2][1]*S[VRED] + kernel.mMatrix[2][2]*SE[VRED]);
-            dst.mV[VGREEN] = (kernel.mMatrix[0][0]*NW[VGREEN] + kernel.mMatrix[0][1]*N[VGREEN] + kernel.mMatrix[0][2]*NE[VGREEN] +
-                              kernel.mMatrix[1][0]*W[VGREEN]  + kernel.mMatrix[1][1]*C[VGREEN] + kernel.mMatrix[1][2]*E[VGREEN] +
-                              kernel.mMatrix[2][0]*SW[VGREEN] + kernel.mMatrix[2][1]*S[VGREEN] + kernel.mMatrix[2][2]*SE[VGREEN]);
-            dst.mV[VBLUE] = (kernel.mMatrix[0][0]*NW[VBLUE] + kernel.mMatrix[0][1]*N[VBLUE] + kernel.mMatrix[0][2]*NE[VBLUE] +
-                             kernel.mMatrix[1][0]*W[VBLUE]  + kernel.mMatrix[1][1]*C[VBLUE] + kernel.mMatrix[1][2]*E[VBLUE] +
-                             kernel.mMatrix[2][0]*SW[VBLUE] + kernel.mMatrix[2][1]*S[VBLUE] + kernel.mMatrix[2][2]*SE[VBLUE]);
-            if (abs_value)
+            // Rows converted to float once and shared by the three output
+            // rows using them. The convolution runs over the interleaved
+            // channels, 4 floats at a time, so it doesn't care about the
+            // pixel layout. Padding keeps the last unaligned load in bounds.
+            const S32 padded_size = ((buffer_size + 3) & ~3) + 4;
+            std::vector<F32> row_buffers[3];
+            for (std::vector<F32>& row : row_buffers)
             {
-                dst.mV[VRED]   = llabs(dst.mV[VRED]);
-                dst.mV[VGREEN] = llabs(dst.mV[VGREEN]);
-                dst.mV[VBLUE]  = llabs(dst.mV[VBLUE]);
+                row.resize(padded_size, 0.f);
             }
-            if (normalize)
+            std::vector<F32> result(padded_size, 0.f);
+            S32 buffered_row[3] = { -1, -1, -1 };
+
+            auto get_row = [&](S32 row) -> const F32*
             {
-                dst.mV[VRED]   = (dst.mV[VRED] - kernel_min)/kernel_range;
-                dst.mV[VGREEN] = (dst.mV[VGREEN] - kernel_min)/kernel_range;
-                dst.mV[VBLUE]  = (dst.mV[VBLUE] - kernel_min)/kernel_range;
+                S32 slot = row % 3;
+                if (buffered_row[slot] != row)
+                {
+                    const U8* src = &src_image[row * buffer_size];
+                    F32* dst = row_buffers[slot].data();
+                    for (S32 x = 0; x < buffer_size; x++)
+                    {
+                        dst[x] = (F32)src[x];
+                    }
+                    buffered_row[slot] = row;
+                }
+                return row_buffers[slot].data();
+            };
+
+            for (S32 j = first_row; j < end_row; j++)
+            {
+                U8* dst_data = data + (j * buffer_size);
+                if (j == 0 || j == (height - 1))
+                {
+                    // First and last lines : we set the line to 0 (debatable)
+                    for (S32 i = 0; i < width; i++)
+                    {
+                        mStencil.blend(mStencil.getAlpha(i,j), dst_data, 0, 0, 0);
+                        dst_data += components;
+                    }
+                    continue;
+                }
+
+                const F32* rows[3] = { get_row(j-1), get_row(j), get_row(j+1) };
+                for (S32 x = components; x < buffer_size - components; x += 4)
+                {
+                    LLVector4a sum;
+                    sum.clear();
+                    for (S32 k = 0; k < NUM_VALUES_IN_MAT3; k++)
+                    {
+                        LLVector4a west, center, east;
+                        west.loadua(rows[k] + x - components);
+                        center.loadua(rows[k] + x);
+                        east.loadua(rows[k] + x + components);
+                        west.mul(taps[k][0]);
+                        center.mul(taps[k][1]);
+                        east.mul(taps[k][2]);
+                        sum.add(west);
+                        sum.add(center);
+                        sum.add(east);
+                    }
+                    memcpy(&result[x], sum.getF32ptr(), 4 * sizeof(F32));  /* Flawfinder: ignore */
+                }
+
+                // First pixel : set to 0
+                mStencil.blend(mStencil.getAlpha(0,j), dst_data, 0, 0, 0);
+                dst_data += components;
+                // All other pixels
+                const F32* conv = &result[components];
+                for (S32 i = 1; i < (width-1); i++)
+                {
+                    LLVector3 dst(conv[VRED], conv[VGREEN], conv[VBLUE]);
+                    if (abs_value)
+                    {
+                        dst.abs();
+                    }
+                    if (normalize)
+                    {
+                        dst.mV[VRED]   = (dst.mV[VRED] - kernel_min)/kernel_range;
+                        dst.mV[VGREEN] = (dst.mV[VGREEN] - kernel_min)/kernel_range;
+                        dst.mV[VBLUE]  = (dst.mV[VBLUE] - kernel_min)/kernel_range;
+                    }
+                    dst.clamp(0.0f,255.0f);
+
+                    // Blend result
+                    mStencil.blend(mStencil.getAlpha(i,j), dst_data, (U8)dst.mV[VRED], (U8)dst.mV[VGREEN], (U8)dst.mV[VBLUE]);
+
+                    // Next pixel
+                    dst_data += components;
+                    conv += components;
+                }
+                // Last pixel : set to 0
+                mStencil.blend(mStencil.getAlpha(width-1,j), dst_data, 0, 0, 0);
             }
-            dst.clamp(0.0f,255.0f);
+        });
+}
 
-            // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, (U8)dst.mV[VRED], (U8)dst.mV[VGREEN], (U8)dst.mV[VBLUE]);
-
-            // Next pixel
-            dst_data += components;
-            NW += components;
-            N += components;
-            NE += components;
-            W += components;
-            C += components;
-            E += components;
-            SW += components;
-            S += components;
-            SE += components;
-        }
-        // Last pixel : set to 0
-        blendStencil(getStencilAlpha(width-1,j), dst_data, 0, 0, 0);
-        dst_data += components;
-        south_data += buffer_size;
-    }
+//static
+LL::ThreadPool* LLImageFilter::sThreadPool = nullptr;
 
-    // Last line
-    for (S32 i = 0; i < width; i++)
-    {
-        blendStencil(getStencilAlpha(i,0), dst_data, 0, 0, 0);
-        dst_data += components;
-    }
+//static
+void LLImageFilter::setThreadPool(LL::ThreadPool* pool)
+{
+    sThreadPool = pool;
 }
 
-void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const F32 angle)
+namespace
 {
-    const S32 components = mImage->getComponents();
-    llassert( components >= 1 && components <= 4 );
+    // Bands are claimed from a counter, so the calling thread can do them
+    // all if the pool is busy or closed.  It only waits for bands a pool
+    // thread has already taken.
+    struct LLImageFilterBandBatch
+    {
+        std::function<void(S32, S32)> mFunc;
+        S32 mHeight = 0;
+        S32 mBandRows = 0;
+        S32 mBands = 0;
 
-    S32 width  = mImage->getWidth();
-    S32 height = mImage->getHeight();
+        std::atomic<S32> mNext{ 0 };
 
-    F32 wave_length_pixels = wave_length * (F32)(height) / 2.0f;
-    F32 sin = sinf(angle*DEG_TO_RAD);
-    F32 cos = cosf(angle*DEG_TO_RAD);
+        std::mutex mMutex;
+        std::condition_variable mDoneCondition;
+        S32 mDone = 0;
 
-    // Precompute the gamma table : gives us the gray level to use when cutting outside the screen (prevents strong aliasing on the screen)
-    U8 gamma[256];
-    for (S32 i = 0; i < 256; i++)
+        void run()
+        {
+            S32 band;
+            while ((band = mNext++) < mBands)
+            {
+                S32 first_row = band * mBandRows;
+                mFunc(first_row, llmin(first_row + mBandRows, mHeight));
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (++mDone == mBands)
+                {
+                    mDoneCondition.notify_all();
+                }
+            }
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDoneCondition.wait(lock, [this]() { return mDone == mBands; });
+        }
+    };
+}
+
+// Runs func(first_row, end_row) over bands of rows, shared with the pool
+// threads when there is enough work (row_cost per row) to pay for it.
+template <typename FUNC>
+void LLImageFilter::forEachRowBand(S32 height, S32 row_cost, const FUNC& func)
+{
+    const S32 MIN_BAND_COST = 256 * 1024;
+
+    LL::ThreadPool* pool = sThreadPool;
+    S32 threads = pool ? (S32)pool->getWidth() + 1 : 1;
+    S32 bands = (S32)llclamp((S64)height * row_cost / MIN_BAND_COST, (S64)1, (S64)threads);
+    if (bands <= 1)
     {
-        F32 gamma_i = llclampf((float)(powf((float)(i)/255.0f,1.0f/4.0f)));
-        gamma[i] = (U8)(255.0 * gamma_i);
+        func(0, height);
+        return;
     }
 
-    U8* dst_data = mImage->getData();
-    for (S32 j = 0; j < height; j++)
+    auto batch = std::make_shared<LLImageFilterBandBatch>();
+    batch->mFunc = func;
+    batch->mHeight = height;
+    batch->mBandRows = (height + bands - 1) / bands;
+    batch->mBands = (height + batch->mBandRows - 1) / batch->mBandRows;
+
+    for (S32 i = 1; i < batch->mBands; ++i)
     {
-        for (S32 i = 0; i < width; i++)
+        if (!pool->getQueue().post([batch]() { batch->run(); }))
         {
-            // Compute screen value
-            F32 value = 0.0;
-            F32 di = 0.0;
-            F32 dj = 0.0;
-            switch (mode)
-            {
-                case SCREEN_MODE_2DSINE:
-                    di =  cos*i + sin*j;
-                    dj = -sin*i + cos*j;
-                    value = (sinf(2*F_PI*di/wave_length_pixels)*sinf(2*F_PI*dj/wave_length_pixels)+1.0f)*255.0f/2.0f;
-                    break;
-                case SCREEN_MODE_LINE:
-                    dj = sin*i - cos*j;
-                    value = (sinf(2*F_PI*dj/wave_length_pixels)+1.0f)*255.0f/2.0f;
-                    break;
-            }
-            U8 dst_value = (dst_data[VRED] >= (U8)(value) ? gamma[dst_data[VRED] - (U8)(value)] : 0);
-
-            // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, dst_value, dst_value, dst_value);
-            dst_data += components;
+            break;
         }
     }
+
+    batch->run();
+    batch->wait();
 }
 
 //============================================================================
@@ -546,55 +648,87 @@ void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const
 //============================================================================
 void LLImageFilter::setStencil(EStencilShape shape, EStencilBlendMode mode, F32 min, F32 max, F32* params)
 {
-    mStencilShape = shape;
-    mStencilBlendMode = mode;
-    mStencilMin = llmin(llmax(min, -1.0f), 1.0f);
-    mStencilMax = llmin(llmax(max, -1.0f), 1.0f);
+    mStencil.mShape = shape;
+    mStencil.mBlendMode = mode;
+    mStencil.mMin = llmin(llmax(min, -1.0f), 1.0f);
+    mStencil.mMax = llmin(llmax(max, -1.0f), 1.0f);
 
     // Each shape will interpret the 4 params differenly.
     // We compute each systematically, though, clearly, values are meaningless when the shape doesn't correspond to the parameters
-    mStencilCenterX = (S32)(mImage->getWidth()  + params[0] * (F32)(mImage->getHeight()))/2;
-    mStencilCenterY = (S32)(mImage->getHeight() + params[1] * (F32)(mImage->getHeight()))/2;
-    mStencilWidth = (S32)(params[2] * (F32)(mImage->getHeight()))/2;
-    mStencilGamma = (params[3] <= 0.0f ? 1.0f : params[3]);
-
-    mStencilWavelength = (params[0] <= 0.0f ? 10.0f : params[0] * (F32)(mImage->getHeight()) / 2.0f);
-    mStencilSine   = sinf(params[1]*DEG_TO_RAD);
-    mStencilCosine = cosf(params[1]*DEG_TO_RAD);
-
-    mStencilStartX = ((F32)(mImage->getWidth())  + params[0] * (F32)(mImage->getHeight()))/2.0f;
-    mStencilStartY = ((F32)(mImage->getHeight()) + params[1] * (F32)(mImage->getHeight()))/2.0f;
-    F32 end_x      = ((F32)(mImage->getWidth())  + params[2] * (F32)(mImage->getHeight()))/2.0f;
-    F32 end_y      = ((F32)(mImage->getHeight()) + params[3] * (F32)(mImage->getHeight()))/2.0f;
-    mStencilGradX  = end_x - mStencilStartX;
-    mStencilGradY  = end_y - mStencilStartY;
-    mStencilGradN  = mStencilGradX*mStencilGradX + mStencilGradY*mStencilGradY;
+    mStencil.mCenterX = (S32)(mImage->getWidth()  + params[0] * (F32)(mImage->getHeight()))/2;
+    mStencil.mCenterY = (S32)(mImage->getHeight() + params[1] * (F32)(mImage->getHeight()))/2;
+    mStencil.mWidth = (S32)(params[2] * (F32)(mImage->getHeight()))/2;
+    mStencil.mGamma = (params[3] <= 0.0f ? 1.0f : params[3]);
+
+    mStencil.mWavelength = (params[0] <= 0.0f ? 10.0f : params[0] * (F32)(mImage->getHeight()) / 2.0f);
+    mStencil.mSine   = sinf(params[1]*DEG_TO_RAD);
+    mStencil.mCosine = cosf(params[1]*DEG_TO_RAD);
+
+    mStencil.mStartX = ((F32)(mImage->getWidth())  + params[0] * (F32)(mImage->getHeight()))/2.0f;
+    mStencil.mStartY = ((F32)(mImage->getHeight()) + params[1] * (F32)(mImage->getHeight()))/2.0f;
+    F32 end_x        = ((F32)(mImage->getWidth())  + params[2] * (F32)(mImage->getHeight()))/2.0f;
+    F32 end_y        = ((F32)(mImage->getHeight()) + params[3] * (F32)(mImage->getHeight()))/2.0f;
+    mStencil.mGradX  = end_x - mStencil.mStartX;
+    mStencil.mGradY  = end_y - mStencil.mStartY;
+    mStencil.mGradN  = mStencil.mGradX*mStencil.mGradX + mStencil.mGradY*mStencil.mGradY;
 }
 
-F32 LLImageFilter::getStencilAlpha(S32 i, S32 j)
+F32 LLImageFilter::Stencil::getAlpha(S32 i, S32 j) const
 {
     F32 alpha = 1.0;    // That init actually takes care of the STENCIL_SHAPE_UNIFORM case...
-    if (mStencilShape == STENCIL_SHAPE_VIGNETTE)
+    if (mShape == STENCIL_SHAPE_VIGNETTE)
     {
         // alpha is a modified gaussian value, with a center and fading in a circular pattern toward the edges
         // The gamma parameter controls the intensity of the drop down from alpha 1.0 (center) to 0.0
-        F32 d_center_square = (F32)((i - mStencilCenterX)*(i - mStencilCenterX) + (j - mStencilCenterY)*(j - mStencilCenterY));
-        alpha = powf(F_E, -(powf((d_center_square/(mStencilWidth*mStencilWidth)),mStencilGamma)/2.0f));
+        F32 d_center_square = (F32)((i - mCenterX)*(i - mCenterX) + (j - mCenterY)*(j - mCenterY));
+        alpha = powf(F_E, -(powf((d_center_square/(mWidth*mWidth)),mGamma)/2.0f));
     }
-    else if (mStencilShape == STENCIL_SHAPE_SCAN_LINES)
+    else if (mShape == STENCIL_SHAPE_SCAN_LINES)
     {
         // alpha varies according to a squared sine function.
-        F32 d = mStencilSine*i - mStencilCosine*j;
-        alpha = (sinf(2*F_PI*d/mStencilWavelength) > 0.0f ? 1.0f : 0.0f);
+        F32 d = mSine*i - mCosine*j;
+        alpha = (sinf(2*F_PI*d/mWavelength) > 0.0f ? 1.0f : 0.0f);
     }
-    else if (mStencilShape == STENCIL_SHAPE_GRADIENT)
+    else if (mShape == STENCIL_SHAPE_GRADIENT)
     {
-        alpha = (((F32)(i) - mStencilStartX)*mStencilGradX + ((F32)(j) - mStencilStartY)*mStencilGradY) / mStencilGradN;
+        alpha = (((F32)(i) - mStartX)*mGradX + ((F32)(j) - mStartY)*mGradY) / mGradN;
         alpha = llclampf(alpha);
     }
 
     // We rescale alpha between min and max
-    return (mStencilMin + alpha * (mStencilMax - mStencilMin));
+    return (mMin + alpha * (mMax - mMin));
+}
+
+void LLImageFilter::Stencil::blend(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue) const
+{
+    F32 inv_alpha = 1.0f - alpha;
+    switch (mBlendMode)
+    {
+        case STENCIL_BLEND_MODE_BLEND:
+            // Classic blend of incoming color with the background image
+            pixel[VRED]   = (U8)(inv_alpha * pixel[VRED]   + alpha * red);
+            pixel[VGREEN] = (U8)(inv_alpha * pixel[VGREEN] + alpha * green);
+            pixel[VBLUE]  = (U8)(inv_alpha * pixel[VBLUE]  + alpha * blue);
+            break;
+        case STENCIL_BLEND_MODE_ADD:
+            // Add incoming color to the background image
+            pixel[VRED]   = (U8)llclampb(pixel[VRED]   + alpha * red);
+            pixel[VGREEN] = (U8)llclampb(pixel[VGREEN] + alpha * green);
+            pixel[VBLUE]  = (U8)llclampb(pixel[VBLUE]  + alpha * blue);
+            break;
+        case STENCIL_BLEND_MODE_ABACK:
+            // Add back background image to the incoming color
+            pixel[VRED]   = (U8)llclampb(inv_alpha * pixel[VRED]   + red);
+            pixel[VGREEN] = (U8)llclampb(inv_alpha * pixel[VGREEN] + green);
+            pixel[VBLUE]  = (U8)llclampb(inv_alpha * pixel[VBLUE]  + blue);
+            break;
+        case STENCIL_BLEND_MODE_FADE:
+            // Fade incoming color to black
+            pixel[VRED]   = (U8)(alpha * red);
+            pixel[VGREEN] = (U8)(alpha * green);
+            pixel[VBLUE]  = (U8)(alpha * blue);
+            break;
+    }
 }
 
 //============================================================================
@@ -612,6 +746,9 @@ U32* LLImageFilter::getBrightnessHistogram()
 
 void LLImageFilter::computeHistograms()
 {
+    // The histograms describe the image as the filter left it so far
+    flushPixelOps();
+
     const S32 components = mImage->getComponents();
     llassert( components >= 1 && components <= 4 );
 
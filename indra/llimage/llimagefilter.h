@@ -29,11 +29,14 @@
 
 #include "llsd.h"
 #include "llimage.h"
+#include "m3math.h"
+#include "threadpool_fwd.h"
+
+#include <vector>
 
 class LLImageRaw;
 class LLColor4U;
 class LLColor3;
-class LLMatrix3;
 
 typedef enum e_stencil_blend_mode
 {
@@ -69,7 +72,60 @@ class LLImageFilter
 
     void executeFilter(LLPointer<LLImageRaw> raw_image);
 
+    // Pool whose threads help the calling thread with large filter passes,
+    // NULL runs every pass on the calling thread
+    static void setThreadPool(LL::ThreadPool* pool);
+
 private:
+    // Current Stencil Settings
+    struct Stencil
+    {
+        F32 getAlpha(S32 i, S32 j) const;
+        void blend(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue) const;
+
+        EStencilBlendMode mBlendMode = STENCIL_BLEND_MODE_BLEND;
+        EStencilShape mShape = STENCIL_SHAPE_UNIFORM;
+        F32 mMin = 0.f;
+        F32 mMax = 1.f;
+
+        S32 mCenterX = 0;
+        S32 mCenterY = 0;
+        S32 mWidth = 0;
+        F32 mGamma = 1.f;
+
+        F32 mWavelength = 0.f;
+        F32 mSine = 0.f;
+        F32 mCosine = 0.f;
+
+        F32 mStartX = 0.f;
+        F32 mStartY = 0.f;
+        F32 mGradX = 0.f;
+        F32 mGradY = 0.f;
+        F32 mGradN = 0.f;
+    };
+
+    // Per-pixel primitive waiting for flushPixelOps(), with the stencil it was queued under
+    struct PixelOp
+    {
+        enum EType
+        {
+            LUT,
+            TRANSFORM,
+            SCREEN
+        };
+
+        void apply(S32 i, S32 j, U8* pixel) const;
+
+        EType mType = LUT;
+        Stencil mStencil;
+        LLMatrix3 mTransform;
+        U8 mLUT[3][256];                // per channel for LUT, gamma in [0] for SCREEN
+        EScreenMode mScreenMode = SCREEN_MODE_2DSINE;
+        F32 mWavelength = 0.f;
+        F32 mSine = 0.f;
+        F32 mCosine = 0.f;
+    };
+
     // Filter Operations : Transforms
     void filterGrayScale();                         // Convert to grayscale
     void filterSepia();                             // Convert to sepia
@@ -91,12 +147,14 @@ class LLImageFilter
     void colorTransform(const LLMatrix3 &transform);
     void colorCorrect(const U8* lut_red, const U8* lut_green, const U8* lut_blue);
     void filterScreen(EScreenMode mode, const F32 wave_length, const F32 angle);
-    void blendStencil(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue);
     void convolve(const LLMatrix3 &kernel, bool normalize, bool abs_value);
+    PixelOp& queuePixelOp(PixelOp::EType type);
+    void flushPixelOps();                           // Apply the queued per-pixel primitives in one pass
+    template <typename FUNC>
+    void forEachRowBand(S32 height, S32 row_cost, const FUNC& func);
 
     // Procedural Stencils
     void setStencil(EStencilShape shape, EStencilBlendMode mode, F32 min, F32 max, F32* params);
-    F32 getStencilAlpha(S32 i, S32 j);
 
     // Histograms
     U32* getBrightnessHistogram();
@@ -111,26 +169,10 @@ class LLImageFilter
     U32 *mHistoBlue;
     U32 *mHistoBrightness;
 
-    // Current Stencil Settings
-    EStencilBlendMode mStencilBlendMode;
-    EStencilShape mStencilShape;
-    F32 mStencilMin;
-    F32 mStencilMax;
-
-    S32 mStencilCenterX;
-    S32 mStencilCenterY;
-    S32 mStencilWidth;
-    F32 mStencilGamma;
-
-    F32 mStencilWavelength;
-    F32 mStencilSine;
-    F32 mStencilCosine;
-
-    F32 mStencilStartX;
-    F32 mStencilStartY;
-    F32 mStencilGradX;
-    F32 mStencilGradY;
-    F32 mStencilGradN;
+    Stencil mStencil;
+    std::vector<PixelOp> mPixelOps;
+
+    static LL::ThreadPool* sThreadPool;
 };
 
 
@@ -140,6 +140,96 @@ bool LLImageJ2C::initDecode(LLImageRaw &raw_image, int discard_level, int* regio
     return mImpl->initDecode(*this,raw_image,discard_level,region);
 }
 
+bool LLImageJ2C::canDecodeRegion() const
+{
+    return mImpl->canDecodeRegion();
+}
+
+// Returns true when done and successful, like decode() with no time limit.
+bool LLImageJ2C::decodeRegion(LLImageRaw *raw_imagep, const LLRect& region, S32 background_discard)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    // Region decoding works on whole code blocks, keep the region on a grid
+    // that stays pixel aligned down to the coarsest discard level
+    const S32 REGION_GRID = 1 << MAX_DISCARD_LEVEL;
+
+    S32 discard = getDiscardLevel();
+    S32 full_width = getWidth();
+    S32 full_height = getHeight();
+    background_discard = llmin(background_discard, (S32)MAX_DISCARD_LEVEL);
+    if (getLevels() > 0)
+    {
+        background_discard = llmin(background_discard, (S32)getLevels());
+    }
+
+    LLRect clipped(region);
+    clipped.intersectWith(LLRect(0, full_height, full_width, 0));
+    S32 left = (clipped.mLeft / REGION_GRID) * REGION_GRID;
+    S32 bottom = (clipped.mBottom / REGION_GRID) * REGION_GRID;
+    S32 right = llmin(((clipped.mRight + REGION_GRID - 1) / REGION_GRID) * REGION_GRID, full_width);
+    S32 top = llmin(((clipped.mTop + REGION_GRID - 1) / REGION_GRID) * REGION_GRID, full_height);
+
+    if (background_discard <= discard || !canDecodeRegion() ||
+        right <= left || top <= bottom ||
+        (right - left) * (top - bottom) >= full_width * full_height)
+    {
+        return decode(raw_imagep, 0.f);
+    }
+
+    // Whole image at the coarse level first
+    LLPointer<LLImageRaw> background = new LLImageRaw();
+    setDiscardLevel(background_discard);
+    bool res = decode(background, 0.f);
+    setDiscardLevel(discard);
+    if (!res)
+    {
+        return false;
+    }
+
+    // Then the region at the requested level. initRegionDecode() takes
+    // rows from the top, as the codestream stores them, and gives back the
+    // origin in rows from the bottom, as raw images are stored.
+    int kdu_region[4] = { left, full_height - top, right, full_height - bottom };
+    S32 origin[2] = { 0, 0 };
+    LLPointer<LLImageRaw> detail = new LLImageRaw();
+    bool has_region;
+    {
+        LLImageDataLock lock(this);
+        updateRawDiscardLevel();
+        has_region = mImpl->initRegionDecode(*this, *detail, discard, kdu_region, origin);
+    }
+    if (!has_region)
+    {
+        return decode(raw_imagep, 0.f);
+    }
+    if (!decode(detail, 0.f))
+    {
+        return false;
+    }
+
+    S32 width = (full_width + (1 << discard) - 1) >> discard;
+    S32 height = (full_height + (1 << discard) - 1) >> discard;
+    if (detail->getComponents() != background->getComponents() ||
+        origin[0] < 0 || origin[1] < 0 ||
+        origin[0] + detail->getWidth() > width ||
+        origin[1] + detail->getHeight() > height)
+    {
+        LL_WARNS() << "Region decode does not fit the image, decoding it whole" << LL_ENDL;
+        return decode(raw_imagep, 0.f);
+    }
+
+    LLImageDataLock lock(raw_imagep);
+    if (!raw_imagep->resize(width, height, background->getComponents()))
+    {
+        setLastError("Memory error");
+        return false;
+    }
+    raw_imagep->copy(background);
+    LLImageDataSharedLock lock_detail(detail);
+    return raw_imagep->setSubImage(origin[0], origin[1], detail->getWidth(), detail->getHeight(), detail->getData());
+}
+
 bool LLImageJ2C::initEncode(LLImageRaw &raw_image, int blocks_size, int precincts_size, int levels)
 {
     return mImpl->initEncode(*this,raw_image,blocks_size,precincts_size,levels);
@@ -30,6 +30,7 @@
 #include "llimage.h"
 #include "llassettype.h"
 #include "llmetricperformancetester.h"
+#include "llrect.h"
 
 // JPEG2000 : compression rate used in j2c conversion.
 const F32 DEFAULT_COMPRESSION_RATE = 1.f/8.f;
@@ -60,6 +61,14 @@ class LLImageJ2C : public LLImageFormatted
     /*virtual*/ void setLastError(const std::string& message, const std::string& filename = std::string());
 
     bool initDecode(LLImageRaw &raw_image, int discard_level, int* region);
+
+    // Decode region (full resolution pixels, rows bottom up like LLImageRaw)
+    // at the current discard level and the rest of the image at the coarser
+    // background_discard, scaled up into place. raw_imagep receives the whole
+    // image at the current discard level. Falls back to a plain decode when
+    // the engine can not restrict decoding to a region.
+    bool decodeRegion(LLImageRaw *raw_imagep, const LLRect& region, S32 background_discard);
+    bool canDecodeRegion() const;
     bool initEncode(LLImageRaw &raw_image, int blocks_size, int precincts_size, int levels);
 
     // Encode with comment text
@@ -123,6 +132,13 @@ class LLImageJ2CImpl
                             bool reversible=false) = 0;
     virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL) = 0;
     virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0) = 0;
+    // Restrict the next decodeImpl() to region (x0, y0, x1, y1 in full
+    // resolution codestream pixels, top row first) at discard_level.
+    // raw_image is sized to the decoded region and origin receives where it
+    // sits in the full image at that discard level, in raw row order.
+    // Engines that can not decode regions keep the default.
+    virtual bool canDecodeRegion() const { return false; }
+    virtual bool initRegionDecode(LLImageJ2C &base, LLImageRaw &raw_image, S32 discard_level, int* region, S32* origin) { return false; }
 
     virtual std::string getEngineInfo() const = 0;
 
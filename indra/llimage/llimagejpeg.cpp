@@ -31,11 +31,15 @@
 #include "llerror.h"
 #include "llexception.h"
 
-jmp_buf LLImageJPEG::sSetjmpBuffer ;
+// Size of the buffer flushed to file by encodeToFile()
+constexpr S32 OUTPUT_FILE_BUFFER_SIZE = 64 * 1024;
+
+thread_local jmp_buf LLImageJPEG::sSetjmpBuffer ;
 LLImageJPEG::LLImageJPEG(S32 quality)
 :   LLImageFormatted(IMG_CODEC_JPEG),
     mOutputBuffer( NULL ),
     mOutputBufferSize( 0 ),
+    mOutputFile( NULL ),
     mEncodeQuality( quality ) // on a scale from 1 to 100
 {
 }
@@ -381,6 +385,18 @@ boolean LLImageJPEG::encodeEmptyOutputBuffer( j_compress_ptr cinfo )
 {
   LLImageJPEG* self = (LLImageJPEG*) cinfo->client_data;
 
+  if (self->mOutputFile)
+  {
+    // Streaming to file: write the whole buffer out and start over
+    if (fwrite(self->mOutputBuffer, 1, self->mOutputBufferSize, self->mOutputFile) != (size_t)self->mOutputBufferSize)
+    {
+      ERREXIT(cinfo, JERR_FILE_WRITE);
+    }
+    cinfo->dest->next_output_byte = self->mOutputBuffer;
+    cinfo->dest->free_in_buffer = self->mOutputBufferSize;
+    return true;
+  }
+
   // Should very rarely happen, since our output buffer is
   // as large as the input to start out with.
 
@@ -413,6 +429,17 @@ void LLImageJPEG::encodeTermDestination( j_compress_ptr cinfo )
 {
     LLImageJPEG* self = (LLImageJPEG*) cinfo->client_data;
 
+    if (self->mOutputFile)
+    {
+        size_t remaining = self->mOutputBufferSize - cinfo->dest->free_in_buffer;
+        if (fwrite(self->mOutputBuffer, 1, remaining, self->mOutputFile) != remaining
+            || fflush(self->mOutputFile) != 0)
+        {
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+        }
+        return;
+    }
+
     LLImageDataLock lock(self);
 
     S32 file_bytes = (S32)(self->mOutputBufferSize - cinfo->dest->free_in_buffer);
@@ -518,6 +545,76 @@ bool LLImageJPEG::encode( const LLImageRaw* raw_image, F32 encode_time )
         return false;
     }
 
+    return compress(raw_image, encode_progress_callback_t());
+}
+
+// Virtual
+// Encode the raw image, writing the compressed data to filename through a
+// small buffer instead of holding the whole JPEG in memory.
+bool LLImageJPEG::encodeToFile(const LLImageRaw* raw_image, const std::string& filename, const encode_progress_callback_t& progress)
+{
+    llassert_always(raw_image);
+
+    resetLastError();
+
+    LLImageDataSharedLock lockIn(raw_image);
+    LLImageDataLock lockOut(this);
+
+    switch( raw_image->getComponents() )
+    {
+    case 1:
+    case 3:
+        break;
+    default:
+        setLastError("Unable to encode a JPEG image that doesn't have 1 or 3 components.");
+        return false;
+    }
+
+    setSize(raw_image->getWidth(), raw_image->getHeight(), raw_image->getComponents());
+
+    delete[] mOutputBuffer;
+    mOutputBufferSize = OUTPUT_FILE_BUFFER_SIZE;
+    mOutputBuffer = new(std::nothrow) U8[ mOutputBufferSize ];
+    if (mOutputBuffer == NULL)
+    {
+        mOutputBufferSize = 0;
+        setLastError("Failed to allocate output buffer");
+        return false;
+    }
+
+    mOutputFile = LLFile::fopen(filename, "wb");
+    if (!mOutputFile)
+    {
+        delete[] mOutputBuffer;
+        mOutputBuffer = NULL;
+        mOutputBufferSize = 0;
+        setLastError("Unable to open file for writing", filename);
+        return false;
+    }
+
+    bool success = compress(raw_image, progress);
+    if (LLFile::close(mOutputFile) != 0 && success)
+    {
+        setLastError("Unable to finish writing file", filename);
+        success = false;
+    }
+    mOutputFile = NULL;
+
+    if (!success)
+    {
+        // Don't leave a truncated image behind
+        LLFile::remove(filename);
+    }
+    return success;
+}
+
+// Runs the JPEG compressor over raw_image into mOutputBuffer, which the
+// destination callbacks then copy into this image or flush to mOutputFile.
+bool LLImageJPEG::compress(const LLImageRaw* raw_image, const encode_progress_callback_t& progress)
+{
+    // Scanlines between two progress reports
+    const JDIMENSION PROGRESS_ROWS = 64;
+
     const U8* raw_image_data = NULL;
     S32 row_stride = 0;
 
@@ -645,6 +742,11 @@ bool LLImageJPEG::encode( const LLImageRaw* raw_image, F32 encode_time )
             row_pointer[0] = (JSAMPROW)(last_row_data - (cinfo.next_scanline * row_stride));
 
             jpeg_write_scanlines(&cinfo, row_pointer, 1);
+
+            if (progress && (cinfo.next_scanline % PROGRESS_ROWS) == 0)
+            {
+                progress((F32)cinfo.next_scanline / (F32)cinfo.image_height);
+            }
         }
 
         ////////////////////////////////////////
@@ -659,6 +761,11 @@ bool LLImageJPEG::encode( const LLImageRaw* raw_image, F32 encode_time )
         ////////////////////////////////////////
         //   Step 7: release JPEG compression object
         jpeg_destroy_compress(&cinfo);
+
+        if (progress)
+        {
+            progress(1.f);
+        }
     }
 
     catch(int)
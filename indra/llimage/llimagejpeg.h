@@ -53,6 +53,7 @@ class LLImageJPEG : public LLImageFormatted
     /*virtual*/ bool updateData();
     /*virtual*/ bool decode(LLImageRaw* raw_image, F32 decode_time);
     /*virtual*/ bool encode(const LLImageRaw* raw_image, F32 encode_time);
+    /*virtual*/ bool encodeToFile(const LLImageRaw* raw_image, const std::string& filename, const encode_progress_callback_t& progress);
 
     void            setEncodeQuality( S32 q )   { mEncodeQuality = q; } // on a scale from 1 to 100
     S32             getEncodeQuality()          { return mEncodeQuality; }
@@ -73,12 +74,15 @@ class LLImageJPEG : public LLImageFormatted
     static void     errorOutputMessage(j_common_ptr cinfo);
 
 protected:
+    bool            compress(const LLImageRaw* raw_image, const encode_progress_callback_t& progress);
+
     U8*             mOutputBuffer;      // temp buffer used during encoding
     S32             mOutputBufferSize;  // bytes in mOuputBuffer
+    LLFILE*         mOutputFile;        // when set, mOutputBuffer is flushed there as it fills up
 
     S32             mEncodeQuality;     // on a scale from 1 to 100
 private:
-    static jmp_buf  sSetjmpBuffer;      // To allow the library to abort.
+    static thread_local jmp_buf sSetjmpBuffer;  // To allow the library to abort, per thread as encodes may run on workers.
 };
 
 #endif  // LL_LLIMAGEJPEG_H
@@ -175,3 +175,45 @@ bool LLImagePNG::encode(const LLImageRaw* raw_image, F32 encode_time)
     return true;
 }
 
+// Virtual
+// Encode the in memory RGB image into PNG format, streaming the rows
+// straight into filename.
+bool LLImagePNG::encodeToFile(const LLImageRaw* raw_image, const std::string& filename, const encode_progress_callback_t& progress)
+{
+    llassert_always(raw_image);
+
+    resetLastError();
+
+    LLImageDataSharedLock lockIn(raw_image);
+    LLImageDataLock lockOut(this);
+
+    // Image logical size
+    setSize(raw_image->getWidth(), raw_image->getHeight(), raw_image->getComponents());
+
+    LLFILE* fp = LLFile::fopen(filename, "wb");
+    if (!fp)
+    {
+        setLastError("Unable to open file for writing", filename);
+        return false;
+    }
+
+    // Delegate actual encoding work to wrapper
+    LLPngWrapper pngWrapper;
+    bool success = pngWrapper.writePng(raw_image, fp, progress);
+    if (LLFile::close(fp) != 0 && success)
+    {
+        setLastError("Unable to finish writing file", filename);
+        success = false;
+    }
+    else if (!success)
+    {
+        setLastError(pngWrapper.getErrorMessage(), filename);
+    }
+
+    if (!success)
+    {
+        // Don't leave a truncated image behind
+        LLFile::remove(filename);
+    }
+    return success;
+}
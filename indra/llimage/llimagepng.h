@@ -41,6 +41,7 @@ class LLImagePNG : public LLImageFormatted
     /*virtual*/ bool updateData();
     /*virtual*/ bool decode(LLImageRaw* raw_image, F32 decode_time);
     /*virtual*/ bool encode(const LLImageRaw* raw_image, F32 encode_time);
+    /*virtual*/ bool encodeToFile(const LLImageRaw* raw_image, const std::string& filename, const encode_progress_callback_t& progress);
 };
 
 #endif
@@ -28,8 +28,25 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llimagej2c.h"
+#include "lltimer.h"
 #include "threadpool.h"
 
+LLTrace::SampleStatHandle<F64Milliseconds> LLImageDecodeThread::sQueueLatency("image_decode_queue_latency", "Time decode requests wait before a thread picks them up");
+LLTrace::SampleStatHandle<F64Percent> LLImageDecodeThread::sUtilization("image_decode_utilization", "Share of the active decode threads spent decoding");
+LLTrace::SampleStatHandle<> LLImageDecodeThread::sActiveThreads("image_decode_active_threads", "Decode threads allowed to run");
+
+// always allow at least 2 concurrent decodes so that a single large texture
+// can not block all other textures from decoding
+static const S32 MIN_ACTIVE_DECODES = 2;
+// pool width when "ThreadPoolSizes" has no "ImageDecode" entry, the viewer
+// sets one from its core budget
+static const S32 DEFAULT_POOL_WIDTH = 8;
+// consecutive busy frames before giving up one decode thread
+static const S32 BUSY_FRAMES_TO_SHRINK = 10;
+// pending requests per active thread before adding one back
+static const S32 BACKLOG_PER_THREAD = 4;
+
 /*--------------------------------------------------------------------------*/
 class ImageRequest
 {
@@ -38,10 +55,14 @@ class ImageRequest
                  S32 discard,
                  bool needs_aux,
                  const LLPointer<LLImageDecodeThread::Responder>& responder,
-                 U32 request_id);
+                 U32 request_id,
+                 S32 compression_quality,
+                 const LLRect& region,
+                 S32 background_discard);
     virtual ~ImageRequest();
 
     /*virtual*/ bool processRequest();
+    void compressRequest();
     /*virtual*/ void finishRequest(bool completed);
 
 private:
@@ -52,9 +73,13 @@ class ImageRequest
     S32 mDiscardLevel;
     U32 mRequestId;
     bool mNeedsAux;
+    S32 mCompressionQuality;
+    LLRect mRegion;
+    S32 mBackgroundDiscard;
     // output
     LLPointer<LLImageRaw> mDecodedImageRaw;
     LLPointer<LLImageRaw> mDecodedImageAux;
+    LLPointer<LLImageDXT> mCompressedImage;
     bool mDecodedRaw;
     bool mDecodedAux;
     LLPointer<LLImageDecodeThread::Responder> mResponder;
@@ -65,34 +90,187 @@ class ImageRequest
 
 // MAIN THREAD
 LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
-    : mDecodeCount(0)
+    : mDecodeCount(0),
+      mCompressionQuality(LLImageDXT::COMPRESS_NONE),
+      mActiveCount(0),
+      mActiveLimit(0),
+      mShuttingDown(false),
+      mBusyFrames(0),
+      mQueueLatencyTotal(0),
+      mBusyTimeTotal(0),
+      mStartedCount(0),
+      mLastSampleTime(LLTimer::getTotalTime())
 {
-    mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
+    mThreadPool.reset(new LL::ThreadPool("ImageDecode", DEFAULT_POOL_WIDTH));
     mThreadPool->start();
+    mActiveLimit = getWidth();
 }
 
 //virtual
 LLImageDecodeThread::~LLImageDecodeThread()
-{}
+{
+    // pool threads must be done before the members they use go away
+    shutdown();
+}
+
+S32 LLImageDecodeThread::getWidth()
+{
+    return (S32)mThreadPool->getWidth();
+}
 
 // MAIN THREAD
 // virtual
 size_t LLImageDecodeThread::update(F32 max_time_ms)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    dispatchDecodes();
+    sampleStats();
     return getPending();
 }
 
+// MAIN THREAD
+void LLImageDecodeThread::updateActiveLimit(bool main_thread_busy, bool rez_burst)
+{
+    S32 width = getWidth();
+    S32 limit = mActiveLimit;
+    if (rez_burst)
+    {
+        mBusyFrames = 0;
+        limit = width;
+    }
+    else if (main_thread_busy)
+    {
+        if (++mBusyFrames >= BUSY_FRAMES_TO_SHRINK)
+        {
+            mBusyFrames = 0;
+            limit--;
+        }
+    }
+    else
+    {
+        mBusyFrames = 0;
+        if (getPending() > (size_t)(limit * BACKLOG_PER_THREAD))
+        {
+            limit++;
+        }
+    }
+    setActiveLimit(llclamp(limit, llmin(MIN_ACTIVE_DECODES, width), width));
+}
+
+void LLImageDecodeThread::setActiveLimit(S32 limit)
+{
+    if (limit == mActiveLimit)
+    {
+        return;
+    }
+    mWaitingMutex.lock();
+    mActiveLimit = limit;
+    mWaitingMutex.unlock();
+    // a raised limit can start waiting requests right away
+    dispatchDecodes();
+}
+
+// MAIN THREAD
+void LLImageDecodeThread::dispatchDecodes()
+{
+    LLMutexLock lock(&mWaitingMutex);
+    while (!mWaiting.empty() && mActiveCount < mActiveLimit && !mShuttingDown)
+    {
+        decode_t decode = std::move(mWaiting.front());
+        mWaiting.pop_front();
+        mActiveCount++;
+        bool posted = mThreadPool->getQueue().post(
+            [this, decode = std::move(decode)]()
+            {
+                runDecodes(decode);
+            });
+        if (!posted)
+        {
+            mActiveCount--;
+            LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
+            break;
+        }
+    }
+}
+
+// POOL THREADS
+void LLImageDecodeThread::runDecodes(decode_t decode)
+{
+    while (decode)
+    {
+        decode();
+
+        // Keep the slot for the next waiting request unless the limit
+        // dropped while this one ran
+        LLMutexLock lock(&mWaitingMutex);
+        if (!mWaiting.empty() && mActiveCount <= mActiveLimit && !mShuttingDown)
+        {
+            decode = std::move(mWaiting.front());
+            mWaiting.pop_front();
+        }
+        else
+        {
+            decode = nullptr;
+            mActiveCount--;
+        }
+    }
+}
+
+// POOL THREADS
+void LLImageDecodeThread::beginDecode(U64MicrosecondsImplicit queued_time)
+{
+    U64MicrosecondsImplicit now = LLTimer::getTotalTime();
+    mQueueLatencyTotal += (now > queued_time) ? (U64)(now - queued_time) : 0;
+    mStartedCount++;
+}
+
+// POOL THREADS
+void LLImageDecodeThread::endDecode(U64MicrosecondsImplicit start_time)
+{
+    mBusyTimeTotal += (U64)(LLTimer::getTotalTime() - start_time);
+}
+
+// MAIN THREAD
+// Pool threads have no LLTrace recorder, so they only accumulate totals
+// which are turned into samples here.
+void LLImageDecodeThread::sampleStats()
+{
+    U64MicrosecondsImplicit now = LLTimer::getTotalTime();
+    U64 elapsed = (U64)(now - mLastSampleTime);
+    if (elapsed == 0)
+    {
+        return;
+    }
+    mLastSampleTime = now;
+
+    U64 latency_total = mQueueLatencyTotal.exchange(0);
+    U64 busy_total = mBusyTimeTotal.exchange(0);
+    U32 started = mStartedCount.CurrentValue();
+    mStartedCount -= started;
+
+    if (started > 0)
+    {
+        sample(sQueueLatency, F64Microseconds((F64)latency_total / (F64)started));
+    }
+    S32 limit = mActiveLimit;
+    sample(sUtilization, F64Percent(llmin(100.0, 100.0 * (F64)busy_total / ((F64)elapsed * (F64)llmax(limit, 1)))));
+    sample(sActiveThreads, limit);
+}
+
 size_t LLImageDecodeThread::getPending()
 {
-    return mThreadPool->getQueue().size();
+    LLMutexLock lock(&mWaitingMutex);
+    return mThreadPool->getQueue().size() + mWaiting.size();
 }
 
 LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     const LLPointer<LLImageFormatted>& image,
     S32 discard,
     bool needs_aux,
-    const LLPointer<LLImageDecodeThread::Responder>& responder)
+    const LLPointer<LLImageDecodeThread::Responder>& responder,
+    bool allow_compression,
+    const LLRect& region,
+    S32 background_discard)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
@@ -100,25 +278,48 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     if (decode_id == 0)
         decode_id = ++mDecodeCount;
 
+    S32 compression_quality = allow_compression ? (S32)mCompressionQuality : LLImageDXT::COMPRESS_NONE;
+
     // Instantiate the ImageRequest right in the lambda, why not?
-    bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
+    decode_t decode(
+        [this,
+         req = ImageRequest(image, discard, needs_aux, responder, decode_id, compression_quality, region, background_discard),
+         queued_time = LLTimer::getTotalTime()]
         () mutable
         {
+            beginDecode(queued_time);
+            U64MicrosecondsImplicit start_time = LLTimer::getTotalTime();
             auto done = req.processRequest();
+            if (done)
+            {
+                req.compressRequest();
+            }
+            endDecode(start_time);
             req.finishRequest(done);
         });
-    if (! posted)
+
     {
-        LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
-        return 0;
+        // Requests wait here rather than in the pool's queue, so a pool
+        // thread only takes one when it is allowed to decode it
+        LLMutexLock lock(&mWaitingMutex);
+        if (mShuttingDown)
+        {
+            LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
+            return 0;
+        }
+        mWaiting.push_back(std::move(decode));
     }
+    dispatchDecodes();
 
     return decode_id;
 }
 
 void LLImageDecodeThread::shutdown()
 {
+    mWaitingMutex.lock();
+    mShuttingDown = true;
+    mWaiting.clear();
+    mWaitingMutex.unlock();
     mThreadPool->close();
 }
 
@@ -132,10 +333,16 @@ ImageRequest::ImageRequest(const LLPointer<LLImageFormatted>& image,
                            S32 discard,
                            bool needs_aux,
                            const LLPointer<LLImageDecodeThread::Responder>& responder,
-                           U32 request_id)
+                           U32 request_id,
+                           S32 compression_quality,
+                           const LLRect& region,
+                           S32 background_discard)
     : mFormattedImage(image),
       mDiscardLevel(discard),
       mNeedsAux(needs_aux),
+      mCompressionQuality(compression_quality),
+      mRegion(region),
+      mBackgroundDiscard(background_discard),
       mDecodedRaw(false),
       mDecodedAux(false),
       mResponder(responder),
@@ -147,6 +354,7 @@ ImageRequest::~ImageRequest()
 {
     mDecodedImageRaw = NULL;
     mDecodedImageAux = NULL;
+    mCompressedImage = NULL;
     mFormattedImage = NULL;
 }
 
@@ -190,7 +398,14 @@ bool ImageRequest::processRequest()
                                               mFormattedImage->getHeight(),
                                               mFormattedImage->getComponents());
         }
-        done = mFormattedImage->decode(mDecodedImageRaw, decode_time_slice);
+        if (mRegion.notEmpty() && !mNeedsAux && mFormattedImage->getCodec() == IMG_CODEC_J2C)
+        {
+            done = ((LLImageJ2C*)mFormattedImage.get())->decodeRegion(mDecodedImageRaw, mRegion, mBackgroundDiscard);
+        }
+        else
+        {
+            done = mFormattedImage->decode(mDecodedImageRaw, decode_time_slice);
+        }
         // some decoders are removing data when task is complete and there were errors
         mDecodedRaw = done && mDecodedImageRaw->getData();
 
@@ -216,12 +431,29 @@ bool ImageRequest::processRequest()
     return done;
 }
 
+// Optional stage after a successful decode: block compress the raw image so
+// the consumer can upload it without the main thread touching the pixels.
+void ImageRequest::compressRequest()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    if (mDecodedRaw)
+    {
+        // NULL is not an error, the consumer falls back to the raw image
+        mCompressedImage = LLImageDXT::createCompressed(mDecodedImageRaw, mCompressionQuality);
+    }
+}
+
 void ImageRequest::finishRequest(bool completed)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
     if (mResponder.notNull())
     {
         bool success = completed && mDecodedRaw && (!mNeedsAux || mDecodedAux);
+        if (success && mCompressedImage.notNull())
+        {
+            mResponder->compressed(mCompressedImage, mRequestId);
+        }
         mResponder->completed(success, mErrorString, mDecodedImageRaw, mDecodedImageAux, mRequestId);
     }
     // Will automatically be deleted
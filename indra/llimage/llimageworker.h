@@ -29,8 +29,16 @@
 
 #include "llimage.h"
 #include "llpointer.h"
+#include "llrect.h"
+#include "lltrace.h"
 #include "threadpool_fwd.h"
 
+#include <atomic>
+#include <deque>
+#include <functional>
+
+class LLImageDXT;
+
 class LLImageDecodeThread
 {
 public:
@@ -40,6 +48,9 @@ class LLImageDecodeThread
         virtual ~Responder();
     public:
         virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id) = 0;
+        // Called just before completed() when the request allowed compression
+        // and a block compressed copy of raw was produced.
+        virtual void compressed(LLImageDXT* compressed_image, U32 request_id) {}
     };
 
 public:
@@ -48,20 +59,69 @@ class LLImageDecodeThread
 
     // meant to resemble LLQueuedThread::handle_t
     typedef U32 handle_t;
+    // A non empty region (full resolution pixels, J2C only) is decoded at
+    // discard and the rest of the image at background_discard, see
+    // LLImageJ2C::decodeRegion().
     handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
                          S32 discard, bool needs_aux,
-                         const LLPointer<Responder>& responder);
+                         const LLPointer<Responder>& responder,
+                         bool allow_compression = false,
+                         const LLRect& region = LLRect(),
+                         S32 background_discard = -1);
     size_t getPending();
     size_t update(F32 max_time_ms);
     S32 getTotalDecodeCount() { return mDecodeCount; }
     void shutdown();
 
+    // Adapts how many of the pool threads may decode at once. Call once per
+    // frame from the main thread: the limit shrinks while the main thread is
+    // CPU-bound and jumps to the full pool width during rez bursts.
+    void updateActiveLimit(bool main_thread_busy, bool rez_burst);
+    S32 getActiveLimit() { return mActiveLimit; }
+    S32 getWidth();
+
+    // LLImageDXT::ECompressionQuality applied to requests that allow
+    // compression, COMPRESS_NONE disables the compression stage.
+    void setCompressionQuality(S32 quality) { mCompressionQuality = quality; }
+    S32 getCompressionQuality() { return mCompressionQuality; }
+
+    static LLTrace::SampleStatHandle<F64Milliseconds> sQueueLatency;
+    static LLTrace::SampleStatHandle<F64Percent> sUtilization;
+    static LLTrace::SampleStatHandle<> sActiveThreads;
+
 private:
+    typedef std::function<void()> decode_t;
+
+    // Posts waiting requests to the pool while fewer than mActiveLimit
+    // are decoding. Pool threads never hold a request they may not run,
+    // which is how the pool shrinks without tearing threads down.
+    void dispatchDecodes();
+    // Runs decode, then keeps taking waiting requests while the limit allows
+    void runDecodes(decode_t decode);
+    void beginDecode(U64MicrosecondsImplicit queued_time);
+    void endDecode(U64MicrosecondsImplicit start_time);
+    void setActiveLimit(S32 limit);
+    void sampleStats();
+
     // As of SL-17483, LLImageDecodeThread is no longer itself an
     // LLQueuedThread - instead this is the API by which we submit work to the
     // "ImageDecode" ThreadPool.
     std::unique_ptr<LL::ThreadPool> mThreadPool;
     LLAtomicU32 mDecodeCount;
+    LLAtomicS32 mCompressionQuality;
+
+    LLMutex mWaitingMutex;
+    std::deque<decode_t> mWaiting;  // protected by mWaitingMutex
+    S32 mActiveCount;               // protected by mWaitingMutex
+    LLAtomicS32 mActiveLimit;
+    LLAtomicBool mShuttingDown;
+    S32 mBusyFrames;
+
+    // accumulated by the pool threads, sampled and reset by sampleStats()
+    std::atomic<U64> mQueueLatencyTotal;   // microseconds
+    std::atomic<U64> mBusyTimeTotal;       // microseconds
+    LLAtomicU32 mStartedCount;
+    U64MicrosecondsImplicit mLastSampleTime;
 };
 
 #endif
@@ -128,6 +128,22 @@ void LLPngWrapper::writeFlush(png_structp png_ptr)
     // no-op since we're just writing to memory
 }
 
+// Called by the libpng library when streaming the encoded PNG to a file.
+void LLPngWrapper::writeFileCallback(png_structp png_ptr, png_bytep src, png_size_t length)
+{
+    LLFILE* fp = (LLFILE*) png_get_io_ptr(png_ptr);
+    if (fwrite(src, 1, length, fp) != length)
+    {
+        png_error(png_ptr, "Data write error. Could not write to file.");
+    }
+}
+
+void LLPngWrapper::writeFileFlush(png_structp png_ptr)
+{
+    LLFILE* fp = (LLFILE*) png_get_io_ptr(png_ptr);
+    fflush(fp);
+}
+
 // Read the PNG file using the libpng.  The low-level interface is used here
 // because we want to do various transformations (including applying gama)
 // which can't be done with the high-level interface.
@@ -292,6 +308,31 @@ void LLPngWrapper::updateMetaData()
 // at the bottom of the image per SecondLife conventions.
 bool LLPngWrapper::writePng(const LLImageRaw* rawImage, U8* dest, size_t destSize)
 {
+    PngDataInfo dataPtr{};
+    dataPtr.mData = dest;
+    dataPtr.mOffset = 0;
+    dataPtr.mDataSize = static_cast<S32>(destSize);
+    if (!writeImage(rawImage, &dataPtr, &writeDataCallback, &writeFlush, LLImageFormatted::encode_progress_callback_t()))
+    {
+        return false;
+    }
+    mFinalSize = dataPtr.mOffset;
+    return true;
+}
+
+// Same as above but rows are compressed and written to fp as they come, so
+// that the encoded image never needs to fit in memory.
+bool LLPngWrapper::writePng(const LLImageRaw* rawImage, LLFILE* fp, const LLImageFormatted::encode_progress_callback_t& progress)
+{
+    return writeImage(rawImage, fp, &writeFileCallback, &writeFileFlush, progress);
+}
+
+bool LLPngWrapper::writeImage(const LLImageRaw* rawImage, png_voidp io_ptr, png_rw_ptr write_fn, png_flush_ptr flush_fn,
+                              const LLImageFormatted::encode_progress_callback_t& progress)
+{
+    // Rows between two progress reports
+    const U32 PROGRESS_ROWS = 64;
+
     try
     {
         S8 numComponents = rawImage->getComponents();
@@ -328,11 +369,7 @@ bool LLPngWrapper::writePng(const LLImageRaw* rawImage, U8* dest, size_t destSiz
         mWriteInfoPtr = png_create_info_struct(mWritePngPtr);
 
         // Setup write function
-        PngDataInfo dataPtr{};
-        dataPtr.mData = dest;
-        dataPtr.mOffset = 0;
-        dataPtr.mDataSize = static_cast<S32>(destSize);
-        png_set_write_fn(mWritePngPtr, &dataPtr, &writeDataCallback, &writeFlush);
+        png_set_write_fn(mWritePngPtr, io_ptr, write_fn, flush_fn);
 
         // Setup image params
         mWidth = rawImage->getWidth();
@@ -361,11 +398,18 @@ bool LLPngWrapper::writePng(const LLImageRaw* rawImage, U8* dest, size_t destSiz
         {
             rowPointer = &data[(mHeight-1-i)*offset];
             png_write_row(mWritePngPtr, const_cast<png_bytep>(rowPointer));
+            if (progress && ((i + 1) % PROGRESS_ROWS) == 0)
+            {
+                progress((F32)(i + 1) / (F32)mHeight);
+            }
         }
 
         // Finish up
         png_write_end(mWritePngPtr, mWriteInfoPtr);
-        mFinalSize = dataPtr.mOffset;
+        if (progress)
+        {
+            progress(1.f);
+        }
     }
     catch (const PngError& msg)
     {
@@ -46,6 +46,8 @@ class LLPngWrapper
     bool isValidPng(U8* src);
     bool readPng(U8* src, S32 dataSize, LLImageRaw* rawImage, ImageInfo *infop = NULL);
     bool writePng(const LLImageRaw* rawImage, U8* dst, size_t destSize);
+    bool writePng(const LLImageRaw* rawImage, LLFILE* fp,
+                  const LLImageFormatted::encode_progress_callback_t& progress = LLImageFormatted::encode_progress_callback_t());
     U32  getFinalSize();
     const std::string& getErrorMessage();
 
@@ -68,6 +70,11 @@ class LLPngWrapper
     static void errorHandler(png_structp png_ptr, png_const_charp msg);
     static void readDataCallback(png_structp png_ptr, png_bytep dest, png_size_t length);
     static void writeDataCallback(png_structp png_ptr, png_bytep src, png_size_t length);
+    static void writeFileCallback(png_structp png_ptr, png_bytep src, png_size_t length);
+    static void writeFileFlush(png_structp png_ptr);
+
+    bool writeImage(const LLImageRaw* rawImage, png_voidp io_ptr, png_rw_ptr write_fn, png_flush_ptr flush_fn,
+                    const LLImageFormatted::encode_progress_callback_t& progress);
 
     void releaseResources();
 
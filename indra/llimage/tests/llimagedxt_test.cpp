@@ -0,0 +1,166 @@
+/**
+ * @file llimagedxt_test.cpp
+ * @brief CPU block compression round trip test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagedxt.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const S32 SIZE = 64;
+
+    // Smooth gradients with a hard edge through the middle, the kind of
+    // content block compression has to get right
+    LLPointer<LLImageRaw> make_image(S32 components, bool with_alpha)
+    {
+        LLPointer<LLImageRaw> raw = new LLImageRaw(SIZE, SIZE, components);
+        U8* data = raw->getData();
+        for (S32 y = 0; y < SIZE; ++y)
+        {
+            for (S32 x = 0; x < SIZE; ++x)
+            {
+                U8* texel = data + (y * SIZE + x) * components;
+                texel[0] = (U8)(x * 4);
+                texel[1] = (U8)(y * 4);
+                texel[2] = x < SIZE / 2 ? 40 : 200;
+                if (components == 4)
+                {
+                    texel[3] = with_alpha ? (y < SIZE / 2 ? 0 : 255) : 255;
+                }
+            }
+        }
+        return raw;
+    }
+
+    // Largest and mean per channel difference
+    void compare(const LLImageRaw* a, const LLImageRaw* b, S32& max_error, F32& mean_error)
+    {
+        const U8* pa = a->getData();
+        const U8* pb = b->getData();
+        S32 count = a->getWidth() * a->getHeight() * a->getComponents();
+        max_error = 0;
+        S64 total = 0;
+        for (S32 i = 0; i < count; ++i)
+        {
+            S32 error = llabs(pa[i] - pb[i]);
+            max_error = llmax(max_error, error);
+            total += error;
+        }
+        mean_error = (F32)total / (F32)count;
+    }
+}
+
+namespace tut
+{
+    struct imagedxt_data
+    {
+    };
+    typedef test_group<imagedxt_data> imagedxt_test;
+    typedef imagedxt_test::object imagedxt_object;
+    tut::imagedxt_test imagedxt_testcase("LLImageDXT");
+
+    template<> template<>
+    void imagedxt_object::test<1>()
+    {
+        set_test_name("Encode and read back every mip");
+
+        for (S32 quality = LLImageDXT::COMPRESS_FAST; quality <= LLImageDXT::COMPRESS_HIGH; ++quality)
+        {
+            for (S32 components = 3; components <= 4; ++components)
+            {
+                LLPointer<LLImageRaw> raw = make_image(components, components == 4);
+                LLPointer<LLImageDXT> dxt = LLImageDXT::createCompressed(raw, quality);
+                ensure("compressed", dxt.notNull());
+                ensure_equals("format", dxt->getFileFormat(), components == 4 ? LLImageDXT::FORMAT_DXR5 : LLImageDXT::FORMAT_DXR1);
+
+                // LLImageGL::setImage() starts at the largest mip and steps
+                // back over each smaller one
+                S32 nmips = LLImageDXT::calcNumMips(SIZE, SIZE);
+                S32 offset = dxt->getMipOffset(0);
+                for (S32 d = 1; d < nmips; ++d)
+                {
+                    S32 w = SIZE, h = SIZE;
+                    LLImageDXT::calcDiscardWidthHeight(d, dxt->getFileFormat(), w, h);
+                    offset -= LLImageDXT::formatBytes(dxt->getFileFormat(), w, h);
+                    ensure_equals("mip offset", offset, dxt->getMipOffset(d));
+                }
+                ensure_equals("header first", offset, dxt->calcHeaderSize());
+
+                // What the GPU returns when the texture is read back
+                for (S32 d = 0; d < nmips; ++d)
+                {
+                    dxt->setDiscardLevel(d);
+                    LLPointer<LLImageRaw> decoded = new LLImageRaw();
+                    ensure("decoded", dxt->decode(decoded, 0.f));
+                    ensure_equals("components", (S32)decoded->getComponents(), components);
+                    S32 w = SIZE, h = SIZE;
+                    LLImageDXT::calcDiscardWidthHeight(d, dxt->getFileFormat(), w, h);
+                    ensure_equals("width", (S32)decoded->getWidth(), w);
+                    ensure_equals("height", (S32)decoded->getHeight(), h);
+
+                    if (d == 0)
+                    {
+                        S32 max_error;
+                        F32 mean_error;
+                        compare(raw, decoded, max_error, mean_error);
+                        ensure("mean error", mean_error < (quality == LLImageDXT::COMPRESS_HIGH ? 4.f : 6.f));
+                        ensure("max error", max_error < 24);
+                    }
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void imagedxt_object::test<2>()
+    {
+        set_test_name("Alpha survives and opaque RGBA drops to BC1");
+
+        LLPointer<LLImageRaw> raw = make_image(4, true);
+        LLPointer<LLImageDXT> dxt = LLImageDXT::createCompressed(raw, LLImageDXT::COMPRESS_FAST);
+        LLPointer<LLImageRaw> decoded = new LLImageRaw();
+        ensure("decoded", dxt->decode(decoded, 0.f));
+        for (S32 i = 0; i < SIZE * SIZE; ++i)
+        {
+            ensure_equals("alpha", decoded->getData()[i * 4 + 3], raw->getData()[i * 4 + 3]);
+        }
+
+        LLPointer<LLImageRaw> opaque = make_image(4, false);
+        dxt = LLImageDXT::createCompressed(opaque, LLImageDXT::COMPRESS_FAST);
+        ensure_equals("format", dxt->getFileFormat(), LLImageDXT::FORMAT_DXR1);
+        S32 chain_bytes = 0;
+        for (S32 size = SIZE; size > 0; size >>= 1)
+        {
+            chain_bytes += LLImageDXT::formatBytes(LLImageDXT::FORMAT_DXR1, size, size);
+        }
+        ensure_equals("BC1 size", dxt->getDataSize() - dxt->calcHeaderSize(), chain_bytes);
+
+        ensure("too small", LLImageDXT::createCompressed(new LLImageRaw(2, 2, 4), LLImageDXT::COMPRESS_FAST).isNull());
+        ensure("not a power of two", LLImageDXT::createCompressed(new LLImageRaw(12, 12, 3), LLImageDXT::COMPRESS_FAST).isNull());
+    }
+}
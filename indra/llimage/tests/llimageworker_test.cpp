@@ -29,6 +29,8 @@
 #include "linden_common.h"
 // Class to test
 #include "../llimageworker.h"
+#include "../llimagedxt.h"
+#include "../llimagej2c.h"
 // For timer class
 #include "../llcommon/lltimer.h"
 // for lltrace class
@@ -69,6 +71,9 @@ U8* LLImageRaw::reallocateData(S32 size) { return NULL; }
 const U8* LLImageBase::getData() const { return NULL; }
 U8* LLImageBase::getData() { return NULL; }
 const std::string& LLImage::getLastThreadError() { static std::string msg; return msg; }
+LLPointer<LLImageDXT> LLImageDXT::createCompressed(const LLImageRaw* raw_image, S32 quality) { return NULL; }
+S8 LLImageFormatted::getCodec() const { return IMG_CODEC_INVALID; }
+bool LLImageJ2C::decodeRegion(LLImageRaw* raw_imagep, const LLRect& region, S32 background_discard) { return false; }
 
 // End Stubbing
 // -------------------------------------------------------------------------------------------
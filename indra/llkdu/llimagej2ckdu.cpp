@@ -397,6 +397,74 @@ bool LLImageJ2CKDU::initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int disc
     return initDecode(base,raw_image,0.0f,MODE_FAST,0,4,discard_level,region);
 }
 
+// Called by LLImageJ2C::decodeRegion(). Leaves the restricted codestream in
+// place so that the following decodeImpl() only walks the tiles and code
+// blocks covering the region.
+//
+// region is { left, top, right, bottom } at full resolution, in rows from
+// the top of the image as the codestream stores it.  origin gets where the
+// decoded region sits in the whole image at discard_level, in rows from
+// the bottom like raw images.
+bool LLImageJ2CKDU::initRegionDecode(LLImageJ2C &base, LLImageRaw &raw_image, S32 discard_level, int* region, S32* origin)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    cleanupCodeStream();
+    if (!initDecode(base, raw_image, 0.0f, MODE_FAST, 0, 4, discard_level, NULL))
+    {
+        cleanupCodeStream();
+        return false;
+    }
+
+    try
+    {
+        // Place the region on the full resolution canvas, which need not
+        // start at zero, then mirror it into the apparent geometry that
+        // initDecode() set up with change_appearance().  Restrictions are
+        // read in that geometry.
+        mCodeStreamp->apply_input_restrictions(0, 4, 0, 0, NULL);
+        kdu_dims canvas;
+        mCodeStreamp->get_dims(0, canvas);
+        canvas.from_apparent(false, true, false);
+
+        kdu_dims region_kdu;
+        region_kdu.pos.x  = canvas.pos.x + region[0];
+        region_kdu.pos.y  = canvas.pos.y + region[1];
+        region_kdu.size.x = region[2] - region[0];
+        region_kdu.size.y = region[3] - region[1];
+        region_kdu.to_apparent(false, true, false);
+
+        // Both are apparent, where rows count up from the bottom of the
+        // image, which is also the order decodeImpl() writes them in.
+        kdu_dims full_dims;
+        mCodeStreamp->apply_input_restrictions(0, 4, discard_level, 0, NULL);
+        mCodeStreamp->get_dims(0, full_dims);
+        mCodeStreamp->apply_input_restrictions(0, 4, discard_level, 0, &region_kdu);
+        kdu_dims region_dims;
+        mCodeStreamp->get_dims(0, region_dims);
+
+        origin[0] = region_dims.pos.x - full_dims.pos.x;
+        origin[1] = region_dims.pos.y - full_dims.pos.y;
+
+        // initDecode() sized and tiled for the whole image
+        raw_image.resize(region_dims.size.x, region_dims.size.y, llmin((S32)base.getComponents(), 4));
+        mCodeStreamp->get_valid_tiles(*mTileIndicesp);
+    }
+    catch (const KDUError& msg)
+    {
+        base.setLastError(msg.what());
+        cleanupCodeStream();
+        return false;
+    }
+    catch (kdu_exception kdu_value)
+    {
+        base.setLastError(report_kdu_exception(kdu_value));
+        cleanupCodeStream();
+        return false;
+    }
+
+    return true;
+}
+
 bool LLImageJ2CKDU::initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size, int precincts_size, int levels)
 {
     mPrecinctsSize = precincts_size;
@@ -66,6 +66,8 @@ class LLImageJ2CKDU : public LLImageJ2CImpl
                                 bool reversible=false);
     virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL);
     virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0);
+    virtual bool canDecodeRegion() const { return true; }
+    virtual bool initRegionDecode(LLImageJ2C &base, LLImageRaw &raw_image, S32 discard_level, int* region, S32* origin);
     virtual std::string getEngineInfo() const;
 
 private:
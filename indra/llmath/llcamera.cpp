@@ -29,6 +29,24 @@
 #include "llmath.h"
 #include "llcamera.h"
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define LL_CAMERA_AVX 1
+#include <immintrin.h>
+#if LL_MSVC
+#include <intrin.h>
+#endif
+#else
+#define LL_CAMERA_AVX 0
+#endif
+
+#if LL_CAMERA_AVX && !LL_MSVC
+// GCC and clang only emit AVX inside functions that ask for it, so the
+// rest of the viewer keeps running on CPUs without it
+#define LL_TARGET_AVX __attribute__((target("avx")))
+#else
+#define LL_TARGET_AVX
+#endif
+
 // ---------------- Constructors and destructors ----------------
 
 LLCamera::LLCamera() :
@@ -299,6 +317,194 @@ S32 LLCamera::AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVec
     return AABBInFrustumNoFarClip(center, radius, mRegionPlanes);
 }
 
+namespace
+{
+    // Active planes of one AABBInFrustumBatch() call: normal, octant
+    // scaler (see sFrustumScaler) and negated distance, one float each
+    struct BatchPlane
+    {
+        F32 mNormal[3];
+        F32 mScale[3];
+        F32 mNegD;
+        bool mFar;
+    };
+
+    struct BatchMasks
+    {
+        U32 mOutside = 0;       // fully behind one of the non far planes
+        U32 mCrossing = 0;      // straddling one of the non far planes
+        U32 mFarOutside = 0;
+        U32 mFarCrossing = 0;
+    };
+
+    // Same arithmetic, in the same order, as AABBInFrustum() so that both
+    // agree on boxes touching a plane
+    void frustum_batch_sse2(const BatchPlane* planes, U32 plane_count, const LLCameraBoxBatch& boxes, BatchMasks& masks)
+    {
+        for (U32 base = 0; base < boxes.mCount; base += 4)
+        {
+            const __m128 cx = _mm_load_ps(boxes.mCenter[0] + base);
+            const __m128 cy = _mm_load_ps(boxes.mCenter[1] + base);
+            const __m128 cz = _mm_load_ps(boxes.mCenter[2] + base);
+            const __m128 rx = _mm_load_ps(boxes.mRadius[0] + base);
+            const __m128 ry = _mm_load_ps(boxes.mRadius[1] + base);
+            const __m128 rz = _mm_load_ps(boxes.mRadius[2] + base);
+
+            for (U32 i = 0; i < plane_count; ++i)
+            {
+                const BatchPlane& p = planes[i];
+                const __m128 sx = _mm_mul_ps(rx, _mm_set1_ps(p.mScale[0]));
+                const __m128 sy = _mm_mul_ps(ry, _mm_set1_ps(p.mScale[1]));
+                const __m128 sz = _mm_mul_ps(rz, _mm_set1_ps(p.mScale[2]));
+                const __m128 nx = _mm_set1_ps(p.mNormal[0]);
+                const __m128 ny = _mm_set1_ps(p.mNormal[1]);
+                const __m128 nz = _mm_set1_ps(p.mNormal[2]);
+                const __m128 d = _mm_set1_ps(p.mNegD);
+
+                __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_sub_ps(cx, sx)), _mm_mul_ps(ny, _mm_sub_ps(cy, sy))), _mm_mul_ps(nz, _mm_sub_ps(cz, sz)));
+                U32 outside = _mm_movemask_ps(_mm_cmpgt_ps(dist, d)) << base;
+                dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_add_ps(cx, sx)), _mm_mul_ps(ny, _mm_add_ps(cy, sy))), _mm_mul_ps(nz, _mm_add_ps(cz, sz)));
+                U32 crossing = _mm_movemask_ps(_mm_cmpgt_ps(dist, d)) << base;
+
+                if (p.mFar)
+                {
+                    masks.mFarOutside |= outside;
+                    masks.mFarCrossing |= crossing;
+                }
+                else
+                {
+                    masks.mOutside |= outside;
+                    masks.mCrossing |= crossing;
+                }
+            }
+        }
+    }
+
+#if LL_CAMERA_AVX
+    LL_TARGET_AVX void frustum_batch_avx(const BatchPlane* planes, U32 plane_count, const LLCameraBoxBatch& boxes, BatchMasks& masks)
+    {
+        const __m256 cx = _mm256_load_ps(boxes.mCenter[0]);
+        const __m256 cy = _mm256_load_ps(boxes.mCenter[1]);
+        const __m256 cz = _mm256_load_ps(boxes.mCenter[2]);
+        const __m256 rx = _mm256_load_ps(boxes.mRadius[0]);
+        const __m256 ry = _mm256_load_ps(boxes.mRadius[1]);
+        const __m256 rz = _mm256_load_ps(boxes.mRadius[2]);
+
+        for (U32 i = 0; i < plane_count; ++i)
+        {
+            const BatchPlane& p = planes[i];
+            const __m256 sx = _mm256_mul_ps(rx, _mm256_broadcast_ss(&p.mScale[0]));
+            const __m256 sy = _mm256_mul_ps(ry, _mm256_broadcast_ss(&p.mScale[1]));
+            const __m256 sz = _mm256_mul_ps(rz, _mm256_broadcast_ss(&p.mScale[2]));
+            const __m256 nx = _mm256_broadcast_ss(&p.mNormal[0]);
+            const __m256 ny = _mm256_broadcast_ss(&p.mNormal[1]);
+            const __m256 nz = _mm256_broadcast_ss(&p.mNormal[2]);
+            const __m256 d = _mm256_broadcast_ss(&p.mNegD);
+
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_sub_ps(cx, sx)), _mm256_mul_ps(ny, _mm256_sub_ps(cy, sy))), _mm256_mul_ps(nz, _mm256_sub_ps(cz, sz)));
+            U32 outside = _mm256_movemask_ps(_mm256_cmp_ps(dist, d, _CMP_GT_OQ));
+            dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_add_ps(cx, sx)), _mm256_mul_ps(ny, _mm256_add_ps(cy, sy))), _mm256_mul_ps(nz, _mm256_add_ps(cz, sz)));
+            U32 crossing = _mm256_movemask_ps(_mm256_cmp_ps(dist, d, _CMP_GT_OQ));
+
+            if (p.mFar)
+            {
+                masks.mFarOutside |= outside;
+                masks.mFarCrossing |= crossing;
+            }
+            else
+            {
+                masks.mOutside |= outside;
+                masks.mCrossing |= crossing;
+            }
+        }
+    }
+
+    bool cpu_has_avx()
+    {
+#if LL_MSVC
+        int info[4];
+        __cpuid(info, 1);
+        const int avx_and_osxsave = (1 << 28) | (1 << 27);
+        // The OS must also save the upper halves of the registers
+        return (info[2] & avx_and_osxsave) == avx_and_osxsave && (_xgetbv(0) & 6) == 6;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx");
+#endif
+    }
+#endif
+}
+
+//static
+bool LLCamera::hasWideFrustumBatch()
+{
+#if LL_CAMERA_AVX
+    static const bool has_avx = cpu_has_avx();
+    return has_avx;
+#else
+    return false;
+#endif
+}
+
+U32 LLCamera::AABBInFrustumBatch(const LLCameraBoxBatch& boxes, S32* res, S32* no_far_clip_res, const LLPlane* planes) const
+{
+    if (!planes)
+    {
+        //use agent space
+        planes = mAgentPlanes;
+    }
+
+    BatchPlane batch_planes[AGENT_PLANE_USER_CLIP_NUM];
+    U32 plane_count = 0;
+    U32 max_planes = llmin(mPlaneCount, (U32) AGENT_PLANE_USER_CLIP_NUM);
+    for (U32 i = 0; i < max_planes; i++)
+    {
+        U8 mask = mPlaneMask[i];
+        if (mask < PLANE_MASK_NUM)
+        {
+            BatchPlane& bp = batch_planes[plane_count++];
+            for (S32 j = 0; j < 3; ++j)
+            {
+                bp.mNormal[j] = planes[i][j];
+                bp.mScale[j] = sFrustumScaler[mask][j];
+            }
+            bp.mNegD = -planes[i][3];
+            bp.mFar = (i == AGENT_PLANE_FAR);
+        }
+    }
+
+    BatchMasks masks;
+#if LL_CAMERA_AVX
+    if (hasWideFrustumBatch())
+    {
+        frustum_batch_avx(batch_planes, plane_count, boxes, masks);
+    }
+    else
+#endif
+    {
+        frustum_batch_sse2(batch_planes, plane_count, boxes, masks);
+    }
+
+    const U32 outside = masks.mOutside | masks.mFarOutside;
+    const U32 crossing = masks.mCrossing | masks.mFarCrossing;
+    for (U32 i = 0; i < boxes.mCount; ++i)
+    {
+        const U32 bit = 1 << i;
+        res[i] = (outside & bit) ? 0 : (crossing & bit) ? 1 : 2;
+        if (no_far_clip_res)
+        {
+            no_far_clip_res[i] = (masks.mOutside & bit) ? 0 : (masks.mCrossing & bit) ? 1 : 2;
+        }
+    }
+
+    return ~outside & ((1 << boxes.mCount) - 1);
+}
+
+U32 LLCamera::AABBInRegionFrustumBatch(const LLCameraBoxBatch& boxes, S32* res, S32* no_far_clip_res) const
+{
+    return AABBInFrustumBatch(boxes, res, no_far_clip_res, mRegionPlanes);
+}
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius)
 {
     LLVector3 dist = sphere_center-mFrustCenter;
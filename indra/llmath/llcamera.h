@@ -52,6 +52,29 @@ const F32 MIN_FAR_PLANE     = 0.2f;
 static const F32 MIN_FIELD_OF_VIEW = 5.0f * DEG_TO_RAD;
 static const F32 MAX_FIELD_OF_VIEW = 175.f * DEG_TO_RAD;
 
+// Up to eight axis aligned boxes stored as one array per axis of centers
+// and half sizes, for testing several boxes against a frustum at once.
+// Unused slots stay zero.
+struct alignas(32) LLCameraBoxBatch
+{
+    static const U32 MAX_BOXES = 8;
+
+    F32 mCenter[3][MAX_BOXES] = {};
+    F32 mRadius[3][MAX_BOXES] = {};
+    U32 mCount = 0;
+
+    void add(const LLVector4a& center, const LLVector4a& radius)
+    {
+        llassert(mCount < MAX_BOXES);
+        for (S32 i = 0; i < 3; ++i)
+        {
+            mCenter[i][mCount] = center[i];
+            mRadius[i][mCount] = radius[i];
+        }
+        ++mCount;
+    }
+};
+
 // An LLCamera is an LLCoorFrame with a view frustum.
 // This means that it has several methods for moving it around
 // that are inherited from the LLCoordFrame() class :
@@ -203,6 +226,17 @@ class LLCamera
     S32 AABBInFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius, const LLPlane* planes = NULL);
     S32 AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius);
 
+    // Test every box in the batch at once.  res[i] gets what AABBInFrustum()
+    // returns for box i and, if given, no_far_clip_res[i] what
+    // AABBInFrustumNoFarClip() returns.  Returns a mask with bit i set if
+    // box i is at least partly inside the frustum with the far plane.
+    U32 AABBInFrustumBatch(const LLCameraBoxBatch& boxes, S32* res, S32* no_far_clip_res = NULL, const LLPlane* planes = NULL) const;
+    U32 AABBInRegionFrustumBatch(const LLCameraBoxBatch& boxes, S32* res, S32* no_far_clip_res = NULL) const;
+
+    // Whether AABBInFrustumBatch() tests eight boxes per instruction (AVX)
+    // rather than four (SSE2).  Decided once from the CPU.
+    static bool hasWideFrustumBatch();
+
     //does a quick 'n dirty sphere-sphere check
     S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius);
 
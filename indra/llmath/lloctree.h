@@ -112,7 +112,8 @@ class alignas(16) LLOctreeNode : public LLTreeNode<T>
                     BaseType* parent,
                     U8 octant = NO_CHILD_NODES)
     :   mParent((oct_node*)parent),
-        mOctant(octant)
+        mOctant(octant),
+        mLooseness(parent ? ((oct_node*)parent)->mLooseness : 1.f)
     {
         llassert(size[0] >= gOctreeMinSize*0.5f);
 
@@ -190,6 +191,50 @@ class alignas(16) LLOctreeNode : public LLTreeNode<T>
         return true;
     }
 
+    // Loose mode: an element that moves may stay in its node while its
+    // position is within the node bounds scaled by the looseness, rather
+    // than being removed and inserted again as soon as it crosses the
+    // tight bounds.  Insertion always uses the tight bounds, so the tree
+    // itself is the same.  New children inherit their parent's looseness
+    // and 1 is a regular octree.
+    F32 getLooseness() const                            { return mLooseness; }
+
+    void setLooseness(F32 looseness)
+    {
+        mLooseness = llmax(looseness, 1.f);
+        for (U32 i = 0; i < getChildCount(); i++)
+        {
+            mChild[i]->setLooseness(mLooseness);
+        }
+    }
+
+    bool isInsideLoose(const LLVector4a& pos) const
+    {
+        if (mLooseness <= 1.f)
+        {
+            return isInside(pos);
+        }
+
+        LLVector4a size;
+        size.setMul(mSize, mLooseness);
+        LLVector4a dist;
+        dist.setSub(pos, mCenter);
+        dist.setAbs(dist);
+        return (dist.greaterThan(size).getGatheredBits() & 0x7) == 0;
+    }
+
+    // Can data, which is already in this node, stay here after it moved
+    // or changed size?
+    bool canRetain(T* data)
+    {
+        F32 radius = data->getBinRadius();
+        oct_node* parent = getOctParent();
+
+        return isInsideLoose(data->getPositionGroup()) &&
+            (contains(radius) ||
+             (radius > mSize[0] && parent && parent->getElementCount() >= gOctreeMaxCapacity));
+    }
+
     void updateMinMax()
     {
         mMax.setAdd(mCenter, mSize);
@@ -666,6 +711,7 @@ class alignas(16) LLOctreeNode : public LLTreeNode<T>
     oct_node* mChild[8];
     U8 mChildMap[8];
     U32 mChildCount;
+    F32 mLooseness;
 
     element_list mData;
 };
@@ -0,0 +1,284 @@
+/**
+ * @file lltransformbatch.cpp
+ * @brief Quaternion and matrix operations on four transforms at a time
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmath.h"
+#include "lltransformbatch.h"
+
+namespace
+{
+    inline __m128 splat(F32 v)
+    {
+        return _mm_set1_ps(v);
+    }
+
+    // acos(x) for 0 <= x <= 1, Abramowitz and Stegun 4.4.46, error 2e-8
+    __m128 acos_unit(__m128 x)
+    {
+        __m128 p = splat(-0.0012624911f);
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(0.0066700901f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(-0.0170881256f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(0.0308918810f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(-0.0501743046f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(0.0889789874f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(-0.2145988016f));
+        p = _mm_add_ps(_mm_mul_ps(p, x), splat(1.5707963050f));
+        return _mm_mul_ps(p, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(splat(1.f), x), _mm_setzero_ps())));
+    }
+
+    // sin(x) for -pi <= x <= pi.  Folded into -pi/2..pi/2, where the
+    // series up to x^11 is good to 6e-8.
+    __m128 sin_pi(__m128 x)
+    {
+        __m128 sign = _mm_and_ps(x, splat(-0.f));
+        __m128 ax = _mm_xor_ps(x, sign);
+        __m128 fold = _mm_cmpgt_ps(ax, splat(F_PI_BY_TWO));
+        ax = _mm_or_ps(_mm_and_ps(fold, _mm_sub_ps(splat(F_PI), ax)), _mm_andnot_ps(fold, ax));
+
+        __m128 x2 = _mm_mul_ps(ax, ax);
+        __m128 p = splat(-1.f / 39916800.f);
+        p = _mm_add_ps(_mm_mul_ps(p, x2), splat(1.f / 362880.f));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), splat(-1.f / 5040.f));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), splat(1.f / 120.f));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), splat(-1.f / 6.f));
+        p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, x2), ax), ax);
+        return _mm_xor_ps(p, sign);
+    }
+
+    // Rows of four 4x4 matrices from their components, c[r][c] holding
+    // element r, c of each
+    void transpose_rows(const __m128 c[4][4], LLMatrix4a* res)
+    {
+        for (U32 r = 0; r < 4; ++r)
+        {
+            __m128 m0 = c[r][0];
+            __m128 m1 = c[r][1];
+            __m128 m2 = c[r][2];
+            __m128 m3 = c[r][3];
+            _MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+            res[0].mMatrix[r] = m0;
+            res[1].mMatrix[r] = m1;
+            res[2].mMatrix[r] = m2;
+            res[3].mMatrix[r] = m3;
+        }
+    }
+}
+
+void LLTransformBatch::normalize(LLQuaternion4& q)
+{
+    LLVector4a& x = q.mQ[VX];
+    LLVector4a& y = q.mQ[VY];
+    LLVector4a& z = q.mQ[VZ];
+    LLVector4a& w = q.mQ[VW];
+
+    __m128 mag = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w)));
+
+    // Only renormalize if far enough from unity, see LLQuaternion::normalize()
+    __m128 drift = _mm_andnot_ps(splat(-0.f), _mm_sub_ps(splat(1.f), mag));
+    __m128 rescale = _mm_cmpgt_ps(drift, splat(ONE_PART_IN_A_MILLION));
+    __m128 oomag = _mm_div_ps(splat(1.f), mag);
+    __m128 scale = _mm_or_ps(_mm_and_ps(rescale, oomag), _mm_andnot_ps(rescale, splat(1.f)));
+
+    __m128 good = _mm_cmpgt_ps(mag, splat(FP_MAG_THRESHOLD));
+    x = _mm_and_ps(good, _mm_mul_ps(x, scale));
+    y = _mm_and_ps(good, _mm_mul_ps(y, scale));
+    z = _mm_and_ps(good, _mm_mul_ps(z, scale));
+    w = _mm_or_ps(_mm_and_ps(good, _mm_mul_ps(w, scale)), _mm_andnot_ps(good, splat(1.f)));
+}
+
+void LLTransformBatch::slerp(const LLVector4a& u, const LLQuaternion4& a, const LLQuaternion4& b, LLQuaternion4& res)
+{
+    __m128 cos_t = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a.mQ[0], b.mQ[0]), _mm_mul_ps(a.mQ[1], b.mQ[1])),
+                                         _mm_mul_ps(a.mQ[2], b.mQ[2])), _mm_mul_ps(a.mQ[3], b.mQ[3]));
+
+    // If b is on the opposite hemisphere from a, use -a instead
+    __m128 flip = _mm_and_ps(cos_t, splat(-0.f));
+    cos_t = _mm_xor_ps(cos_t, flip);
+
+    __m128 theta = acos_unit(cos_t);
+    __m128 ut = _mm_mul_ps(u, theta);
+    __m128 oo_sin_t = _mm_div_ps(splat(1.f), sin_pi(theta));
+    __m128 beta = _mm_mul_ps(sin_pi(_mm_sub_ps(theta, ut)), oo_sin_t);
+    __m128 alpha = _mm_mul_ps(sin_pi(ut), oo_sin_t);
+
+    // Linear when a and b are the same within precision limits
+    __m128 same = _mm_cmplt_ps(_mm_sub_ps(splat(1.f), cos_t), splat(0.00001f));
+    beta = _mm_or_ps(_mm_and_ps(same, _mm_sub_ps(splat(1.f), u)), _mm_andnot_ps(same, beta));
+    alpha = _mm_or_ps(_mm_and_ps(same, u), _mm_andnot_ps(same, alpha));
+    beta = _mm_xor_ps(beta, flip);
+
+    for (U32 i = 0; i < 4; ++i)
+    {
+        res.mQ[i] = _mm_add_ps(_mm_mul_ps(beta, a.mQ[i]), _mm_mul_ps(alpha, b.mQ[i]));
+    }
+}
+
+void LLTransformBatch::toMatrices(const LLVector3x4& scale, const LLQuaternion4& rot, const LLVector3x4& pos, LLMatrix4a* res)
+{
+    const LLVector4a& x = rot.mQ[VX];
+    const LLVector4a& y = rot.mQ[VY];
+    const LLVector4a& z = rot.mQ[VZ];
+    const LLVector4a& w = rot.mQ[VW];
+
+    __m128 xx = _mm_mul_ps(x, x);
+    __m128 xy = _mm_mul_ps(x, y);
+    __m128 xz = _mm_mul_ps(x, z);
+    __m128 xw = _mm_mul_ps(x, w);
+    __m128 yy = _mm_mul_ps(y, y);
+    __m128 yz = _mm_mul_ps(y, z);
+    __m128 yw = _mm_mul_ps(y, w);
+    __m128 zz = _mm_mul_ps(z, z);
+    __m128 zw = _mm_mul_ps(z, w);
+
+    const __m128 one = splat(1.f);
+    const __m128 two = splat(2.f);
+    const __m128 zero = _mm_setzero_ps();
+    const LLVector4a& sx = scale.mV[VX];
+    const LLVector4a& sy = scale.mV[VY];
+    const LLVector4a& sz = scale.mV[VZ];
+
+    const __m128 c[4][4] =
+    {
+        {
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, zw)), sx),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, yw)), sx),
+            zero
+        },
+        {
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, zw)), sy),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, xw)), sy),
+            zero
+        },
+        {
+            _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, yw)), sz),
+            _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, xw)), sz),
+            _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+            zero
+        },
+        {
+            pos.mV[VX],
+            pos.mV[VY],
+            pos.mV[VZ],
+            one
+        }
+    };
+
+    transpose_rows(c, res);
+}
+
+void LLTransformBatch::normalize(LLQuaternion* q, U32 count)
+{
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        LLQuaternion4 q4;
+        q4.load(q[i], q[i + 1], q[i + 2], q[i + 3]);
+        normalize(q4);
+        q4.store(q[i], q[i + 1], q[i + 2], q[i + 3]);
+    }
+
+    if (i < count)
+    {
+        LLQuaternion tail[4];
+        std::copy(q + i, q + count, tail);
+
+        LLQuaternion4 q4;
+        q4.load(tail[0], tail[1], tail[2], tail[3]);
+        normalize(q4);
+        q4.store(tail[0], tail[1], tail[2], tail[3]);
+
+        std::copy(tail, tail + count - i, q + i);
+    }
+}
+
+void LLTransformBatch::slerp(const F32* u, const LLQuaternion* a, const LLQuaternion* b, LLQuaternion* res, U32 count)
+{
+    for (U32 i = 0; i < count; i += 4)
+    {
+        U32 n = llmin(count - i, 4U);
+        LLQuaternion ta[4], tb[4], tres[4];
+        F32 tu[4] = { 0.f, 0.f, 0.f, 0.f };
+        std::copy(a + i, a + i + n, ta);
+        std::copy(b + i, b + i + n, tb);
+        std::copy(u + i, u + i + n, tu);
+
+        LLQuaternion4 a4, b4;
+        a4.load(ta[0], ta[1], ta[2], ta[3]);
+        b4.load(tb[0], tb[1], tb[2], tb[3]);
+        LLVector4a u4;
+        u4.loadua(tu);
+        slerp(u4, a4, b4, a4);
+        a4.store(tres[0], tres[1], tres[2], tres[3]);
+
+        std::copy(tres, tres + n, res + i);
+    }
+}
+
+void LLTransformBatch::toMatrices(const LLVector3* scale, const LLQuaternion* rot, const LLVector3* pos, LLMatrix4a* res, U32 count)
+{
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        LLVector3x4 scale4, pos4;
+        LLQuaternion4 rot4;
+        scale4.load(scale[i], scale[i + 1], scale[i + 2], scale[i + 3]);
+        rot4.load(rot[i], rot[i + 1], rot[i + 2], rot[i + 3]);
+        pos4.load(pos[i], pos[i + 1], pos[i + 2], pos[i + 3]);
+        toMatrices(scale4, rot4, pos4, res + i);
+    }
+
+    if (i < count)
+    {
+        U32 n = count - i;
+        LLVector3 tscale[4], tpos[4];
+        LLQuaternion trot[4];
+        std::copy(scale + i, scale + count, tscale);
+        std::copy(rot + i, rot + count, trot);
+        std::copy(pos + i, pos + count, tpos);
+
+        LLVector3x4 scale4, pos4;
+        LLQuaternion4 rot4;
+        scale4.load(tscale[0], tscale[1], tscale[2], tscale[3]);
+        rot4.load(trot[0], trot[1], trot[2], trot[3]);
+        pos4.load(tpos[0], tpos[1], tpos[2], tpos[3]);
+
+        LLMatrix4a tres[4];
+        toMatrices(scale4, rot4, pos4, tres);
+        std::copy(tres, tres + n, res + i);
+    }
+}
+
+void LLTransformBatch::mul(const LLMatrix4a* a, const LLMatrix4a* const* b, LLMatrix4a* res, U32 count)
+{
+    // Each row is already four wide, so the products stay in row form
+    for (U32 i = 0; i < count; ++i)
+    {
+        matMulUnsafe(a[i], *b[i], res[i]);
+    }
+}
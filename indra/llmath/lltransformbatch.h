@@ -0,0 +1,172 @@
+/**
+ * @file lltransformbatch.h
+ * @brief Quaternion and matrix operations on four transforms at a time
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRANSFORMBATCH_H
+#define LL_LLTRANSFORMBATCH_H
+
+#include "llquaternion.h"
+#include "llmatrix4a.h"
+#include "v3math.h"
+
+// Structure of arrays versions of the LLQuaternion, LLVector3 and
+// LLMatrix4 math used for joint hierarchies.  Each LLVector4a holds one
+// component of four different values, so one SSE instruction does the
+// work of four scalar ones and there is no shuffling inside a value.
+//
+// The kernels use the same formulas in the same order as the scalar
+// versions, so except for slerp() the results are identical.
+
+// Four quaternions, x y z and w of each in mQ[0..3]
+class LLQuaternion4
+{
+public:
+    LLVector4a mQ[4];
+
+    void load(const LLQuaternion& a, const LLQuaternion& b, const LLQuaternion& c, const LLQuaternion& d)
+    {
+        __m128 r0 = _mm_loadu_ps(a.mQ);
+        __m128 r1 = _mm_loadu_ps(b.mQ);
+        __m128 r2 = _mm_loadu_ps(c.mQ);
+        __m128 r3 = _mm_loadu_ps(d.mQ);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        mQ[0] = r0;
+        mQ[1] = r1;
+        mQ[2] = r2;
+        mQ[3] = r3;
+    }
+
+    void store(LLQuaternion& a, LLQuaternion& b, LLQuaternion& c, LLQuaternion& d) const
+    {
+        __m128 r0 = mQ[0];
+        __m128 r1 = mQ[1];
+        __m128 r2 = mQ[2];
+        __m128 r3 = mQ[3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(a.mQ, r0);
+        _mm_storeu_ps(b.mQ, r1);
+        _mm_storeu_ps(c.mQ, r2);
+        _mm_storeu_ps(d.mQ, r3);
+    }
+};
+
+// Four 3 component vectors, x y and z of each in mV[0..2]
+class LLVector3x4
+{
+public:
+    LLVector4a mV[3];
+
+    void load(const LLVector3& a, const LLVector3& b, const LLVector3& c, const LLVector3& d)
+    {
+        // LLVector3 is 12 bytes, so no 16 byte loads past the last one
+        mV[0].set(a.mV[VX], b.mV[VX], c.mV[VX], d.mV[VX]);
+        mV[1].set(a.mV[VY], b.mV[VY], c.mV[VY], d.mV[VY]);
+        mV[2].set(a.mV[VZ], b.mV[VZ], c.mV[VZ], d.mV[VZ]);
+    }
+
+    void store(LLVector3& a, LLVector3& b, LLVector3& c, LLVector3& d) const
+    {
+        LL_ALIGN_16(F32 v[3][4]);
+        mV[0].store4a(v[0]);
+        mV[1].store4a(v[1]);
+        mV[2].store4a(v[2]);
+        a.set(v[0][0], v[1][0], v[2][0]);
+        b.set(v[0][1], v[1][1], v[2][1]);
+        c.set(v[0][2], v[1][2], v[2][2]);
+        d.set(v[0][3], v[1][3], v[2][3]);
+    }
+};
+
+namespace LLTransformBatch
+{
+    // res = a * b, as LLQuaternion operator*.  res may be a or b.
+    inline void mul(const LLQuaternion4& a, const LLQuaternion4& b, LLQuaternion4& res)
+    {
+        const LLVector4a& ax = a.mQ[VX];
+        const LLVector4a& ay = a.mQ[VY];
+        const LLVector4a& az = a.mQ[VZ];
+        const LLVector4a& aw = a.mQ[VW];
+        const LLVector4a& bx = b.mQ[VX];
+        const LLVector4a& by = b.mQ[VY];
+        const LLVector4a& bz = b.mQ[VZ];
+        const LLVector4a& bw = b.mQ[VW];
+
+        __m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bw, ax), _mm_mul_ps(bx, aw)), _mm_mul_ps(by, az)), _mm_mul_ps(bz, ay));
+        __m128 y = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bw, ay), _mm_mul_ps(by, aw)), _mm_mul_ps(bz, ax)), _mm_mul_ps(bx, az));
+        __m128 z = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bw, az), _mm_mul_ps(bz, aw)), _mm_mul_ps(bx, ay)), _mm_mul_ps(by, ax));
+        __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(bw, aw), _mm_mul_ps(bx, ax)), _mm_mul_ps(by, ay)), _mm_mul_ps(bz, az));
+
+        res.mQ[VX] = x;
+        res.mQ[VY] = y;
+        res.mQ[VZ] = z;
+        res.mQ[VW] = w;
+    }
+
+    // res = v rotated by q, as LLVector3 * LLQuaternion.  res may be v.
+    inline void rotate(const LLVector3x4& v, const LLQuaternion4& q, LLVector3x4& res)
+    {
+        const LLVector4a& vx = v.mV[VX];
+        const LLVector4a& vy = v.mV[VY];
+        const LLVector4a& vz = v.mV[VZ];
+        const LLVector4a& qx = q.mQ[VX];
+        const LLVector4a& qy = q.mQ[VY];
+        const LLVector4a& qz = q.mQ[VZ];
+        const LLVector4a& qw = q.mQ[VW];
+
+        __m128 rw = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(qx, vx)), _mm_mul_ps(qy, vy)), _mm_mul_ps(qz, vz));
+        __m128 rx = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vx), _mm_mul_ps(qy, vz)), _mm_mul_ps(qz, vy));
+        __m128 ry = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vy), _mm_mul_ps(qz, vx)), _mm_mul_ps(qx, vz));
+        __m128 rz = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vz), _mm_mul_ps(qx, vy)), _mm_mul_ps(qy, vx));
+
+        __m128 nx = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(rw, qx)), _mm_mul_ps(rx, qw)), _mm_mul_ps(ry, qz)), _mm_mul_ps(rz, qy));
+        __m128 ny = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(rw, qy)), _mm_mul_ps(ry, qw)), _mm_mul_ps(rz, qx)), _mm_mul_ps(rx, qz));
+        __m128 nz = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(rw, qz)), _mm_mul_ps(rz, qw)), _mm_mul_ps(rx, qy)), _mm_mul_ps(ry, qx));
+
+        res.mV[VX] = nx;
+        res.mV[VY] = ny;
+        res.mV[VZ] = nz;
+    }
+
+    // As LLQuaternion::normalize(), including the fallback to identity
+    void normalize(LLQuaternion4& q);
+
+    // res = slerp(u, a, b) with a polynomial acos and sin, within about
+    // 1e-6 of the scalar version.  res may be a or b.
+    void slerp(const LLVector4a& u, const LLQuaternion4& a, const LLQuaternion4& b, LLQuaternion4& res);
+
+    // res[0..3] = LLMatrix4::initAll(scale, rot, pos) of each lane
+    void toMatrices(const LLVector3x4& scale, const LLQuaternion4& rot, const LLVector3x4& pos, LLMatrix4a* res);
+
+    // Array versions for any count
+    void normalize(LLQuaternion* q, U32 count);
+    void slerp(const F32* u, const LLQuaternion* a, const LLQuaternion* b, LLQuaternion* res, U32 count);
+    void toMatrices(const LLVector3* scale, const LLQuaternion* rot, const LLVector3* pos, LLMatrix4a* res, U32 count);
+
+    // res[i] = a[i] * *b[i], for a skinning palette of inverse bind
+    // matrices times joint world matrices.  res must not overlap a or b.
+    void mul(const LLMatrix4a* a, const LLMatrix4a* const* b, LLMatrix4a* res, U32 count);
+}
+
+#endif
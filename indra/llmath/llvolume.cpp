@@ -32,6 +32,9 @@
 #include <stdint.h>
 #endif
 #include <cmath>
+#include <condition_variable>
+#include <list>
+#include <mutex>
 #include <unordered_map>
 
 #include "llerror.h"
@@ -52,6 +55,9 @@
 #include "llmeshoptimizer.h"
 #include "lltimer.h"
 #include "llvolumeoctree.h"
+#include "llvolumebvh.h"
+#include "hbxxh.h"
+#include "threadpool.h"
 
 #include "mikktspace/mikktspace.hh"
 
@@ -1951,7 +1957,9 @@ LLProfile::~LLProfile()
 }
 
 
-S32 LLVolume::sNumMeshPoints = 0;
+std::atomic<S32> LLVolume::sNumMeshPoints(0);
+bool LLVolume::sRaycastBVH = true;
+static LL::ThreadPool* sOptimizeThreadPool = nullptr;
 
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const bool generate_single_face, const bool is_unique)
     : mParams(params)
@@ -1963,6 +1971,9 @@ LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const bool ge
     mSurfaceArea = 1.f; //only calculated for sculpts, defaults to 1 for all other prims
     mIsMeshAssetLoaded = false;
     mIsMeshAssetUnavaliable = false;
+    mNumReusedFaces = 0;
+    mQuantized = false;
+    mFacesTouched = false;
     mLODScaleBias.setVec(1,1,1);
     mHullPoints = nullptr;
     mHullIndices = nullptr;
@@ -2005,6 +2016,7 @@ void LLVolume::regen()
 
 void LLVolume::genTangents(S32 face)
 {
+    touchFaces();
     // generate legacy tangents for the specified face
     llassert(!isMeshAssetLoaded() || mVolumeFaces[face].mTangents != nullptr); // if this is a complete mesh asset, we should already have tangents
     mVolumeFaces[face].createTangents();
@@ -2034,7 +2046,7 @@ S64 LLVolume::getNumTriangles64(S64* vcount) const
 
 	for (S32 i = 0; i < getNumVolumeFaces(); ++i)
 	{
-		const LLVolumeFace& face = getVolumeFace(i);
+		const LLVolumeFace& face = peekVolumeFace(i);
 		triangle_count += face.mNumIndices / 3;
 
 		vertex_count += face.mNumVertices;
@@ -2762,6 +2774,7 @@ bool LLVolume::isMeshAssetUnavaliable() const
 
 void LLVolume::copyFacesTo(std::vector<LLVolumeFace> &faces) const
 {
+    touchFaces();
     faces = mVolumeFaces;
 }
 
@@ -2773,20 +2786,297 @@ void LLVolume::copyFacesFrom(const std::vector<LLVolumeFace> &faces)
 
 void LLVolume::copyVolumeFaces(const LLVolume* volume)
 {
+    volume->touchFaces();
     mVolumeFaces = volume->mVolumeFaces;
     mSculptLevel = 0;
 }
 
-bool LLVolume::cacheOptimize(bool gen_tangents)
+void LLVolume::swapGeometry(LLVolume& other)
+{
+    llassert(mParams == other.mParams && mDetail == other.mDetail);
+
+    std::swap(mPathp, other.mPathp);
+    std::swap(mProfilep, other.mProfilep);
+    std::swap(mMesh.mArray, other.mMesh.mArray);
+    std::swap(mMesh.mElementCount, other.mMesh.mElementCount);
+    std::swap(mMesh.mCapacity, other.mMesh.mCapacity);
+    mVolumeFaces.swap(other.mVolumeFaces);
+    std::swap(mQuantized, other.mQuantized);
+    std::swap(mSculptLevel, other.mSculptLevel);
+    std::swap(mSurfaceArea, other.mSurfaceArea);
+    std::swap(mFaceMask, other.mFaceMask);
+    std::swap(mLODScaleBias, other.mLODScaleBias);
+}
+
+namespace
 {
-    for (S32 i = 0; i < mVolumeFaces.size(); ++i)
+    // Faces below this size are optimized faster than they are hashed
+    // and copied
+    constexpr S32 MIN_REUSED_FACE_INDICES = 3 * 512;
+
+    // Optimized faces by a hash of everything LLVolumeFace::cacheOptimize()
+    // reads, least recently used first out
+    class LLVolumeFaceOptimizeCache
     {
-        if (!mVolumeFaces[i].cacheOptimize(gen_tangents))
+    public:
+        void setMaxBytes(size_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMaxBytes = bytes;
+            trim();
+        }
+
+        bool isEnabled() const { return mMaxBytes != 0; }
+
+        static U64 getKey(const LLVolumeFace& face, bool gen_tangents)
+        {
+            HBXXH64 hash;
+            S32 vert_size = face.mNumVertices * sizeof(LLVector4a);
+            hash.update(face.mPositions, vert_size);
+            if (face.mNormals)
+            {
+                hash.update(face.mNormals, vert_size);
+            }
+            if (face.mTexCoords)
+            {
+                hash.update(face.mTexCoords, face.mNumVertices * sizeof(LLVector2));
+            }
+            if (face.mWeights)
+            {
+                hash.update(face.mWeights, vert_size);
+            }
+            hash.update(face.mIndices, face.mNumIndices * sizeof(U16));
+            hash.update(face.mNormalizedScale.mV, sizeof(face.mNormalizedScale.mV));
+            U32 counts[] = { (U32)face.mNumVertices, (U32)face.mNumIndices,
+                             (U32)((face.mNormals ? 1 : 0) | (face.mTexCoords ? 2 : 0) | (face.mWeights ? 4 : 0) | (gen_tangents ? 8 : 0)) };
+            hash.update(counts, sizeof(counts));
+            return hash.digest();
+        }
+
+        bool get(U64 key, LLVolumeFace& face)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto found = mEntries.find(key);
+            if (found == mEntries.end())
+            {
+                return false;
+            }
+
+            mOrder.splice(mOrder.begin(), mOrder, found->second);
+            S32 id = face.mID;
+            face = found->second->mFace;
+            face.mID = id;
+            return true;
+        }
+
+        void put(U64 key, const LLVolumeFace& face)
+        {
+            size_t bytes = face.mNumVertices * (sizeof(LLVector4a) * 4 + sizeof(LLVector2)) + face.mNumIndices * sizeof(U16);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (bytes > mMaxBytes / 4 || mEntries.find(key) != mEntries.end())
+            {
+                return;
+            }
+
+            mOrder.emplace_front();
+            mOrder.front().mKey = key;
+            mOrder.front().mFace = face;
+            mOrder.front().mBytes = bytes;
+            mEntries[key] = mOrder.begin();
+            mBytes += bytes;
+            trim();
+        }
+
+    private:
+        void trim()
+        {
+            while (mBytes > mMaxBytes && !mOrder.empty())
+            {
+                mBytes -= mOrder.back().mBytes;
+                mEntries.erase(mOrder.back().mKey);
+                mOrder.pop_back();
+            }
+        }
+
+        struct Entry
+        {
+            U64 mKey = 0;
+            LLVolumeFace mFace;
+            size_t mBytes = 0;
+        };
+
+        std::mutex mMutex;
+        std::list<Entry> mOrder;
+        std::unordered_map<U64, std::list<Entry>::iterator> mEntries;
+        size_t mBytes = 0;
+        std::atomic<size_t> mMaxBytes{ 0 };     // also read by isEnabled() without mMutex
+    };
+
+    LLVolumeFaceOptimizeCache sOptimizeCache;
+
+    bool optimize_face(LLVolumeFace& face, bool gen_tangents, bool& reused)
+    {
+        bool reuse = sOptimizeCache.isEnabled() && face.mNumIndices >= MIN_REUSED_FACE_INDICES;
+        U64 key = reuse ? LLVolumeFaceOptimizeCache::getKey(face, gen_tangents) : 0;
+        if (reuse && sOptimizeCache.get(key, face))
+        {
+            reused = true;
+            return true;
+        }
+
+        if (!face.cacheOptimize(gen_tangents))
         {
             return false;
         }
+
+        if (reuse)
+        {
+            sOptimizeCache.put(key, face);
+        }
+        return true;
     }
-    return true;
+
+    // Faces of one volume shared between the calling thread and pool
+    // threads.  Whoever comes along takes the next face, largest first; a
+    // pool thread that arrives after the last face was taken only touches
+    // this, which it shares ownership of.
+    struct LLVolumeOptimizeBatch
+    {
+        LLVolumeFace* mFaces = nullptr;
+        std::vector<S32> mOrder;
+        bool mGenTangents = false;
+
+        std::atomic<S32> mNext{ 0 };
+        std::atomic<S32> mReused{ 0 };
+        std::atomic<bool> mFailed{ false };
+
+        std::mutex mMutex;
+        std::condition_variable mDoneCondition;
+        S32 mDone = 0;
+
+        void run()
+        {
+            S32 count = (S32)mOrder.size();
+            S32 i;
+            while ((i = mNext++) < count)
+            {
+                bool reused = false;
+                if (!optimize_face(mFaces[mOrder[i]], mGenTangents, reused))
+                {
+                    mFailed = true;
+                }
+                if (reused)
+                {
+                    mReused++;
+                }
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (++mDone == count)
+                {
+                    mDoneCondition.notify_all();
+                }
+            }
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDoneCondition.wait(lock, [this]() { return mDone == (S32)mOrder.size(); });
+        }
+    };
+}
+
+bool LLVolume::quantizeIdleFaces()
+{
+    if (mFacesTouched || mQuantized)
+    {
+        mFacesTouched = false;
+        return false;
+    }
+
+    bool quantized = false;
+    for (LLVolumeFace& face : mVolumeFaces)
+    {
+        quantized |= face.quantize();
+    }
+    mQuantized = quantized;
+    return quantized;
+}
+
+void LLVolume::dequantizeFaces() const
+{
+    // Quantized faces are only decoded in place, the volume's shape does
+    // not change
+    mQuantized = false;
+    for (const LLVolumeFace& face : mVolumeFaces)
+    {
+        const_cast<LLVolumeFace&>(face).dequantize();
+    }
+}
+
+//static
+void LLVolume::setOptimizeThreadPool(LL::ThreadPool* pool)
+{
+    sOptimizeThreadPool = pool;
+}
+
+//static
+void LLVolume::setOptimizeCacheSize(size_t bytes)
+{
+    sOptimizeCache.setMaxBytes(bytes);
+}
+
+bool LLVolume::cacheOptimize(bool gen_tangents)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    touchFaces();
+    mNumReusedFaces = 0;
+    S32 face_count = getNumVolumeFaces();
+
+    LL::ThreadPool* pool = sOptimizeThreadPool;
+    if (!pool || face_count < 2)
+    {
+        for (S32 i = 0; i < face_count; ++i)
+        {
+            bool reused = false;
+            if (!optimize_face(mVolumeFaces[i], gen_tangents, reused))
+            {
+                return false;
+            }
+            mNumReusedFaces += reused ? 1 : 0;
+        }
+        return true;
+    }
+
+    auto batch = std::make_shared<LLVolumeOptimizeBatch>();
+    batch->mFaces = mVolumeFaces.data();
+    batch->mGenTangents = gen_tangents;
+    batch->mOrder.resize(face_count);
+    for (S32 i = 0; i < face_count; ++i)
+    {
+        batch->mOrder[i] = i;
+    }
+    std::stable_sort(batch->mOrder.begin(), batch->mOrder.end(),
+        [this](S32 a, S32 b) { return mVolumeFaces[a].mNumIndices > mVolumeFaces[b].mNumIndices; });
+
+    // Helpers for all but the face this thread starts on.  If the queue
+    // is closed the ones not posted are simply done here.
+    S32 helpers = llmin(face_count - 1, (S32)pool->getWidth());
+    for (S32 i = 0; i < helpers; ++i)
+    {
+        if (!pool->getQueue().post([batch]() { batch->run(); }))
+        {
+            break;
+        }
+    }
+
+    batch->run();
+    batch->wait();
+
+    mNumReusedFaces = batch->mReused;
+    return !batch->mFailed;
 }
 
 
@@ -3737,7 +4027,7 @@ S32 LLVolume::getNumTriangles(S32* vcount) const
 
     for (S32 i = 0; i < getNumVolumeFaces(); ++i)
     {
-        const LLVolumeFace& face = getVolumeFace(i);
+        const LLVolumeFace& face = peekVolumeFace(i);
         triangle_count += face.mNumIndices/3;
 
         vertex_count += face.mNumVertices;
@@ -4262,6 +4552,7 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
     F32 closest_t = 2.f; // must be larger than 1
 
     end_face = llmin(end_face, getNumVolumeFaces()-1);
+    touchFaces();
 
     for (S32 i = start_face; i <= end_face; i++)
     {
@@ -4368,6 +4659,80 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
                     }
                 }
             }
+            else if (sRaycastBVH)
+            {
+                if (!face.getBVH())
+                {
+                    face.createBVH();
+                }
+
+                U32 tri;
+                F32 a, b;
+                if (face.getBVH()->intersect(face, start, dir, closest_t, tri, a, b))
+                {
+                    hit_face = i;
+
+                    if (intersection != NULL)
+                    {
+                        LLVector4a intersect = dir;
+                        intersect.mul(closest_t);
+                        intersect.add(start);
+                        *intersection = intersect;
+                    }
+
+                    U16 idx0 = face.mIndices[tri*3+0];
+                    U16 idx1 = face.mIndices[tri*3+1];
+                    U16 idx2 = face.mIndices[tri*3+2];
+
+                    if (tex_coord != NULL && face.mTexCoords)
+                    {
+                        LLVector2* tc = face.mTexCoords;
+                        *tex_coord = ((1.f - a - b) * tc[idx0] +
+                            a * tc[idx1] +
+                            b * tc[idx2]);
+                    }
+
+                    if (normal != NULL && face.mNormals)
+                    {
+                        LLVector4a* norm = face.mNormals;
+
+                        LLVector4a n1,n2,n3;
+                        n1 = norm[idx0];
+                        n1.mul(1.f-a-b);
+
+                        n2 = norm[idx1];
+                        n2.mul(a);
+
+                        n3 = norm[idx2];
+                        n3.mul(b);
+
+                        n1.add(n2);
+                        n1.add(n3);
+
+                        *normal = n1;
+                    }
+
+                    if (tangent_out != NULL && face.mTangents)
+                    {
+                        LLVector4a* tangents = face.mTangents;
+
+                        LLVector4a t1,t2,t3;
+                        t1 = tangents[idx0];
+                        t1.mul(1.f-a-b);
+
+                        t2 = tangents[idx1];
+                        t2.mul(a);
+
+                        t3 = tangents[idx2];
+                        t3.mul(b);
+
+                        t1.add(t2);
+                        t1.add(t3);
+
+                        *tangent_out = t1;
+                    }
+                }
+            }
             else
             {
                 if (!face.getOctree())
@@ -4909,6 +5274,22 @@ std::ostream& operator<<(std::ostream &s, const LLVolume *volumep)
     return s;
 }
 
+// Defined ahead of freeData(), which deletes it
+struct LLVolumeFace::Quantized
+{
+    LLVector4a mPositionMin;
+    LLVector4a mPositionStep;       // size of one unit of the 16 bit positions
+    F32 mPositionW = 0.f;
+    F32 mNormalW = 0.f;
+    LLVector2 mTexCoordMin;
+    LLVector2 mTexCoordStep;
+
+    std::vector<U16> mPositions;    // x, y, z per vertex
+    std::vector<U32> mNormals;
+    std::vector<U32> mTangents;     // empty if the face had no tangents
+    std::vector<U16> mTexCoords;    // s, t per vertex
+};
+
 LLVolumeFace::LLVolumeFace() :
     mID(0),
     mTypeMask(0),
@@ -4932,6 +5313,8 @@ LLVolumeFace::LLVolumeFace() :
     mWeightsScrubbed(false),
     mOctree(NULL),
     mOctreeTriangles(NULL),
+    mBVH(NULL),
+    mQuantized(NULL),
     mOptimized(false)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4962,7 +5345,9 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 #endif
     mWeightsScrubbed(false),
     mOctree(NULL),
-    mOctreeTriangles(NULL)
+    mOctreeTriangles(NULL),
+    mBVH(NULL),
+    mQuantized(NULL)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
     mCenter = mExtents+2;
@@ -4976,6 +5361,11 @@ LLVolumeFace& LLVolumeFace::operator=(const LLVolumeFace& src)
         return *this;
     }
 
+    if (src.mQuantized)
+    { // copies are made of the full vertex data
+        const_cast<LLVolumeFace&>(src).dequantize();
+    }
+
     mID = src.mID;
     mTypeMask = src.mTypeMask;
     mBeginS = src.mBeginS;
@@ -5104,7 +5494,11 @@ void LLVolumeFace::freeData()
     mJustWeights = NULL;
 #endif
 
+    delete mQuantized;
+    mQuantized = NULL;
+
     destroyOctree();
+    destroyBVH();
 }
 
 bool LLVolumeFace::create(LLVolume* volume, bool partial_build)
@@ -5113,6 +5507,7 @@ bool LLVolumeFace::create(LLVolume* volume, bool partial_build)
 
     //tree for this face is no longer valid
     destroyOctree();
+    destroyBVH();
 
     LL_CHECK_MEMORY
     bool ret = false ;
@@ -5212,6 +5607,10 @@ void LLVolumeFace::remap()
     ll_aligned_free_16(mIndices);
     ll_aligned_free<64>(mPositions);
 
+    // So are trees built over the old buffers
+    destroyOctree();
+    destroyBVH();
+
     // Tangets are now invalid
     ll_aligned_free_16(mTangents);
     mTangents = NULL;
@@ -5681,6 +6080,10 @@ bool LLVolumeFace::cacheOptimize(bool gen_tangents)
     llassert(!mOptimized);
     mOptimized = true;
 
+    // Vertices and indices are about to be reordered
+    destroyOctree();
+    destroyBVH();
+
     if (gen_tangents && mNormals && mTexCoords)
     { // generate mikkt space tangents before cache optimizing since the index buffer may change
         // a bit of a hack to do this here, but this function gets called exactly once for the lifetime of a mesh
@@ -5878,9 +6281,233 @@ const LLVolumeOctree* LLVolumeFace::getOctree() const
     return mOctree;
 }
 
+void LLVolumeFace::createBVH()
+{
+    if (!mBVH)
+    {
+        mBVH = new LLVolumeBVH(*this);
+    }
+}
+
+void LLVolumeFace::destroyBVH()
+{
+    delete mBVH;
+    mBVH = nullptr;
+}
+
+const LLVolumeBVH* LLVolumeFace::getBVH() const
+{
+    return mBVH;
+}
+
+namespace
+{
+    constexpr F32 QUANTIZE_MAX = 65535.f;
+
+    U16 quantize_unit(F32 v, F32 min, F32 inv_step)
+    {
+        return (U16)llclamp((S32)((v - min) * inv_step + 0.5f), 0, 65535);
+    }
+
+    // Octahedral encoding of a direction: project onto the octahedron
+    // |x| + |y| + |z| = 1, fold the lower half over the upper and keep x
+    // and y.  bits is the precision of each of them, at most 16.
+    U32 encode_octahedral(const LLVector4a& dir, S32 bits)
+    {
+        const F32* v = dir.getF32ptr();
+        F32 l1 = fabsf(v[0]) + fabsf(v[1]) + fabsf(v[2]);
+        F32 x = 0.f;
+        F32 y = 0.f;
+        if (l1 > 0.f)
+        {
+            x = v[0] / l1;
+            y = v[1] / l1;
+            if (v[2] < 0.f)
+            {
+                F32 fx = x;
+                x = (1.f - fabsf(y)) * (fx >= 0.f ? 1.f : -1.f);
+                y = (1.f - fabsf(fx)) * (y >= 0.f ? 1.f : -1.f);
+            }
+        }
+        F32 range = (F32)((1 << (bits - 1)) - 1);
+        S32 qx = ll_round(llclamp(x, -1.f, 1.f) * range);
+        S32 qy = ll_round(llclamp(y, -1.f, 1.f) * range);
+        U32 mask = (1 << bits) - 1;
+        return ((U32)qx & mask) | (((U32)qy & mask) << 16);
+    }
+
+    void decode_octahedral(U32 packed, S32 bits, LLVector4a& dir)
+    {
+        S32 shift = 32 - bits;
+        F32 range = (F32)((1 << (bits - 1)) - 1);
+        // sign extend the low and high halves
+        F32 x = (F32)((S32)(packed << shift) >> shift) / range;
+        F32 y = (F32)((S32)((packed >> 16) << shift) >> shift) / range;
+        F32 z = 1.f - fabsf(x) - fabsf(y);
+        if (z < 0.f)
+        {
+            F32 fx = x;
+            x = (1.f - fabsf(y)) * (fx >= 0.f ? 1.f : -1.f);
+            y = (1.f - fabsf(fx)) * (y >= 0.f ? 1.f : -1.f);
+        }
+        dir.set(x, y, z, 0.f);
+        dir.normalize3();
+    }
+
+    // Tangents keep their handedness in the top bit, the rest has 15 bits
+    // per axis
+    constexpr S32 TANGENT_BITS = 15;
+    constexpr U32 TANGENT_HANDEDNESS = 0x80000000;
+}
+
+bool LLVolumeFace::quantize()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    if (mQuantized || !mPositions || mNumVertices == 0)
+    {
+        return false;
+    }
+
+    F32 position_w = mPositions[0].getF32ptr()[3];
+    F32 normal_w = mNormals[0].getF32ptr()[3];
+    LLVector4a min = mPositions[0];
+    LLVector4a max = mPositions[0];
+    LLVector2 min_tc = mTexCoords[0];
+    LLVector2 max_tc = mTexCoords[0];
+    for (S32 i = 0; i < mNumVertices; ++i)
+    {
+        if (mPositions[i].getF32ptr()[3] != position_w || mNormals[i].getF32ptr()[3] != normal_w)
+        {
+            return false;
+        }
+        min.setMin(min, mPositions[i]);
+        max.setMax(max, mPositions[i]);
+        update_min_max(min_tc, max_tc, mTexCoords[i]);
+    }
+
+    Quantized* quantized = new Quantized();
+    quantized->mPositionW = position_w;
+    quantized->mNormalW = normal_w;
+    quantized->mPositionMin = min;
+    quantized->mTexCoordMin = min_tc;
+
+    LLVector4a inv_step;
+    for (S32 axis = 0; axis < 3; ++axis)
+    {
+        F32 range = max[axis] - min[axis];
+        quantized->mPositionStep.getF32ptr()[axis] = range / QUANTIZE_MAX;
+        inv_step.getF32ptr()[axis] = range > 0.f ? QUANTIZE_MAX / range : 0.f;
+    }
+    quantized->mPositionStep.getF32ptr()[3] = 0.f;
+    LLVector2 inv_tc_step;
+    for (S32 axis = 0; axis < 2; ++axis)
+    {
+        F32 range = max_tc.mV[axis] - min_tc.mV[axis];
+        quantized->mTexCoordStep.mV[axis] = range / QUANTIZE_MAX;
+        inv_tc_step.mV[axis] = range > 0.f ? QUANTIZE_MAX / range : 0.f;
+    }
+
+    quantized->mPositions.resize(mNumVertices * 3);
+    quantized->mNormals.resize(mNumVertices);
+    quantized->mTexCoords.resize(mNumVertices * 2);
+    if (mTangents)
+    {
+        quantized->mTangents.resize(mNumVertices);
+    }
+
+    for (S32 i = 0; i < mNumVertices; ++i)
+    {
+        const F32* p = mPositions[i].getF32ptr();
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            quantized->mPositions[i * 3 + axis] = quantize_unit(p[axis], min[axis], inv_step[axis]);
+        }
+        quantized->mNormals[i] = encode_octahedral(mNormals[i], 16);
+        for (S32 axis = 0; axis < 2; ++axis)
+        {
+            quantized->mTexCoords[i * 2 + axis] = quantize_unit(mTexCoords[i].mV[axis], min_tc.mV[axis], inv_tc_step.mV[axis]);
+        }
+        if (mTangents)
+        {
+            quantized->mTangents[i] = encode_octahedral(mTangents[i], TANGENT_BITS) |
+                (mTangents[i].getF32ptr()[3] < 0.f ? TANGENT_HANDEDNESS : 0);
+        }
+    }
+
+    // Both refer to the vertex arrays about to go
+    destroyOctree();
+    destroyBVH();
+
+    ll_aligned_free<64>(mPositions);
+    mPositions = NULL;
+    mNormals = NULL;
+    mTexCoords = NULL;
+    ll_aligned_free_16(mTangents);
+    mTangents = NULL;
+    mNumAllocatedVertices = 0;
+
+    mQuantized = quantized;
+    return true;
+}
+
+void LLVolumeFace::dequantize()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    if (!mQuantized)
+    {
+        return;
+    }
+
+    Quantized* quantized = mQuantized;
+    mQuantized = NULL;
+
+    // Same layout as resizeVertices(), which would also drop the rigging
+    // info that is still good
+    S32 tc_size = ((mNumVertices*sizeof(LLVector2)) + 0xF) & ~0xF;
+    mPositions = (LLVector4a*) ll_aligned_malloc<64>(sizeof(LLVector4a)*2*mNumVertices+tc_size);
+    mNormals = mPositions+mNumVertices;
+    mTexCoords = (LLVector2*) (mNormals+mNumVertices);
+    mNumAllocatedVertices = mNumVertices;
+    if (!quantized->mTangents.empty())
+    {
+        allocateTangents(mNumVertices);
+    }
+
+    const F32* min = quantized->mPositionMin.getF32ptr();
+    const F32* step = quantized->mPositionStep.getF32ptr();
+    for (S32 i = 0; i < mNumVertices; ++i)
+    {
+        const U16* p = &quantized->mPositions[i * 3];
+        mPositions[i].set(min[0] + p[0] * step[0], min[1] + p[1] * step[1], min[2] + p[2] * step[2], quantized->mPositionW);
+
+        decode_octahedral(quantized->mNormals[i], 16, mNormals[i]);
+        mNormals[i].getF32ptr()[3] = quantized->mNormalW;
+
+        const U16* tc = &quantized->mTexCoords[i * 2];
+        mTexCoords[i].set(quantized->mTexCoordMin.mV[0] + tc[0] * quantized->mTexCoordStep.mV[0],
+                          quantized->mTexCoordMin.mV[1] + tc[1] * quantized->mTexCoordStep.mV[1]);
+
+        if (mTangents)
+        {
+            U32 packed = quantized->mTangents[i];
+            decode_octahedral(packed & ~TANGENT_HANDEDNESS, TANGENT_BITS, mTangents[i]);
+            mTangents[i].getF32ptr()[3] = (packed & TANGENT_HANDEDNESS) ? -1.f : 1.f;
+        }
+    }
+
+    delete quantized;
+}
+
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
+    destroyOctree();
+    destroyBVH();
+    rhs.destroyOctree();
+    rhs.destroyBVH();
+
     llswap(rhs.mPositions, mPositions);
     llswap(rhs.mNormals, mNormals);
     llswap(rhs.mTangents, mTangents);
@@ -5888,6 +6515,7 @@ void LLVolumeFace::swapData(LLVolumeFace& rhs)
     llswap(rhs.mIndices,mIndices);
     llswap(rhs.mNumVertices, mNumVertices);
     llswap(rhs.mNumIndices, mNumIndices);
+    llswap(rhs.mQuantized, mQuantized);
 }
 
 void    LerpPlanarVertex(LLVolumeFace::VertexData& v0,
@@ -6524,12 +7152,18 @@ void LLVolumeFace::resizeVertices(S32 num_verts)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
+    destroyOctree();
+    destroyBVH();
+
     ll_aligned_free<64>(mPositions);
     //DO NOT free mNormals and mTexCoords as they are part of mPositions buffer
     ll_aligned_free_16(mTangents);
 
     mTangents = NULL;
 
+    delete mQuantized;
+    mQuantized = NULL;
+
     if (num_verts)
     {
         //pad texture coordinate block end to allow for QWORD reads
@@ -6588,6 +7222,9 @@ void LLVolumeFace::pushVertex(const LLVector4a& pos, const LLVector4a& norm, con
 
         LLVector4a* old_buf = mPositions;
 
+        destroyOctree();
+        destroyBVH();
+
         mPositions = (LLVector4a*) ll_aligned_malloc<64>(new_size);
         mNormals = mPositions+new_verts;
         mTexCoords = (LLVector2*) (mNormals+new_verts);
@@ -7202,16 +7839,10 @@ void LLCalculateTangentArray(U32 vertexCount, const LLVector4a *vertex, const LL
         const LLVector2& w2 = texcoord[i2];
         const LLVector2& w3 = texcoord[i3];
 
-        const F32* v1ptr = v1.getF32ptr();
-        const F32* v2ptr = v2.getF32ptr();
-        const F32* v3ptr = v3.getF32ptr();
-
-        float x1 = v2ptr[0] - v1ptr[0];
-        float x2 = v3ptr[0] - v1ptr[0];
-        float y1 = v2ptr[1] - v1ptr[1];
-        float y2 = v3ptr[1] - v1ptr[1];
-        float z1 = v2ptr[2] - v1ptr[2];
-        float z2 = v3ptr[2] - v1ptr[2];
+        // edges, x1 y1 z1 and x2 y2 z2 in Lengyel's terms
+        LLVector4a e1, e2;
+        e1.setSub(v2, v1);
+        e2.setSub(v3, v1);
 
         float s1 = w2.mV[0] - w1.mV[0];
         float s2 = w3.mV[0] - w1.mV[0];
@@ -7226,10 +7857,22 @@ void LLCalculateTangentArray(U32 vertexCount, const LLVector4a *vertex, const LL
         llassert(llfinite(r));
         llassert(!llisnan(r));
 
-        LLVector4a sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r,
-                (t2 * z1 - t1 * z2) * r);
-        LLVector4a tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r,
-                (s1 * z2 - s2 * z1) * r);
+        // sdir = (t2 * e1 - t1 * e2) * r, tdir = (s1 * e2 - s2 * e1) * r,
+        // all three axes at once
+        LLVector4a sdir, tdir, tmp;
+        sdir = e1;
+        sdir.mul(t2);
+        tmp = e2;
+        tmp.mul(t1);
+        sdir.sub(tmp);
+        sdir.mul(r);
+
+        tdir = e2;
+        tdir.mul(s1);
+        tmp = e1;
+        tmp.mul(s2);
+        tdir.sub(tmp);
+        tdir.mul(r);
 
         tan1[i1].add(sdir);
         tan1[i2].add(sdir);
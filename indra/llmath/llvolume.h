@@ -27,6 +27,7 @@
 #ifndef LL_LLVOLUME_H
 #define LL_LLVOLUME_H
 
+#include <atomic>
 #include <iostream>
 
 class LLProfileParams;
@@ -42,6 +43,7 @@ class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
 class LLVolumeOctree;
+class LLVolumeBVH;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -60,6 +62,7 @@ class LLVolumeOctree;
 #include "llfile.h"
 #include "llalignedarray.h"
 #include "llrigginginfo.h"
+#include "threadpool_fwd.h"
 
 //============================================================================
 
@@ -913,11 +916,27 @@ class LLVolumeFace
     void optimize(F32 angle_cutoff = 2.f);
     bool cacheOptimize(bool gen_tangents = false);
 
+    // Swap the vertex data for a compact form for faces that are kept but
+    // rarely looked at: positions as 16 bits per axis within the face's
+    // bounds, normals and tangents octahedral encoded in 32 bits and texture
+    // coordinates as 16 bits per axis within their range.  Indices and
+    // weights are kept as they are.  Returns false if there is nothing to
+    // quantize or the w of positions or normals varies.
+    bool quantize();
+    // Back to full vertex arrays, within the quantization error
+    void dequantize();
+    bool isQuantized() const { return mQuantized != NULL; }
+
     void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
     void destroyOctree();
     // Get a reference to the octree, which may be null
     const LLVolumeOctree* getOctree() const;
 
+    void createBVH();
+    void destroyBVH();
+    // Get a reference to the BVH, which may be null
+    const LLVolumeBVH* getBVH() const;
+
     // Part of silhouette generation (used by selection outlines)
     // Populates the provided edge array with numbers corresponding to
     // *partial* logic of whether a particular index should be rendered
@@ -999,6 +1018,10 @@ class LLVolumeFace
 private:
     LLVolumeOctree* mOctree;
     LLVolumeTriangle* mOctreeTriangles;
+    LLVolumeBVH* mBVH;
+
+    struct Quantized;
+    Quantized* mQuantized;
 
     bool createUnCutCubeCap(LLVolume* volume, bool partial_build = false);
     bool createCap(LLVolume* volume, bool partial_build = false);
@@ -1082,16 +1105,35 @@ class LLVolume : public LLRefCount
     LLFaceID generateFaceMask();
 
     bool isFaceMaskValid(LLFaceID face_mask);
-    static S32 sNumMeshPoints;
+    static std::atomic<S32> sNumMeshPoints;
+    static bool sRaycastBVH; // Raycast faces through LLVolumeBVH rather than LLVolumeOctree
+
+    // Optimize the faces of a volume in parallel on this pool.  The calling
+    // thread takes faces as well, so it may itself be one of the pool's.
+    static void setOptimizeThreadPool(LL::ThreadPool* pool);
+    // Keep up to this many bytes of optimized faces, so a face that shows
+    // up again (the same geometry in several LODs of a mesh) is copied
+    // instead of optimized again.  0 turns reuse off.
+    static void setOptimizeCacheSize(size_t bytes);
 
     friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
     friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);      // HACK to bypass Windoze confusion over
                                                                                 // conversion if *(LLVolume*) to LLVolume&
-    const LLVolumeFace &getVolumeFace(const S32 f) const {return mVolumeFaces[f];} // DO NOT DELETE VOLUME WHILE USING THIS REFERENCE, OR HOLD A POINTER TO THIS VOLUMEFACE
+    const LLVolumeFace &getVolumeFace(const S32 f) const {touchFaces(); return mVolumeFaces[f];} // DO NOT DELETE VOLUME WHILE USING THIS REFERENCE, OR HOLD A POINTER TO THIS VOLUMEFACE
+
+    LLVolumeFace &getVolumeFace(const S32 f) {touchFaces(); return mVolumeFaces[f];} // DO NOT DELETE VOLUME WHILE USING THIS REFERENCE, OR HOLD A POINTER TO THIS VOLUMEFACE
+
+    face_list_t& getVolumeFaces() { touchFaces(); return mVolumeFaces; }
 
-    LLVolumeFace &getVolumeFace(const S32 f) {return mVolumeFaces[f];} // DO NOT DELETE VOLUME WHILE USING THIS REFERENCE, OR HOLD A POINTER TO THIS VOLUMEFACE
+    // The face without decoding it if it is quantized.  Only its counts,
+    // extents and center are good to read, not its vertices.
+    const LLVolumeFace &peekVolumeFace(const S32 f) const { return mVolumeFaces[f]; }
 
-    face_list_t& getVolumeFaces() { return mVolumeFaces; }
+    // Quantize the faces of a volume nobody has looked at since the last
+    // call, see LLVolumeFace::quantize().  They are decoded again as soon
+    // as anyone asks for a face.  Returns true if the faces were quantized.
+    bool quantizeIdleFaces();
+    bool isQuantized() const { return mQuantized; }
 
     U32                 mFaceMask;          // bit array of which faces exist in this volume
     LLVector3           mLODScaleBias;      // vector for biasing LOD based on scale
@@ -1101,9 +1143,15 @@ class LLVolume : public LLRefCount
     void copyFacesTo(std::vector<LLVolumeFace> &faces) const;
     void copyFacesFrom(const std::vector<LLVolumeFace> &faces);
 
+    // Take over the shape of other, a volume with the same parameters and
+    // detail that was generated or sculpted on another thread
+    void swapGeometry(LLVolume& other);
+
     // use meshoptimizer to optimize index buffer for vertex shader cache
     //  gen_tangents - if true, generate MikkTSpace tangents if needed before optimizing index buffer
     bool cacheOptimize(bool gen_tangents = false);
+    // Faces the last cacheOptimize() copied from an identical face
+    S32 getNumReusedFaces() const { return mNumReusedFaces; }
 
 private:
     void sculptGenerateMapVertices(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, U8 sculpt_type);
@@ -1117,6 +1165,8 @@ class LLVolume : public LLRefCount
 public:
     bool unpackVolumeFaces(std::istream& is, S32 size);
     bool unpackVolumeFaces(U8* in_data, S32 size);
+    // Faces already decompressed, in the same format as a mesh LOD block
+    bool unpackVolumeFaces(const LLSD& mdl) { return unpackVolumeFacesInternal(mdl); }
 private:
     bool unpackVolumeFacesInternal(const LLSD& mdl);
 
@@ -1133,6 +1183,19 @@ class LLVolume : public LLRefCount
     F32 mSurfaceArea; //unscaled surface area
     bool mIsMeshAssetLoaded;
     bool mIsMeshAssetUnavaliable;
+    S32 mNumReusedFaces;
+
+    void touchFaces() const
+    {
+        mFacesTouched = true;
+        if (mQuantized)
+        {
+            dequantizeFaces();
+        }
+    }
+    void dequantizeFaces() const;
+    mutable bool mQuantized;
+    mutable bool mFacesTouched;
 
     const LLVolumeParams mParams;
     LLPath *mPathp;
@@ -0,0 +1,422 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flat bounding volume hierarchy for raycasting volume faces
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "llvolumebvh.h"
+#include "llvolume.h"
+
+#include <algorithm>
+
+namespace
+{
+    const S32 NUM_BINS = 8;
+    const U32 MIN_LEAF_SIZE = 4;        // Leaves this small always stop splitting
+    const U32 MAX_LEAF_SIZE = 8;        // Leaves this small may stop splitting
+    const F32 TRAVERSAL_COST = 1.f;     // Relative to one triangle test
+    const S32 MAX_DEPTH = 64;           // Traversal stack, deeper trees make leaves
+
+    struct Bounds
+    {
+        LLVector4a mMin;
+        LLVector4a mMax;
+
+        void clear()
+        {
+            mMin.splat(FLT_MAX);
+            mMax.splat(-FLT_MAX);
+        }
+
+        void grow(const LLVector4a& p)
+        {
+            mMin.setMin(mMin, p);
+            mMax.setMax(mMax, p);
+        }
+
+        void grow(const Bounds& b)
+        {
+            mMin.setMin(mMin, b.mMin);
+            mMax.setMax(mMax, b.mMax);
+        }
+
+        // Half the surface area, only used for comparisons
+        F32 area() const
+        {
+            LLVector4a e;
+            e.setSub(mMax, mMin);
+            if (e[0] < 0.f)
+            {
+                return 0.f;
+            }
+            return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+        }
+    };
+
+    // Per triangle build data, partitioned along with the tree so
+    // each pass over a node reads it sequentially
+    struct BuildRef
+    {
+        Bounds mBounds;
+        LLVector4a mCenter;
+        U32 mTriangle;
+    };
+
+    struct BuildTask
+    {
+        U32 mBegin;
+        U32 mEnd;
+        U32 mParent;    // Node whose second child this is, or U32_MAX
+        S32 mDepth;
+    };
+
+    // Bin of a triangle center on each axis
+    inline void bin_index(const LLVector4a& center, const LLVector4a& min, const LLVector4a& scale, S32* bins)
+    {
+        LLVector4a offset;
+        offset.setSub(center, min);
+        offset.mul(scale);
+        _mm_storeu_si128((__m128i*)bins, _mm_cvttps_epi32(offset));
+    }
+
+    void store_bounds(LLVolumeBVH::Node& node, const Bounds& b)
+    {
+        for (S32 i = 0; i < 3; ++i)
+        {
+            node.mMin[i] = b.mMin[i];
+            node.mMax[i] = b.mMax[i];
+        }
+    }
+
+    // Entry distance of the segment into the node, false if it misses
+    // the node or enters it beyond max_t.  The w lanes of the node hold
+    // mOffset and mCount and are masked off.
+    inline bool hit_node(const LLVolumeBVH::Node& node, const LLQuad& org, const LLQuad& inv_dir,
+                         F32 max_t, F32& near_t)
+    {
+        static const LLQuad xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+        LLQuad lo = _mm_and_ps(_mm_load_ps(node.mMin), xyz);
+        LLQuad hi = _mm_and_ps(_mm_load_ps(node.mMax), xyz);
+        lo = _mm_mul_ps(_mm_sub_ps(lo, org), inv_dir);
+        hi = _mm_mul_ps(_mm_sub_ps(hi, org), inv_dir);
+
+        LLQuad t0 = _mm_min_ps(lo, hi);
+        LLQuad t1 = _mm_max_ps(lo, hi);
+
+        // Largest entry and smallest exit of x, y and z in lane 0
+        t0 = _mm_max_ss(t0, _mm_shuffle_ps(t0, t0, _MM_SHUFFLE(3, 3, 3, 1)));
+        t0 = _mm_max_ss(t0, _mm_movehl_ps(t0, t0));
+        t1 = _mm_min_ss(t1, _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(3, 3, 3, 1)));
+        t1 = _mm_min_ss(t1, _mm_movehl_ps(t1, t1));
+
+        t0 = _mm_max_ss(t0, _mm_setzero_ps());
+        t1 = _mm_min_ss(t1, _mm_set_ss(max_t));
+
+        // Widen the exit a little so rounding can't drop a triangle
+        // lying on the box's faces
+        near_t = _mm_cvtss_f32(t0);
+        return near_t <= _mm_cvtss_f32(t1) * 1.000001f;
+    }
+}
+
+LLVolumeBVH::LLVolumeBVH(const LLVolumeFace& face)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    const U32 num_triangles = face.mNumIndices / 3;
+    if (!num_triangles)
+    {
+        return;
+    }
+
+    std::vector<BuildRef> refs(num_triangles);
+    for (U32 i = 0; i < num_triangles; ++i)
+    {
+        const U16* idx = face.mIndices + i * 3;
+        BuildRef& ref = refs[i];
+        ref.mBounds.mMin = face.mPositions[idx[0]];
+        ref.mBounds.mMax = ref.mBounds.mMin;
+        ref.mBounds.grow(face.mPositions[idx[1]]);
+        ref.mBounds.grow(face.mPositions[idx[2]]);
+        ref.mCenter.setAdd(ref.mBounds.mMin, ref.mBounds.mMax);
+        ref.mCenter.mul(0.5f);
+        ref.mTriangle = i;
+    }
+
+    // About two nodes per leaf of three or four triangles
+    mNodes.reserve(num_triangles * 2 / 3 + 1);
+
+    std::vector<BuildTask> stack;
+    stack.push_back({ 0, num_triangles, U32_MAX, 0 });
+
+    Bounds bins[3][NUM_BINS];
+    U32 bin_counts[3][NUM_BINS];
+    F32 right_area[NUM_BINS];
+    U32 right_count[NUM_BINS];
+
+    while (!stack.empty())
+    {
+        BuildTask task = stack.back();
+        stack.pop_back();
+
+        const U32 node_index = (U32)mNodes.size();
+        if (task.mParent != U32_MAX)
+        {
+            mNodes[task.mParent].mOffset = node_index;
+        }
+        mNodes.emplace_back();
+
+        Bounds bounds;
+        Bounds center_bounds;
+        bounds.clear();
+        center_bounds.clear();
+        for (U32 i = task.mBegin; i < task.mEnd; ++i)
+        {
+            bounds.grow(refs[i].mBounds);
+            center_bounds.grow(refs[i].mCenter);
+        }
+        store_bounds(mNodes[node_index], bounds);
+
+        const U32 count = task.mEnd - task.mBegin;
+        const F32 leaf_cost = (F32)count;
+
+        // Bin the centers on all three axes in one pass, then pick the
+        // cheapest bin boundary.  Flat axes scale to zero and put
+        // everything in their first bin, which offers no split.
+        F32 best_cost = FLT_MAX;
+        S32 best_axis = -1;
+        S32 best_split = 0;
+        LLVector4a extent;
+        extent.setSub(center_bounds.mMax, center_bounds.mMin);
+        // Small nodes need fewer bins
+        const S32 num_bins = llmin((S32)count, NUM_BINS);
+        LLVector4a scale;
+        for (S32 axis = 0; axis < 4; ++axis)
+        {
+            scale.getF32ptr()[axis] = axis < 3 && extent[axis] > 0.f ? num_bins * 0.9999f / extent[axis] : 0.f;
+        }
+        if (count > MIN_LEAF_SIZE && task.mDepth < MAX_DEPTH - 1)
+        {
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                for (S32 b = 0; b < num_bins; ++b)
+                {
+                    bins[axis][b].clear();
+                    bin_counts[axis][b] = 0;
+                }
+            }
+            for (U32 i = task.mBegin; i < task.mEnd; ++i)
+            {
+                S32 b[4];
+                bin_index(refs[i].mCenter, center_bounds.mMin, scale, b);
+                for (S32 axis = 0; axis < 3; ++axis)
+                {
+                    bins[axis][b[axis]].grow(refs[i].mBounds);
+                    ++bin_counts[axis][b[axis]];
+                }
+            }
+
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                Bounds acc;
+                acc.clear();
+                U32 acc_count = 0;
+                for (S32 b = num_bins - 1; b > 0; --b)
+                {
+                    acc.grow(bins[axis][b]);
+                    acc_count += bin_counts[axis][b];
+                    right_area[b] = acc.area();
+                    right_count[b] = acc_count;
+                }
+
+                acc.clear();
+                acc_count = 0;
+                for (S32 b = 0; b < num_bins - 1; ++b)
+                {
+                    acc.grow(bins[axis][b]);
+                    acc_count += bin_counts[axis][b];
+                    if (!acc_count || !right_count[b + 1])
+                    {
+                        continue;
+                    }
+                    F32 cost = acc.area() * acc_count + right_area[b + 1] * right_count[b + 1];
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_split = b + 1;
+                    }
+                }
+            }
+        }
+
+        const F32 area = bounds.area();
+        if (best_axis >= 0 && area > 0.f)
+        {
+            best_cost = TRAVERSAL_COST + best_cost / area;
+        }
+
+        if (best_axis < 0 || (count <= MAX_LEAF_SIZE && best_cost >= leaf_cost))
+        {
+            mNodes[node_index].mOffset = task.mBegin;
+            mNodes[node_index].mCount = count;
+            continue;
+        }
+
+        BuildRef* mid = std::partition(refs.data() + task.mBegin, refs.data() + task.mEnd,
+            [&](const BuildRef& ref)
+            {
+                S32 b[4];
+                bin_index(ref.mCenter, center_bounds.mMin, scale, b);
+                return b[best_axis] < best_split;
+            });
+        const U32 split = (U32)(mid - refs.data());
+
+        mNodes[node_index].mCount = 0;
+
+        // First child is built next so it lands right after this node
+        stack.push_back({ split, task.mEnd, node_index, task.mDepth + 1 });
+        stack.push_back({ task.mBegin, split, U32_MAX, task.mDepth + 1 });
+    }
+
+    mNodes.shrink_to_fit();
+
+    mTriangles.resize(num_triangles);
+    for (U32 i = 0; i < num_triangles; ++i)
+    {
+        mTriangles[i] = refs[i].mTriangle;
+    }
+}
+
+bool LLVolumeBVH::intersect(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& dir,
+                            F32& closest_t, U32& triangle, F32& a, F32& b) const
+{
+    if (mNodes.empty())
+    {
+        return false;
+    }
+
+    // Keep the reciprocal finite so empty extents don't make 0 * inf
+    LLVector4a inv_dir;
+    for (S32 i = 0; i < 3; ++i)
+    {
+        F32 d = dir[i];
+        if (fabsf(d) < 1e-30f)
+        {
+            d = d < 0.f ? -1e-30f : 1e-30f;
+        }
+        inv_dir.getF32ptr()[i] = 1.f / d;
+    }
+    inv_dir.getF32ptr()[3] = 0.f;
+
+    LLVector4a org(start);
+    org.getF32ptr()[3] = 0.f;
+
+    bool hit = false;
+    F32 max_t = llmin(closest_t, 1.f);
+    F32 near_t;
+
+    // Deferred nodes with their entry distance
+    U32 stack[MAX_DEPTH];
+    F32 stack_t[MAX_DEPTH];
+    S32 depth = 0;
+    U32 node_index = 0;
+
+    if (!hit_node(mNodes[0], org, inv_dir, max_t, near_t))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        const Node& node = mNodes[node_index];
+        if (node.isLeaf())
+        {
+            for (U32 i = node.mOffset, end = node.mOffset + node.mCount; i < end; ++i)
+            {
+                const U32 tri = mTriangles[i];
+                const U16* idx = face.mIndices + tri * 3;
+
+                F32 tri_a, tri_b, t;
+                if (LLTriangleRayIntersect(face.mPositions[idx[0]], face.mPositions[idx[1]], face.mPositions[idx[2]],
+                                           start, dir, tri_a, tri_b, t) &&
+                    t >= 0.f && t <= max_t && t < closest_t)
+                {
+                    closest_t = t;
+                    max_t = t;
+                    triangle = tri;
+                    a = tri_a;
+                    b = tri_b;
+                    hit = true;
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first, defer the other
+            U32 first = node_index + 1;
+            U32 second = node.mOffset;
+            F32 first_t, second_t;
+            bool first_hit = hit_node(mNodes[first], org, inv_dir, max_t, first_t);
+            bool second_hit = hit_node(mNodes[second], org, inv_dir, max_t, second_t);
+            if (first_hit && second_hit)
+            {
+                if (second_t < first_t)
+                {
+                    std::swap(first, second);
+                    std::swap(first_t, second_t);
+                }
+                stack[depth] = second;
+                stack_t[depth++] = second_t;
+                node_index = first;
+                continue;
+            }
+            if (first_hit || second_hit)
+            {
+                node_index = first_hit ? first : second;
+                continue;
+            }
+        }
+
+        // Skip deferred nodes that start beyond a hit found since
+        do
+        {
+            if (!depth)
+            {
+                return hit;
+            }
+            --depth;
+        }
+        while (stack_t[depth] > max_t);
+        node_index = stack[depth];
+    }
+}
+
+size_t LLVolumeBVH::getMemoryUsage() const
+{
+    return sizeof(*this) + mNodes.capacity() * sizeof(Node) + mTriangles.capacity() * sizeof(U32);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flat bounding volume hierarchy for raycasting volume faces
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUME_BVH_H
+#define LL_LLVOLUME_BVH_H
+
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLVolumeFace;
+
+// Bounding volume hierarchy over the triangles of one LLVolumeFace,
+// built with a binned surface area heuristic and stored as a flat
+// array of nodes in depth first order.  Leaves refer to triangles by
+// their number in the face's index array, so the face must not
+// change while the hierarchy is in use.
+//
+// Alternative to LLVolumeOctree for LLVolume::lineSegmentIntersect():
+// no per triangle allocations or listeners, a fraction of the memory
+// and a build that is a few passes over the triangle bounds.
+class LLVolumeBVH
+{
+public:
+    // 32 bytes.  An interior node's first child follows it directly and
+    // mOffset is the second child.  A leaf holds mCount triangles starting
+    // at mOffset in mTriangles.
+    struct alignas(32) Node
+    {
+        F32 mMin[3];
+        U32 mOffset;
+        F32 mMax[3];
+        U32 mCount;
+
+        bool isLeaf() const { return mCount != 0; }
+    };
+
+    LLVolumeBVH(const LLVolumeFace& face);
+
+    // Find the closest triangle hit by the segment start + t * dir with
+    // 0 <= t <= 1 that is closer than closest_t.  On a hit closest_t,
+    // triangle and the barycentric a and b are updated.
+    bool intersect(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& dir,
+                   F32& closest_t, U32& triangle, F32& a, F32& b) const;
+
+    const std::vector<Node>& getNodes() const { return mNodes; }
+    const std::vector<U32>& getTriangles() const { return mTriangles; }
+    size_t getMemoryUsage() const;
+
+private:
+    std::vector<Node> mNodes;
+    std::vector<U32> mTriangles;
+};
+
+#endif
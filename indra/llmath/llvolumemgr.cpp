@@ -27,6 +27,7 @@
 
 #include "llvolumemgr.h"
 #include "llvolume.h"
+#include "threadpool.h"
 
 
 const F32 BASE_THRESHOLD = 0.03f;
@@ -41,10 +42,37 @@ F32 LLVolumeLODGroup::mDetailThresholds[NUM_LODS] = {BASE_THRESHOLD,
 F32 LLVolumeLODGroup::mDetailScales[NUM_LODS] = {1.f, 1.5f, 2.5f, 4.f};
 
 
+//============================================================================
+
+void LLVolumeSculptMap::set(U16 width, U16 height, S8 components, const U8* data, S32 level, bool visible_placeholder)
+{
+    mLevel = level;
+    mVisiblePlaceholder = visible_placeholder;
+    if (data)
+    {
+        mWidth = width;
+        mHeight = height;
+        mComponents = components;
+        mData.assign(data, data + (size_t)width * height * components);
+    }
+    else
+    {
+        mWidth = mHeight = 0;
+        mComponents = 0;
+        mData.clear();
+    }
+}
+
+void LLVolumeSculptMap::sculpt(LLVolume* volume) const
+{
+    volume->sculpt(mWidth, mHeight, mComponents, mData.empty() ? NULL : mData.data(), mLevel, mVisiblePlaceholder);
+}
+
 //============================================================================
 
 LLVolumeMgr::LLVolumeMgr()
-:   mDataMutex(NULL)
+:   mDataMutex(NULL),
+    mNumPendingLODs(0)
 {
     // the LLMutex magic interferes with easy unit testing,
     // so you now must manually call useMutex() to use it
@@ -53,6 +81,18 @@ LLVolumeMgr::LLVolumeMgr()
 
 LLVolumeMgr::~LLVolumeMgr()
 {
+    if (mGenerateThreadPool)
+    {
+        mGenerateThreadPool->close();
+        mGenerateThreadPool.reset();
+    }
+    for (const Generated& generated : mGenerated)
+    {
+        LLPointer<LLVolume> discard = generated.mVolume;
+    }
+    mGenerated.clear();
+    mPendingSculpts.clear();
+
     cleanup();
 
     delete mDataMutex;
@@ -218,6 +258,160 @@ void LLVolumeMgr::useMutex()
     }
 }
 
+void LLVolumeMgr::startGenerateThreads(size_t threads)
+{
+    if (!mGenerateThreadPool && threads > 0)
+    {
+        mGenerateThreadPool.reset(new LL::ThreadPool("VolumeGen", threads));
+        mGenerateThreadPool->start();
+    }
+}
+
+bool LLVolumeMgr::requestVolume(const LLVolumeParams& volume_params, const S32 detail, const LLVolumeSculptMap* sculpt)
+{
+    LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+    if (!mGenerateThreadPool || !volgroupp || volgroupp->hasLOD(detail))
+    {
+        return true;
+    }
+
+    U32& pending = mPendingLODs[volume_params];
+    if (pending & (1 << detail))
+    {
+        return false;
+    }
+
+    F32 volume_detail = LLVolumeLODGroup::getVolumeScaleFromDetail(detail);
+    bool posted = mGenerateThreadPool->getQueue().post(
+        [this, volume_params, detail, volume_detail,
+         sculpt_map = sculpt ? std::make_shared<LLVolumeSculptMap>(*sculpt) : std::shared_ptr<LLVolumeSculptMap>()]
+        ()
+        {
+            LLVolume* volumep = new LLVolume(volume_params, volume_detail);
+            if (sculpt_map)
+            {
+                sculpt_map->sculpt(volumep);
+            }
+            LLMutexLock lock(&mGeneratedMutex);
+            mGenerated.push_back({ volumep, detail, NULL });
+        });
+    if (!posted)
+    {
+        // Shutting down, generate inline
+        return true;
+    }
+
+    pending |= 1 << detail;
+    mNumPendingLODs++;
+    return false;
+}
+
+bool LLVolumeMgr::requestSculpt(LLVolume* volumep, const LLVolumeSculptMap& sculpt)
+{
+    if (!mGenerateThreadPool || volumep->isUnique())
+    {
+        return false;
+    }
+
+    if (isSculptPending(volumep))
+    {
+        return true;
+    }
+
+    LLVolumeParams volume_params = volumep->getParams();
+    F32 volume_detail = volumep->getDetail();
+    bool posted = mGenerateThreadPool->getQueue().post(
+        [this, volume_params, volume_detail, sculpt_map = std::make_shared<LLVolumeSculptMap>(sculpt), target = (const LLVolume*) volumep]
+        ()
+        {
+            LLVolume* generated = new LLVolume(volume_params, volume_detail);
+            sculpt_map->sculpt(generated);
+            LLMutexLock lock(&mGeneratedMutex);
+            mGenerated.push_back({ generated, -1, target });
+        });
+    if (!posted)
+    {
+        return false;
+    }
+
+    // Keeps the target alive until the result is swapped in
+    mPendingSculpts[volumep] = volumep;
+    return true;
+}
+
+bool LLVolumeMgr::isSculptPending(const LLVolume* volumep) const
+{
+    return mPendingSculpts.find(volumep) != mPendingSculpts.end();
+}
+
+S32 LLVolumeMgr::updateGenerated()
+{
+    std::vector<Generated> generated;
+    {
+        LLMutexLock lock(&mGeneratedMutex);
+        generated.swap(mGenerated);
+    }
+
+    for (const Generated& item : generated)
+    {
+        LLPointer<LLVolume> volumep = item.mVolume;
+
+        if (item.mTarget)
+        {
+            auto iter = mPendingSculpts.find(item.mTarget);
+            if (iter != mPendingSculpts.end())
+            {
+                iter->second->swapGeometry(*volumep);
+                mPendingSculpts.erase(iter);
+            }
+            continue;
+        }
+
+        const LLVolumeParams& volume_params = volumep->getParams();
+        auto pending = mPendingLODs.find(volume_params);
+        if (pending != mPendingLODs.end())
+        {
+            pending->second &= ~(1 << item.mDetail);
+            if (!pending->second)
+            {
+                mPendingLODs.erase(pending);
+            }
+            mNumPendingLODs--;
+        }
+
+        // The group is gone if every object using it went away meanwhile
+        LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+        if (volgroupp)
+        {
+            volgroupp->adoptLOD(item.mDetail, volumep);
+        }
+    }
+
+    // Whether or not a result was used, whoever waited on it has to
+    // look again
+    return (S32)generated.size();
+}
+
+S32 LLVolumeMgr::quantizeIdleVolumes()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    if (mDataMutex)
+    {
+        mDataMutex->lock();
+    }
+    S32 quantized = 0;
+    for (auto& entry : mVolumeLODGroups)
+    {
+        quantized += entry.second->quantizeIdleLODs();
+    }
+    if (mDataMutex)
+    {
+        mDataMutex->unlock();
+    }
+    return quantized;
+}
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 {
     s << "{ numLODgroups=" << volume_mgr.mVolumeLODGroups.size() << ", ";
@@ -301,6 +495,32 @@ LLVolume* LLVolumeLODGroup::refLOD(const S32 lod)
     return mVolumeLODs[lod];
 }
 
+bool LLVolumeLODGroup::adoptLOD(const S32 detail, LLVolume* volumep)
+{
+    llassert(detail >=0 && detail < NUM_LODS);
+    if (mVolumeLODs[detail].notNull())
+    {
+        return false;
+    }
+    mVolumeLODs[detail] = volumep;
+    return true;
+}
+
+S32 LLVolumeLODGroup::quantizeIdleLODs()
+{
+    S32 quantized = 0;
+    for (S32 i = 0; i < NUM_LODS; i++)
+    {
+        // Prims and sculpts are regenerated rather than kept around long
+        LLVolume* volumep = mVolumeLODs[i];
+        if (volumep && volumep->isMeshAssetLoaded() && !volumep->isUnique() && volumep->quantizeIdleFaces())
+        {
+            quantized++;
+        }
+    }
+    return quantized;
+}
+
 bool LLVolumeLODGroup::derefLOD(LLVolume *volumep)
 {
     llassert_always(mRefs > 0);
@@ -28,14 +28,32 @@
 #define LL_LLVOLUMEMGR_H
 
 #include <map>
+#include <memory>
+#include <vector>
 
 #include "llvolume.h"
 #include "llpointer.h"
 #include "llthread.h"
+#include "threadpool_fwd.h"
 
 class LLVolumeParams;
 class LLVolumeLODGroup;
 
+// Copy of a sculpt texture's pixels, so a sculpted volume can be
+// generated on another thread while the texture moves on
+struct LLVolumeSculptMap
+{
+    U16 mWidth = 0;
+    U16 mHeight = 0;
+    S8 mComponents = 0;
+    S32 mLevel = -1;
+    bool mVisiblePlaceholder = false;
+    std::vector<U8> mData;
+
+    void set(U16 width, U16 height, S8 components, const U8* data, S32 level, bool visible_placeholder);
+    void sculpt(LLVolume* volume) const;
+};
+
 class LLVolumeLODGroup
 {
     LOG_CLASS(LLVolumeLODGroup);
@@ -57,6 +75,11 @@ class LLVolumeLODGroup
 
     LLVolume* refLOD(const S32 detail);
     bool derefLOD(LLVolume *volumep);
+    bool hasLOD(const S32 detail) const { return mVolumeLODs[detail].notNull(); }
+    // Keep a volume generated elsewhere as LOD detail, unless it has one already
+    bool adoptLOD(const S32 detail, LLVolume* volumep);
+    // See LLVolumeMgr::quantizeIdleVolumes()
+    S32 quantizeIdleLODs();
     S32 getNumRefs() const { return mRefs; }
 
     const LLVolumeParams* getVolumeParams() const { return &mVolumeParams; };
@@ -95,6 +118,36 @@ class LLVolumeMgr
     // manually call this for mutex magic
     void useMutex();
 
+    // Generate new volumes on a pool of threads from now on.  Until this
+    // is called requestVolume() and requestSculpt() return without
+    // queueing anything and callers generate inline as before.
+    void startGenerateThreads(size_t threads);
+    bool isGenerateAsync() const { return mGenerateThreadPool != nullptr; }
+
+    // Start generating LOD detail of volume_params in the background if
+    // its group doesn't have it yet.  Sculpted volumes pass their sculpt
+    // map.  Returns true if refVolume() can hand the LOD out right away,
+    // false while it is being generated.
+    bool requestVolume(const LLVolumeParams& volume_params, const S32 detail, const LLVolumeSculptMap* sculpt = nullptr);
+
+    // Sculpt a copy of volumep in the background and swap the result in.
+    // Returns false if nothing was queued and the caller should sculpt
+    // inline.
+    bool requestSculpt(LLVolume* volumep, const LLVolumeSculptMap& sculpt);
+    bool isSculptPending(const LLVolume* volumep) const;
+
+    // Hand finished volumes to their LOD groups or swap them into the
+    // volumes they were sculpted for.  Call on the main thread.  Returns
+    // the number of requests finished, including any that were dropped
+    // because their group or volume went away.
+    S32 updateGenerated();
+    S32 getNumPendingGenerated() const { return (S32)(mPendingSculpts.size() + mNumPendingLODs); }
+
+    // Quantize the faces of mesh LODs nobody asked for since the last call,
+    // see LLVolume::quantizeIdleFaces().  Call on the main thread every so
+    // often.  Returns the number of volumes quantized.
+    S32 quantizeIdleVolumes();
+
     friend std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr);
 
 protected:
@@ -107,6 +160,23 @@ class LLVolumeMgr
     volume_lod_group_map_t mVolumeLODGroups;
 
     LLMutex* mDataMutex;
+
+    // Volumes being generated in the background, touched by the main
+    // thread only.  A bit per LOD for new volumes, the target for sculpts.
+    std::map<LLVolumeParams, U32> mPendingLODs;
+    std::map<const LLVolume*, LLPointer<LLVolume> > mPendingSculpts;
+    S32 mNumPendingLODs;
+
+    struct Generated
+    {
+        LLVolume* mVolume;          // unreferenced until updateGenerated()
+        S32 mDetail;
+        const LLVolume* mTarget;    // sculpted for, or NULL for a new LOD
+    };
+    LLMutex mGeneratedMutex;
+    std::vector<Generated> mGenerated;
+
+    std::unique_ptr<LL::ThreadPool> mGenerateThreadPool;
 };
 
 #endif // LL_LLVOLUMEMGR_H
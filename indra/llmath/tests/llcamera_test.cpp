@@ -0,0 +1,221 @@
+/**
+ * @file llcamera_test.cpp
+ * @brief LLCamera frustum test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../llcamera.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+#include <vector>
+
+namespace tut
+{
+    struct camera_data
+    {
+        LLCamera mCamera;
+
+        camera_data()
+        {
+            setFrustum();
+        }
+
+        // Looking down +X from the origin, near plane at 1m and far plane at 64m
+        void setFrustum()
+        {
+            LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM];
+            frust[0].setVec(1.f, 0.5f, -0.5f);
+            frust[1].setVec(1.f, -0.5f, -0.5f);
+            frust[2].setVec(1.f, -0.5f, 0.5f);
+            frust[3].setVec(1.f, 0.5f, 0.5f);
+            for (S32 i = 0; i < 4; ++i)
+            {
+                frust[i + 4] = frust[i] * 64.f;
+            }
+            mCamera.calcAgentFrustumPlanes(frust);
+            mCamera.calcRegionFrustumPlanes(LLVector3(-20.f, 5.f, 0.f), 48.f);
+        }
+
+        static F32 nextRandom(U32& seed)
+        {
+            seed = seed * 1664525 + 1013904223;
+            return (F32)(seed >> 8) / (F32)(1 << 24);
+        }
+
+        void makeBoxes(std::vector<LLVector4a>& centers, std::vector<LLVector4a>& radii, S32 count)
+        {
+            U32 seed = 11;
+            for (S32 i = 0; i < count; ++i)
+            {
+                centers.push_back(LLVector4a(nextRandom(seed) * 100.f - 20.f, nextRandom(seed) * 100.f - 50.f, nextRandom(seed) * 100.f - 50.f));
+                F32 size = nextRandom(seed) * 8.f;
+                radii.push_back(LLVector4a(size, size * nextRandom(seed), size * nextRandom(seed)));
+            }
+        }
+    };
+    typedef test_group<camera_data> camera_test;
+    typedef camera_test::object camera_object;
+    tut::camera_test camera_testcase("LLCamera");
+
+    template<> template<>
+    void camera_object::test<1>()
+    {
+        set_test_name("Batch frustum test matches one box at a time");
+
+        LLCamera& camera = mCamera;
+
+        std::vector<LLVector4a> centers, radii;
+        makeBoxes(centers, radii, 4000);
+
+        S32 seen[3] = { 0, 0, 0 };
+        for (size_t base = 0; base < centers.size(); )
+        {
+            // Odd sized batches too, to cover the unused slots
+            LLCameraBoxBatch batch;
+            U32 count = llmin((U32)(centers.size() - base), 1 + (U32)(base % LLCameraBoxBatch::MAX_BOXES));
+            for (U32 i = 0; i < count; ++i)
+            {
+                batch.add(centers[base + i], radii[base + i]);
+            }
+
+            S32 res[LLCameraBoxBatch::MAX_BOXES];
+            S32 no_far_res[LLCameraBoxBatch::MAX_BOXES];
+            U32 visible = camera.AABBInFrustumBatch(batch, res, no_far_res);
+            S32 region_res[LLCameraBoxBatch::MAX_BOXES];
+            S32 region_no_far_res[LLCameraBoxBatch::MAX_BOXES];
+            camera.AABBInRegionFrustumBatch(batch, region_res, region_no_far_res);
+
+            for (U32 i = 0; i < count; ++i)
+            {
+                const LLVector4a& center = centers[base + i];
+                const LLVector4a& radius = radii[base + i];
+                S32 expected = camera.AABBInFrustum(center, radius);
+                ensure_equals("agent", res[i], expected);
+                ensure_equals("visible mask", (visible >> i) & 1, (U32)(expected != 0));
+                ensure_equals("agent no far clip", no_far_res[i], camera.AABBInFrustumNoFarClip(center, radius));
+                ensure_equals("region", region_res[i], camera.AABBInRegionFrustum(center, radius));
+                ensure_equals("region no far clip", region_no_far_res[i], camera.AABBInRegionFrustumNoFarClip(center, radius));
+                ++seen[expected];
+            }
+            ensure_equals("no bits past the batch", visible >> count, (U32)0);
+            base += count;
+        }
+
+        ensure("boxes outside, crossing and inside", seen[0] > 0 && seen[1] > 0 && seen[2] > 0);
+    }
+
+    template<> template<>
+    void camera_object::test<2>()
+    {
+        set_test_name("Batch frustum test with a user clip plane");
+
+        LLCamera& camera = mCamera;
+        LLPlane clip(LLVector3(0.f, 0.f, 10.f), LLVector3(0.f, 0.f, 1.f));
+        camera.setUserClipPlane(clip);
+        setFrustum();
+
+        std::vector<LLVector4a> centers, radii;
+        makeBoxes(centers, radii, 800);
+
+        for (size_t base = 0; base < centers.size(); base += LLCameraBoxBatch::MAX_BOXES)
+        {
+            LLCameraBoxBatch batch;
+            for (U32 i = 0; i < LLCameraBoxBatch::MAX_BOXES; ++i)
+            {
+                batch.add(centers[base + i], radii[base + i]);
+            }
+
+            S32 res[LLCameraBoxBatch::MAX_BOXES];
+            camera.AABBInFrustumBatch(batch, res);
+            for (U32 i = 0; i < LLCameraBoxBatch::MAX_BOXES; ++i)
+            {
+                ensure_equals("clipped", res[i], camera.AABBInFrustum(centers[base + i], radii[base + i]));
+            }
+        }
+    }
+
+    template<> template<>
+    void camera_object::test<3>()
+    {
+        set_test_name("Batch frustum test speed");
+
+        // Timing only, test<1> already checks the batch results
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time batch frustum tests");
+        }
+
+        LLCamera& camera = mCamera;
+
+        std::vector<LLVector4a> centers, radii;
+        makeBoxes(centers, radii, 4096);
+
+        std::vector<LLCameraBoxBatch> batches(centers.size() / LLCameraBoxBatch::MAX_BOXES);
+        for (size_t i = 0; i < centers.size(); ++i)
+        {
+            batches[i / LLCameraBoxBatch::MAX_BOXES].add(centers[i], radii[i]);
+        }
+
+        const S32 passes = 200;
+        S32 single_visible = 0;
+        LLTimer timer;
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            for (size_t i = 0; i < centers.size(); ++i)
+            {
+                single_visible += camera.AABBInFrustumNoFarClip(centers[i], radii[i]) != 0;
+            }
+        }
+        F64 single = timer.getElapsedTimeF64();
+
+        S32 batch_visible = 0;
+        timer.reset();
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            for (size_t i = 0; i < batches.size(); ++i)
+            {
+                S32 res[LLCameraBoxBatch::MAX_BOXES];
+                S32 no_far_res[LLCameraBoxBatch::MAX_BOXES];
+                camera.AABBInFrustumBatch(batches[i], res, no_far_res);
+                for (U32 j = 0; j < LLCameraBoxBatch::MAX_BOXES; ++j)
+                {
+                    batch_visible += no_far_res[j] != 0;
+                }
+            }
+        }
+        F64 batch = timer.getElapsedTimeF64();
+
+        ensure_equals("same boxes visible", batch_visible, single_visible);
+
+        F64 boxes = (F64)centers.size() * passes;
+        std::cout << "\nMboxes/s: one at a time " << boxes / single / 1000000.0
+                  << " -> batch of " << LLCameraBoxBatch::MAX_BOXES << " " << boxes / batch / 1000000.0
+                  << (LLCamera::hasWideFrustumBatch() ? " (AVX)" : " (SSE2)") << std::endl;
+    }
+}
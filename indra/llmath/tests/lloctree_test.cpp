@@ -0,0 +1,285 @@
+/**
+ * @file lloctree_test.cpp
+ * @brief Loose octree test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../lloctree.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    class Mover;
+    typedef LLOctreeNode<Mover, Mover*> MoverNode;
+    typedef LLOctreeRoot<Mover, Mover*> MoverRoot;
+
+    // Stands in for a drawable: something with a position and a bin
+    // radius that remembers which node it was put in
+    class alignas(16) Mover
+    {
+    public:
+        Mover() : mRadius(1.f), mBinIndex(-1), mNode(NULL) { }
+
+        const LLVector4a& getPositionGroup() const  { return mPosition; }
+        F32 getBinRadius() const                    { return mRadius; }
+        S32 getBinIndex() const                     { return mBinIndex; }
+        void setBinIndex(S32 index)                 { mBinIndex = index; }
+
+        LLVector4a mPosition;
+        LLVector4a mVelocity;
+        F32 mRadius;
+        S32 mBinIndex;
+        MoverNode* mNode;
+    };
+
+    // Tracks the node of each element the way LLViewerOctreeGroup does
+    class MoverListener : public LLOctreeListener<Mover, Mover*>
+    {
+    public:
+        void handleInsertion(const LLTreeNode<Mover>* node, Mover* data) override
+        {
+            data->mNode = (MoverNode*) node;
+        }
+
+        void handleRemoval(const LLTreeNode<Mover>* node, Mover* data) override
+        {
+            data->mNode = NULL;
+        }
+
+        void handleDestruction(const LLTreeNode<Mover>* node) override { }
+        void handleStateChange(const LLTreeNode<Mover>* node) override { }
+
+        void handleChildAddition(const MoverNode* parent, MoverNode* child) override
+        {
+            child->addListener(new MoverListener);
+        }
+
+        void handleChildRemoval(const MoverNode* parent, const MoverNode* child) override { }
+    };
+}
+
+namespace tut
+{
+    struct octree_data
+    {
+        octree_data()
+        {
+            gOctreeMaxCapacity = 128;
+            gOctreeMinSize = 0.01f;
+        }
+
+        static F32 nextRandom(U32& seed)
+        {
+            seed = seed * 1664525 + 1013904223;
+            return (F32)(seed >> 8) / (F32)(1 << 24);
+        }
+
+        // Avatars and vehicles spread over a region, moving up to about
+        // 10 m/s at 45 frames per second
+        void makeMovers(std::vector<Mover>& movers, S32 count)
+        {
+            U32 seed = 5;
+            movers.resize(count);
+            for (S32 i = 0; i < count; ++i)
+            {
+                Mover& mover = movers[i];
+                mover.mPosition.set(nextRandom(seed) * 256.f, nextRandom(seed) * 256.f, 20.f + nextRandom(seed) * 40.f);
+                mover.mVelocity.set(nextRandom(seed) * 0.44f - 0.22f, nextRandom(seed) * 0.44f - 0.22f, nextRandom(seed) * 0.04f - 0.02f);
+                mover.mRadius = 0.5f + nextRandom(seed) * (i % 10 ? 1.5f : 8.f);
+            }
+        }
+
+        MoverRoot* makeTree(std::vector<Mover>& movers, F32 looseness)
+        {
+            LLVector4a center, size;
+            center.splat(0.f);
+            size.splat(1.f);
+            MoverRoot* root = new MoverRoot(center, size, NULL);
+            root->addListener(new MoverListener);
+            root->setLooseness(looseness);
+            for (size_t i = 0; i < movers.size(); ++i)
+            {
+                root->insert(&movers[i]);
+            }
+            return root;
+        }
+
+        // One frame of LLSpatialPartition::move(): a mover that can't stay
+        // in its node is removed and inserted again from the root
+        S32 step(MoverRoot* root, std::vector<Mover>& movers)
+        {
+            S32 moved = 0;
+            for (size_t i = 0; i < movers.size(); ++i)
+            {
+                Mover& mover = movers[i];
+                mover.mPosition.add(mover.mVelocity);
+                if (!mover.mNode->canRetain(&mover))
+                {
+                    mover.mNode->remove(&mover);
+                    root->insert(&mover);
+                    ++moved;
+                }
+            }
+            return moved;
+        }
+
+        // Reinsertions over frames of count movers in a tree of looseness
+        S32 countReinsertions(S32 count, S32 frames, F32 looseness)
+        {
+            std::vector<Mover> movers;
+            makeMovers(movers, count);
+            MoverRoot* root = makeTree(movers, looseness);
+
+            S32 moved = 0;
+            for (S32 frame = 0; frame < frames; ++frame)
+            {
+                moved += step(root, movers);
+            }
+            delete root;
+            return moved;
+        }
+    };
+    typedef test_group<octree_data> octree_test;
+    typedef octree_test::object octree_object;
+    tut::octree_test octree_testcase("LLOctree");
+
+    template<> template<>
+    void octree_object::test<1>()
+    {
+        set_test_name("Loose bounds");
+
+        LLVector4a center(10.f, 10.f, 10.f);
+        LLVector4a size;
+        size.splat(2.f);
+        MoverNode node(center, size, NULL);
+        ensure_equals("tight by default", node.getLooseness(), 1.f);
+
+        node.setLooseness(0.5f);
+        ensure_equals("never tighter than the node", node.getLooseness(), 1.f);
+
+        LLVector4a just_out(12.5f, 10.f, 10.f);
+        LLVector4a far_out(10.f, 6.5f, 10.f);
+        ensure("tight inside", node.isInsideLoose(LLVector4a(11.f, 9.f, 12.f)));
+        ensure("tight outside", !node.isInsideLoose(just_out));
+
+        node.setLooseness(1.5f);
+        ensure("loose inside", node.isInsideLoose(just_out));
+        ensure("loose corner", node.isInsideLoose(LLVector4a(12.9f, 7.1f, 12.9f)));
+        ensure("loose outside", !node.isInsideLoose(far_out));
+        ensure("tight bounds unchanged", !node.isInside(just_out));
+
+        // Children made afterwards pick it up
+        std::vector<Mover> movers;
+        makeMovers(movers, 500);
+        MoverRoot* root = makeTree(movers, 2.f);
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            ensure_equals("inherited", movers[i].mNode->getLooseness(), 2.f);
+        }
+
+        root->setLooseness(1.f);
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            ensure_equals("pushed down", movers[i].mNode->getLooseness(), 1.f);
+        }
+        delete root;
+    }
+
+    template<> template<>
+    void octree_object::test<2>()
+    {
+        set_test_name("Movers stay findable");
+
+        std::vector<Mover> movers;
+        makeMovers(movers, 2000);
+        MoverRoot* root = makeTree(movers, 1.5f);
+
+        for (S32 frame = 0; frame < 100; ++frame)
+        {
+            step(root, movers);
+        }
+
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            Mover& mover = movers[i];
+            MoverNode* node = mover.mNode;
+            ensure("in a node", node != NULL);
+            ensure("bin index", mover.getBinIndex() >= 0 && mover.getBinIndex() < (S32)node->getElementCount());
+            ensure("node holds it", *(node->getDataBegin() + mover.getBinIndex()) == &mover);
+            ensure("within loose bounds", node->getParent() == NULL || node->isInsideLoose(mover.getPositionGroup()));
+        }
+
+        for (size_t i = 0; i < movers.size(); ++i)
+        {
+            ensure("removed", movers[i].mNode->remove(&movers[i]));
+            ensure_equals("bin cleared", movers[i].getBinIndex(), -1);
+        }
+        ensure_equals("empty", root->getChildCount(), (U32)0);
+        delete root;
+    }
+
+    template<> template<>
+    void octree_object::test<3>()
+    {
+        set_test_name("Loose nodes reinsert fewer movers");
+
+        ensure("fewer reinsertions", countReinsertions(2000, 100, 1.5f) < countReinsertions(2000, 100, 1.f));
+    }
+
+    template<> template<>
+    void octree_object::test<4>()
+    {
+        set_test_name("Per frame update cost");
+
+        // Timing only, test<3> already checks the reinsertions
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time octree updates");
+        }
+
+        const S32 count = 5000;
+        const S32 frames = 300;
+        const F32 loose = 1.5f;
+
+        LLTimer timer;
+        S32 tight_moved = countReinsertions(count, frames, 1.f);
+        F64 tight = timer.getElapsedTimeF64();
+
+        timer.reset();
+        S32 loose_moved = countReinsertions(count, frames, loose);
+        F64 loose_time = timer.getElapsedTimeF64();
+
+        std::cout << "\n" << count << " movers, reinsertions per frame: tight " << tight_moved / frames
+                  << " -> loose " << loose << " " << loose_moved / frames
+                  << ", ms per run: tight " << tight * 1000.0
+                  << " -> loose " << loose_time * 1000.0 << std::endl;
+    }
+}
@@ -0,0 +1,328 @@
+/**
+ * @file lltransformbatch_test.cpp
+ * @brief Batched quaternion and matrix test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../lltransformbatch.h"
+#include "../xform.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const S32 NUM_JOINTS = 150;
+
+    F32 next_random(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (F32)(seed >> 8) / (F32)(1 << 24);
+    }
+
+    LLQuaternion random_rotation(U32& seed)
+    {
+        return LLQuaternion(next_random(seed) * F_TWO_PI, LLVector3(next_random(seed) - 0.5f, next_random(seed) - 0.5f, next_random(seed) - 0.5f));
+    }
+
+    LLVector3 random_vector(U32& seed, F32 scale)
+    {
+        return LLVector3(next_random(seed) - 0.5f, next_random(seed) - 0.5f, next_random(seed) - 0.5f) * scale;
+    }
+
+    bool same_matrix(const LLMatrix4a& a, const LLMatrix4& b)
+    {
+        return memcmp(a.getF32ptr(), &b.mMatrix[0][0], sizeof(LLMatrix4)) == 0;
+    }
+
+    // A skeleton shaped roughly like an avatar's: long chains with the
+    // occasional branch, and some joints scaling their children's offsets
+    struct Skeleton
+    {
+        Skeleton()
+        {
+            U32 seed = 3;
+            mParent.resize(NUM_JOINTS);
+            mDepth.resize(NUM_JOINTS);
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                mParent[i] = i == 0 ? -1 : (next_random(seed) < 0.4f ? i - 1 : (S32)(next_random(seed) * i));
+                mDepth[i] = i == 0 ? 0 : mDepth[mParent[i]] + 1;
+                mLevels.resize(llmax((S32)mLevels.size(), mDepth[i] + 1));
+                mLevels[mDepth[i]].push_back(i);
+
+                mXforms[i].init();
+                mXforms[i].setPosition(random_vector(seed, 0.4f));
+                mXforms[i].setRotation(random_rotation(seed));
+                mXforms[i].setScale(LLVector3(1.f, 1.f, 1.f) + random_vector(seed, 0.2f));
+                mXforms[i].setScaleChildOffset(i % 5 == 0);
+                if (i > 0)
+                {
+                    mXforms[i].setParent(&mXforms[mParent[i]]);
+                }
+            }
+        }
+
+        void animate(U32 frame)
+        {
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                mXforms[i].setRotation(LLQuaternion(0.01f * (frame + i), LLVector3(0.f, 0.f, 1.f)));
+            }
+        }
+
+        void updateOneByOne()
+        {
+            // Parents come before their children
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                mXforms[i].updateMatrix(false);
+                mMatrices[i].loadu(mXforms[i].getWorldMatrix());
+            }
+        }
+
+        void updateBatched()
+        {
+            for (size_t l = 0; l < mLevels.size(); ++l)
+            {
+                LLXformMatrix* xforms[NUM_JOINTS];
+                LLMatrix4a* matrices[NUM_JOINTS];
+                const std::vector<S32>& level = mLevels[l];
+                for (size_t i = 0; i < level.size(); ++i)
+                {
+                    xforms[i] = &mXforms[level[i]];
+                    matrices[i] = &mMatrices[level[i]];
+                }
+                LLXformMatrix::updateMatrices(xforms, matrices, (U32)level.size());
+            }
+        }
+
+        LLXformMatrix mXforms[NUM_JOINTS];
+        LLMatrix4a mMatrices[NUM_JOINTS];
+        std::vector<S32> mParent;
+        std::vector<S32> mDepth;
+        std::vector<std::vector<S32> > mLevels;
+    };
+}
+
+namespace tut
+{
+    struct transformbatch_data
+    {
+        // The same skeleton, updated one joint at a time and in batches
+        Skeleton mOne;
+        Skeleton mBatched;
+    };
+    typedef test_group<transformbatch_data> transformbatch_test;
+    typedef transformbatch_test::object transformbatch_object;
+    tut::transformbatch_test transformbatch_testcase("LLTransformBatch");
+
+    template<> template<>
+    void transformbatch_object::test<1>()
+    {
+        set_test_name("Kernels match the scalar versions");
+
+        U32 seed = 1;
+        const U32 count = 103;
+        std::vector<LLQuaternion> a(count), b(count), res(count);
+        std::vector<LLVector3> scale(count), pos(count);
+        std::vector<F32> u(count);
+        for (U32 i = 0; i < count; ++i)
+        {
+            a[i] = random_rotation(seed);
+            b[i] = i % 7 == 0 ? a[i] : random_rotation(seed);
+            if (i % 3 == 0)
+            {
+                b[i] = -b[i];
+            }
+            scale[i] = random_vector(seed, 4.f);
+            pos[i] = random_vector(seed, 100.f);
+            u[i] = next_random(seed);
+        }
+
+        for (U32 i = 0; i + 4 <= count; i += 4)
+        {
+            LLQuaternion4 a4, b4;
+            a4.load(a[i], a[i + 1], a[i + 2], a[i + 3]);
+            b4.load(b[i], b[i + 1], b[i + 2], b[i + 3]);
+            LLTransformBatch::mul(a4, b4, a4);
+            a4.store(res[i], res[i + 1], res[i + 2], res[i + 3]);
+
+            LLVector3x4 v4;
+            v4.load(pos[i], pos[i + 1], pos[i + 2], pos[i + 3]);
+            LLTransformBatch::rotate(v4, b4, v4);
+            LLVector3 rotated[4];
+            v4.store(rotated[0], rotated[1], rotated[2], rotated[3]);
+
+            for (U32 j = 0; j < 4; ++j)
+            {
+                LLQuaternion expected = a[i + j] * b[i + j];
+                ensure("mul", memcmp(res[i + j].mQ, expected.mQ, sizeof(expected.mQ)) == 0);
+                ensure("rotate", (rotated[j] - pos[i + j] * b[i + j]).magVec() < 1e-4f);
+            }
+        }
+
+        std::vector<LLMatrix4a> matrices(count);
+        LLTransformBatch::toMatrices(&scale[0], &a[0], &pos[0], &matrices[0], count);
+        for (U32 i = 0; i < count; ++i)
+        {
+            LLMatrix4 expected;
+            expected.initAll(scale[i], a[i], pos[i]);
+            ensure("matrix", same_matrix(matrices[i], expected));
+        }
+
+        LLTransformBatch::slerp(&u[0], &a[0], &b[0], &res[0], count);
+        for (U32 i = 0; i < count; ++i)
+        {
+            LLQuaternion expected = slerp(u[i], a[i], b[i]);
+            ensure("slerp", res[i].isEqualEps(expected, 1e-5f));
+        }
+
+        res = a;
+        for (U32 i = 0; i < count; ++i)
+        {
+            F32 s = i % 11 == 0 ? 1e-9f : 0.5f + next_random(seed);
+            for (U32 j = 0; j < 4; ++j)
+            {
+                res[i].mQ[j] *= s;
+            }
+        }
+        std::vector<LLQuaternion> expected = res;
+        LLTransformBatch::normalize(&res[0], count);
+        for (U32 i = 0; i < count; ++i)
+        {
+            expected[i].normalize();
+            ensure("normalize", res[i].isEqualEps(expected[i], 1e-6f));
+        }
+    }
+
+    template<> template<>
+    void transformbatch_object::test<2>()
+    {
+        set_test_name("Skeleton updates match one joint at a time");
+
+        Skeleton& one = mOne;
+        Skeleton& batched = mBatched;
+        one.animate(10);
+        batched.animate(10);
+        one.updateOneByOne();
+        batched.updateBatched();
+
+        for (S32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            ensure("world matrix", same_matrix(batched.mMatrices[i], one.mXforms[i].getWorldMatrix()));
+            ensure("same as the xform", same_matrix(batched.mMatrices[i], batched.mXforms[i].getWorldMatrix()));
+            ensure("world position", batched.mXforms[i].getWorldPosition() == one.mXforms[i].getWorldPosition());
+            ensure("world rotation", batched.mXforms[i].getWorldRotation() == one.mXforms[i].getWorldRotation());
+        }
+
+        std::vector<LLMatrix4a> inv_bind(NUM_JOINTS);
+        std::vector<const LLMatrix4a*> world(NUM_JOINTS);
+        std::vector<LLMatrix4a> palette(NUM_JOINTS);
+        for (S32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            inv_bind[i] = one.mMatrices[NUM_JOINTS - 1 - i];
+            world[i] = &batched.mMatrices[i];
+        }
+        LLTransformBatch::mul(&inv_bind[0], &world[0], &palette[0], NUM_JOINTS);
+        for (S32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            LLMatrix4a expected;
+            matMul(inv_bind[i], batched.mMatrices[i], expected);
+            ensure("palette", palette[i] == expected);
+        }
+    }
+
+    template<> template<>
+    void transformbatch_object::test<3>()
+    {
+        set_test_name("150 joint skeleton speed");
+
+        // Timing only, test<1> and test<2> already check the results
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time skeleton updates");
+        }
+
+        Skeleton& one = mOne;
+        Skeleton& batched = mBatched;
+        one.animate(0);
+        batched.animate(0);
+        const U32 frames = 20000;
+
+        LLTimer timer;
+        for (U32 frame = 0; frame < frames; ++frame)
+        {
+            one.updateOneByOne();
+        }
+        F64 one_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        for (U32 frame = 0; frame < frames; ++frame)
+        {
+            batched.updateBatched();
+        }
+        F64 batched_time = timer.getElapsedTimeF64();
+
+        ensure("same result", same_matrix(batched.mMatrices[NUM_JOINTS - 1], one.mXforms[NUM_JOINTS - 1].getWorldMatrix()));
+
+        std::vector<LLQuaternion> a(NUM_JOINTS), b(NUM_JOINTS), res(NUM_JOINTS);
+        std::vector<F32> u(NUM_JOINTS);
+        U32 seed = 9;
+        for (S32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            a[i] = random_rotation(seed);
+            b[i] = random_rotation(seed);
+            u[i] = next_random(seed);
+        }
+
+        timer.reset();
+        for (U32 frame = 0; frame < frames; ++frame)
+        {
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                res[i] = slerp(u[i], a[i], b[i]);
+            }
+            u[frame % NUM_JOINTS] = res[frame % NUM_JOINTS].mQ[VW] * 0.5f + 0.5f;
+        }
+        F64 one_slerp = timer.getElapsedTimeF64();
+
+        timer.reset();
+        for (U32 frame = 0; frame < frames; ++frame)
+        {
+            LLTransformBatch::slerp(&u[0], &a[0], &b[0], &res[0], NUM_JOINTS);
+            u[frame % NUM_JOINTS] = res[frame % NUM_JOINTS].mQ[VW] * 0.5f + 0.5f;
+        }
+        F64 batched_slerp = timer.getElapsedTimeF64();
+
+        std::cout << "\n" << NUM_JOINTS << " joints in " << one.mLevels.size() << " levels, us per skeleton: world matrices "
+                  << one_time / frames * 1000000.0 << " -> " << batched_time / frames * 1000000.0
+                  << ", slerp " << one_slerp / frames * 1000000.0 << " -> " << batched_slerp / frames * 1000000.0 << std::endl;
+    }
+}
@@ -0,0 +1,278 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Volume face BVH test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumeoctree.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+#include <vector>
+
+namespace tut
+{
+    struct volumebvh_data
+    {
+        static const S32 GRID_SIZE = 180;      // 64800 triangles
+
+        // A bumpy sphere inside the unit cube, triangulated as a
+        // latitude / longitude grid like a sculpt or a dense mesh
+        LLVolumeFace mFace;
+
+        volumebvh_data()
+        {
+            gOctreeMaxCapacity = 128;
+            gOctreeMinSize = 0.01f;
+
+            const S32 rows = GRID_SIZE + 1;
+            mFace.resizeVertices(rows * rows);
+            mFace.resizeIndices(GRID_SIZE * GRID_SIZE * 6);
+
+            for (S32 y = 0; y < rows; ++y)
+            {
+                for (S32 x = 0; x < rows; ++x)
+                {
+                    F32 theta = F_PI * y / GRID_SIZE;
+                    F32 phi = F_TWO_PI * x / GRID_SIZE;
+                    F32 r = 0.45f + 0.03f * sinf(phi * 7.f) * sinf(theta * 5.f);
+                    LLVector4a n(sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta));
+                    S32 v = y * rows + x;
+                    mFace.mNormals[v] = n;
+                    mFace.mPositions[v].setMul(n, LLVector4a(r, r, r));
+                    mFace.mTexCoords[v].set((F32)x / GRID_SIZE, (F32)y / GRID_SIZE);
+                }
+            }
+
+            U16* idx = mFace.mIndices;
+            for (S32 y = 0; y < GRID_SIZE; ++y)
+            {
+                for (S32 x = 0; x < GRID_SIZE; ++x)
+                {
+                    U16 v = (U16)(y * rows + x);
+                    *idx++ = v;
+                    *idx++ = v + rows;
+                    *idx++ = v + 1;
+                    *idx++ = v + 1;
+                    *idx++ = v + rows;
+                    *idx++ = v + rows + 1;
+                }
+            }
+
+            mFace.mExtents[0].splat(-0.5f);
+            mFace.mExtents[1].splat(0.5f);
+        }
+
+        static F32 nextRandom(U32& seed)
+        {
+            seed = seed * 1664525 + 1013904223;
+            return (F32)(seed >> 8) / (F32)(1 << 24);
+        }
+
+        // Segments from outside the sphere towards a point near its middle,
+        // with every fourth one aimed off to the side to miss
+        void makeRays(std::vector<LLVector4a>& starts, std::vector<LLVector4a>& dirs, S32 count)
+        {
+            U32 seed = 7;
+            for (S32 i = 0; i < count; ++i)
+            {
+                LLVector4a start(nextRandom(seed) - 0.5f, nextRandom(seed) - 0.5f, nextRandom(seed) - 0.5f);
+                start.normalize3fast();
+                start.mul(0.9f);
+                LLVector4a end(nextRandom(seed) * 0.2f - 0.1f, nextRandom(seed) * 0.2f - 0.1f, nextRandom(seed) * 0.2f - 0.1f);
+                if (i % 4 == 3)
+                {
+                    end.setAdd(end, LLVector4a(1.5f, 0.f, 0.f));
+                }
+                LLVector4a dir;
+                dir.setSub(end, start);
+                starts.push_back(start);
+                dirs.push_back(dir);
+            }
+        }
+    };
+    typedef test_group<volumebvh_data> volumebvh_test;
+    typedef volumebvh_test::object volumebvh_object;
+    tut::volumebvh_test volumebvh_testcase("LLVolumeBVH");
+
+    template<> template<>
+    void volumebvh_object::test<1>()
+    {
+        set_test_name("Tree covers every triangle once");
+
+        LLVolumeFace& face = mFace;
+        face.createBVH();
+        const LLVolumeBVH* bvh = face.getBVH();
+        ensure("built", bvh != NULL);
+
+        const std::vector<LLVolumeBVH::Node>& nodes = bvh->getNodes();
+        const std::vector<U32>& triangles = bvh->getTriangles();
+        ensure_equals("triangle count", (S32)triangles.size(), face.mNumIndices / 3);
+
+        std::vector<U8> seen(triangles.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const LLVolumeBVH::Node& node = nodes[i];
+            if (!node.isLeaf())
+            {
+                ensure("second child after first", node.mOffset > i + 1 && node.mOffset < nodes.size());
+                continue;
+            }
+            for (U32 t = node.mOffset; t < node.mOffset + node.mCount; ++t)
+            {
+                U32 tri = triangles[t];
+                ++seen[tri];
+                for (S32 v = 0; v < 3; ++v)
+                {
+                    const LLVector4a& p = face.mPositions[face.mIndices[tri * 3 + v]];
+                    for (S32 axis = 0; axis < 3; ++axis)
+                    {
+                        ensure("triangle inside leaf", p[axis] >= node.mMin[axis] && p[axis] <= node.mMax[axis]);
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < seen.size(); ++i)
+        {
+            ensure_equals("triangle referenced once", (S32)seen[i], 1);
+        }
+
+        face.destroyBVH();
+        ensure("destroyed", face.getBVH() == NULL);
+
+        LLVolumeFace empty;
+        empty.createBVH();
+        F32 closest_t = 2.f;
+        U32 tri;
+        F32 a, b;
+        ensure("empty face", !empty.getBVH()->intersect(empty, LLVector4a(-1.f, 0.f, 0.f), LLVector4a(2.f, 0.f, 0.f), closest_t, tri, a, b));
+    }
+
+    template<> template<>
+    void volumebvh_object::test<2>()
+    {
+        set_test_name("Hits match the octree");
+
+        LLVolumeFace& face = mFace;
+        face.createOctree();
+        face.createBVH();
+
+        std::vector<LLVector4a> starts, dirs;
+        makeRays(starts, dirs, 2000);
+
+        S32 hits = 0;
+        for (size_t i = 0; i < starts.size(); ++i)
+        {
+            F32 octree_t = 2.f;
+            LLOctreeTriangleRayIntersect intersect(starts[i], dirs[i], &face, &octree_t, NULL, NULL, NULL, NULL);
+            intersect.traverse(face.getOctree());
+
+            F32 bvh_t = 2.f;
+            U32 tri;
+            F32 a, b;
+            bool hit = face.getBVH()->intersect(face, starts[i], dirs[i], bvh_t, tri, a, b);
+
+            ensure_equals("same hit", hit, intersect.mHitFace);
+            if (hit)
+            {
+                ++hits;
+                ensure_approximately_equals("same distance", bvh_t, octree_t, 16);
+                ensure("barycentrics", a >= 0.f && b >= 0.f && a + b <= 1.001f);
+            }
+        }
+        ensure("rays hit", hits > 1000);
+    }
+
+    template<> template<>
+    void volumebvh_object::test<3>()
+    {
+        set_test_name("Build and raycast against the octree");
+
+        // Timing only, test<2> already checks the hits
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time the BVH against the octree");
+        }
+
+        LLVolumeFace& face = mFace;
+
+        std::vector<LLVector4a> starts, dirs;
+        makeRays(starts, dirs, 20000);
+
+        const S32 builds = 10;
+        LLTimer timer;
+        for (S32 i = 0; i < builds; ++i)
+        {
+            face.destroyOctree();
+            face.createOctree();
+        }
+        F64 octree_build = timer.getElapsedTimeF64() / builds;
+
+        timer.reset();
+        for (S32 i = 0; i < builds; ++i)
+        {
+            face.destroyBVH();
+            face.createBVH();
+        }
+        F64 bvh_build = timer.getElapsedTimeF64() / builds;
+
+        S32 octree_hits = 0;
+        timer.reset();
+        for (size_t i = 0; i < starts.size(); ++i)
+        {
+            F32 closest_t = 2.f;
+            LLOctreeTriangleRayIntersect intersect(starts[i], dirs[i], &face, &closest_t, NULL, NULL, NULL, NULL);
+            intersect.traverse(face.getOctree());
+            octree_hits += intersect.mHitFace;
+        }
+        F64 octree_rays = timer.getElapsedTimeF64();
+
+        S32 bvh_hits = 0;
+        timer.reset();
+        for (size_t i = 0; i < starts.size(); ++i)
+        {
+            F32 closest_t = 2.f;
+            U32 tri;
+            F32 a, b;
+            bvh_hits += face.getBVH()->intersect(face, starts[i], dirs[i], closest_t, tri, a, b);
+        }
+        F64 bvh_rays = timer.getElapsedTimeF64();
+
+        ensure_equals("hits", bvh_hits, octree_hits);
+
+        S32 num_triangles = face.mNumIndices / 3;
+        std::cout << "\n" << num_triangles << " triangles, build ms: octree " << octree_build * 1000.0
+                  << " -> bvh " << bvh_build * 1000.0
+                  << ", krays/s: octree " << (S32)(starts.size() / octree_rays / 1000.0)
+                  << " -> bvh " << (S32)(starts.size() / bvh_rays / 1000.0)
+                  << ", KB: octree triangles alone " << num_triangles * sizeof(LLVolumeTriangle) / 1024
+                  << " -> bvh " << face.getBVH()->getMemoryUsage() / 1024 << std::endl;
+    }
+}
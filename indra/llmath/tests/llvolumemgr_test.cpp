@@ -0,0 +1,283 @@
+/**
+ * @file llvolumemgr_test.cpp
+ * @brief LLVolumeMgr background generation test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../llvolume.h"
+#include "../llvolumemgr.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace tut
+{
+    struct volumemgr_data
+    {
+        // Every profile and path type, plain and hollow with a cut
+        std::vector<LLVolumeParams> mParams;
+
+        volumemgr_data()
+        {
+            const U8 profiles[] = { LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PROFILE_SQUARE, LL_PCODE_PROFILE_ISOTRI,
+                                    LL_PCODE_PROFILE_EQUALTRI, LL_PCODE_PROFILE_RIGHTTRI, LL_PCODE_PROFILE_CIRCLE_HALF };
+            const U8 paths[] = { LL_PCODE_PATH_LINE, LL_PCODE_PATH_CIRCLE, LL_PCODE_PATH_CIRCLE2, LL_PCODE_PATH_TEST };
+
+            for (U8 profile : profiles)
+            {
+                for (U8 path : paths)
+                {
+                    for (S32 hollow = 0; hollow < 2; ++hollow)
+                    {
+                        LLVolumeParams volume_params;
+                        volume_params.setType(profile, path);
+                        if (path != LL_PCODE_PATH_LINE)
+                        {
+                            volume_params.setRatio(1.f, 0.25f);
+                        }
+                        if (hollow)
+                        {
+                            volume_params.setHollow(0.5f);
+                            volume_params.setBeginAndEndS(0.125f, 0.875f);
+                        }
+                        mParams.push_back(volume_params);
+                    }
+                }
+            }
+        }
+
+        // False if the generate threads are still busy after the deadline
+        bool waitForGenerated(LLVolumeMgr& volume_mgr)
+        {
+            const F64 TIMEOUT_SECONDS = 60.0;
+            LLTimer timer;
+            volume_mgr.updateGenerated();
+            while (volume_mgr.getNumPendingGenerated() > 0)
+            {
+                if (timer.getElapsedTimeF64() > TIMEOUT_SECONDS)
+                {
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                volume_mgr.updateGenerated();
+            }
+            return true;
+        }
+    };
+    typedef test_group<volumemgr_data> volumemgr_test;
+    typedef volumemgr_test::object volumemgr_object;
+    tut::volumemgr_test volumemgr_testcase("LLVolumeMgr");
+
+    template<> template<>
+    void volumemgr_object::test<1>()
+    {
+        set_test_name("Requests without generate threads are inline");
+
+        LLVolumeMgr volume_mgr;
+        ensure("not async", !volume_mgr.isGenerateAsync());
+
+        LLVolume* volumep = volume_mgr.refVolume(mParams[0], 0);
+        ensure("no thread pool", volume_mgr.requestVolume(mParams[0], 3));
+        LLVolumeSculptMap sculpt_map;
+        ensure("sculpt inline", !volume_mgr.requestSculpt(volumep, sculpt_map));
+        ensure_equals("nothing pending", volume_mgr.getNumPendingGenerated(), 0);
+        volume_mgr.unrefVolume(volumep);
+    }
+
+    template<> template<>
+    void volumemgr_object::test<2>()
+    {
+        set_test_name("Generated LODs match inline generation");
+
+        LLVolumeMgr volume_mgr;
+        volume_mgr.startGenerateThreads(2);
+        ensure("async", volume_mgr.isGenerateAsync());
+
+        // The group has to exist for a request, as it does for an object
+        // switching LOD
+        std::vector<LLVolume*> lowest;
+        for (const LLVolumeParams& volume_params : mParams)
+        {
+            lowest.push_back(volume_mgr.refVolume(volume_params, 0));
+        }
+
+        for (const LLVolumeParams& volume_params : mParams)
+        {
+            ensure("already there", volume_mgr.requestVolume(volume_params, 0));
+            for (S32 detail = 1; detail < LLVolumeLODGroup::NUM_LODS; ++detail)
+            {
+                ensure("queued", !volume_mgr.requestVolume(volume_params, detail));
+                ensure("queued once", !volume_mgr.requestVolume(volume_params, detail));
+            }
+        }
+        ensure_equals("pending", volume_mgr.getNumPendingGenerated(), (S32)mParams.size() * (LLVolumeLODGroup::NUM_LODS - 1));
+
+        ensure("generated in time", waitForGenerated(volume_mgr));
+
+        for (const LLVolumeParams& volume_params : mParams)
+        {
+            for (S32 detail = 1; detail < LLVolumeLODGroup::NUM_LODS; ++detail)
+            {
+                ensure("ready", volume_mgr.requestVolume(volume_params, detail));
+                LLVolume* volumep = volume_mgr.refVolume(volume_params, detail);
+                LLPointer<LLVolume> inline_volume = new LLVolume(volume_params, LLVolumeLODGroup::getVolumeScaleFromDetail(detail));
+                ensure_equals("same faces", volumep->getNumVolumeFaces(), inline_volume->getNumVolumeFaces());
+                ensure_equals("same triangles", volumep->getNumTriangles(), inline_volume->getNumTriangles());
+                volume_mgr.unrefVolume(volumep);
+            }
+        }
+
+        for (LLVolume* volumep : lowest)
+        {
+            volume_mgr.unrefVolume(volumep);
+        }
+    }
+
+    template<> template<>
+    void volumemgr_object::test<3>()
+    {
+        set_test_name("Sculpt is swapped into its target");
+
+        LLVolumeMgr volume_mgr;
+        volume_mgr.startGenerateThreads(1);
+
+        LLVolumeParams volume_params;
+        volume_params.setType(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE);
+        volume_params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_SPHERE);
+
+        // A 32x32 sphere map, every pixel its own direction
+        const U16 size = 32;
+        std::vector<U8> pixels;
+        for (U16 y = 0; y < size; ++y)
+        {
+            for (U16 x = 0; x < size; ++x)
+            {
+                F32 theta = F_PI * y / (size - 1);
+                F32 phi = F_TWO_PI * x / (size - 1);
+                pixels.push_back((U8)(127.5f + 127.f * sinf(theta) * cosf(phi)));
+                pixels.push_back((U8)(127.5f + 127.f * sinf(theta) * sinf(phi)));
+                pixels.push_back((U8)(127.5f + 127.f * cosf(theta)));
+            }
+        }
+        LLVolumeSculptMap sculpt_map;
+        sculpt_map.set(size, size, 3, pixels.data(), 0, false);
+
+        LLVolume* volumep = volume_mgr.refVolume(volume_params, 3);
+        ensure("queued", volume_mgr.requestSculpt(volumep, sculpt_map));
+        ensure("pending", volume_mgr.isSculptPending(volumep));
+        ensure("queued once", volume_mgr.requestSculpt(volumep, sculpt_map));
+
+        ensure("generated in time", waitForGenerated(volume_mgr));
+        ensure("swapped", !volume_mgr.isSculptPending(volumep));
+        ensure_equals("sculpt level", (S32)volumep->getSculptLevel(), 0);
+
+        LLPointer<LLVolume> inline_volume = new LLVolume(volume_params, volumep->getDetail());
+        sculpt_map.sculpt(inline_volume);
+        ensure_equals("same triangles", volumep->getNumTriangles(), inline_volume->getNumTriangles());
+
+        volume_mgr.unrefVolume(volumep);
+    }
+
+    template<> template<>
+    void volumemgr_object::test<4>()
+    {
+        set_test_name("Generate every profile and path at every detail");
+
+        // Timing only, test<2> already checks the generated volumes
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time volume generation");
+        }
+
+        const S32 passes = 4;
+        S32 inline_triangles = 0;
+        LLTimer timer;
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            for (const LLVolumeParams& volume_params : mParams)
+            {
+                for (S32 detail = 0; detail < LLVolumeLODGroup::NUM_LODS; ++detail)
+                {
+                    LLPointer<LLVolume> volumep = new LLVolume(volume_params, LLVolumeLODGroup::getVolumeScaleFromDetail(detail));
+                    inline_triangles += volumep->getNumTriangles();
+                }
+            }
+        }
+        F64 inline_time = timer.getElapsedTimeF64();
+
+        size_t threads = llclamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+        S32 async_triangles = 0;
+        F64 main_thread_time = 0.0;
+        timer.reset();
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            LLVolumeMgr volume_mgr;
+            volume_mgr.startGenerateThreads(threads);
+
+            LLTimer main_timer;
+            std::vector<LLVolume*> lowest;
+            for (const LLVolumeParams& volume_params : mParams)
+            {
+                lowest.push_back(volume_mgr.refVolume(volume_params, 0));
+                async_triangles += lowest.back()->getNumTriangles();
+                for (S32 detail = 1; detail < LLVolumeLODGroup::NUM_LODS; ++detail)
+                {
+                    volume_mgr.requestVolume(volume_params, detail);
+                }
+            }
+            main_thread_time += main_timer.getElapsedTimeF64();
+
+            ensure("generated in time", waitForGenerated(volume_mgr));
+
+            for (const LLVolumeParams& volume_params : mParams)
+            {
+                for (S32 detail = 1; detail < LLVolumeLODGroup::NUM_LODS; ++detail)
+                {
+                    LLVolume* volumep = volume_mgr.refVolume(volume_params, detail);
+                    async_triangles += volumep->getNumTriangles();
+                    volume_mgr.unrefVolume(volumep);
+                }
+            }
+            for (LLVolume* volumep : lowest)
+            {
+                volume_mgr.unrefVolume(volumep);
+            }
+        }
+        F64 async_time = timer.getElapsedTimeF64();
+
+        ensure_equals("same triangles", async_triangles, inline_triangles);
+
+        S32 volumes = (S32)mParams.size() * LLVolumeLODGroup::NUM_LODS;
+        std::cout << "\n" << volumes << " volumes, ms per pass: inline " << inline_time * 1000.0 / passes
+                  << " -> " << threads << " threads " << async_time * 1000.0 / passes
+                  << " (main thread " << main_thread_time * 1000.0 / passes << ")" << std::endl;
+    }
+}
@@ -0,0 +1,290 @@
+/**
+ * @file llvolumeoptimize_test.cpp
+ * @brief Volume face tangent and cache optimization test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../llvolume.h"
+#include "lltimer.h"
+#include "threadpool.h"
+
+#include "../test/lltut.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    bool same_data(const void* a, const void* b, size_t size)
+    {
+        return (a == NULL) == (b == NULL) && (a == NULL || memcmp(a, b, size) == 0);
+    }
+
+    bool same_face(const LLVolumeFace& a, const LLVolumeFace& b)
+    {
+        return a.mNumVertices == b.mNumVertices && a.mNumIndices == b.mNumIndices &&
+            same_data(a.mPositions, b.mPositions, a.mNumVertices * sizeof(LLVector4a)) &&
+            same_data(a.mNormals, b.mNormals, a.mNumVertices * sizeof(LLVector4a)) &&
+            same_data(a.mTangents, b.mTangents, a.mNumVertices * sizeof(LLVector4a)) &&
+            same_data(a.mTexCoords, b.mTexCoords, a.mNumVertices * sizeof(LLVector2)) &&
+            same_data(a.mIndices, b.mIndices, a.mNumIndices * sizeof(U16));
+    }
+
+    // LLCalculateTangentArray() as it was before it worked on all three
+    // axes at once
+    void scalar_tangents(U32 vertexCount, const LLVector4a *vertex, const LLVector4a *normal,
+                         const LLVector2 *texcoord, U32 triangleCount, const U16* index_array, LLVector4a *tangent)
+    {
+        std::vector<LLVector4a> tan1(vertexCount * 2);
+        LLVector4a* tan2 = &tan1[vertexCount];
+        for (U32 i = 0; i < vertexCount * 2; i++)
+        {
+            tan1[i].clear();
+        }
+
+        for (U32 a = 0; a < triangleCount; a++)
+        {
+            U32 i1 = *index_array++;
+            U32 i2 = *index_array++;
+            U32 i3 = *index_array++;
+
+            const F32* v1ptr = vertex[i1].getF32ptr();
+            const F32* v2ptr = vertex[i2].getF32ptr();
+            const F32* v3ptr = vertex[i3].getF32ptr();
+            const LLVector2& w1 = texcoord[i1];
+            const LLVector2& w2 = texcoord[i2];
+            const LLVector2& w3 = texcoord[i3];
+
+            float x1 = v2ptr[0] - v1ptr[0];
+            float x2 = v3ptr[0] - v1ptr[0];
+            float y1 = v2ptr[1] - v1ptr[1];
+            float y2 = v3ptr[1] - v1ptr[1];
+            float z1 = v2ptr[2] - v1ptr[2];
+            float z2 = v3ptr[2] - v1ptr[2];
+
+            float s1 = w2.mV[0] - w1.mV[0];
+            float s2 = w3.mV[0] - w1.mV[0];
+            float t1 = w2.mV[1] - w1.mV[1];
+            float t2 = w3.mV[1] - w1.mV[1];
+
+            F32 rd = s1*t2-s2*t1;
+            float r = ((rd*rd) > FLT_EPSILON) ? (1.0f / rd) : ((rd > 0.0f) ? 1024.f : -1024.f);
+
+            LLVector4a sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
+            LLVector4a tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
+
+            tan1[i1].add(sdir);
+            tan1[i2].add(sdir);
+            tan1[i3].add(sdir);
+            tan2[i1].add(tdir);
+            tan2[i2].add(tdir);
+            tan2[i3].add(tdir);
+        }
+
+        for (U32 a = 0; a < vertexCount; a++)
+        {
+            LLVector4a n = normal[a];
+            const LLVector4a& t = tan1[a];
+            LLVector4a ncrosst;
+            ncrosst.setCross3(n,t);
+            n.mul(n.dot3(t).getF32());
+            LLVector4a tsubn;
+            tsubn.setSub(t,n);
+            if (tsubn.dot3(tsubn).getF32() > F_APPROXIMATELY_ZERO)
+            {
+                tsubn.normalize3fast();
+                tsubn.getF32ptr()[3] = ncrosst.dot3(tan2[a]).getF32() < 0.f ? -1.f : 1.f;
+                tangent[a] = tsubn;
+            }
+            else
+            {
+                tangent[a].set(0,0,1,1);
+            }
+        }
+    }
+}
+
+namespace tut
+{
+    struct volumeoptimize_data
+    {
+        // Faces of a finely tesselated torus, six of them with a cut and a hollow
+        std::vector<LLVolumeFace> mFaces;
+
+        volumeoptimize_data()
+        {
+            LLVolumeParams volume_params;
+            volume_params.setType(LL_PCODE_PROFILE_SQUARE | LL_PCODE_HOLE_CIRCLE, LL_PCODE_PATH_CIRCLE);
+            volume_params.setRatio(1.f, 0.25f);
+            volume_params.setHollow(0.5f);
+            volume_params.setBeginAndEndS(0.125f, 0.875f);
+            LLPointer<LLVolume> volumep = new LLVolume(volume_params, 4.f);
+            volumep->copyFacesTo(mFaces);
+        }
+    };
+    typedef test_group<volumeoptimize_data> volumeoptimize_test;
+    typedef volumeoptimize_test::object volumeoptimize_object;
+    tut::volumeoptimize_test volumeoptimize_testcase("LLVolumeOptimize");
+
+    template<> template<>
+    void volumeoptimize_object::test<1>()
+    {
+        set_test_name("Tangents match the one axis at a time version");
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+
+        for (const LLVolumeFace& face : faces)
+        {
+            std::vector<LLVector4a> expected(face.mNumVertices);
+            std::vector<LLVector4a> tangents(face.mNumVertices);
+            scalar_tangents(face.mNumVertices, face.mPositions, face.mNormals, face.mTexCoords, face.mNumIndices / 3, face.mIndices, expected.data());
+            LLCalculateTangentArray(face.mNumVertices, face.mPositions, face.mNormals, face.mTexCoords, face.mNumIndices / 3, face.mIndices, tangents.data());
+            for (S32 i = 0; i < face.mNumVertices; ++i)
+            {
+                for (S32 j = 0; j < 4; ++j)
+                {
+                    ensure_equals("tangent", tangents[i][j], expected[i][j]);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void volumeoptimize_object::test<2>()
+    {
+        set_test_name("Faces optimized on a pool and reused match one at a time");
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+        ensure("several faces", faces.size() > 4);
+
+        LLVolumeParams volume_params;
+        LLPointer<LLVolume> serial = new LLVolume(volume_params, 1.f);
+        serial->copyFacesFrom(faces);
+        ensure("serial", serial->cacheOptimize(true));
+        ensure_equals("nothing reused", serial->getNumReusedFaces(), 0);
+
+        LL::ThreadPool pool("VolumeOptimizeTest", 3);
+        pool.start();
+        LLVolume::setOptimizeThreadPool(&pool);
+
+        LLPointer<LLVolume> parallel = new LLVolume(volume_params, 1.f);
+        parallel->copyFacesFrom(faces);
+        ensure("parallel", parallel->cacheOptimize(true));
+
+        LLVolume::setOptimizeCacheSize(64 * 1024 * 1024);
+        LLPointer<LLVolume> first = new LLVolume(volume_params, 1.f);
+        first->copyFacesFrom(faces);
+        ensure("first", first->cacheOptimize(true));
+        LLPointer<LLVolume> second = new LLVolume(volume_params, 1.f);
+        second->copyFacesFrom(faces);
+        ensure("second", second->cacheOptimize(true));
+        ensure("reused", second->getNumReusedFaces() > 0);
+        LLVolume::setOptimizeCacheSize(0);
+
+        LLVolume::setOptimizeThreadPool(NULL);
+        pool.close();
+
+        for (S32 i = 0; i < serial->getNumVolumeFaces(); ++i)
+        {
+            ensure("parallel face", same_face(parallel->getVolumeFace(i), serial->getVolumeFace(i)));
+            ensure("reused face", same_face(second->getVolumeFace(i), serial->getVolumeFace(i)));
+        }
+    }
+
+    template<> template<>
+    void volumeoptimize_object::test<3>()
+    {
+        set_test_name("Optimize speed");
+
+        // Timing only, test<1> and test<2> already check the results
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time face optimization");
+        }
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+
+        const S32 passes = 20;
+        LLVolumeParams volume_params;
+        S32 num_vertices = 0;
+        for (const LLVolumeFace& face : faces)
+        {
+            num_vertices += face.mNumVertices;
+        }
+
+        LLTimer timer;
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            for (const LLVolumeFace& face : faces)
+            {
+                std::vector<LLVector4a> tangents(face.mNumVertices);
+                scalar_tangents(face.mNumVertices, face.mPositions, face.mNormals, face.mTexCoords, face.mNumIndices / 3, face.mIndices, tangents.data());
+            }
+        }
+        F64 scalar = timer.getElapsedTimeF64() / passes;
+
+        timer.reset();
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            for (const LLVolumeFace& face : faces)
+            {
+                std::vector<LLVector4a> tangents(face.mNumVertices);
+                LLCalculateTangentArray(face.mNumVertices, face.mPositions, face.mNormals, face.mTexCoords, face.mNumIndices / 3, face.mIndices, tangents.data());
+            }
+        }
+        F64 vector = timer.getElapsedTimeF64() / passes;
+
+        timer.reset();
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            LLPointer<LLVolume> volumep = new LLVolume(volume_params, 1.f);
+            volumep->copyFacesFrom(faces);
+            volumep->cacheOptimize(true);
+        }
+        F64 serial = timer.getElapsedTimeF64() / passes;
+
+        size_t threads = llclamp(std::thread::hardware_concurrency(), 2u, 8u) - 1;
+        LL::ThreadPool pool("VolumeOptimizeTest", threads);
+        pool.start();
+        LLVolume::setOptimizeThreadPool(&pool);
+        timer.reset();
+        for (S32 pass = 0; pass < passes; ++pass)
+        {
+            LLPointer<LLVolume> volumep = new LLVolume(volume_params, 1.f);
+            volumep->copyFacesFrom(faces);
+            volumep->cacheOptimize(true);
+        }
+        F64 parallel = timer.getElapsedTimeF64() / passes;
+        LLVolume::setOptimizeThreadPool(NULL);
+        pool.close();
+
+        std::cout << "\n" << faces.size() << " faces, " << num_vertices << " vertices, ms: tangents " << scalar * 1000.0
+                  << " -> " << vector * 1000.0 << ", optimize " << serial * 1000.0
+                  << " -> " << threads << " threads " << parallel * 1000.0 << std::endl;
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * @file llvolumequantize_test.cpp
+ * @brief Quantized volume face test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+
+#include "../llvolume.h"
+#include "../llvolumemgr.h"
+
+#include "../test/lltut.h"
+
+#include <vector>
+
+namespace tut
+{
+    struct volumequantize_data
+    {
+        // A torus with a hollow and a cut, with tangents, standing in for a
+        // mesh the way the mesh repository hands them over
+        LLVolumeParams mParams;
+        std::vector<LLVolumeFace> mFaces;
+
+        volumequantize_data()
+        {
+            mParams.setType(LL_PCODE_PROFILE_SQUARE | LL_PCODE_HOLE_CIRCLE, LL_PCODE_PATH_CIRCLE);
+            mParams.setRatio(1.f, 0.25f);
+            mParams.setHollow(0.5f);
+            mParams.setBeginAndEndS(0.125f, 0.875f);
+
+            LLPointer<LLVolume> volumep = new LLVolume(mParams, 4.f);
+            volumep->copyFacesTo(mFaces);
+            for (LLVolumeFace& face : mFaces)
+            {
+                face.createTangents();
+            }
+        }
+
+        static F32 maxExtent(const LLVolumeFace& face)
+        {
+            LLVector4a size;
+            size.setSub(face.mExtents[1], face.mExtents[0]);
+            return llmax(size[0], llmax(size[1], size[2]));
+        }
+    };
+    typedef test_group<volumequantize_data> volumequantize_test;
+    typedef volumequantize_test::object volumequantize_object;
+    tut::volumequantize_test volumequantize_testcase("LLVolumeQuantize");
+
+    template<> template<>
+    void volumequantize_object::test<1>()
+    {
+        set_test_name("Quantized faces decode close to the original");
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+
+        for (const LLVolumeFace& original : faces)
+        {
+            LLVolumeFace face(original);
+            ensure("quantized", face.quantize());
+            ensure("is quantized", face.isQuantized());
+            ensure("vertex data gone", face.mPositions == NULL && face.mTangents == NULL);
+            ensure_equals("vertices kept", face.mNumVertices, original.mNumVertices);
+            ensure("indices kept", face.mIndices != NULL);
+            ensure("only once", !face.quantize());
+
+            face.dequantize();
+            ensure("decoded", !face.isQuantized() && face.mPositions != NULL && face.mTangents != NULL);
+
+            F32 position_tolerance = maxExtent(original) / 65535.f;
+            for (S32 i = 0; i < face.mNumVertices; ++i)
+            {
+                for (S32 axis = 0; axis < 3; ++axis)
+                {
+                    ensure("position", fabsf(face.mPositions[i][axis] - original.mPositions[i][axis]) <= position_tolerance);
+                }
+                ensure_equals("position w", face.mPositions[i][3], original.mPositions[i][3]);
+
+                LLVector4a normal = original.mNormals[i];
+                normal.normalize3();
+                ensure("normal", face.mNormals[i].dot3(normal).getF32() > 0.99999f);
+
+                LLVector4a tangent = original.mTangents[i];
+                tangent.normalize3();
+                ensure("tangent", face.mTangents[i].dot3(tangent).getF32() > 0.9999f);
+                ensure_equals("handedness", face.mTangents[i][3], original.mTangents[i][3]);
+
+                for (S32 axis = 0; axis < 2; ++axis)
+                {
+                    F32 range = original.mTexCoordExtents[1].mV[axis] - original.mTexCoordExtents[0].mV[axis];
+                    ensure("texture coordinate", fabsf(face.mTexCoords[i].mV[axis] - original.mTexCoords[i].mV[axis]) <= llmax(range, 1.f) / 65535.f);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void volumequantize_object::test<2>()
+    {
+        set_test_name("Copies of a quantized face are full");
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+
+        LLVolumeFace face(faces[0]);
+        face.quantize();
+        LLVolumeFace copy(face);
+        ensure("copy decoded", !copy.isQuantized() && copy.mPositions != NULL);
+        ensure("source decoded", !face.isQuantized());
+
+        face.quantize();
+        face.resizeVertices(3);
+        ensure("resize drops the quantized data", !face.isQuantized());
+    }
+
+    template<> template<>
+    void volumequantize_object::test<3>()
+    {
+        set_test_name("Idle mesh LODs are quantized and decoded on access");
+
+        const std::vector<LLVolumeFace>& faces = mFaces;
+
+        LLVolumeMgr volume_mgr;
+        LLVolumeParams volume_params = mParams;
+        volume_params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_MESH);
+        LLVolume* volumep = volume_mgr.refVolume(volume_params, 3);
+        volumep->copyFacesFrom(faces);
+
+        ensure_equals("not a mesh yet", volume_mgr.quantizeIdleVolumes(), 0);
+        volumep->setMeshAssetLoaded(true);
+
+        // Looked at since the last sweep
+        volumep->getVolumeFace(0);
+        ensure_equals("recently used", volume_mgr.quantizeIdleVolumes(), 0);
+        ensure_equals("idle", volume_mgr.quantizeIdleVolumes(), 1);
+        ensure("quantized", volumep->isQuantized());
+        ensure_equals("faces kept", volumep->getNumVolumeFaces(), (S32)faces.size());
+
+        S32 triangles = 0;
+        for (const LLVolumeFace& src : faces)
+        {
+            triangles += src.mNumIndices / 3;
+        }
+        ensure_equals("counted while quantized", volumep->getNumTriangles(), triangles);
+        ensure_equals("counted while quantized 64", volumep->getNumTriangles64(), (S64)triangles);
+        ensure_equals("peek keeps counts", volumep->peekVolumeFace(1).mNumVertices, faces[1].mNumVertices);
+        ensure("counting doesn't decode", volumep->isQuantized());
+
+        const LLVolumeFace& face = volumep->getVolumeFace(1);
+        ensure("decoded on access", !volumep->isQuantized() && face.mPositions != NULL && !face.isQuantized());
+        ensure_equals("same vertices", face.mNumVertices, faces[1].mNumVertices);
+
+        ensure_equals("used again", volume_mgr.quantizeIdleVolumes(), 0);
+        ensure_equals("idle again", volume_mgr.quantizeIdleVolumes(), 1);
+
+        LLVector4a start(-2.f, 0.f, 0.f);
+        LLVector4a end(2.f, 0.f, 0.f);
+        LLVector4a hit;
+        volumep->lineSegmentIntersect(start, end, -1, &hit);
+        ensure("raycast decodes", !volumep->isQuantized());
+
+        volume_mgr.unrefVolume(volumep);
+    }
+}
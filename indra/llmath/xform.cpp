@@ -26,6 +26,7 @@
 #include "linden_common.h"
 
 #include "xform.h"
+#include "lltransformbatch.h"
 
 LLXform::LLXform()
 {
@@ -112,6 +113,78 @@ void LLXformMatrix::updateMatrix(bool update_bounds)
     }
 }
 
+// static
+void LLXformMatrix::updateMatrices(LLXformMatrix* const* xforms, LLMatrix4a* const* matrices, U32 count)
+{
+    for (U32 i = 0; i < count; i += 4)
+    {
+        U32 n = llmin(count - i, 4U);
+
+        // A short last batch repeats its last transform
+        LLXformMatrix* xform[4];
+        LLVector3 pos[4];
+        LLVector3 parent_pos[4];
+        const LLQuaternion* parent_rot[4];
+        for (U32 j = 0; j < 4; ++j)
+        {
+            LLXformMatrix* x = xforms[i + llmin(j, n - 1)];
+            xform[j] = x;
+            pos[j] = x->mPosition;
+
+            LLXform* parent = x->mParent;
+            if (parent)
+            {
+                if (parent->getScaleChildOffset())
+                {
+                    pos[j].scaleVec(parent->getScale());
+                }
+                parent_pos[j] = parent->getWorldPosition();
+                parent_rot[j] = &parent->getWorldRotation();
+            }
+            else
+            {
+                parent_rot[j] = &LLQuaternion::DEFAULT;
+            }
+        }
+
+        LLVector3x4 pos4, parent_pos4, scale4;
+        LLQuaternion4 rot4, parent_rot4;
+        pos4.load(pos[0], pos[1], pos[2], pos[3]);
+        parent_pos4.load(parent_pos[0], parent_pos[1], parent_pos[2], parent_pos[3]);
+        scale4.load(xform[0]->mScale, xform[1]->mScale, xform[2]->mScale, xform[3]->mScale);
+        rot4.load(xform[0]->mRotation, xform[1]->mRotation, xform[2]->mRotation, xform[3]->mRotation);
+        parent_rot4.load(*parent_rot[0], *parent_rot[1], *parent_rot[2], *parent_rot[3]);
+
+        // Same as update()
+        LLTransformBatch::rotate(pos4, parent_rot4, pos4);
+        for (U32 k = 0; k < 3; ++k)
+        {
+            pos4.mV[k].add(parent_pos4.mV[k]);
+        }
+        LLTransformBatch::mul(rot4, parent_rot4, rot4);
+
+        LLMatrix4a mat[4];
+        LLTransformBatch::toMatrices(scale4, rot4, pos4, mat);
+
+        LLVector3 world_pos[4];
+        LLQuaternion world_rot[4];
+        pos4.store(world_pos[0], world_pos[1], world_pos[2], world_pos[3]);
+        rot4.store(world_rot[0], world_rot[1], world_rot[2], world_rot[3]);
+
+        for (U32 j = 0; j < n; ++j)
+        {
+            LLXformMatrix* x = xform[j];
+            x->mWorldPosition = world_pos[j];
+            x->mWorldRotation = world_rot[j];
+            x->mWorldMatrix = mat[j].asMatrix4();
+            if (matrices)
+            {
+                *matrices[i + j] = mat[j];
+            }
+        }
+    }
+}
+
 void LLXformMatrix::getMinMax(LLVector3& min, LLVector3& max) const
 {
     min = mMin;
@@ -30,6 +30,8 @@
 #include "m4math.h"
 #include "llquaternion.h"
 
+class LLMatrix4a;
+
 constexpr F32 MAX_OBJECT_Z      = 4096.f; // should match REGION_HEIGHT_METERS, Pre-havok4: 768.f
 constexpr F32 MIN_OBJECT_Z      = -256.f;
 constexpr F32 DEFAULT_MAX_PRIM_SCALE = 64.f;
@@ -150,6 +152,11 @@ class LLXformMatrix : public LLXform
 
     void update();
     void updateMatrix(bool update_bounds = true);
+
+    // updateMatrix(false) for count transforms, four at a time.  Their
+    // parents must be up to date and not in the same batch.  If matrices
+    // is not NULL, *matrices[i] also gets the world matrix of xforms[i].
+    static void updateMatrices(LLXformMatrix* const* xforms, LLMatrix4a* const* matrices, U32 count);
     void getMinMax(LLVector3& min,LLVector3& max) const;
 
 protected:
@@ -0,0 +1,186 @@
+/**
+ * @file llmessagelayout.cpp
+ * @brief Flat decode tables for template messages
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmessagelayout.h"
+
+LLMessageLayout::LLMessageLayout(const LLMessageTemplate& message_template)
+{
+    mBlocks.reserve(message_template.mMemberBlocks.size());
+    for (const LLMessageBlock* blockp : message_template.mMemberBlocks)
+    {
+        Block block;
+        block.mName = blockp->mName;
+        block.mType = blockp->mType;
+        block.mNumber = blockp->mNumber;
+        block.mFirstVariable = (S32)mVariables.size();
+        block.mNumVariables = (S32)blockp->mMemberVariables.size();
+        mBlocks.push_back(block);
+
+        for (const LLMessageVariable* varp : blockp->mMemberVariables)
+        {
+            Variable variable;
+            variable.mName = varp->getName();
+            variable.mType = varp->getType();
+            variable.mSize = varp->getSize();
+            mVariables.push_back(variable);
+        }
+    }
+}
+
+S32 LLMessageLayout::findBlock(const char* name) const
+{
+    for (S32 i = 0, count = (S32)mBlocks.size(); i < count; ++i)
+    {
+        if (mBlocks[i].mName == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+S32 LLMessageLayout::findVariable(S32 block, const char* name) const
+{
+    const Block& blockr = mBlocks[block];
+    for (S32 i = 0; i < blockr.mNumVariables; ++i)
+    {
+        if (mVariables[blockr.mFirstVariable + i].mName == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+LLFlatMessage::LLFlatMessage()
+:   mLayout(NULL),
+    mBuffer(NULL)
+{
+}
+
+void LLFlatMessage::clear()
+{
+    mLayout = NULL;
+    mBuffer = NULL;
+}
+
+bool LLFlatMessage::decode(const LLMessageLayout& layout, const U8* buffer, S32 decode_pos, S32 buffer_size,
+                           S32& ran_off_end, S32& wanted)
+{
+    mLayout = &layout;
+    mBuffer = buffer;
+    mFields.clear();
+    ran_off_end = -1;
+    wanted = 0;
+
+    const S32 num_blocks = layout.getNumBlocks();
+    mBlockData.resize(num_blocks);
+
+    S32 total_blocks = 0;
+    for (S32 b = 0; b < num_blocks; ++b)
+    {
+        const LLMessageLayout::Block& block = layout.getBlock(b);
+
+        S32 repeat_number = 1;
+        if (block.mType == MBT_MULTIPLE)
+        {
+            repeat_number = block.mNumber;
+        }
+        else if (block.mType == MBT_VARIABLE)
+        {
+            // Missing variable blocks at the end of a message are legal
+            repeat_number = decode_pos < buffer_size ? buffer[decode_pos++] : 0;
+        }
+
+        mBlockData[b].mFirstField = (S32)mFields.size();
+        mBlockData[b].mCount = repeat_number;
+        total_blocks += repeat_number;
+
+        for (S32 i = 0; i < repeat_number; ++i)
+        {
+            for (S32 v = 0; v < block.mNumVariables; ++v)
+            {
+                const LLMessageLayout::Variable& variable = layout.getVariable(b, v);
+                Field field;
+                if (variable.mType == MVT_VARIABLE)
+                {
+                    // Little endian length prefix of 1, 2 or 4 bytes
+                    S32 length = 0;
+                    if (decode_pos + variable.mSize > buffer_size)
+                    {
+                        if (ran_off_end < 0)
+                        {
+                            ran_off_end = decode_pos;
+                            wanted = variable.mSize;
+                        }
+                    }
+                    else
+                    {
+                        for (S32 byte = variable.mSize - 1; byte >= 0; --byte)
+                        {
+                            length = (length << 8) | buffer[decode_pos + byte];
+                        }
+                    }
+                    decode_pos += variable.mSize;
+                    field.mSize = length;
+                }
+                else
+                {
+                    field.mSize = variable.mSize;
+                }
+
+                if (decode_pos + field.mSize > buffer_size)
+                {
+                    if (ran_off_end < 0)
+                    {
+                        ran_off_end = decode_pos;
+                        wanted = field.mSize;
+                    }
+                    field.mOffset = -1;
+                    if ((S32)mZeros.size() < field.mSize)
+                    {
+                        mZeros.resize(field.mSize, 0);
+                    }
+                }
+                else
+                {
+                    field.mOffset = decode_pos;
+                }
+                decode_pos += field.mSize;
+                mFields.push_back(field);
+            }
+        }
+    }
+
+    if (mZeros.empty())
+    {
+        mZeros.push_back(0);
+    }
+
+    return total_blocks > 0 || num_blocks == 0;
+}
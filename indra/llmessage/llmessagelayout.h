@@ -0,0 +1,126 @@
+/**
+ * @file llmessagelayout.h
+ * @brief Flat decode tables for template messages
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGELAYOUT_H
+#define LL_LLMESSAGELAYOUT_H
+
+#include <vector>
+
+#include "llmessagetemplate.h"
+
+// A message template flattened into arrays, in template order. Compiled
+// once per template by LLMessageTemplate::compileLayout().
+class LLMessageLayout
+{
+public:
+    struct Block
+    {
+        char*           mName;
+        EMsgBlockType   mType;
+        S32             mNumber;        // repeat count of MBT_MULTIPLE blocks
+        S32             mFirstVariable; // index in mVariables
+        S32             mNumVariables;
+    };
+
+    struct Variable
+    {
+        char*               mName;
+        EMsgVariableType    mType;
+        S32                 mSize;      // size of the length prefix for MVT_VARIABLE
+    };
+
+    LLMessageLayout(const LLMessageTemplate& message_template);
+
+    // Names are the canonical string table pointers, returns -1 when not found
+    S32 findBlock(const char* name) const;
+    // Variable index within the block
+    S32 findVariable(S32 block, const char* name) const;
+
+    const Block& getBlock(S32 block) const                      { return mBlocks[block]; }
+    const Variable& getVariable(S32 block, S32 variable) const  { return mVariables[mBlocks[block].mFirstVariable + variable]; }
+    S32 getNumBlocks() const                                    { return (S32)mBlocks.size(); }
+
+private:
+    std::vector<Block>      mBlocks;
+    std::vector<Variable>   mVariables;
+};
+
+// One received message decoded against an LLMessageLayout in a single
+// pass. Fields point into the receive buffer, nothing is copied, so the
+// data is only valid while that buffer is, i.e. until the next message.
+class LLFlatMessage
+{
+public:
+    LLFlatMessage();
+
+    // Returns false if the message has no blocks while its template has some.
+    // Sets ran_off_end/wanted to the first read past buffer_size, -1 if none;
+    // such fields read as zeros.
+    bool decode(const LLMessageLayout& layout, const U8* buffer, S32 decode_pos, S32 buffer_size,
+                S32& ran_off_end, S32& wanted);
+    void clear();
+
+    bool isDecoded() const                  { return mLayout != NULL; }
+    const LLMessageLayout* getLayout() const { return mLayout; }
+
+    S32 getNumberOfBlocks(S32 block) const  { return mBlockData[block].mCount; }
+    S32 getSize(S32 block, S32 blocknum, S32 variable) const
+    {
+        return getField(block, blocknum, variable).mSize;
+    }
+    const U8* getData(S32 block, S32 blocknum, S32 variable) const
+    {
+        const Field& field = getField(block, blocknum, variable);
+        return field.mOffset >= 0 ? mBuffer + field.mOffset : mZeros.data();
+    }
+
+private:
+    struct Field
+    {
+        S32 mOffset;    // into mBuffer, -1 past the end of the packet
+        S32 mSize;
+    };
+
+    struct BlockData
+    {
+        S32 mFirstField;
+        S32 mCount;
+    };
+
+    const Field& getField(S32 block, S32 blocknum, S32 variable) const
+    {
+        llassert(blocknum >= 0 && blocknum < mBlockData[block].mCount);
+        return mFields[mBlockData[block].mFirstField + blocknum * mLayout->getBlock(block).mNumVariables + variable];
+    }
+
+    const LLMessageLayout*  mLayout;
+    const U8*               mBuffer;
+    std::vector<BlockData>  mBlockData;
+    std::vector<Field>      mFields;
+    std::vector<U8>         mZeros;     // backs fields that ran off the end
+};
+
+#endif // LL_LLMESSAGELAYOUT_H
@@ -29,6 +29,7 @@
 
 #include "stdtypes.h"
 
+class LLFlatMessage;
 class LLHost;
 class LLMessageBuilder;
 class LLMsgData;
@@ -84,6 +85,10 @@ class LLMessageReader
 
     virtual void copyToBuilder(LLMessageBuilder&) const = 0;
 
+    // Flat tables of the current message if it was decoded into them, see
+    // llmessageviews.h. NULL otherwise.
+    virtual const LLFlatMessage* getFlatMessage() const { return NULL; }
+
 
     static void setTimeDecodes(bool b);
     static bool getTimeDecodes();
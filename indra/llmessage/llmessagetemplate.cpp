@@ -28,6 +28,7 @@
 
 #include "llmessagetemplate.h"
 
+#include "llmessagelayout.h"
 #include "message.h"
 
 void LLMsgVarData::addData(const void *data, S32 size, EMsgVariableType type, S32 data_size)
@@ -171,6 +172,23 @@ std::ostream& operator<<(std::ostream& s, LLMessageTemplate &msg)
     return s;
 }
 
+LLMessageTemplate::~LLMessageTemplate()
+{
+    for_each(mMemberBlocks.begin(), mMemberBlocks.end(), DeletePointer());
+    delete mLayout;
+}
+
+void LLMessageTemplate::compileLayout()
+{
+#if LL_LITTLE_ENDIAN
+    // Flat fields are read in wire order, which only matches host order here
+    if (!mLayout)
+    {
+        mLayout = new LLMessageLayout(*this);
+    }
+#endif
+}
+
 void LLMessageTemplate::banUdp()
 {
     static const char* deprecation[] = {
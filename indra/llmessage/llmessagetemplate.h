@@ -31,6 +31,8 @@
 #include "llstl.h"
 #include "llindexedvector.h"
 
+class LLMessageLayout;
+
 class LLMsgVarData
 {
 public:
@@ -287,15 +289,13 @@ class LLMessageTemplate
         mBanFromTrusted(false),
         mBanFromUntrusted(false),
         mHandlerFunc(NULL),
-        mUserData(NULL)
+        mUserData(NULL),
+        mLayout(NULL)
     {
         mName = LLMessageStringTable::getInstance()->getString(name);
     }
 
-    ~LLMessageTemplate()
-    {
-        for_each(mMemberBlocks.begin(), mMemberBlocks.end(), DeletePointer());
-    }
+    ~LLMessageTemplate();
 
     void addBlock(LLMessageBlock *blockp)
     {
@@ -385,6 +385,12 @@ class LLMessageTemplate
 
     friend std::ostream&     operator<<(std::ostream& s, LLMessageTemplate &msg);
 
+    // Received messages with a compiled layout are decoded into flat tables
+    // instead of LLMsgData, see LLFlatMessage. Done for the messages the
+    // typed views in llmessageviews.h read.
+    void compileLayout();
+    const LLMessageLayout* getLayout() const    { return mLayout; }
+
     const LLMessageBlock* getBlock(char* name) const
     {
         message_block_map_t::const_iterator iter = mMemberBlocks.find(name);
@@ -416,6 +422,8 @@ class LLMessageTemplate
     // message handler function (this is set by each application)
     void                                    (*mHandlerFunc)(LLMessageSystem *msgsystem, void **user_data);
     void                                    **mUserData;
+
+    LLMessageLayout*                        mLayout;
 };
 
 #endif // LL_LLMESSAGETEMPLATE_H
@@ -0,0 +1,298 @@
+/**
+ * @file llmessageviews.cpp
+ * @brief Typed accessors for the busiest template messages
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmessageviews.h"
+
+#include "llmessagereader.h"
+
+// Field lists follow message_template.msg. A field that doesn't match the
+// loaded template makes its view fall back to reading by name.
+
+LLMessageFieldTable LLObjectUpdateView::sFields("ObjectUpdate",
+{
+    { "RegionData", "RegionHandle", MVT_U64 },
+    { "RegionData", "TimeDilation", MVT_U16 },
+    { "ObjectData", "ID",           MVT_U32 },
+    { "ObjectData", "FullID",       MVT_LLUUID },
+    { "ObjectData", "CRC",          MVT_U32 },
+    { "ObjectData", "PCode",        MVT_U8 },
+    { "ObjectData", "ParentID",     MVT_U32 },
+    { "ObjectData", "UpdateFlags",  MVT_U32 },
+});
+
+LLMessageFieldTable LLTerseObjectUpdateView::sFields("ImprovedTerseObjectUpdate",
+{
+    { "RegionData", "RegionHandle", MVT_U64 },
+    { "RegionData", "TimeDilation", MVT_U16 },
+    { "ObjectData", "Data",         MVT_VARIABLE },
+    { "ObjectData", "TextureEntry", MVT_VARIABLE },
+});
+
+LLMessageFieldTable LLCoarseLocationUpdateView::sFields("CoarseLocationUpdate",
+{
+    { "Location",   "X",            MVT_U8 },
+    { "Location",   "Y",            MVT_U8 },
+    { "Location",   "Z",            MVT_U8 },
+    { "Index",      "You",          MVT_S16 },
+    { "Index",      "Prey",         MVT_S16 },
+    { "AgentData",  "AgentID",      MVT_LLUUID },
+});
+
+LLMessageFieldTable LLLayerDataView::sFields("LayerData",
+{
+    { "LayerID",    "Type",         MVT_U8 },
+    { "LayerData",  "Data",         MVT_VARIABLE },
+});
+
+static std::vector<LLMessageFieldTable*>& field_tables()
+{
+    static std::vector<LLMessageFieldTable*> tables;
+    return tables;
+}
+
+LLMessageFieldTable::LLMessageFieldTable(const char* message, std::initializer_list<Field> fields)
+:   mMessage(message),
+    mFields(fields),
+    mLayout(NULL)
+{
+    field_tables().push_back(this);
+}
+
+//static
+void LLMessageFieldTable::bindAll(const LLMessageSystem::message_template_name_map_t& templates)
+{
+    for (LLMessageFieldTable* table : field_tables())
+    {
+        table->bind(templates);
+    }
+}
+
+void LLMessageFieldTable::bind(const LLMessageSystem::message_template_name_map_t& templates)
+{
+    mLayout = NULL;
+
+    // Template maps are keyed by the canonical name pointers, and so are the
+    // named getters the views fall back to.
+    LLMessageStringTable* strings = LLMessageStringTable::getInstance();
+    mMessage = strings->getString(mMessage);
+    for (Field& field : mFields)
+    {
+        field.mBlock = strings->getString(field.mBlock);
+        field.mVariable = strings->getString(field.mVariable);
+        field.mBlockIndex = -1;
+        field.mVariableIndex = -1;
+    }
+
+    LLMessageSystem::message_template_name_map_t::const_iterator iter = templates.find(mMessage);
+    if (iter == templates.end())
+    {
+        return;
+    }
+
+    LLMessageTemplate* templatep = iter->second;
+    templatep->compileLayout();
+    const LLMessageLayout* layout = templatep->getLayout();
+    if (!layout)
+    {
+        return;
+    }
+
+    for (Field& field : mFields)
+    {
+        field.mBlockIndex = layout->findBlock(field.mBlock);
+        if (field.mBlockIndex >= 0)
+        {
+            field.mVariableIndex = layout->findVariable(field.mBlockIndex, field.mVariable);
+        }
+        if (field.mVariableIndex < 0
+            || layout->getVariable(field.mBlockIndex, field.mVariableIndex).mType != field.mType)
+        {
+            LL_WARNS("Messaging") << mMessage << " " << field.mBlock << "." << field.mVariable
+                << " doesn't match the message template, reading the message by name" << LL_ENDL;
+            return;
+        }
+    }
+
+    mLayout = layout;
+}
+
+LLMessageView::LLMessageView(LLMessageSystem* msg, const LLMessageFieldTable& fields)
+:   LLMessageView(msg->mMessageReader.get(), fields)
+{
+}
+
+LLMessageView::LLMessageView(LLMessageReader* reader, const LLMessageFieldTable& fields)
+:   mReader(reader),
+    mFields(fields),
+    mFlat(NULL)
+{
+    const LLFlatMessage* flat = reader->getFlatMessage();
+    if (flat && fields.getLayout() && flat->getLayout() == fields.getLayout())
+    {
+        mFlat = flat;
+    }
+}
+
+S32 LLMessageView::getNumberOfBlocks(S32 field) const
+{
+    if (mFlat)
+    {
+        return mFlat->getNumberOfBlocks(mFields[field].mBlockIndex);
+    }
+    return mReader->getNumberOfBlocks(mFields[field].mBlock);
+}
+
+S32 LLMessageView::getSize(S32 field, S32 blocknum) const
+{
+    const LLMessageFieldTable::Field& f = mFields[field];
+    if (mFlat)
+    {
+        if (blocknum >= mFlat->getNumberOfBlocks(f.mBlockIndex))
+        {
+            return LL_BLOCK_NOT_IN_MESSAGE;
+        }
+        return mFlat->getSize(f.mBlockIndex, blocknum, f.mVariableIndex);
+    }
+    return mReader->getSize(f.mBlock, blocknum, f.mVariable);
+}
+
+void LLMessageView::getBinaryData(S32 field, void* datap, S32 max_size, S32 blocknum) const
+{
+    const LLMessageFieldTable::Field& f = mFields[field];
+    if (mFlat)
+    {
+        S32 size = mFlat->getSize(f.mBlockIndex, blocknum, f.mVariableIndex);
+        if (size > max_size)
+        {
+            LL_WARNS("Messaging") << f.mBlock << "." << f.mVariable << " is size " << size
+                << " but truncated to max size of " << max_size << LL_ENDL;
+            size = max_size;
+        }
+        memcpy(datap, getFlatData(field, blocknum), size); /*Flawfinder: ignore*/
+        return;
+    }
+    mReader->getBinaryData(f.mBlock, f.mVariable, datap, 0, blocknum, max_size);
+}
+
+S8 LLMessageView::getS8(S32 field, S32 blocknum) const
+{
+    S8 value = 0;
+    if (mFlat)
+    {
+        value = (S8)*getFlatData(field, blocknum);
+    }
+    else
+    {
+        mReader->getS8(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+U8 LLMessageView::getU8(S32 field, S32 blocknum) const
+{
+    U8 value = 0;
+    if (mFlat)
+    {
+        value = *getFlatData(field, blocknum);
+    }
+    else
+    {
+        mReader->getU8(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+S16 LLMessageView::getS16(S32 field, S32 blocknum) const
+{
+    S16 value = 0;
+    if (mFlat)
+    {
+        memcpy(&value, getFlatData(field, blocknum), sizeof(value));
+    }
+    else
+    {
+        mReader->getS16(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+U16 LLMessageView::getU16(S32 field, S32 blocknum) const
+{
+    U16 value = 0;
+    if (mFlat)
+    {
+        memcpy(&value, getFlatData(field, blocknum), sizeof(value));
+    }
+    else
+    {
+        mReader->getU16(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+U32 LLMessageView::getU32(S32 field, S32 blocknum) const
+{
+    U32 value = 0;
+    if (mFlat)
+    {
+        memcpy(&value, getFlatData(field, blocknum), sizeof(value));
+    }
+    else
+    {
+        mReader->getU32(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+U64 LLMessageView::getU64(S32 field, S32 blocknum) const
+{
+    U64 value = 0;
+    if (mFlat)
+    {
+        memcpy(&value, getFlatData(field, blocknum), sizeof(value));
+    }
+    else
+    {
+        mReader->getU64(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
+
+LLUUID LLMessageView::getUUID(S32 field, S32 blocknum) const
+{
+    LLUUID value;
+    if (mFlat)
+    {
+        memcpy(value.mData, getFlatData(field, blocknum), UUID_BYTES);
+    }
+    else
+    {
+        mReader->getUUID(mFields[field].mBlock, mFields[field].mVariable, value, blocknum);
+    }
+    return value;
+}
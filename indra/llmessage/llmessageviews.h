@@ -0,0 +1,185 @@
+/**
+ * @file llmessageviews.h
+ * @brief Typed accessors for the busiest template messages
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGEVIEWS_H
+#define LL_LLMESSAGEVIEWS_H
+
+#include <initializer_list>
+#include <vector>
+
+#include "llmessagelayout.h"
+#include "lluuid.h"
+#include "message.h"
+
+// The fields one of the views below reads. Resolved against the message
+// template when it is loaded, which also compiles the template's layout so
+// those messages get decoded into flat tables.
+class LLMessageFieldTable
+{
+public:
+    struct Field
+    {
+        const char*         mBlock;
+        const char*         mVariable;
+        EMsgVariableType    mType;
+        S32                 mBlockIndex;
+        S32                 mVariableIndex;
+    };
+
+    LLMessageFieldTable(const char* message, std::initializer_list<Field> fields);
+
+    // Called by LLMessageSystem once the template file is loaded
+    static void bindAll(const LLMessageSystem::message_template_name_map_t& templates);
+
+    const Field& operator[](S32 field) const    { return mFields[field]; }
+    // NULL when the template doesn't match the table
+    const LLMessageLayout* getLayout() const    { return mLayout; }
+
+private:
+    void bind(const LLMessageSystem::message_template_name_map_t& templates);
+
+    const char*             mMessage;
+    std::vector<Field>      mFields;
+    const LLMessageLayout*  mLayout;
+};
+
+// Reads the current message straight from its flat tables when it was
+// decoded with the table's layout, no name lookups. Falls back to the named
+// reader getters otherwise, e.g. for messages that came in as LLSD.
+class LLMessageView
+{
+public:
+    bool isFlat() const                 { return mFlat != NULL; }
+
+protected:
+    LLMessageView(LLMessageSystem* msg, const LLMessageFieldTable& fields);
+    // A reader other than the message system's current one
+    LLMessageView(LLMessageReader* reader, const LLMessageFieldTable& fields);
+
+    S32     getNumberOfBlocks(S32 field) const;
+    S32     getSize(S32 field, S32 blocknum) const;
+    void    getBinaryData(S32 field, void* datap, S32 max_size, S32 blocknum) const;
+
+    S8      getS8(S32 field, S32 blocknum) const;
+    U8      getU8(S32 field, S32 blocknum) const;
+    S16     getS16(S32 field, S32 blocknum) const;
+    U16     getU16(S32 field, S32 blocknum) const;
+    U32     getU32(S32 field, S32 blocknum) const;
+    U64     getU64(S32 field, S32 blocknum) const;
+    LLUUID  getUUID(S32 field, S32 blocknum) const;
+
+private:
+    const U8* getFlatData(S32 field, S32 blocknum) const
+    {
+        const LLMessageFieldTable::Field& f = mFields[field];
+        return mFlat->getData(f.mBlockIndex, blocknum, f.mVariableIndex);
+    }
+
+    LLMessageReader*            mReader;
+    const LLMessageFieldTable&  mFields;
+    const LLFlatMessage*        mFlat;
+};
+
+// ObjectUpdate, the header and identity of full object updates
+class LLObjectUpdateView : public LLMessageView
+{
+public:
+    LLObjectUpdateView(LLMessageSystem* msg) : LLMessageView(msg, sFields) {}
+    LLObjectUpdateView(LLMessageReader* reader) : LLMessageView(reader, sFields) {}
+
+    U64     getRegionHandle() const             { return getU64(REGION_HANDLE, 0); }
+    U16     getTimeDilation() const             { return getU16(TIME_DILATION, 0); }
+    S32     getNumObjects() const               { return getNumberOfBlocks(ID); }
+    U32     getID(S32 i) const                  { return getU32(ID, i); }
+    LLUUID  getFullID(S32 i) const              { return getUUID(FULL_ID, i); }
+    U32     getCRC(S32 i) const                 { return getU32(CRC, i); }
+    U8      getPCode(S32 i) const               { return getU8(PCODE, i); }
+    U32     getParentID(S32 i) const            { return getU32(PARENT_ID, i); }
+    U32     getUpdateFlags(S32 i) const         { return getU32(UPDATE_FLAGS, i); }
+
+private:
+    enum { REGION_HANDLE, TIME_DILATION, ID, FULL_ID, CRC, PCODE, PARENT_ID, UPDATE_FLAGS };
+    static LLMessageFieldTable sFields;
+};
+
+// ImprovedTerseObjectUpdate
+class LLTerseObjectUpdateView : public LLMessageView
+{
+public:
+    LLTerseObjectUpdateView(LLMessageSystem* msg) : LLMessageView(msg, sFields) {}
+    LLTerseObjectUpdateView(LLMessageReader* reader) : LLMessageView(reader, sFields) {}
+
+    U64     getRegionHandle() const             { return getU64(REGION_HANDLE, 0); }
+    U16     getTimeDilation() const             { return getU16(TIME_DILATION, 0); }
+    S32     getNumObjects() const               { return getNumberOfBlocks(DATA); }
+    S32     getDataSize(S32 i) const            { return getSize(DATA, i); }
+    void    getData(S32 i, U8* datap, S32 max_size) const { getBinaryData(DATA, datap, max_size, i); }
+    S32     getTextureEntrySize(S32 i) const    { return getSize(TEXTURE_ENTRY, i); }
+    void    getTextureEntry(S32 i, U8* datap, S32 max_size) const { getBinaryData(TEXTURE_ENTRY, datap, max_size, i); }
+
+private:
+    enum { REGION_HANDLE, TIME_DILATION, DATA, TEXTURE_ENTRY };
+    static LLMessageFieldTable sFields;
+};
+
+// CoarseLocationUpdate
+class LLCoarseLocationUpdateView : public LLMessageView
+{
+public:
+    LLCoarseLocationUpdateView(LLMessageSystem* msg) : LLMessageView(msg, sFields) {}
+    LLCoarseLocationUpdateView(LLMessageReader* reader) : LLMessageView(reader, sFields) {}
+
+    S32     getNumLocations() const             { return getNumberOfBlocks(X); }
+    U8      getX(S32 i) const                   { return getU8(X, i); }
+    U8      getY(S32 i) const                   { return getU8(Y, i); }
+    U8      getZ(S32 i) const                   { return getU8(Z, i); }
+    S16     getYou() const                      { return getS16(YOU, 0); }
+    S16     getPrey() const                     { return getS16(PREY, 0); }
+    S32     getNumAgents() const                { return getNumberOfBlocks(AGENT_ID); }
+    LLUUID  getAgentID(S32 i) const             { return getUUID(AGENT_ID, i); }
+
+private:
+    enum { X, Y, Z, YOU, PREY, AGENT_ID };
+    static LLMessageFieldTable sFields;
+};
+
+// LayerData
+class LLLayerDataView : public LLMessageView
+{
+public:
+    LLLayerDataView(LLMessageSystem* msg) : LLMessageView(msg, sFields) {}
+    LLLayerDataView(LLMessageReader* reader) : LLMessageView(reader, sFields) {}
+
+    S8      getType() const                     { return getS8(TYPE, 0); }
+    S32     getDataSize() const                 { return getSize(DATA, 0); }
+    void    getData(U8* datap, S32 max_size) const { getBinaryData(DATA, datap, max_size, 0); }
+
+private:
+    enum { TYPE, DATA };
+    static LLMessageFieldTable sFields;
+};
+
+#endif // LL_LLMESSAGEVIEWS_H
@@ -34,7 +34,12 @@
 
 ///////////////////////////////////////////////////////////
 
-LLPacketBuffer::LLPacketBuffer(const LLHost &host, const char *datap, const S32 size) : mHost(host)
+LLPacketBuffer::LLPacketBuffer() : mSize(0), mReceiveTime(0.0)
+{
+    mData[0] = '!';
+}
+
+LLPacketBuffer::LLPacketBuffer(const LLHost &host, const char *datap, const S32 size) : mHost(host), mReceiveTime(0.0)
 {
     mSize = 0;
     mData[0] = '!';
@@ -72,5 +77,6 @@ void LLPacketBuffer::init (S32 hSocket)
     mSize = receive_packet(hSocket, mData);
     mHost = ::get_sender();
     mReceivingIF = ::get_receiving_interface();
+    mReceiveTime = mSize > 0 ? LLTimer::getTotalSeconds().value() : 0.0;
 }
 
@@ -34,6 +34,7 @@
 class LLPacketBuffer
 {
 public:
+    LLPacketBuffer();                      // empty slot, see LLPacketThread
     LLPacketBuffer(const LLHost &host, const char *datap, const S32 size);
     LLPacketBuffer(S32 hSocket);           // receive a packet
     ~LLPacketBuffer();
@@ -42,6 +43,7 @@ class LLPacketBuffer
     const char  *getData() const                { return mData; }
     LLHost      getHost() const                 { return mHost; }
     LLHost      getReceivingInterface() const   { return mReceivingIF; }
+    F64         getReceiveTime() const          { return mReceiveTime; }
     void init(S32 hSocket);
 
 protected:
@@ -49,6 +51,7 @@ class LLPacketBuffer
     S32     mSize;          // size of buffer in bytes
     LLHost  mHost;         // source/dest IP and port
     LLHost  mReceivingIF;         // source/dest IP and port
+    F64     mReceiveTime;   // LLTimer::getTotalSeconds() when init() received it, 0 otherwise
 };
 
 #endif
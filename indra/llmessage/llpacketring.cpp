@@ -55,13 +55,19 @@ LLPacketRing::LLPacketRing () :
     mInBufferLength(0),
     mOutBufferLength(0),
     mDropPercentage(0.0f),
-    mPacketsToDrop(0x0)
+    mPacketsToDrop(0x0),
+    mLastReceiveTime(0.0),
+    mUseBatchIO(false),
+    mReceiveCount(0),
+    mReceiveNext(0),
+    mSendCount(0)
 {
 }
 
 ///////////////////////////////////////////////////////////
 LLPacketRing::~LLPacketRing ()
 {
+    stopReceiveThread();
     cleanup();
 }
 
@@ -116,6 +122,116 @@ void LLPacketRing::setOutBandwidth(const F32 bps)
 {
     mOutThrottle.setRate(bps);
 }
+
+void LLPacketRing::setUseBatchIO(bool use_batch_io)
+{
+    mUseBatchIO = use_batch_io;
+    if (mUseBatchIO && mReceiveSlab.empty())
+    {
+        mReceiveSlab.resize(NET_BATCH_SIZE * NET_BUFFER_SIZE);
+        mSendSlab.resize(NET_BATCH_SIZE * NET_BUFFER_SIZE);
+    }
+}
+
+void LLPacketRing::startReceiveThread(S32 socket)
+{
+    if (!mReceiveThread)
+    {
+        mReceiveThread = std::make_unique<LLPacketThread>(socket);
+        mReceiveThread->start();
+    }
+}
+
+void LLPacketRing::stopReceiveThread()
+{
+    if (mReceiveThread)
+    {
+        mReceiveThread->shutdown();
+        // Packets still queued are lost, same as if they'd never been read
+        mReceiveThread.reset();
+    }
+}
+
+///////////////////////////////////////////////////////////
+S32 LLPacketRing::receiveFromThread(char *datap)
+{
+    const LLPacketBuffer* packetp = mReceiveThread->front();
+    if (!packetp)
+    {
+        return 0;
+    }
+
+    S32 packet_size = packetp->getSize();
+    memcpy(datap, packetp->getData(), packet_size); /*Flawfinder: ignore*/
+    mLastSender = packetp->getHost();
+    mLastReceivingIF = packetp->getReceivingInterface();
+    mLastReceiveTime = packetp->getReceiveTime();
+    mReceiveThread->pop();
+    return packet_size;
+}
+
+S32 LLPacketRing::receiveFromNet(S32 socket, char *datap)
+{
+    if (mReceiveThread)
+    {
+        return receiveFromThread(datap);
+    }
+
+    mLastReceiveTime = 0.0;
+    if (mUseBatchIO || mReceiveNext < mReceiveCount)
+    {
+        // Also drains what is left in the slab after batching got turned off
+        return receiveFromSlab(socket, datap);
+    }
+
+    S32 packet_size = receive_packet(socket, datap);
+    mLastSender = ::get_sender();
+    mLastReceivingIF = ::get_receiving_interface();
+    return packet_size;
+}
+
+///////////////////////////////////////////////////////////
+S32 LLPacketRing::receiveFromSlab(S32 socket, char *datap)
+{
+    if (mReceiveNext >= mReceiveCount)
+    {
+        if (!mUseBatchIO)
+        {
+            return 0;
+        }
+        // Slab used up, drain whatever the socket has queued in one go
+        mReceiveNext = 0;
+        mReceiveCount = receive_packets(socket, mReceiveSlab.data(), mReceiveSizes, mReceiveSenders, mReceiveIFs, NET_BATCH_SIZE);
+        if (!mReceiveCount)
+        {
+            return 0;
+        }
+    }
+
+    S32 packet_size = mReceiveSizes[mReceiveNext];
+    memcpy(datap, &mReceiveSlab[mReceiveNext * NET_BUFFER_SIZE], packet_size); /*Flawfinder: ignore*/
+    mLastSender = mReceiveSenders[mReceiveNext];
+    mLastReceivingIF = mReceiveIFs[mReceiveNext];
+    mReceiveNext++;
+    return packet_size;
+}
+
+S32 LLPacketRing::flushSends(int h_socket)
+{
+    if (!mSendCount)
+    {
+        return 0;
+    }
+
+    const char* buffers[NET_BATCH_SIZE];
+    for (S32 i = 0; i < mSendCount; i++)
+    {
+        buffers[i] = &mSendSlab[i * NET_BUFFER_SIZE];
+    }
+    S32 failed = mSendCount - send_packets(h_socket, buffers, mSendSizes, mSendHosts, mSendCount);
+    mSendCount = 0;
+    return failed;
+}
 ///////////////////////////////////////////////////////////
 S32 LLPacketRing::receiveFromRing (S32 socket, char *datap)
 {
@@ -167,7 +283,19 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
         while (!done)
         {
             LLPacketBuffer *packetp;
-            packetp = new LLPacketBuffer(socket);
+            if (mReceiveThread)
+            {
+                packetp = new LLPacketBuffer();
+                if (const LLPacketBuffer* queuedp = mReceiveThread->front())
+                {
+                    *packetp = *queuedp;
+                    mReceiveThread->pop();
+                }
+            }
+            else
+            {
+                packetp = new LLPacketBuffer(socket);
+            }
 
             if (packetp->getSize())
             {
@@ -227,7 +355,7 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
         if (LLProxy::isSOCKSProxyEnabled())
         {
             U8 buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
-            packet_size = receive_packet(socket, static_cast<char*>(static_cast<void*>(buffer)));
+            packet_size = receiveFromNet(socket, static_cast<char*>(static_cast<void*>(buffer)));
 
             if (packet_size > SOCKS_HEADER_SIZE)
             {
@@ -246,12 +374,9 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
         }
         else
         {
-            packet_size = receive_packet(socket, datap);
-            mLastSender = ::get_sender();
+            packet_size = receiveFromNet(socket, datap);
         }
 
-        mLastReceivingIF = ::get_receiving_interface();
-
         if (packet_size)  // did we actually get a packet?
         {
             if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
@@ -275,6 +400,19 @@ bool LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LL
     bool status = true;
     if (!mUseOutThrottle)
     {
+        if (mUseBatchIO && !LLProxy::isSOCKSProxyEnabled() && buf_size <= NET_BUFFER_SIZE)
+        {
+            // Queue it up for the next flushSends()
+            if (mSendCount == NET_BATCH_SIZE)
+            {
+                status = (flushSends(h_socket) == 0);
+            }
+            memcpy(&mSendSlab[mSendCount * NET_BUFFER_SIZE], send_buffer, buf_size); /*Flawfinder: ignore*/
+            mSendSizes[mSendCount] = buf_size;
+            mSendHosts[mSendCount] = host;
+            mSendCount++;
+            return status;
+        }
         return sendPacketImpl(h_socket, send_buffer, buf_size, host );
     }
     else
@@ -28,10 +28,13 @@
 #ifndef LL_LLPACKETRING_H
 #define LL_LLPACKETRING_H
 
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include "llhost.h"
 #include "llpacketbuffer.h"
+#include "llpacketthread.h"
 #include "llproxy.h"
 #include "llthrottle.h"
 #include "net.h"
@@ -55,6 +58,25 @@ class LLPacketRing
 
     bool sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
+    // Batched I/O: receivePacket() drains the socket NET_BATCH_SIZE datagrams at a
+    // time into a slab, and sendPacket() queues datagrams until flushSends().
+    // Sends are only batched when neither the out throttle nor a SOCKS proxy are in use.
+    void setUseBatchIO(bool use_batch_io);
+    bool getUseBatchIO() const                  { return mUseBatchIO; }
+    // Sends the queued datagrams, returns how many of them could not be sent.
+    S32  flushSends(int h_socket);
+
+    // Receive on a dedicated thread, see LLPacketThread. receivePacket() then
+    // takes packets from its queue instead of the socket.
+    void startReceiveThread(S32 socket);
+    void stopReceiveThread();
+    bool hasReceiveThread() const               { return (bool)mReceiveThread; }
+    // Running totals, 0 without a receive thread
+    U32  getPacketsQueued() const               { return mReceiveThread ? mReceiveThread->getPacketsQueued() : 0; }
+    U32  getPacketsDropped() const              { return mReceiveThread ? mReceiveThread->getPacketsDropped() : 0; }
+    // When the last packet handed out by receivePacket() arrived, 0 if unknown
+    F64  getLastReceiveTime() const             { return mLastReceiveTime; }
+
     inline LLHost getLastSender();
     inline LLHost getLastReceivingInterface();
 
@@ -82,9 +104,34 @@ class LLPacketRing
 
     LLHost mLastSender;
     LLHost mLastReceivingIF;
+    F64 mLastReceiveTime;
+
+    std::unique_ptr<LLPacketThread> mReceiveThread;
+
+    bool mUseBatchIO;
+
+    // Datagrams received by the last receive_packets() call, handed out one
+    // by one. NET_BATCH_SIZE buffers of NET_BUFFER_SIZE bytes.
+    std::vector<char> mReceiveSlab;
+    S32 mReceiveSizes[NET_BATCH_SIZE];
+    LLHost mReceiveSenders[NET_BATCH_SIZE];
+    LLHost mReceiveIFs[NET_BATCH_SIZE];
+    S32 mReceiveCount;
+    S32 mReceiveNext;
+
+    // Datagrams waiting for flushSends(), same layout.
+    std::vector<char> mSendSlab;
+    S32 mSendSizes[NET_BATCH_SIZE];
+    LLHost mSendHosts[NET_BATCH_SIZE];
+    S32 mSendCount;
 
 private:
     bool sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
+    S32  receiveFromSlab(S32 socket, char *datap);
+    S32  receiveFromThread(char *datap);
+    // Next datagram from the receive thread, the slab or the socket itself,
+    // sets mLastSender and mLastReceivingIF.
+    S32  receiveFromNet(S32 socket, char *datap);
 };
 
 
@@ -0,0 +1,121 @@
+/**
+ * @file llpacketthread.cpp
+ * @brief implementation of LLPacketThread
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpacketthread.h"
+
+#include "llerror.h"
+#include "net.h"
+
+// How long run() blocks on the socket before checking whether it should quit
+static const S32 PACKET_WAIT_MS = 20;
+
+static U32 round_up_pow2(U32 value)
+{
+    U32 result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+LLPacketThread::LLPacketThread(S32 socket, U32 capacity)
+:   LLThread("UDP Receive"),
+    mSocket(socket),
+    mMask(round_up_pow2(llmax(capacity, 2U)) - 1),
+    mSlots(new LLPacketBuffer[mMask + 1]),
+    mHead(0),
+    mTail(0),
+    mPacketsQueued(0),
+    mPacketsDropped(0)
+{
+}
+
+LLPacketThread::~LLPacketThread()
+{
+    shutdown();
+}
+
+const LLPacketBuffer* LLPacketThread::front() const
+{
+    U32 tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire))
+    {
+        return NULL;
+    }
+    return &mSlots[tail & mMask];
+}
+
+void LLPacketThread::pop()
+{
+    mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void LLPacketThread::run()
+{
+    LL_INFOS() << "UDP receive thread started, " << (mMask + 1) << " packet slots" << LL_ENDL;
+
+    LLPacketBuffer overflow;
+    while (!isQuitting())
+    {
+        if (!wait_for_packet(mSocket, PACKET_WAIT_MS))
+        {
+            continue;
+        }
+
+        // Drain everything the socket has pending
+        while (!isQuitting())
+        {
+            U32 head = mHead.load(std::memory_order_relaxed);
+            if (head - mTail.load(std::memory_order_acquire) > mMask)
+            {
+                // Ring full, the main thread is way behind. Reading into a
+                // scratch slot at least keeps track of what we lose.
+                overflow.init(mSocket);
+                if (overflow.getSize() <= 0)
+                {
+                    break;
+                }
+                mPacketsDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            LLPacketBuffer& slot = mSlots[head & mMask];
+            slot.init(mSocket);
+            if (slot.getSize() <= 0)
+            {
+                break;
+            }
+            mHead.store(head + 1, std::memory_order_release);
+            mPacketsQueued.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    LL_INFOS() << "UDP receive thread stopped, " << getPacketsQueued() << " packets queued, "
+        << getPacketsDropped() << " dropped" << LL_ENDL;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file llpacketthread.h
+ * @brief definition of LLPacketThread, which drains the UDP socket
+ * off the main thread
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKETTHREAD_H
+#define LL_LLPACKETTHREAD_H
+
+#include <atomic>
+#include <memory>
+
+#include "llpacketbuffer.h"
+#include "llthread.h"
+
+// Receives datagrams as soon as they arrive so a long main thread frame
+// doesn't overflow the kernel socket buffer. Packets go into a fixed ring
+// of LLPacketBuffer slots with a single producer (this thread) and a single
+// consumer (the main thread, through LLPacketRing), no locks involved.
+// When the ring is full the thread keeps draining the socket and counts
+// what it has to throw away.
+class LLPacketThread : public LLThread
+{
+public:
+    // capacity is rounded up to a power of two
+    LLPacketThread(S32 socket, U32 capacity = 1024);
+    ~LLPacketThread();
+
+    // Main thread: oldest received packet, NULL when the ring is empty.
+    // Stays valid until pop().
+    const LLPacketBuffer* front() const;
+    void pop();
+
+    U32 getPacketsQueued() const    { return mPacketsQueued.load(std::memory_order_relaxed); }
+    U32 getPacketsDropped() const   { return mPacketsDropped.load(std::memory_order_relaxed); }
+
+protected:
+    /*virtual*/ void run() override;
+
+private:
+    const S32 mSocket;
+    const U32 mMask;
+    std::unique_ptr<LLPacketBuffer[]> mSlots;
+
+    // Only the network thread writes mHead and only the main thread writes
+    // mTail, kept on separate cache lines.
+    alignas(64) std::atomic<U32> mHead;
+    alignas(64) std::atomic<U32> mTail;
+
+    std::atomic<U32> mPacketsQueued;
+    std::atomic<U32> mPacketsDropped;
+};
+
+#endif
@@ -61,6 +61,49 @@ void LLTemplateMessageReader::clearMessage()
     mCurrentRMessageTemplate = NULL;
     delete mCurrentRMessageData;
     mCurrentRMessageData = NULL;
+    mFlatMessage.clear();
+}
+
+S32 LLTemplateMessageReader::findVariableData(const char *blockname, S32 blocknum, const char *varname,
+                                              const void*& datap, S32& size) const
+{
+    if (mFlatMessage.isDecoded())
+    {
+        const LLMessageLayout* layout = mFlatMessage.getLayout();
+        S32 block = layout->findBlock(blockname);
+        if (block < 0 || blocknum < 0 || blocknum >= mFlatMessage.getNumberOfBlocks(block))
+        {
+            return LL_BLOCK_NOT_IN_MESSAGE;
+        }
+        S32 variable = layout->findVariable(block, varname);
+        if (variable < 0)
+        {
+            return LL_VARIABLE_NOT_IN_BLOCK;
+        }
+        datap = mFlatMessage.getData(block, blocknum, variable);
+        size = mFlatMessage.getSize(block, blocknum, variable);
+        return 0;
+    }
+
+    char *bnamep = (char *)blockname + blocknum; // this works because it's just a hash.  The bnamep is never derefference
+    char *vnamep = (char *)varname;
+
+    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
+    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    {
+        return LL_BLOCK_NOT_IN_MESSAGE;
+    }
+
+    const LLMsgBlkData::msg_var_data_map_t &var_data_map = iter->second->mMemberVarData;
+    LLMsgBlkData::msg_var_data_map_t::const_iterator var_iter = var_data_map.find(vnamep);
+    if (var_iter == var_data_map.end())
+    {
+        return LL_VARIABLE_NOT_IN_BLOCK;
+    }
+
+    datap = var_iter->getData();
+    size = var_iter->getSize();
+    return 0;
 }
 
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
@@ -72,79 +115,71 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
         return;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessageData && !mFlatMessage.isDecoded())
     {
         LL_ERRS() << "Invalid mCurrentMessageData in getData!" << LL_ENDL;
         return;
     }
 
-    char *bnamep = (char *)blockname + blocknum; // this works because it's just a hash.  The bnamep is never derefference
-    char *vnamep = (char *)varname;
+    const void* vardata = NULL;
+    S32 vardata_size = 0;
+    S32 status = findVariableData(blockname, blocknum, varname, vardata, vardata_size);
 
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    if (status == LL_BLOCK_NOT_IN_MESSAGE)
     {
         LL_ERRS() << "Block " << blockname << " #" << blocknum
-            << " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+            << " not in message " << mCurrentRMessageTemplate->mName << LL_ENDL;
         return;
     }
 
-    LLMsgBlkData *msg_block_data = iter->second;
-    LLMsgBlkData::msg_var_data_map_t &var_data_map = msg_block_data->mMemberVarData;
-
-    if (var_data_map.find(vnamep) == var_data_map.end())
+    if (status == LL_VARIABLE_NOT_IN_BLOCK)
     {
-        LL_ERRS() << "Variable "<< vnamep << " not in message "
-            << mCurrentRMessageData->mName<< " block " << bnamep << LL_ENDL;
+        LL_ERRS() << "Variable "<< varname << " not in message "
+            << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return;
     }
 
-    LLMsgVarData& vardata = msg_block_data->mMemberVarData[vnamep];
-
-    if (size && size != vardata.getSize())
+    if (size && size != vardata_size)
     {
-        LL_ERRS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
-            << " is size " << vardata.getSize()
+        LL_ERRS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << vardata_size
             << " but copying into buffer of size " << size
             << LL_ENDL;
         return;
     }
 
-
-    const S32 vardata_size = vardata.getSize();
     if( max_size >= vardata_size )
     {
         switch( vardata_size )
         {
         case 1:
-            *((U8*)datap) = *((U8*)vardata.getData());
+            *((U8*)datap) = *((const U8*)vardata);
             break;
         case 2:
-            *((U16*)datap) = *((U16*)vardata.getData());
+            *((U16*)datap) = *((const U16*)vardata);
             break;
         case 4:
-            *((U32*)datap) = *((U32*)vardata.getData());
+            *((U32*)datap) = *((const U32*)vardata);
             break;
         case 8:
-            ((U32*)datap)[0] = ((U32*)vardata.getData())[0];
-            ((U32*)datap)[1] = ((U32*)vardata.getData())[1];
+            ((U32*)datap)[0] = ((const U32*)vardata)[0];
+            ((U32*)datap)[1] = ((const U32*)vardata)[1];
             break;
         default:
-            memcpy(datap, vardata.getData(), vardata_size);
+            memcpy(datap, vardata, vardata_size);
             break;
         }
     }
     else
     {
-        LL_WARNS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
-            << " is size " << vardata.getSize()
+        LL_WARNS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << vardata_size
             << " but truncated to max size of " << max_size
             << LL_ENDL;
 
-        memcpy(datap, vardata.getData(), max_size);
+        memcpy(datap, vardata, max_size);
     }
 }
 
@@ -157,6 +192,12 @@ S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
         return -1;
     }
 
+    if (mFlatMessage.isDecoded())
+    {
+        S32 block = mFlatMessage.getLayout()->findBlock(blockname);
+        return block < 0 ? 0 : mFlatMessage.getNumberOfBlocks(block);
+    }
+
     if (!mCurrentRMessageData)
     {
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
@@ -184,43 +225,38 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, const char *varname)
         return LL_MESSAGE_ERROR;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessageData && !mFlatMessage.isDecoded())
     {   // This is a serious error - crash
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    char *bnamep = (char *)blockname;
+    const void* vardata = NULL;
+    S32 vardata_size = 0;
+    S32 status = findVariableData(blockname, 0, varname, vardata, vardata_size);
 
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    if (status == LL_BLOCK_NOT_IN_MESSAGE)
     {   // don't crash
-        LL_INFOS() << "Block " << bnamep << " not in message "
-            << mCurrentRMessageData->mName << LL_ENDL;
+        LL_INFOS() << "Block " << blockname << " not in message "
+            << mCurrentRMessageTemplate->mName << LL_ENDL;
         return LL_BLOCK_NOT_IN_MESSAGE;
     }
 
-    char *vnamep = (char *)varname;
-
-    LLMsgBlkData* msg_data = iter->second;
-    LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-
-    if (!vardata.getName())
+    if (status == LL_VARIABLE_NOT_IN_BLOCK)
     {   // don't crash
         LL_INFOS() << "Variable " << varname << " not in message "
-            << mCurrentRMessageData->mName << " block " << bnamep << LL_ENDL;
+            << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return LL_VARIABLE_NOT_IN_BLOCK;
     }
 
-    if (mCurrentRMessageTemplate->mMemberBlocks[bnamep]->mType != MBT_SINGLE)
+    if (mCurrentRMessageTemplate->mMemberBlocks[(char *)blockname]->mType != MBT_SINGLE)
     {   // This is a serious error - crash
-        LL_ERRS() << "Block " << bnamep << " isn't type MBT_SINGLE,"
+        LL_ERRS() << "Block " << blockname << " isn't type MBT_SINGLE,"
             " use getSize with blocknum argument!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    return vardata.getSize();
+    return vardata_size;
 }
 
 S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const char *varname)
@@ -232,35 +268,31 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const
         return LL_MESSAGE_ERROR;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessageData && !mFlatMessage.isDecoded())
     {   // This is a serious error - crash
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    char *bnamep = (char *)blockname + blocknum;
-    char *vnamep = (char *)varname;
-
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
+    const void* vardata = NULL;
+    S32 vardata_size = 0;
+    S32 status = findVariableData(blockname, blocknum, varname, vardata, vardata_size);
 
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    if (status == LL_BLOCK_NOT_IN_MESSAGE)
     {   // don't crash
-        LL_INFOS() << "Block " << bnamep << " not in message "
-            << mCurrentRMessageData->mName << LL_ENDL;
+        LL_INFOS() << "Block " << blockname << " #" << blocknum << " not in message "
+            << mCurrentRMessageTemplate->mName << LL_ENDL;
         return LL_BLOCK_NOT_IN_MESSAGE;
     }
 
-    LLMsgBlkData* msg_data = iter->second;
-    LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-
-    if (!vardata.getName())
+    if (status == LL_VARIABLE_NOT_IN_BLOCK)
     {   // don't crash
-        LL_INFOS() << "Variable " << vnamep << " not in message "
-            <<  mCurrentRMessageData->mName << " block " << bnamep << LL_ENDL;
+        LL_INFOS() << "Variable " << varname << " not in message "
+            <<  mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return LL_VARIABLE_NOT_IN_BLOCK;
     }
 
-    return vardata.getSize();
+    return vardata_size;
 }
 
 void LLTemplateMessageReader::getBinaryData(const char *blockname,
@@ -539,166 +571,188 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
     llassert( mCurrentRMessageTemplate);
     llassert( !mCurrentRMessageData );
     delete mCurrentRMessageData; // just to make sure
+    mCurrentRMessageData = NULL;
+    mFlatMessage.clear();
 
     // The offset tells us how may bytes to skip after the end of the
     // message name.
     U8 offset = buffer[PHL_OFFSET];
     S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
 
-    // create base working data set
-    mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
-
-    // loop through the template building the data structure as we go
-    LLMessageTemplate::message_block_map_t::const_iterator iter;
-    for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
-        iter != mCurrentRMessageTemplate->mMemberBlocks.end();
-        ++iter)
+    const LLMessageLayout* layout = mCurrentRMessageTemplate->getLayout();
+    if (layout)
     {
-        LLMessageBlock* mbci = *iter;
-        U8  repeat_number;
-        S32 i;
-
-        // how many of this block?
-
-        if (mbci->mType == MBT_SINGLE)
+        // Single pass over the compiled layout, fields are left in the buffer
+        S32 ran_off_end = -1;
+        S32 wanted = 0;
+        bool has_blocks = mFlatMessage.decode(*layout, buffer, decode_pos, mReceiveSize, ran_off_end, wanted);
+        if (ran_off_end >= 0)
         {
-            // just one
-            repeat_number = 1;
+            logRanOffEndOfPacket(sender, ran_off_end, wanted);
         }
-        else if (mbci->mType == MBT_MULTIPLE)
+        if (!has_blocks)
         {
-            // a known number
-            repeat_number = mbci->mNumber;
+            LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
+            return false;
         }
-        else if (mbci->mType == MBT_VARIABLE)
+    }
+    else
+    {
+        // create base working data set
+        mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+
+        // loop through the template building the data structure as we go
+        LLMessageTemplate::message_block_map_t::const_iterator iter;
+        for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
+            iter != mCurrentRMessageTemplate->mMemberBlocks.end();
+            ++iter)
         {
-            // need to read the number from the message
-            // repeat number is a single byte
-            if (decode_pos >= mReceiveSize)
-            {
-                // commented out - hetgrid says that missing variable blocks
-                // at end of message are legal
-                // logRanOffEndOfPacket(sender, decode_pos, 1);
+            LLMessageBlock* mbci = *iter;
+            U8  repeat_number;
+            S32 i;
 
-                // default to 0 repeats
-                repeat_number = 0;
+            // how many of this block?
+
+            if (mbci->mType == MBT_SINGLE)
+            {
+                // just one
+                repeat_number = 1;
             }
-            else
+            else if (mbci->mType == MBT_MULTIPLE)
             {
-                repeat_number = buffer[decode_pos];
-                decode_pos++;
+                // a known number
+                repeat_number = mbci->mNumber;
             }
-        }
-        else
-        {
-            LL_ERRS() << "Unknown block type" << LL_ENDL;
-            return false;
-        }
-
-        LLMsgBlkData* cur_data_block = NULL;
-
-        // now loop through the block
-        for (i = 0; i < repeat_number; i++)
-        {
-            if (i)
+            else if (mbci->mType == MBT_VARIABLE)
             {
-                // build new name to prevent collisions
-                // TODO: This should really change to a vector
-                cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
-                cur_data_block->mName = mbci->mName + i;
+                // need to read the number from the message
+                // repeat number is a single byte
+                if (decode_pos >= mReceiveSize)
+                {
+                    // commented out - hetgrid says that missing variable blocks
+                    // at end of message are legal
+                    // logRanOffEndOfPacket(sender, decode_pos, 1);
+
+                    // default to 0 repeats
+                    repeat_number = 0;
+                }
+                else
+                {
+                    repeat_number = buffer[decode_pos];
+                    decode_pos++;
+                }
             }
             else
             {
-                cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+                LL_ERRS() << "Unknown block type" << LL_ENDL;
+                return false;
             }
 
-            // add the block to the message
-            mCurrentRMessageData->addBlock(cur_data_block);
+            LLMsgBlkData* cur_data_block = NULL;
 
-            // now read the variables
-            for (LLMessageBlock::message_variable_map_t::const_iterator iter =
-                     mbci->mMemberVariables.begin();
-                 iter != mbci->mMemberVariables.end(); iter++)
+            // now loop through the block
+            for (i = 0; i < repeat_number; i++)
             {
-                const LLMessageVariable& mvci = **iter;
+                if (i)
+                {
+                    // build new name to prevent collisions
+                    // TODO: This should really change to a vector
+                    cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+                    cur_data_block->mName = mbci->mName + i;
+                }
+                else
+                {
+                    cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+                }
 
-                // ok, build out the variables
-                // add variable block
-                cur_data_block->addVariable(mvci.getName(), mvci.getType());
+                // add the block to the message
+                mCurrentRMessageData->addBlock(cur_data_block);
 
-                // what type of variable?
-                if (mvci.getType() == MVT_VARIABLE)
+                // now read the variables
+                for (LLMessageBlock::message_variable_map_t::const_iterator iter =
+                         mbci->mMemberVariables.begin();
+                     iter != mbci->mMemberVariables.end(); iter++)
                 {
-                    // variable, get the number of bytes to read from the template
-                    S32 data_size = mvci.getSize();
-                    U8 tsizeb = 0;
-                    U16 tsizeh = 0;
-                    U32 tsize = 0;
+                    const LLMessageVariable& mvci = **iter;
 
-                    if ((decode_pos + data_size) > mReceiveSize)
-                    {
-                        logRanOffEndOfPacket(sender, decode_pos, data_size);
+                    // ok, build out the variables
+                    // add variable block
+                    cur_data_block->addVariable(mvci.getName(), mvci.getType());
 
-                        // default to 0 length variable blocks
-                        tsize = 0;
-                    }
-                    else
+                    // what type of variable?
+                    if (mvci.getType() == MVT_VARIABLE)
                     {
-                        switch(data_size)
+                        // variable, get the number of bytes to read from the template
+                        S32 data_size = mvci.getSize();
+                        U8 tsizeb = 0;
+                        U16 tsizeh = 0;
+                        U32 tsize = 0;
+
+                        if ((decode_pos + data_size) > mReceiveSize)
                         {
-                        case 1:
-                            htolememcpy(&tsizeb, &buffer[decode_pos], MVT_U8, 1);
-                            tsize = tsizeb;
-                            break;
-                        case 2:
-                            htolememcpy(&tsizeh, &buffer[decode_pos], MVT_U16, 2);
-                            tsize = tsizeh;
-                            break;
-                        case 4:
-                            htolememcpy(&tsize, &buffer[decode_pos], MVT_U32, 4);
-                            break;
-                        default:
-                            LL_ERRS() << "Attempting to read variable field with unknown size of " << data_size << LL_ENDL;
-                            break;
-                        }
-                    }
-                    decode_pos += data_size;
+                            logRanOffEndOfPacket(sender, decode_pos, data_size);
 
-                    cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
-                    decode_pos += tsize;
-                }
-                else
-                {
-                    // fixed!
-                    // so, copy data pointer and set data size to fixed size
-                    if ((decode_pos + mvci.getSize()) > mReceiveSize)
-                    {
-                        logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
+                            // default to 0 length variable blocks
+                            tsize = 0;
+                        }
+                        else
+                        {
+                            switch(data_size)
+                            {
+                            case 1:
+                                htolememcpy(&tsizeb, &buffer[decode_pos], MVT_U8, 1);
+                                tsize = tsizeb;
+                                break;
+                            case 2:
+                                htolememcpy(&tsizeh, &buffer[decode_pos], MVT_U16, 2);
+                                tsize = tsizeh;
+                                break;
+                            case 4:
+                                htolememcpy(&tsize, &buffer[decode_pos], MVT_U32, 4);
+                                break;
+                            default:
+                                LL_ERRS() << "Attempting to read variable field with unknown size of " << data_size << LL_ENDL;
+                                break;
+                            }
+                        }
+                        decode_pos += data_size;
 
-                        // default to 0s.
-                        U32 size = mvci.getSize();
-                        std::vector<U8> data(size, 0);
-                        cur_data_block->addData(mvci.getName(), &(data[0]),
-                                                size, mvci.getType());
+                        cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+                        decode_pos += tsize;
                     }
                     else
                     {
-                        cur_data_block->addData(mvci.getName(),
-                                                &buffer[decode_pos],
-                                                mvci.getSize(),
-                                                mvci.getType());
+                        // fixed!
+                        // so, copy data pointer and set data size to fixed size
+                        if ((decode_pos + mvci.getSize()) > mReceiveSize)
+                        {
+                            logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
+
+                            // default to 0s.
+                            U32 size = mvci.getSize();
+                            std::vector<U8> data(size, 0);
+                            cur_data_block->addData(mvci.getName(), &(data[0]),
+                                                    size, mvci.getType());
+                        }
+                        else
+                        {
+                            cur_data_block->addData(mvci.getName(),
+                                                    &buffer[decode_pos],
+                                                    mvci.getSize(),
+                                                    mvci.getType());
+                        }
+                        decode_pos += mvci.getSize();
                     }
-                    decode_pos += mvci.getSize();
                 }
             }
         }
-    }
 
-    if (mCurrentRMessageData->mMemberBlocks.empty()
-        && !mCurrentRMessageTemplate->mMemberBlocks.empty())
-    {
-        LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
-        return false;
+        if (mCurrentRMessageData->mMemberBlocks.empty()
+            && !mCurrentRMessageTemplate->mMemberBlocks.empty())
+        {
+            LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
+            return false;
+        }
     }
 
     {
@@ -826,5 +880,38 @@ void LLTemplateMessageReader::copyToBuilder(LLMessageBuilder& builder) const
     {
         return;
     }
+    if (mFlatMessage.isDecoded())
+    {
+        LLMsgData* msg_data = buildMsgData();
+        builder.copyFromMessageData(*msg_data);
+        delete msg_data;
+        return;
+    }
     builder.copyFromMessageData(*mCurrentRMessageData);
 }
+
+LLMsgData* LLTemplateMessageReader::buildMsgData() const
+{
+    const LLMessageLayout* layout = mFlatMessage.getLayout();
+    LLMsgData* msg_data = new LLMsgData(mCurrentRMessageTemplate->mName);
+    for (S32 block = 0; block < layout->getNumBlocks(); ++block)
+    {
+        const LLMessageLayout::Block& blockr = layout->getBlock(block);
+        S32 repeat_number = mFlatMessage.getNumberOfBlocks(block);
+        for (S32 i = 0; i < repeat_number; ++i)
+        {
+            LLMsgBlkData* block_data = new LLMsgBlkData(blockr.mName, repeat_number);
+            block_data->mName = blockr.mName + i;
+            msg_data->addBlock(block_data);
+
+            for (S32 variable = 0; variable < blockr.mNumVariables; ++variable)
+            {
+                const LLMessageLayout::Variable& var = layout->getVariable(block, variable);
+                block_data->addVariable(var.mName, var.mType);
+                block_data->addData(var.mName, mFlatMessage.getData(block, i, variable),
+                                    mFlatMessage.getSize(block, i, variable), var.mType);
+            }
+        }
+    }
+    return msg_data;
+}
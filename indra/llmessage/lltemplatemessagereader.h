@@ -28,6 +28,7 @@
 #define LL_LLTEMPLATEMESSAGEREADER_H
 
 #include "llmessagereader.h"
+#include "llmessagelayout.h"
 
 #include <map>
 
@@ -106,6 +107,12 @@ class LLTemplateMessageReader : public LLMessageReader
     bool isBanned(bool trusted_source) const;
     bool isUdpBanned() const;
 
+    // The current message when its template has a compiled layout, NULL otherwise
+    virtual const LLFlatMessage* getFlatMessage() const
+    {
+        return mFlatMessage.isDecoded() ? &mFlatMessage : NULL;
+    }
+
 private:
 
     void getData(const char *blockname, const char *varname, void *datap,
@@ -118,9 +125,16 @@ class LLTemplateMessageReader : public LLMessageReader
 
     bool decodeData(const U8* buffer, const LLHost& sender );
 
+    // Finds the data of a variable in whichever form the current message was
+    // decoded to. Returns 0, LL_BLOCK_NOT_IN_MESSAGE or LL_VARIABLE_NOT_IN_BLOCK.
+    S32 findVariableData(const char *blockname, S32 blocknum, const char *varname,
+                          const void*& datap, S32& size) const;
+    LLMsgData* buildMsgData() const;
+
     S32 mReceiveSize;
     LLMessageTemplate* mCurrentRMessageTemplate;
     LLMsgData* mCurrentRMessageData;
+    LLFlatMessage mFlatMessage;
     message_template_number_map_t& mMessageNumbers;
 };
 
@@ -0,0 +1,203 @@
+/**
+ * @file llzerocode.cpp
+ * @brief Zero run length coding of message bodies
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llzerocode.h"
+
+#include <bit>
+#include <emmintrin.h>
+
+namespace
+{
+    const S32 MAX_ZERO_RUN = 255;
+    const S32 CHUNK_SIZE = sizeof(__m128i);
+
+    // Bit i is set if byte i of the chunk is zero
+    inline U32 zero_mask(__m128i chunk)
+    {
+        return (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+    }
+
+    inline __m128i load_chunk(const U8* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+
+    // Number of non-zero bytes at the start of [in, end)
+    S32 literal_length(const U8* in, const U8* end)
+    {
+        const U8* p = in;
+        while (end - p >= CHUNK_SIZE)
+        {
+            U32 zeros = zero_mask(load_chunk(p));
+            if (zeros)
+            {
+                return (S32)(p - in) + std::countr_zero(zeros);
+            }
+            p += CHUNK_SIZE;
+        }
+        while (p < end && *p)
+        {
+            ++p;
+        }
+        return (S32)(p - in);
+    }
+
+    // Number of zero bytes at the start of [in, end)
+    S32 zero_run_length(const U8* in, const U8* end)
+    {
+        const U8* p = in;
+        while (end - p >= CHUNK_SIZE)
+        {
+            U32 non_zeros = zero_mask(load_chunk(p)) ^ 0xffff;
+            if (non_zeros)
+            {
+                return (S32)(p - in) + std::countr_zero(non_zeros);
+            }
+            p += CHUNK_SIZE;
+        }
+        while (p < end && !*p)
+        {
+            ++p;
+        }
+        return (S32)(p - in);
+    }
+}
+
+S32 zero_code_encoded_size(const U8* in, S32 in_size)
+{
+    const U8* end = in + in_size;
+    S32 size = 0;
+    while (in < end)
+    {
+        S32 literal = literal_length(in, end);
+        in += literal;
+        size += literal;
+        if (in < end)
+        {
+            S32 run = zero_run_length(in, end);
+            in += run;
+            size += 2 * ((run + MAX_ZERO_RUN - 1) / MAX_ZERO_RUN);
+        }
+    }
+    return size;
+}
+
+S32 zero_code_encode(const U8* in, S32 in_size, U8* out)
+{
+    const U8* end = in + in_size;
+    U8* out_start = out;
+    while (in < end)
+    {
+        S32 literal = literal_length(in, end);
+        if (literal <= CHUNK_SIZE && end - in >= CHUNK_SIZE)
+        {
+            // out has room for a whole chunk, the bytes past the literal
+            // are overwritten by the zero run
+            _mm_storeu_si128((__m128i*)out, load_chunk(in));
+        }
+        else
+        {
+            memcpy(out, in, literal); /*Flawfinder: ignore*/
+        }
+        in += literal;
+        out += literal;
+        if (in < end)
+        {
+            S32 run = zero_run_length(in, end);
+            in += run;
+            while (run > MAX_ZERO_RUN)
+            {
+                *out++ = 0;
+                *out++ = (U8)MAX_ZERO_RUN;
+                run -= MAX_ZERO_RUN;
+            }
+            *out++ = 0;
+            *out++ = (U8)run;
+        }
+    }
+    return (S32)(out - out_start);
+}
+
+S32 zero_code_decode(const U8* in, S32 in_size, U8* out, S32 out_size)
+{
+    const U8* end = in + in_size;
+    U8* out_start = out;
+    U8* out_end = out + out_size;
+    while (in < end)
+    {
+        // Copy whole chunks up to the next zero. The bytes stored past it
+        // are overwritten by the zero run.
+        while (end - in >= CHUNK_SIZE && out_end - out >= CHUNK_SIZE)
+        {
+            __m128i chunk = load_chunk(in);
+            _mm_storeu_si128((__m128i*)out, chunk);
+            U32 zeros = zero_mask(chunk);
+            if (zeros)
+            {
+                S32 literal = std::countr_zero(zeros);
+                in += literal;
+                out += literal;
+                break;
+            }
+            in += CHUNK_SIZE;
+            out += CHUNK_SIZE;
+        }
+        while (in < end && *in)
+        {
+            if (out == out_end)
+            {
+                return -1;
+            }
+            *out++ = *in++;
+        }
+        if (in == end)
+        {
+            break;
+        }
+
+        // A zero, then its count, with zero counts meaning 256 more
+        ++in;
+        S32 run = 1;
+        while (in < end && !*in)
+        {
+            run += 256;
+            ++in;
+        }
+        if (in < end)
+        {
+            run += *in++ - 1;
+        }
+        if (out_end - out < run)
+        {
+            return -1;
+        }
+        memset(out, 0, run);
+        out += run;
+    }
+    return (S32)(out - out_start);
+}
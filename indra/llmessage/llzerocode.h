@@ -0,0 +1,44 @@
+/**
+ * @file llzerocode.h
+ * @brief Zero run length coding of message bodies
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLZEROCODE_H
+#define LL_LLZEROCODE_H
+
+// Sequential zero bytes are encoded as 0 [U8 count], runs longer than 255
+// are split. When decoding, each extra 0 in place of a count adds 256 zeroes.
+// These work on the message body, the packet header is never coded.
+// Non-zero bytes and zero runs are found 16 bytes at a time with SSE2.
+
+// Size of the encoded body, without encoding it
+S32 zero_code_encoded_size(const U8* in, S32 in_size);
+
+// out must hold 2 * in_size bytes. Returns the encoded size.
+S32 zero_code_encode(const U8* in, S32 in_size, U8* out);
+
+// Returns the decoded size, or -1 if it doesn't fit in out_size.
+S32 zero_code_decode(const U8* in, S32 in_size, U8* out, S32 out_size);
+
+#endif // LL_LLZEROCODE_H
@@ -62,6 +62,7 @@
 #include "lltrustedmessageservice.h"
 #include "llmessagetemplate.h"
 #include "llmessagetemplateparser.h"
+#include "llmessageviews.h"
 #include "llsd.h"
 #include "llsdmessagebuilder.h"
 #include "llsdmessagereader.h"
@@ -70,6 +71,7 @@
 #include "lltransfermanager.h"
 #include "lluuid.h"
 #include "llxfermanager.h"
+#include "llzerocode.h"
 #include "llquaternion.h"
 #include "u64.h"
 #include "v3dmath.h"
@@ -315,6 +317,9 @@ void LLMessageSystem::loadTemplateFile(const std::string& filename, bool failure
         addTemplate(*iter);
         count++;
     }
+
+    // Compile flat decode tables for the messages read through typed views
+    LLMessageFieldTable::bindAll(mMessageTemplates);
     LL_INFOS("Messaging") << "Read " << count << " messages from " << filename << LL_ENDL;
 }
 
@@ -327,6 +332,8 @@ LLMessageSystem::~LLMessageSystem()
 
     if (!mbError)
     {
+        flushSends();
+        mPacketRing.stopReceiveThread();
         end_net(mSocket);
     }
     mSocket = 0;
@@ -819,6 +826,26 @@ void LLMessageSystem::processAcks(LockMessageChecker&, F32 collect_time)
         mResendDumpTime = mt_sec;
         mCircuitInfo.dumpResends();
     }
+
+    // Everything sent since the last call, acks included, goes out together
+    flushSends();
+}
+
+void LLMessageSystem::flushSends()
+{
+    mSendPacketFailureCount += mPacketRing.flushSends(mSocket);
+}
+
+void LLMessageSystem::setUseReceiveThread(bool use_thread)
+{
+    if (use_thread && !mbError)
+    {
+        mPacketRing.startReceiveThread(mSocket);
+    }
+    else
+    {
+        mPacketRing.stopReceiveThread();
+    }
 }
 
 void LLMessageSystem::copyMessageReceivedToSend()
@@ -2759,54 +2786,10 @@ S32 LLMessageSystem::zeroCodeAdjustCurrentSendTotal()
     // TODO: babbage: remove this horror
     mMessageBuilder->setBuilt(false);
 
-    S32 count = mSendSize;
-
-    S32 net_gain = 0;
-    U8 num_zeroes = 0;
-
-    U8 *inptr = (U8 *)mSendBuffer;
-
-// skip the packet id field
-
-    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-    {
-        count--;
-        inptr++;
-    }
-
-// don't actually build, just test
-
-// sequential zero bytes are encoded as 0 [U8 count]
-// with 0 0 [count] representing wrap (>256 zeroes)
-
-    while (count--)
-    {
-        if (!(*inptr))   // in a zero count
-        {
-            if (num_zeroes)
-            {
-                if (++num_zeroes > 254)
-                {
-                    num_zeroes = 0;
-                }
-                net_gain--;   // subseqent zeroes save one
-            }
-            else
-            {
-                net_gain++;  // starting a zero count adds one
-                num_zeroes = 1;
-            }
-            inptr++;
-        }
-        else
-        {
-            if (num_zeroes)
-            {
-                num_zeroes = 0;
-            }
-            inptr++;
-        }
-    }
+    // skip the packet id field, sequential zero bytes are encoded as
+    // 0 [U8 count], don't actually build, just test
+    S32 body_size = mSendSize - LL_PACKET_ID_SIZE;
+    S32 net_gain = zero_code_encoded_size(mSendBuffer + LL_PACKET_ID_SIZE, body_size) - body_size;
     if (net_gain < 0)
     {
         return net_gain;
@@ -2841,72 +2824,22 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 
     *data[0] &= (~LL_ZERO_CODE_FLAG);
 
-    S32 count = (*data_size);
-
-    U8 *inptr = (U8 *)*data;
-    U8 *outptr = (U8 *)mEncodedRecvBuffer;
-
-// skip the packet id field
-
-    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-    {
-        count--;
-        *outptr++ = *inptr++;
-    }
-
-// reconstruct encoded packet, keeping track of net size gain
-
-// sequential zero bytes are encoded as 0 [U8 count]
-// with 0 0 [count] representing wrap (>256 zeroes)
-
-    while (count--)
+    // copy the packet id field, then expand the body straight into the
+    // decode buffer
+    memcpy(mEncodedRecvBuffer, *data, LL_PACKET_ID_SIZE); /*Flawfinder: ignore*/
+    S32 expanded_size = zero_code_decode(*data + LL_PACKET_ID_SIZE, llmax(in_size - (S32)LL_PACKET_ID_SIZE, 0),
+                                         mEncodedRecvBuffer + LL_PACKET_ID_SIZE, MAX_BUFFER_SIZE - LL_PACKET_ID_SIZE);
+    if (expanded_size < 0)
     {
-        if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
-        {
-            LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
-            callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-            outptr = mEncodedRecvBuffer;
-            break;
-        }
-        if (!((*outptr++ = *inptr++)))
-        {
-            while (((count--)) && (!(*inptr)))
-            {
-                *outptr++ = *inptr++;
-                if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-                {
-                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
-                    callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-                    outptr = mEncodedRecvBuffer;
-                    count = -1;
-                    break;
-                }
-                memset(outptr,0,255);
-                outptr += 255;
-            }
-
-            if (count < 0)
-            {
-                break;
-            }
-
-            else
-            {
-                if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-                {
-                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
-                    callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-                    outptr = mEncodedRecvBuffer;
-                }
-                memset(outptr,0,(*inptr) - 1);
-                outptr += ((*inptr) - 1);
-                inptr++;
-            }
-        }
+        LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << LL_ENDL;
+        callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+        *data = mEncodedRecvBuffer;
+        *data_size = 0;
+        return(in_size);
     }
 
     *data = mEncodedRecvBuffer;
-    *data_size = (S32)(outptr - mEncodedRecvBuffer);
+    *data_size = LL_PACKET_ID_SIZE + expanded_size;
     mUncompressedBytesIn += *data_size;
 
     return(in_size);
@@ -228,6 +228,7 @@ class LLMessageReaderPointer
     // It is essential that comparison and dereferencing must be fast, which
     // is why we don't check for nullptr when dereferencing.
     LLMessageReader* operator->() const { return mPtr; }
+    LLMessageReader* get() const { return mPtr; }
     bool operator==(const LLMessageReader* other) const { return mPtr == other; }
     bool operator!=(const LLMessageReader* other) const { return ! (*this == other); }
 private:
@@ -762,6 +763,14 @@ class LLMessageSystem : public LLMessageSenderInterface
     void setMaxMessageTime(const F32 seconds);  // Max time to process messages before warning and dumping (neg to disable)
     void setMaxMessageCounts(const S32 num);    // Max number of messages before dumping (neg to disable)
 
+    // Sends the datagrams mPacketRing queued up while batching, see LLPacketRing::setUseBatchIO().
+    // Done by processAcks(), once per frame.
+    void flushSends();
+
+    // Drain the socket from a dedicated thread, messages are still decoded and
+    // dispatched by checkMessages() on the calling thread.
+    void setUseReceiveThread(bool use_thread);
+
     static U64Microseconds getMessageTimeUsecs(const bool update = false);  // Get the current message system time in microseconds
     static F64Seconds getMessageTimeSeconds(const bool update = false); // Get the current message system time in seconds
 
@@ -905,6 +914,7 @@ class LLMessageSystem : public LLMessageSenderInterface
     LLSDMessageReader* mLLSDMessageReader;
 
     friend class LLMessageHandlerBridge;
+    friend class LLMessageView;
     friend class LockMessageChecker;
 
     bool callHandler(const char *name, bool trustedSource,
@@ -40,6 +40,7 @@
     #include <arpa/inet.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <poll.h>
 #endif
 
 // linden library includes
@@ -660,4 +661,167 @@ bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
 
 #endif
 
+#if LL_LINUX
+
+S32 receive_packets(int hSocket, char* receiveBuffers, S32* sizes, LLHost* senders, LLHost* receivingIFs, S32 count)
+{
+    count = llmin(count, NET_BATCH_SIZE);
+
+    struct mmsghdr msgs[NET_BATCH_SIZE];
+    struct iovec iovs[NET_BATCH_SIZE];
+    struct sockaddr_in addrs[NET_BATCH_SIZE];
+    char cmsgs[NET_BATCH_SIZE][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+    memset(msgs, 0, sizeof(struct mmsghdr) * count);
+    for (S32 i = 0; i < count; i++)
+    {
+        iovs[i].iov_base = receiveBuffers + i * NET_BUFFER_SIZE;
+        iovs[i].iov_len = NET_BUFFER_SIZE;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = cmsgs[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+    }
+
+    // Non-blocking socket: returns what is already queued, up to count
+    int received = recvmmsg(hSocket, msgs, count, 0, NULL);
+    if (received <= 0)
+    {
+        return 0;
+    }
+
+    for (S32 i = 0; i < received; i++)
+    {
+        sizes[i] = msgs[i].msg_len;
+        senders[i] = LLHost(addrs[i].sin_addr.s_addr, ntohs(addrs[i].sin_port));
+
+        U32 receiving_ip = INVALID_HOST_IP_ADDRESS;
+        for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+        {
+            if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+            {
+                in_pktinfo* pktinfo = (in_pktinfo*)CMSG_DATA(cmsgptr);
+                receiving_ip = pktinfo->ipi_spec_dst.s_addr;
+            }
+        }
+        receivingIFs[i] = LLHost(receiving_ip, INVALID_PORT);
+    }
+
+    // Keep get_receiving_interface() in line with the single packet path
+    gsnReceivingIFAddr = receivingIFs[received - 1].getAddress();
+
+    return received;
+}
+
+S32 send_packets(int hSocket, const char* const* sendBuffers, const S32* sizes, const LLHost* recipients, S32 count)
+{
+    count = llmin(count, NET_BATCH_SIZE);
+
+    struct mmsghdr msgs[NET_BATCH_SIZE];
+    struct iovec iovs[NET_BATCH_SIZE];
+    struct sockaddr_in addrs[NET_BATCH_SIZE];
+
+    memset(msgs, 0, sizeof(struct mmsghdr) * count);
+    memset(addrs, 0, sizeof(struct sockaddr_in) * count);
+    for (S32 i = 0; i < count; i++)
+    {
+        addrs[i].sin_family = AF_INET;
+        addrs[i].sin_addr.s_addr = recipients[i].getAddress();
+        addrs[i].sin_port = htons(recipients[i].getPort());
+        iovs[i].iov_base = const_cast<char*>(sendBuffers[i]);
+        iovs[i].iov_len = sizes[i];
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Same retry policy as send_packet(): a full buffer or an earlier ICMP
+    // refusal gets a few more attempts, any other error skips the datagram.
+    S32 sent = 0;
+    S32 next = 0;
+    S32 send_attempts = 0;
+    while (next < count)
+    {
+        int ret = sendmmsg(hSocket, msgs + next, count - next, 0);
+        if (ret > 0)
+        {
+            sent += ret;
+            next += ret;
+            send_attempts = 0;
+            continue;
+        }
+
+        if ((errno == EAGAIN || errno == ECONNREFUSED) && ++send_attempts < 3)
+        {
+            LL_INFOS() << "sendmmsg() failed: " << strerror(errno) << ", resending (attempt " << send_attempts << ")" << LL_ENDL;
+            continue;
+        }
+
+        LL_INFOS() << "sendmmsg() failed: " << errno << ", " << strerror(errno) << ", dropping packet to " << recipients[next] << LL_ENDL;
+        next++;
+        send_attempts = 0;
+    }
+
+    return sent;
+}
+
+#else
+
+S32 receive_packets(int hSocket, char* receiveBuffers, S32* sizes, LLHost* senders, LLHost* receivingIFs, S32 count)
+{
+    count = llmin(count, NET_BATCH_SIZE);
+
+    S32 received = 0;
+    while (received < count)
+    {
+        S32 size = receive_packet(hSocket, receiveBuffers + received * NET_BUFFER_SIZE);
+        if (size <= 0)
+        {
+            break;
+        }
+        sizes[received] = size;
+        senders[received] = get_sender();
+        receivingIFs[received] = get_receiving_interface();
+        received++;
+    }
+    return received;
+}
+
+S32 send_packets(int hSocket, const char* const* sendBuffers, const S32* sizes, const LLHost* recipients, S32 count)
+{
+    S32 sent = 0;
+    for (S32 i = 0; i < count; i++)
+    {
+        if (send_packet(hSocket, sendBuffers[i], sizes[i], recipients[i].getAddress(), recipients[i].getPort()))
+        {
+            sent++;
+        }
+    }
+    return sent;
+}
+
+#endif
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+#if LL_WINDOWS
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    FD_SET((SOCKET)hSocket, &read_set);
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(0, &read_set, NULL, NULL, &timeout) > 0;
+#else
+    pollfd poll_fd;
+    poll_fd.fd = hSocket;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    return poll(&poll_fd, 1, timeout_ms) > 0 && (poll_fd.revents & POLLIN);
+#endif
+}
+
 //EOF
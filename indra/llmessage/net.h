@@ -45,6 +45,21 @@ S32     receive_packet(int hSocket, char * receiveBuffer);
 
 bool    send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);   // Returns true on success.
 
+// Most datagrams moved by one receive_packets() or send_packets() call
+const S32 NET_BATCH_SIZE = 64;
+
+// Batched versions of the above, one system call for up to NET_BATCH_SIZE datagrams on
+// Linux (recvmmsg/sendmmsg), a loop over the single packet calls elsewhere.
+// receive_packets() fills count buffers of NET_BUFFER_SIZE bytes laid out back to back
+// and returns how many datagrams it got, 0 when none is pending or on error.
+S32     receive_packets(int hSocket, char* receiveBuffers, S32* sizes, LLHost* senders, LLHost* receivingIFs, S32 count);
+// Returns how many of the datagrams were sent, failed ones are skipped.
+S32     send_packets(int hSocket, const char* const* sendBuffers, const S32* sizes, const LLHost* recipients, S32 count);
+
+// Blocks until a datagram is pending on the socket or timeout_ms went by, returns
+// true when there is something to receive.
+bool    wait_for_packet(int hSocket, S32 timeout_ms);
+
 //void  get_sender(char * tmp);
 LLHost  get_sender();
 U32     get_sender_port();
@@ -0,0 +1,225 @@
+/**
+ * @file llpacketring_test.cpp
+ * @brief LLPacketRing batched I/O and receive thread test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+
+namespace
+{
+    const S32 PACKET_SIZE = 200;    // Typical size of an object update
+
+    void fill_packet(char* buffer, S32 index)
+    {
+        memset(buffer, index & 0xff, PACKET_SIZE);
+        memcpy(buffer, &index, sizeof(index));
+    }
+
+    S32 packet_index(const char* buffer)
+    {
+        S32 index;
+        memcpy(&index, buffer, sizeof(index));
+        return index;
+    }
+}
+
+namespace tut
+{
+    struct packetring_data
+    {
+        packetring_data()
+        {
+            mSenderPort = NET_USE_OS_ASSIGNED_PORT;
+            mReceiverPort = NET_USE_OS_ASSIGNED_PORT;
+            mOk = start_net(mSender, mSenderPort) == 0 && start_net(mReceiver, mReceiverPort) == 0;
+            mLoopback = ip_string_to_u32("127.0.0.1");
+        }
+
+        ~packetring_data()
+        {
+            end_net(mSender);
+            end_net(mReceiver);
+        }
+
+        // Receives until count packets arrived or a second went by without any.
+        S32 receive(LLPacketRing& ring, S32 count, S32 first_index)
+        {
+            char buffer[NET_BUFFER_SIZE];
+            S32 received = 0;
+            LLTimer idle;
+            while (received < count && idle.getElapsedTimeF32() < 1.f)
+            {
+                S32 size = ring.receivePacket(mReceiver, buffer);
+                if (size <= 0)
+                {
+                    continue;
+                }
+                ensure_equals("packet size", size, PACKET_SIZE);
+                ensure_equals("packet order", packet_index(buffer), first_index + received);
+                ensure_equals("sender port", (S32)ring.getLastSender().getPort(), mSenderPort);
+                ++received;
+                idle.reset();
+            }
+            return received;
+        }
+
+        // Replays count packets NET_BATCH_SIZE at a time, returns packets per second.
+        F64 replay(bool use_batch_io, S32 count)
+        {
+            LLPacketRing send_ring;
+            LLPacketRing receive_ring;
+            send_ring.setUseBatchIO(use_batch_io);
+            receive_ring.setUseBatchIO(use_batch_io);
+            LLHost receiver(mLoopback, mReceiverPort);
+
+            char buffer[NET_BUFFER_SIZE];
+            LLTimer timer;
+            S32 received = 0;
+            for (S32 sent = 0; sent < count; )
+            {
+                S32 burst = llmin(NET_BATCH_SIZE, count - sent);
+                for (S32 i = 0; i < burst; ++i)
+                {
+                    fill_packet(buffer, sent + i);
+                    send_ring.sendPacket(mSender, buffer, PACKET_SIZE, receiver);
+                }
+                send_ring.flushSends(mSender);
+                received += receive(receive_ring, burst, sent);
+                sent += burst;
+            }
+            F64 seconds = timer.getElapsedTimeF64();
+            ensure_equals("all replayed packets received", received, count);
+            return seconds > 0.0 ? count / seconds : 0.0;
+        }
+
+        S32 mSender;
+        S32 mReceiver;
+        S32 mSenderPort;
+        S32 mReceiverPort;
+        U32 mLoopback;
+        bool mOk;
+    };
+    typedef test_group<packetring_data> packetring_test;
+    typedef packetring_test::object packetring_object;
+    tut::packetring_test packetring_testcase("LLPacketRing");
+
+    template<> template<>
+    void packetring_object::test<1>()
+    {
+        set_test_name("Batched receive keeps order and senders");
+        ensure("sockets opened", mOk);
+
+        const S32 count = NET_BATCH_SIZE + NET_BATCH_SIZE / 2;
+        char buffer[NET_BUFFER_SIZE];
+        for (S32 i = 0; i < count; ++i)
+        {
+            fill_packet(buffer, i);
+            ensure("send_packet", send_packet(mSender, buffer, PACKET_SIZE, mLoopback, mReceiverPort));
+        }
+
+        LLPacketRing ring;
+        ring.setUseBatchIO(true);
+        ensure_equals("received", receive(ring, count, 0), count);
+
+        // Nothing left over once the socket is drained
+        ensure_equals("empty socket", ring.receivePacket(mReceiver, buffer), 0);
+    }
+
+    template<> template<>
+    void packetring_object::test<2>()
+    {
+        set_test_name("Queued sends are delivered on flush");
+        ensure("sockets opened", mOk);
+
+        LLPacketRing send_ring;
+        send_ring.setUseBatchIO(true);
+        LLHost receiver(mLoopback, mReceiverPort);
+
+        const S32 count = 10;
+        char buffer[NET_BUFFER_SIZE];
+        for (S32 i = 0; i < count; ++i)
+        {
+            fill_packet(buffer, i);
+            ensure("sendPacket", send_ring.sendPacket(mSender, buffer, PACKET_SIZE, receiver));
+        }
+        ensure_equals("flushSends failures", send_ring.flushSends(mSender), 0);
+
+        LLPacketRing receive_ring;
+        ensure_equals("received", receive(receive_ring, count, 0), count);
+    }
+
+    template<> template<>
+    void packetring_object::test<3>()
+    {
+        set_test_name("Receive thread keeps order and timestamps packets");
+        ensure("sockets opened", mOk);
+
+        LLPacketRing ring;
+        ring.startReceiveThread(mReceiver);
+        ensure("receive thread", ring.hasReceiveThread());
+
+        const S32 count = 100;
+        char buffer[NET_BUFFER_SIZE];
+        F64 sent_time = LLTimer::getTotalSeconds().value();
+        for (S32 i = 0; i < count; ++i)
+        {
+            fill_packet(buffer, i);
+            ensure("send_packet", send_packet(mSender, buffer, PACKET_SIZE, mLoopback, mReceiverPort));
+        }
+
+        ensure_equals("received", receive(ring, count, 0), count);
+        ensure("receive time", ring.getLastReceiveTime() >= sent_time);
+        ensure_equals("queued", ring.getPacketsQueued(), (U32)count);
+        ensure_equals("dropped", ring.getPacketsDropped(), 0U);
+
+        ring.stopReceiveThread();
+        ensure("receive thread stopped", !ring.hasReceiveThread());
+    }
+
+    template<> template<>
+    void packetring_object::test<4>()
+    {
+        set_test_name("Packet replay throughput");
+        // Timing only, test<1> and test<2> already check batched delivery
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time packet replay");
+        }
+        ensure("sockets opened", mOk);
+
+        const S32 count = 20000;
+        F64 single = replay(false, count);
+        F64 batched = replay(true, count);
+        std::cout << "\nLLPacketRing replay of " << count << " packets: "
+                  << (S32)single << " packets/s per packet, "
+                  << (S32)batched << " packets/s batched" << std::endl;
+    }
+}
@@ -0,0 +1,238 @@
+/**
+ * @file llzerocode_test.cpp
+ * @brief Zero coding test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llzerocode.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const S32 BUFFER_SIZE = 4096;
+
+    // The byte at a time coder this replaced, as the reference
+    S32 reference_encode(const U8* inptr, S32 count, U8* out)
+    {
+        U8* outptr = out;
+        U8 num_zeroes = 0;
+        while (count--)
+        {
+            if (!(*inptr))
+            {
+                if (num_zeroes)
+                {
+                    if (++num_zeroes > 254)
+                    {
+                        *outptr++ = num_zeroes;
+                        num_zeroes = 0;
+                    }
+                }
+                else
+                {
+                    *outptr++ = 0;
+                    num_zeroes = 1;
+                }
+                inptr++;
+            }
+            else
+            {
+                if (num_zeroes)
+                {
+                    *outptr++ = num_zeroes;
+                    num_zeroes = 0;
+                }
+                *outptr++ = *inptr++;
+            }
+        }
+        if (num_zeroes)
+        {
+            *outptr++ = num_zeroes;
+        }
+        return (S32)(outptr - out);
+    }
+
+    S32 reference_decode(const U8* inptr, S32 count, U8* out)
+    {
+        U8* outptr = out;
+        while (count--)
+        {
+            if (!((*outptr++ = *inptr++)))
+            {
+                while ((count--) && (!(*inptr)))
+                {
+                    *outptr++ = *inptr++;
+                    memset(outptr, 0, 255);
+                    outptr += 255;
+                }
+                if (count < 0)
+                {
+                    break;
+                }
+                memset(outptr, 0, (*inptr) - 1);
+                outptr += ((*inptr) - 1);
+                inptr++;
+            }
+        }
+        return (S32)(outptr - out);
+    }
+}
+
+namespace tut
+{
+    struct zerocode_data
+    {
+        // Bodies shaped like object updates: short fields with sparse zeroes,
+        // zero padded vectors and flags, some long runs of empty texture entries.
+        static std::vector<U8> make_body(U32& seed, S32 size)
+        {
+            std::vector<U8> body(size);
+            for (S32 i = 0; i < size; ++i)
+            {
+                seed = seed * 1664525 + 1013904223;
+                U8 byte = (U8)(seed >> 24);
+                body[i] = (byte & 3) ? byte : 0;
+            }
+            seed = seed * 1664525 + 1013904223;
+            S32 run_start = (seed >> 8) % size;
+            S32 run_length = llmin((S32)((seed >> 20) % 600), size - run_start);
+            memset(&body[run_start], 0, run_length);
+            return body;
+        }
+    };
+    typedef test_group<zerocode_data> zerocode_test;
+    typedef zerocode_test::object zerocode_object;
+    tut::zerocode_test zerocode_testcase("LLZeroCode");
+
+    template<> template<>
+    void zerocode_object::test<1>()
+    {
+        set_test_name("Encoding matches the byte at a time coder");
+
+        U32 seed = 1;
+        U8 expected[2 * BUFFER_SIZE];
+        U8 encoded[2 * BUFFER_SIZE];
+        U8 decoded[BUFFER_SIZE];
+        for (S32 size = 0; size < 1200; size += 7)
+        {
+            std::vector<U8> body = make_body(seed, llmax(size, 1));
+            S32 expected_size = reference_encode(body.data(), (S32)body.size(), expected);
+            S32 encoded_size = zero_code_encode(body.data(), (S32)body.size(), encoded);
+            ensure_equals("encoded size", encoded_size, expected_size);
+            ensure_equals("encoded size estimate", zero_code_encoded_size(body.data(), (S32)body.size()), expected_size);
+            ensure("encoded bytes", !memcmp(encoded, expected, expected_size));
+
+            S32 decoded_size = zero_code_decode(encoded, encoded_size, decoded, BUFFER_SIZE);
+            ensure_equals("decoded size", decoded_size, (S32)body.size());
+            ensure("decoded bytes", !memcmp(decoded, body.data(), body.size()));
+        }
+    }
+
+    template<> template<>
+    void zerocode_object::test<2>()
+    {
+        set_test_name("Decoding matches the byte at a time coder");
+
+        // Zero counts, missing trailing counts and runs past 255
+        const U8 bodies[][8] = {
+            { 1, 0, 0, 0, 5, 2, 3, 4 },
+            { 0, 0, 0, 0, 0, 0, 0, 0 },
+            { 7, 7, 7, 7, 7, 7, 7, 0 },
+            { 0, 255, 0, 255, 0, 1, 9, 9 },
+        };
+        U8 expected[BUFFER_SIZE];
+        U8 decoded[BUFFER_SIZE];
+        for (const U8* body : bodies)
+        {
+            S32 expected_size = reference_decode(body, 8, expected);
+            S32 decoded_size = zero_code_decode(body, 8, decoded, BUFFER_SIZE);
+            ensure_equals("decoded size", decoded_size, expected_size);
+            ensure("decoded bytes", !memcmp(decoded, expected, expected_size));
+        }
+
+        const U8 too_long[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        ensure_equals("overflow", zero_code_decode(too_long, sizeof(too_long), decoded, BUFFER_SIZE), -1);
+    }
+
+    template<> template<>
+    void zerocode_object::test<3>()
+    {
+        set_test_name("Zero coding throughput");
+        // Timing only, test<1> and test<2> already check both coders agree
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time zero coding");
+        }
+
+        U32 seed = 2;
+        std::vector<std::vector<U8> > packets;
+        std::vector<std::vector<U8> > encoded_packets;
+        S32 total_bytes = 0;
+        U8 encoded[2 * BUFFER_SIZE];
+        for (S32 i = 0; i < 256; ++i)
+        {
+            std::vector<U8> body = make_body(seed, 100 + (i * 37) % 1100);
+            S32 encoded_size = zero_code_encode(body.data(), (S32)body.size(), encoded);
+            encoded_packets.emplace_back(encoded, encoded + encoded_size);
+            total_bytes += (S32)body.size();
+            packets.push_back(std::move(body));
+        }
+
+        const S32 rounds = 200;
+        U8 decoded[BUFFER_SIZE];
+        S32 check = 0;
+        F64 times[4];
+        for (S32 pass = 0; pass < 4; ++pass)
+        {
+            LLTimer timer;
+            for (S32 r = 0; r < rounds; ++r)
+            {
+                for (size_t p = 0; p < packets.size(); ++p)
+                {
+                    const std::vector<U8>& body = packets[p];
+                    const std::vector<U8>& coded = encoded_packets[p];
+                    switch (pass)
+                    {
+                    case 0: check += reference_encode(body.data(), (S32)body.size(), encoded); break;
+                    case 1: check += zero_code_encode(body.data(), (S32)body.size(), encoded); break;
+                    case 2: check += reference_decode(coded.data(), (S32)coded.size(), decoded); break;
+                    case 3: check += zero_code_decode(coded.data(), (S32)coded.size(), decoded, BUFFER_SIZE); break;
+                    }
+                }
+            }
+            times[pass] = timer.getElapsedTimeF64();
+        }
+        ensure("coded", check > 0);
+
+        F64 megabytes = (F64)total_bytes * rounds / (1024.0 * 1024.0);
+        std::cout << "\nZero coding MB/s: encode " << (S32)(megabytes / times[0]) << " -> " << (S32)(megabytes / times[1])
+                  << ", decode " << (S32)(megabytes / times[2]) << " -> " << (S32)(megabytes / times[3]) << std::endl;
+    }
+}
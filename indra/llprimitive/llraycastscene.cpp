@@ -0,0 +1,338 @@
+/**
+ * @file llraycastscene.cpp
+ * @brief A set of placed volumes that rays can be cast against without
+ * the rest of the viewer, for measuring picking.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llraycastscene.h"
+
+#include "llsdutil.h"
+#include "lltimer.h"
+
+namespace
+{
+    void append_u16(LLSD::Binary& out, U16 value)
+    {
+        out.push_back((U8) (value & 0xFF));
+        out.push_back((U8) (value >> 8));
+    }
+
+    LLVector3 volume_to_agent(const LLRaycastScene::Object& object, const LLVector3& pos)
+    {
+        LLVector3 ret = pos;
+        ret.scaleVec(object.mScale);
+        ret = ret * object.mRotation;
+        ret += object.mPosition;
+        return ret;
+    }
+
+    LLVector3 agent_to_volume(const LLRaycastScene::Object& object, const LLVector3& pos)
+    {
+        LLVector3 ret = pos - object.mPosition;
+        ret = ret * ~object.mRotation;
+        LLVector3 inv_scale(1.f / object.mScale.mV[VX], 1.f / object.mScale.mV[VY], 1.f / object.mScale.mV[VZ]);
+        ret.scaleVec(inv_scale);
+        return ret;
+    }
+}
+
+LLRaycastScene::LLRaycastScene()
+    : mGenerateTime(0.0),
+      mTreeTime(0.0),
+      mNumTriangles(0)
+{
+}
+
+void LLRaycastScene::clear()
+{
+    mObjects.clear();
+    mGenerateTime = 0.0;
+    mTreeTime = 0.0;
+    mNumTriangles = 0;
+}
+
+void LLRaycastScene::addObject(const LLVolumeParams& params, F32 detail,
+                               const LLVector3& position, const LLQuaternion& rotation, const LLVector3& scale,
+                               const LLSD& faces)
+{
+    Object object;
+    object.mParams = params;
+    object.mDetail = detail;
+    object.mPosition = position;
+    object.mRotation = rotation;
+    object.mScale = scale;
+    object.mFaces = faces;
+    mObjects.push_back(object);
+}
+
+void LLRaycastScene::addObject(const LLVolume* volume,
+                               const LLVector3& position, const LLQuaternion& rotation, const LLVector3& scale)
+{
+    LLVolumeParams params = volume->getParams();
+    U8 sculpt_type = params.getSculptType();
+    if (sculpt_type == LL_SCULPT_TYPE_NONE)
+    {
+        addObject(params, volume->getDetail(), position, rotation, scale);
+    }
+    else
+    {
+        // The faces have been mirrored and inverted already
+        params.setSculptID(params.getSculptID(), sculpt_type & LL_SCULPT_TYPE_MASK);
+        addObject(params, volume->getDetail(), position, rotation, scale, encodeFaces(volume));
+    }
+}
+
+LLSD LLRaycastScene::asLLSD() const
+{
+    LLSD objects = LLSD::emptyArray();
+    for (const Object& object : mObjects)
+    {
+        LLSD sd;
+        sd["VolumeParams"] = object.mParams.asLLSD();
+        sd["Detail"] = object.mDetail;
+        sd["Position"] = object.mPosition.getValue();
+        sd["Rotation"] = object.mRotation.getValue();
+        sd["Scale"] = object.mScale.getValue();
+        if (object.mFaces.isDefined())
+        {
+            sd["Faces"] = object.mFaces;
+        }
+        objects.append(sd);
+    }
+
+    LLSD ret;
+    ret["Objects"] = objects;
+    return ret;
+}
+
+bool LLRaycastScene::fromLLSD(const LLSD& sd)
+{
+    clear();
+
+    if (!sd.has("Objects") || !sd["Objects"].isArray())
+    {
+        LL_WARNS() << "No objects in raycast scene" << LL_ENDL;
+        return false;
+    }
+
+    for (const LLSD& entry : llsd::inArray(sd["Objects"]))
+    {
+        LLVolumeParams params;
+        LLSD params_sd = entry["VolumeParams"];
+        if (!params.fromLLSD(params_sd))
+        {
+            LL_WARNS() << "Bad volume params in raycast scene" << LL_ENDL;
+            clear();
+            return false;
+        }
+
+        LLVector3 position(entry["Position"]);
+        LLQuaternion rotation;
+        rotation.setValue(entry["Rotation"]);
+        LLVector3 scale(entry["Scale"]);
+
+        addObject(params, (F32) entry["Detail"].asReal(), position, rotation, scale, entry["Faces"]);
+    }
+
+    return true;
+}
+
+void LLRaycastScene::build()
+{
+    LLTimer timer;
+    mNumTriangles = 0;
+    for (Object& object : mObjects)
+    {
+        object.mVolume = new LLVolume(object.mParams, object.mDetail);
+        if (object.mFaces.isDefined() && !object.mVolume->unpackVolumeFaces(object.mFaces))
+        {
+            LL_WARNS() << "Failed to unpack faces of raycast scene object" << LL_ENDL;
+        }
+        mNumTriangles += object.mVolume->getNumTriangles();
+        updateBounds(object);
+    }
+    mGenerateTime = timer.getElapsedTimeF64();
+
+    timer.reset();
+    for (Object& object : mObjects)
+    {
+        for (S32 i = 0; i < object.mVolume->getNumVolumeFaces(); ++i)
+        {
+            LLVolumeFace& face = object.mVolume->getVolumeFace(i);
+            if (LLVolume::sRaycastBVH)
+            {
+                if (!face.getBVH())
+                {
+                    face.createBVH();
+                }
+            }
+            else if (!face.getOctree())
+            {
+                face.createOctree();
+            }
+        }
+    }
+    mTreeTime = timer.getElapsedTimeF64();
+}
+
+S32 LLRaycastScene::lineSegmentIntersect(const LLVector3& start, const LLVector3& end,
+                                         S32* face_hit, LLVector3* intersection)
+{
+    S32 hit = -1;
+    LLVector3 closest = end;
+
+    for (size_t i = 0; i < mObjects.size(); ++i)
+    {
+        Object& object = mObjects[i];
+        if (object.mVolume.isNull() || !LLLineSegmentBoxIntersect(start, closest, object.mCenter, object.mHalfSize))
+        {
+            continue;
+        }
+
+        LLVector4a v_start, v_end, v_hit;
+        v_start.load3(agent_to_volume(object, start).mV);
+        v_end.load3(agent_to_volume(object, closest).mV);
+
+        S32 face = object.mVolume->lineSegmentIntersect(v_start, v_end, -1, &v_hit);
+        if (face >= 0)
+        {
+            // Later objects only have to beat this one
+            closest = volume_to_agent(object, LLVector3(v_hit));
+            hit = (S32) i;
+            if (face_hit)
+            {
+                *face_hit = face;
+            }
+        }
+    }
+
+    if (hit >= 0 && intersection)
+    {
+        *intersection = closest;
+    }
+    return hit;
+}
+
+//static
+LLSD LLRaycastScene::encodeFaces(const LLVolume* volume)
+{
+    LLSD ret = LLSD::emptyArray();
+    for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+    {
+        const LLVolumeFace& face = volume->getVolumeFace(i);
+        LLSD sd;
+        if (face.mNumVertices < 3 || face.mNumIndices < 3)
+        {
+            sd["NoGeometry"] = true;
+            ret.append(sd);
+            continue;
+        }
+
+        LLVector4a min = face.mPositions[0];
+        LLVector4a max = face.mPositions[0];
+        for (S32 j = 1; j < face.mNumVertices; ++j)
+        {
+            min.setMin(min, face.mPositions[j]);
+            max.setMax(max, face.mPositions[j]);
+        }
+
+        LLVector4a range;
+        range.setSub(max, min);
+        const F32* range_ptr = range.getF32ptr();
+        LLVector4a scale(range_ptr[0] > 0.f ? 65535.f / range_ptr[0] : 0.f,
+                         range_ptr[1] > 0.f ? 65535.f / range_ptr[1] : 0.f,
+                         range_ptr[2] > 0.f ? 65535.f / range_ptr[2] : 0.f);
+
+        LLSD::Binary pos;
+        pos.reserve(face.mNumVertices * 6);
+        for (S32 j = 0; j < face.mNumVertices; ++j)
+        {
+            LLVector4a p;
+            p.setSub(face.mPositions[j], min);
+            p.mul(scale);
+            const F32* p_ptr = p.getF32ptr();
+            for (U32 k = 0; k < 3; ++k)
+            {
+                append_u16(pos, (U16) llclamp(ll_round(p_ptr[k]), 0, 65535));
+            }
+        }
+
+        LLSD::Binary idx;
+        idx.reserve(face.mNumIndices * 2);
+        for (S32 j = 0; j < face.mNumIndices; ++j)
+        {
+            append_u16(idx, face.mIndices[j]);
+        }
+
+        sd["PositionDomain"]["Min"] = LLVector3(min).getValue();
+        sd["PositionDomain"]["Max"] = LLVector3(max).getValue();
+        sd["Position"] = pos;
+        sd["TriangleList"] = idx;
+        ret.append(sd);
+    }
+    return ret;
+}
+
+void LLRaycastScene::updateBounds(Object& object)
+{
+    LLVector4a min, max;
+    min.splat(0.f);
+    max.splat(0.f);
+    for (S32 i = 0; i < object.mVolume->getNumVolumeFaces(); ++i)
+    {
+        const LLVolumeFace& face = object.mVolume->getVolumeFace(i);
+        if (i == 0)
+        {
+            min = face.mExtents[0];
+            max = face.mExtents[1];
+        }
+        else
+        {
+            min.setMin(min, face.mExtents[0]);
+            max.setMax(max, face.mExtents[1]);
+        }
+    }
+
+    LLVector3 agent_min, agent_max;
+    for (U32 corner = 0; corner < 8; ++corner)
+    {
+        LLVector3 p((corner & 1 ? max : min).getF32ptr()[0],
+                    (corner & 2 ? max : min).getF32ptr()[1],
+                    (corner & 4 ? max : min).getF32ptr()[2]);
+        p = volume_to_agent(object, p);
+        if (corner == 0)
+        {
+            agent_min = agent_max = p;
+        }
+        else
+        {
+            update_min_max(agent_min, agent_max, p);
+        }
+    }
+
+    object.mCenter = (agent_min + agent_max) * 0.5f;
+    object.mHalfSize = (agent_max - agent_min) * 0.5f;
+}
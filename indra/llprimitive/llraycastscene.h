@@ -0,0 +1,109 @@
+/**
+ * @file llraycastscene.h
+ * @brief A set of placed volumes that rays can be cast against without
+ * the rest of the viewer, for measuring picking.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLRAYCASTSCENE_H
+#define LL_LLRAYCASTSCENE_H
+
+#include "llvolume.h"
+#include "llquaternion.h"
+#include "llsd.h"
+
+// Objects are kept the way they would be rezzed: volume params and a
+// detail, or for sculpts and meshes the faces of the LOD that was showing,
+// in the mesh asset's LOD format.  Placements are in agent space, and a
+// segment is tested the way LLVOVolume::lineSegmentIntersect() does it, so
+// the time spent here is the time spent in LLVolume, LLVolumeOctree and
+// LLVolumeBVH when picking.
+class LLRaycastScene
+{
+public:
+    struct Object
+    {
+        LLVolumeParams mParams;
+        F32 mDetail;
+        LLVector3 mPosition;
+        LLQuaternion mRotation;
+        LLVector3 mScale;
+        // Undefined for prims, which are generated from mParams
+        LLSD mFaces;
+
+        LLPointer<LLVolume> mVolume;
+        // Agent space bounds of mVolume, as center and half size
+        LLVector3 mCenter;
+        LLVector3 mHalfSize;
+    };
+
+    LLRaycastScene();
+
+    void clear();
+
+    // A prim to be generated from its params, or any volume given its
+    // faces as encodeFaces() makes them
+    void addObject(const LLVolumeParams& params, F32 detail,
+                   const LLVector3& position, const LLQuaternion& rotation, const LLVector3& scale,
+                   const LLSD& faces = LLSD());
+    // Any volume, keeping the faces it has now unless it is a plain prim
+    void addObject(const LLVolume* volume,
+                   const LLVector3& position, const LLQuaternion& rotation, const LLVector3& scale);
+
+    S32 getNumObjects() const { return static_cast<S32>(mObjects.size()); }
+    const Object& getObject(S32 i) const { return mObjects[i]; }
+
+    // { "Objects": [ { "VolumeParams", "Detail", "Position", "Rotation",
+    // "Scale", "Faces" (sculpts and meshes only) }, ... ] }
+    LLSD asLLSD() const;
+    bool fromLLSD(const LLSD& sd);
+
+    // Makes the volumes, then the octree or BVH of every face as
+    // LLVolume::sRaycastBVH says.  The time each step took is kept.
+    void build();
+    F64 getGenerateTime() const { return mGenerateTime; }
+    F64 getTreeTime() const { return mTreeTime; }
+    S32 getNumTriangles() const { return mNumTriangles; }
+
+    // Index of the object hit closest to start, or -1.  end is in agent
+    // space like start, and is not moved.  Builds any trees build() did
+    // not.
+    S32 lineSegmentIntersect(const LLVector3& start, const LLVector3& end,
+                             S32* face_hit = nullptr,           // return the face of the object that was hit
+                             LLVector3* intersection = nullptr  // return the intersection point
+        );
+
+    // The faces of a volume in the format unpackVolumeFaces() takes, with
+    // positions and indices only
+    static LLSD encodeFaces(const LLVolume* volume);
+
+private:
+    void updateBounds(Object& object);
+
+    std::vector<Object> mObjects;
+    F64 mGenerateTime;
+    F64 mTreeTime;
+    S32 mNumTriangles;
+};
+
+#endif
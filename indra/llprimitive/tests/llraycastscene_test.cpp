@@ -0,0 +1,304 @@
+/**
+ * @file llraycastscene_test.cpp
+ * @brief Raycast benchmark over generated or captured scenes.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llraycastscene.h"
+
+#include "../../llmath/llvolumemgr.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Set LL_RAYCAST_SCENE to a file saved with Develop > World > Capture
+// Raycast Scene to time that scene instead of the generated one.
+
+namespace tut
+{
+    struct raycastscene_data
+    {
+        static F32 nextRandom(U32& seed)
+        {
+            seed = seed * 1664525 + 1013904223;
+            return (F32)(seed >> 8) / (F32)(1 << 24);
+        }
+
+        LLVolumeParams makeParams(U32& seed)
+        {
+            const U8 profiles[] = { LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PROFILE_SQUARE, LL_PCODE_PROFILE_EQUALTRI, LL_PCODE_PROFILE_CIRCLE_HALF };
+            const U8 paths[] = { LL_PCODE_PATH_LINE, LL_PCODE_PATH_CIRCLE };
+
+            LLVolumeParams params;
+            U8 profile = profiles[(S32)(nextRandom(seed) * 4) % 4];
+            U8 path = profile == LL_PCODE_PROFILE_CIRCLE_HALF ? LL_PCODE_PATH_CIRCLE : paths[(S32)(nextRandom(seed) * 2) % 2];
+            params.setType(profile, path);
+            if (path == LL_PCODE_PATH_CIRCLE && profile != LL_PCODE_PROFILE_CIRCLE_HALF)
+            {
+                params.setRatio(1.f, 0.25f);
+            }
+            if (nextRandom(seed) < 0.3f)
+            {
+                params.setHollow(0.5f);
+            }
+            return params;
+        }
+
+        // A few hundred prims and meshes over a 64m square, the size of a
+        // busy parcel seen from the ground
+        void makeScene(LLRaycastScene& scene, S32 count)
+        {
+            U32 seed = 11;
+            for (S32 i = 0; i < count; ++i)
+            {
+                LLVolumeParams params = makeParams(seed);
+                F32 detail = LLVolumeLODGroup::getVolumeScaleFromDetail((S32)(nextRandom(seed) * 4) % 4);
+                LLVector3 position(nextRandom(seed) * 64.f, nextRandom(seed) * 64.f, 20.f + nextRandom(seed) * 10.f);
+                LLQuaternion rotation(nextRandom(seed) * F_TWO_PI, LLVector3(nextRandom(seed) - 0.5f, nextRandom(seed) - 0.5f, nextRandom(seed) - 0.5f));
+                LLVector3 scale(0.2f + nextRandom(seed) * 4.f, 0.2f + nextRandom(seed) * 4.f, 0.2f + nextRandom(seed) * 4.f);
+
+                if (i % 4 == 0)
+                {
+                    // Stands in for a mesh: the faces of a finer prim
+                    LLPointer<LLVolume> volume = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+                    params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_MESH);
+                    scene.addObject(params, detail, position, rotation, scale, LLRaycastScene::encodeFaces(volume));
+                }
+                else
+                {
+                    scene.addObject(params, detail, position, rotation, scale);
+                }
+            }
+        }
+
+        // Hover picks: from eye height at the edge of the scene toward a
+        // random point past the far side
+        void makeRay(U32& seed, LLVector3& start, LLVector3& end)
+        {
+            start.set(nextRandom(seed) * 64.f, -10.f, 22.f + nextRandom(seed) * 6.f);
+            end.set(nextRandom(seed) * 96.f - 16.f, 128.f, 10.f + nextRandom(seed) * 30.f);
+        }
+
+        bool sameHits(LLRaycastScene& a, LLRaycastScene& b, S32 rays, F32 tolerance, S32& hits)
+        {
+            U32 seed = 17;
+            hits = 0;
+            for (S32 i = 0; i < rays; ++i)
+            {
+                LLVector3 start, end, hit_a, hit_b;
+                makeRay(seed, start, end);
+                S32 face_a = -1, face_b = -1;
+                S32 object_a = a.lineSegmentIntersect(start, end, &face_a, &hit_a);
+                S32 object_b = b.lineSegmentIntersect(start, end, &face_b, &hit_b);
+                if (object_a != object_b || face_a != face_b)
+                {
+                    return false;
+                }
+                if (object_a >= 0)
+                {
+                    if ((hit_a - hit_b).magVec() > tolerance)
+                    {
+                        return false;
+                    }
+                    ++hits;
+                }
+            }
+            return true;
+        }
+    };
+    typedef test_group<raycastscene_data> raycastscene_test;
+    typedef raycastscene_test::object raycastscene_object;
+    tut::raycastscene_test raycastscene_testcase("LLRaycastScene");
+
+    template<> template<>
+    void raycastscene_object::test<1>()
+    {
+        set_test_name("Captured faces hit where the prim does");
+
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE);
+        LLVector3 position(10.f, 20.f, 25.f);
+        LLQuaternion rotation(0.5f, LLVector3(1.f, 1.f, 0.f));
+        LLVector3 scale(8.f, 8.f, 3.f);
+        F32 detail = LLVolumeLODGroup::getVolumeScaleFromDetail(2);
+
+        LLRaycastScene prim, captured;
+        prim.addObject(params, detail, position, rotation, scale);
+        LLPointer<LLVolume> volume = new LLVolume(params, detail);
+        params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_MESH);
+        captured.addObject(params, detail, position, rotation, scale, LLRaycastScene::encodeFaces(volume));
+        prim.build();
+        captured.build();
+
+        ensure_equals("same triangles", captured.getNumTriangles(), prim.getNumTriangles());
+
+        U32 seed = 3;
+        S32 hits = 0;
+        for (S32 i = 0; i < 1000; ++i)
+        {
+            LLVector3 start(nextRandom(seed) * 20.f, 0.f, 20.f + nextRandom(seed) * 10.f);
+            LLVector3 end(nextRandom(seed) * 20.f, 40.f, 20.f + nextRandom(seed) * 10.f);
+            LLVector3 hit_prim, hit_captured;
+            S32 object_prim = prim.lineSegmentIntersect(start, end, NULL, &hit_prim);
+            S32 object_captured = captured.lineSegmentIntersect(start, end, NULL, &hit_captured);
+            if (object_prim >= 0 && object_captured >= 0)
+            {
+                // Positions are 16 bits over each face's bounds
+                ensure("close", (hit_prim - hit_captured).magVec() < 0.01f);
+                ++hits;
+            }
+        }
+        ensure("some hits", hits > 100);
+    }
+
+    template<> template<>
+    void raycastscene_object::test<2>()
+    {
+        set_test_name("Saved scenes hit the same");
+
+        LLRaycastScene scene;
+        makeScene(scene, 200);
+
+        std::stringstream str;
+        LLSDSerialize::toBinary(scene.asLLSD(), str);
+        LLSD sd;
+        ensure("read back", LLSDSerialize::fromBinary(sd, str, str.str().size()) > 0);
+
+        LLRaycastScene loaded;
+        ensure("loaded", loaded.fromLLSD(sd));
+        ensure_equals("objects", loaded.getNumObjects(), scene.getNumObjects());
+        ensure("bad scene", !loaded.fromLLSD(LLSD()));
+        loaded.fromLLSD(sd);
+
+        scene.build();
+        loaded.build();
+        ensure_equals("triangles", loaded.getNumTriangles(), scene.getNumTriangles());
+
+        S32 hits = 0;
+        ensure("same hits", sameHits(scene, loaded, 2000, 0.f, hits));
+        ensure("some hits", hits > 100);
+    }
+
+    template<> template<>
+    void raycastscene_object::test<3>()
+    {
+        set_test_name("Octree and BVH hit the same");
+
+        LLRaycastScene scene;
+        makeScene(scene, 200);
+        scene.build();
+
+        bool raycast_bvh = LLVolume::sRaycastBVH;
+        U32 seed = 29;
+        S32 hits = 0;
+        S32 mismatches = 0;
+        for (S32 i = 0; i < 2000; ++i)
+        {
+            LLVector3 start, end, hit_octree, hit_bvh;
+            makeRay(seed, start, end);
+            S32 face_octree = -1, face_bvh = -1;
+            LLVolume::sRaycastBVH = false;
+            S32 object_octree = scene.lineSegmentIntersect(start, end, &face_octree, &hit_octree);
+            LLVolume::sRaycastBVH = true;
+            S32 object_bvh = scene.lineSegmentIntersect(start, end, &face_bvh, &hit_bvh);
+            if (object_octree != object_bvh || face_octree != face_bvh
+                || (object_octree >= 0 && (hit_octree - hit_bvh).magVec() > 0.001f))
+            {
+                ++mismatches;
+            }
+            hits += object_octree >= 0;
+        }
+        LLVolume::sRaycastBVH = raycast_bvh;
+
+        ensure_equals("same hits", mismatches, 0);
+        ensure("some hits", hits > 100);
+    }
+
+    template<> template<>
+    void raycastscene_object::test<4>()
+    {
+        set_test_name("Rays per second");
+
+        // Timing only, test<3> already checks octree and BVH agree
+        const char* path = getenv("LL_RAYCAST_SCENE");
+        if (!path && !getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS or LL_RAYCAST_SCENE to time raycasts");
+        }
+
+        LLSD captured;
+        if (path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            ensure("scene file", file.is_open() && LLSDSerialize::deserialize(captured, file, LLSDSerialize::SIZE_UNLIMITED));
+        }
+
+        const S32 rays = 20000;
+        bool raycast_bvh = LLVolume::sRaycastBVH;
+        S32 hits[2] = { 0, 0 };
+        for (S32 bvh = 0; bvh < 2; ++bvh)
+        {
+            LLVolume::sRaycastBVH = bvh != 0;
+
+            LLRaycastScene scene;
+            if (captured.isDefined())
+            {
+                ensure("captured scene", scene.fromLLSD(captured));
+            }
+            else
+            {
+                makeScene(scene, 400);
+            }
+            scene.build();
+
+            U32 seed = 23;
+            LLTimer timer;
+            for (S32 i = 0; i < rays; ++i)
+            {
+                LLVector3 start, end;
+                makeRay(seed, start, end);
+                if (scene.lineSegmentIntersect(start, end) >= 0)
+                {
+                    ++hits[bvh];
+                }
+            }
+            F64 ray_time = timer.getElapsedTimeF64();
+
+            std::cout << "\n" << (path ? path : "generated scene") << " (" << (bvh ? "BVH" : "octree") << "), "
+                      << scene.getNumObjects() << " objects, " << scene.getNumTriangles() << " triangles: generate "
+                      << scene.getGenerateTime() * 1000.0 << " ms, trees " << scene.getTreeTime() * 1000.0 << " ms, "
+                      << (S32)(rays / ray_time) << " rays/s, " << hits[bvh] << " hits" << std::endl;
+        }
+        LLVolume::sRaycastBVH = raycast_bvh;
+
+        ensure_equals("octree and BVH agree", hits[1], hits[0]);
+    }
+}
@@ -790,7 +790,15 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
                 if (is_compressed)
                 {
                     GLsizei tex_size = (GLsizei)dataFormatBytes(mFormatPrimary, w, h);
+                    if (gl_level == 0)
+                    {
+                        free_cur_tex_image();
+                    }
                     glCompressedTexImage2D(mTarget, gl_level, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
+                    if (gl_level == 0)
+                    {
+                        alloc_tex_image(w, h, mFormatPrimary, 1);
+                    }
                     stop_glerror();
                 }
                 else
@@ -993,7 +1001,9 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
         if (is_compressed)
         {
             GLsizei tex_size = (GLsizei)dataFormatBytes(mFormatPrimary, w, h);
+            free_cur_tex_image();
             glCompressedTexImage2D(mTarget, 0, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
+            alloc_tex_image(w, h, mFormatPrimary, 1);
             stop_glerror();
         }
         else
@@ -1620,6 +1630,63 @@ bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
     return createGLTexture(discard_level, rawdata, false, usename, defer_copy, tex_name);
 }
 
+bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* compressed, S32 usename, S32 category)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    checkActiveThread();
+
+    if (!compressed || !compressed->isCompressed() || !imageraw || imageraw->isBufferInvalid()
+        || compressed->getWidth() != imageraw->getWidth()
+        || compressed->getHeight() != imageraw->getHeight()
+        || mHasExplicitFormat)
+    {
+        return createGLTexture(discard_level, imageraw, usename, true, category);
+    }
+
+    if (gGLManager.mIsDisabled)
+    {
+        LL_WARNS() << "Trying to create a texture while GL is disabled!" << LL_ENDL;
+        return false;
+    }
+
+    if (discard_level < 0)
+    {
+        llassert(mCurrentDiscardLevel >= 0);
+        discard_level = mCurrentDiscardLevel;
+    }
+
+    S32 raw_w = imageraw->getWidth();
+    S32 raw_h = imageraw->getHeight();
+
+    if (!setSize(raw_w << discard_level, raw_h << discard_level, imageraw->getComponents(), discard_level))
+    {
+        LL_WARNS() << "Trying to create a texture with incorrect dimensions!" << LL_ENDL;
+        mGLTextureCreated = false;
+        return false;
+    }
+
+    // Alpha analysis and the pick mask need the uncompressed layout
+    mFormatInternal = mComponents == 4 ? GL_RGBA8 : GL_RGB8;
+    mFormatPrimary = mComponents == 4 ? GL_RGBA : GL_RGB;
+    mFormatType = GL_UNSIGNED_BYTE;
+    calcAlphaChannelOffsetAndStride();
+    analyzeAlpha(imageraw->getData(), raw_w, raw_h);
+    updatePickMask(raw_w, raw_h, imageraw->getData());
+
+    // DXR1 is only produced for opaque images, so the punch-through alpha
+    // of the RGBA variant is never used.
+    const LLGLenum format = (compressed->getFileFormat() == LLImageDXT::FORMAT_DXR5) ?
+        GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    mFormatInternal = format;
+    mFormatPrimary = format;
+
+    setCategory(category);
+    // Smaller mips are stored before the largest one, which is what setImage() expects
+    LLImageDataSharedLock lock(compressed);
+    const U8* data = compressed->getData() + compressed->getMipOffset(0);
+    return createGLTexture(discard_level, data, true, usename);
+}
+
 bool LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, bool data_hasmips, S32 usename, bool defer_copy, LLGLuint* tex_name)
 // Call with void data, vmem is allocated but unitialized
 {
@@ -1854,9 +1921,15 @@ bool LLImageGL::readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compre
     LLGLint is_compressed = 0;
     if (compressed_ok)
     {
-        glGetTexLevelParameteriv(mTarget, is_compressed, GL_TEXTURE_COMPRESSED, (GLint*)&is_compressed);
+        glGetTexLevelParameteriv(mTarget, gl_discard, GL_TEXTURE_COMPRESSED, (GLint*)&is_compressed);
     }
 
+    // Block compressed textures are decompressed by GL into the layout
+    // their raw image had
+    const bool decompress = isCompressed();
+    const LLGLenum read_format = decompress ? (ncomponents == 4 ? GL_RGBA : GL_RGB) : mFormatPrimary;
+    const LLGLenum read_type = decompress ? GL_UNSIGNED_BYTE : mFormatType;
+
     //-----------------------------------------------------------------------------------------------
     GLenum error ;
     while((error = glGetError()) != GL_NO_ERROR)
@@ -1890,7 +1963,7 @@ bool LLImageGL::readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compre
             return false ;
         }
 
-        glGetTexImage(GL_TEXTURE_2D, gl_discard, mFormatPrimary, mFormatType, (GLvoid*)(imageraw->getData()));
+        glGetTexImage(GL_TEXTURE_2D, gl_discard, read_format, read_type, (GLvoid*)(imageraw->getData()));
         //stop_glerror();
     }
 
@@ -2296,7 +2369,7 @@ void LLImageGL::freePickMask()
     mPickMaskWidth = mPickMaskHeight = 0;
 }
 
-bool LLImageGL::isCompressed()
+bool LLImageGL::isCompressed() const
 {
     llassert(mFormatPrimary != 0);
     // *NOTE: Not all compressed formats are included here.
@@ -2452,6 +2525,11 @@ bool LLImageGL::scaleDown(S32 desired_discard)
         return false;
     }
 
+    if (isCompressed())
+    {
+        return scaleDownCompressed(desired_discard);
+    }
+
     S32 mip = desired_discard - mCurrentDiscardLevel;
 
     S32 desired_width = getWidth(desired_discard);
@@ -2533,6 +2611,72 @@ bool LLImageGL::scaleDown(S32 desired_discard)
     return true;
 }
 
+bool LLImageGL::scaleDownCompressed(S32 desired_discard)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    // Compressed textures are uploaded with their whole mip chain, so the
+    // smaller levels are copied down through the scratch PBO as they are.
+    // Neither drawing nor glGenerateMipmap can write compressed formats.
+    if (!mHasMipMaps)
+    {
+        return false;
+    }
+
+    S32 mip = desired_discard - mCurrentDiscardLevel;
+    S32 levels = mMaxDiscardLevel - desired_discard + 1;
+
+    std::vector<U64> offsets(levels + 1, 0);
+    for (S32 i = 0; i < levels; ++i)
+    {
+        offsets[i + 1] = offsets[i] + dataFormatBytes(mFormatPrimary, getWidth(desired_discard + i), getHeight(desired_discard + i));
+    }
+    U64 size = offsets[levels];
+
+    gGL.getTexUnit(0)->bind(this, false, true);
+
+    if (sScratchPBO == 0)
+    {
+        glGenBuffers(1, &sScratchPBO);
+        sScratchPBOSize = 0;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, sScratchPBO);
+
+    if (size > sScratchPBOSize)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_COPY);
+        sScratchPBOSize = (U32)size;
+    }
+
+    for (S32 i = 0; i < levels; ++i)
+    {
+        glGetCompressedTexImage(mTarget, mip + i, (GLvoid*)offsets[i]);
+    }
+
+    free_tex_image(mTexName);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sScratchPBO);
+    for (S32 i = 0; i < levels; ++i)
+    {
+        glCompressedTexImage2D(mTarget, i, mFormatPrimary, getWidth(desired_discard + i), getHeight(desired_discard + i), 0,
+                               (GLsizei)(offsets[i + 1] - offsets[i]), (GLvoid*)offsets[i]);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glTexParameteri(mTarget, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    alloc_tex_image(getWidth(desired_discard), getHeight(desired_discard), mFormatPrimary, 1);
+
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+
+    mMipLevels = levels - 1;
+    mCurrentDiscardLevel = desired_discard;
+
+    return true;
+}
+
 
 //----------------------------------------------------------------------------
 #if LL_IMAGEGL_THREAD_CHECK
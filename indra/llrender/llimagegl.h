@@ -29,6 +29,7 @@
 #define LL_LLIMAGEGL_H
 
 #include "llimage.h"
+#include "llimagedxt.h"
 
 #include "llgltypes.h"
 #include "llpointer.h"
@@ -127,6 +128,10 @@ class LLImageGL : public LLRefCount
     bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, bool to_create = true,
         S32 category = sMaxCategories-1, bool defer_copy = false, LLGLuint* tex_name = nullptr);
     bool createGLTexture(S32 discard_level, const U8* data, bool data_hasmips = false, S32 usename = 0, bool defer_copy = false, LLGLuint* tex_name = nullptr);
+    // Uploads a block compressed copy of imageraw (see LLImageDXT::encodeCompressed).
+    // imageraw is still needed for alpha analysis and the pick mask.
+    bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* compressed, S32 usename = 0,
+        S32 category = sMaxCategories-1);
     void setImage(const LLImageRaw* imageraw);
     bool setImage(const U8* data_in, bool data_hasmips = false, S32 usename = 0);
     // *TODO: This function may not work if the textures is compressed (i.e.
@@ -229,7 +234,10 @@ class LLImageGL : public LLRefCount
 private:
     U32 createPickMask(S32 pWidth, S32 pHeight);
     void freePickMask();
-    bool isCompressed();
+    bool isCompressed() const;
+    // scaleDown() for block compressed textures, which keep their
+    // uploaded mips instead of being redrawn
+    bool scaleDownCompressed(S32 desired_discard);
 
     LLPointer<LLImageRaw> mSaveData; // used for destroyGL/restoreGL
     LL::WorkQueue::weak_t mMainQueue;
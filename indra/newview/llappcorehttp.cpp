@@ -50,6 +50,7 @@
 
 const F64 LLAppCoreHttp::MAX_THREAD_WAIT_TIME(10.0);
 const long LLAppCoreHttp::PIPELINING_DEPTH(5L);
+const long LLAppCoreHttp::HTTP2_CONNECTIONS(1L);
 
 //  Default and dynamic values for classes
 static const struct
@@ -59,57 +60,59 @@ static const struct
     U32                         mMax;
     U32                         mRate;
     bool                        mPipelined;
+    bool                        mMultiplexed;
+    bool                        mAdaptive;
     std::string                 mKey;
     const char *                mUsage;
 } init_data[LLAppCoreHttp::AP_COUNT] =
 {
     { // AP_DEFAULT
-        8,      8,      8,      0,      false,
+        8,      8,      8,      0,      false,  false,  false,
         "",
         "other"
     },
     { // AP_TEXTURE
-        8,      1,      12,     0,      true,
+        8,      1,      12,     0,      true,   true,   true,
         "TextureFetchConcurrency",
         "texture fetch"
     },
     { // AP_MESH1
-        32,     1,      128,    0,      false,
+        32,     1,      128,    0,      false,  false,  true,
         "MeshMaxConcurrentRequests",
         "mesh fetch"
     },
     { // AP_MESH2
-        8,      1,      32,     0,      true,
+        8,      1,      32,     0,      true,   true,   true,
         "Mesh2MaxConcurrentRequests",
         "mesh2 fetch"
     },
     { // AP_LARGE_MESH
-        2,      1,      8,      0,      false,
+        2,      1,      8,      0,      false,  false,  false,
         "",
         "large mesh fetch"
     },
     { // AP_UPLOADS
-        2,      1,      8,      0,      false,
+        2,      1,      8,      0,      false,  false,  false,
         "",
         "asset upload"
     },
     { // AP_LONG_POLL
-        32,     32,     32,     0,      false,
+        32,     32,     32,     0,      false,  false,  false,
         "",
         "long poll"
     },
     { // AP_INVENTORY
-        4,      1,      4,      0,      false,
+        4,      1,      4,      0,      false,  false,  false,
         "",
         "inventory"
     },
     { // AP_MATERIALS
-        2,      1,      8,      0,      false,
+        2,      1,      8,      0,      false,  false,  false,
         "RenderMaterials",
         "material manager requests"
     },
     { // AP_AGENT
-        2,      1,      32,     0,      false,
+        2,      1,      32,     0,      false,  false,  false,
         "Agent",
         "Agent requests"
     }
@@ -122,7 +125,8 @@ static void ssl_verification_changed();
 LLAppCoreHttp::HttpClass::HttpClass()
     : mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
       mConnLimit(0U),
-      mPipelined(false)
+      mPipelined(false),
+      mMultiplexed(false)
 {}
 
 
@@ -131,7 +135,9 @@ LLAppCoreHttp::LLAppCoreHttp()
       mStopHandle(LLCORE_HTTP_HANDLE_INVALID),
       mStopRequested(0.0),
       mStopped(false),
-      mPipelined(true)
+      mPipelined(true),
+      mMultiplexed(false),
+      mAdaptive(false)
 {}
 
 
@@ -281,6 +287,22 @@ void LLAppCoreHttp::init()
         LL_INFOS("Init") << "HTTP Pipelining " << (mPipelined ? "enabled" : "disabled") << "!" << LL_ENDL;
     }
 
+    // Global HTTP/2 setting, takes precedence over pipelining
+    static const std::string http_multiplexing("HttpMultiplexing");
+    if (gSavedSettings.controlExists(http_multiplexing))
+    {
+        mMultiplexed = gSavedSettings.getBOOL(http_multiplexing);
+        LL_INFOS("Init") << "HTTP/2 multiplexing " << (mMultiplexed ? "enabled" : "disabled") << "!" << LL_ENDL;
+    }
+
+    // Global adaptive concurrency setting
+    static const std::string http_adaptive("HttpAdaptiveConcurrency");
+    if (gSavedSettings.controlExists(http_adaptive))
+    {
+        mAdaptive = gSavedSettings.getBOOL(http_adaptive);
+        LL_INFOS("Init") << "HTTP adaptive concurrency " << (mAdaptive ? "enabled" : "disabled") << "!" << LL_ENDL;
+    }
+
     // Register signals for settings and state changes
     for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
     {
@@ -422,7 +444,8 @@ void LLAppCoreHttp::refreshSettings(bool initial)
         // Pipelining changes
         if (initial)
         {
-            const bool to_pipeline(mPipelined && init_data[i].mPipelined);
+            mHttpClasses[app_policy].mMultiplexed = mMultiplexed && init_data[i].mMultiplexed;
+            const bool to_pipeline(mPipelined && init_data[i].mPipelined && ! mHttpClasses[app_policy].mMultiplexed);
             if (to_pipeline != mHttpClasses[app_policy].mPipelined)
             {
                 // Pipeline election changing, set dynamic option via request
@@ -449,6 +472,30 @@ void LLAppCoreHttp::refreshSettings(bool initial)
                     mHttpClasses[app_policy].mPipelined = to_pipeline;
                 }
             }
+
+            if (mAdaptive && init_data[i].mAdaptive)
+            {
+                // Let llcorehttp move the in-flight limit up to what
+                // the largest concurrency setting would allow.
+                LLCore::HttpHandle handle;
+                const long ceiling(mHttpClasses[app_policy].mMultiplexed
+                                   ? init_data[i].mMax * HTTP2_CONNECTIONS
+                                   : mHttpClasses[app_policy].mPipelined
+                                   ? init_data[i].mMax * PIPELINING_DEPTH
+                                   : init_data[i].mMax);
+
+                handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_ADAPTIVE_LIMIT,
+                                                   mHttpClasses[app_policy].mPolicy,
+                                                   ceiling,
+                                                   LLCore::HttpHandler::ptr_t());
+                if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                {
+                    status = mRequest->getStatus();
+                    LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+                                     << " adaptive concurrency.  Reason:  " << status.toString()
+                                     << LL_ENDL;
+                }
+            }
         }
 
         // Get target connection concurrency value
@@ -479,10 +526,31 @@ void LLAppCoreHttp::refreshSettings(bool initial)
             // avatars, etc.) can request additional outbound connections
             // to other servers via 2X total connection limit.
             //
+            // HTTP/2.  As with pipelining but the setting is the number
+            // of concurrent streams on a single connection per host.
+            //
+            const bool multiplexed(mHttpClasses[app_policy].mMultiplexed);
+            const U32 per_host_limit(multiplexed ? U32(HTTP2_CONNECTIONS) : setting);
             LLCore::HttpHandle handle;
+            if (multiplexed)
+            {
+                handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAMS,
+                                                   mHttpClasses[app_policy].mPolicy,
+                                                   setting,
+                                                   LLCore::HttpHandler::ptr_t());
+                if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                {
+                    status = mRequest->getStatus();
+                    LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+                                     << " HTTP/2 streams.  Reason:  " << status.toString()
+                                     << LL_ENDL;
+                }
+            }
             handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_CONNECTION_LIMIT,
                                                mHttpClasses[app_policy].mPolicy,
-                                               (mHttpClasses[app_policy].mPipelined ? 2 * setting : setting),
+                                               (mHttpClasses[app_policy].mPipelined || multiplexed
+                                                ? 2 * per_host_limit
+                                                : setting),
                                                LLCore::HttpHandler::ptr_t());
             if (LLCORE_HTTP_HANDLE_INVALID == handle)
             {
@@ -495,7 +563,7 @@ void LLAppCoreHttp::refreshSettings(bool initial)
             {
                 handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
                                                    mHttpClasses[app_policy].mPolicy,
-                                                   setting,
+                                                   per_host_limit,
                                                    LLCore::HttpHandler::ptr_t());
                 if (LLCORE_HTTP_HANDLE_INVALID == handle)
                 {
@@ -42,6 +42,7 @@ class LLAppCoreHttp : public LLCore::HttpHandler
 {
 public:
     static const long           PIPELINING_DEPTH;
+    static const long           HTTP2_CONNECTIONS;
 
     typedef LLCore::HttpRequest::policy_t policy_t;
 
@@ -223,9 +224,10 @@ class LLAppCoreHttp : public LLCore::HttpHandler
         }
 
     // Return whether a policy is using pipelined operations.
+    // HTTP/2 multiplexing counts, it wants the same deep queues.
     bool isPipelined(EAppPolicy policy) const
         {
-            return mHttpClasses[policy].mPipelined;
+            return mHttpClasses[policy].mPipelined || mHttpClasses[policy].mMultiplexed;
         }
 
     // Apply initial or new settings from the environment.
@@ -246,6 +248,7 @@ class LLAppCoreHttp : public LLCore::HttpHandler
         policy_t                    mPolicy;            // Policy class id for the class
         U32                         mConnLimit;
         bool                        mPipelined;
+        bool                        mMultiplexed;       // Using HTTP/2 streams
         boost::signals2::connection mSettingsSignal;    // Signal to global setting that affect this class (if any)
     };
 
@@ -255,6 +258,8 @@ class LLAppCoreHttp : public LLCore::HttpHandler
     bool                        mStopped;
     HttpClass                   mHttpClasses[AP_COUNT];
     bool                        mPipelined;             // Global setting
+    bool                        mMultiplexed;           // Global setting
+    bool                        mAdaptive;              // Global setting
     boost::signals2::connection mPipelinedSignal;       // Signal for 'HttpPipelining' setting
     boost::signals2::connection mSSLNoVerifySignal;     // Signal for 'NoVerifySSLCert' setting
 
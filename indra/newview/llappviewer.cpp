@@ -125,6 +125,8 @@
 #include "lldiriterator.h"
 #include "llexperiencecache.h"
 #include "llimagej2c.h"
+#include "llimagedxt.h"
+#include "llimagefilter.h"
 #include "llmemory.h"
 #include "llprimitive.h"
 #include "llurlaction.h"
@@ -582,6 +584,7 @@ static void settings_modify()
     LLVOSurfacePatch::sLODFactor *= LLVOSurfacePatch::sLODFactor; //square lod factor to get exponential range of [1,4]
     gDebugGL       = gDebugGLSession || gDebugSession;
     gDebugPipeline = gSavedSettings.getBOOL("RenderDebugPipeline");
+    LLVolume::sRaycastBVH = gSavedSettings.getBOOL("RenderRaycastBVH");
 }
 
 class LLFastTimerLogThread : public LLThread
@@ -1781,6 +1784,16 @@ S32 LLAppViewer::updateTextureThreads(F32 max_time)
     }
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_APP("Image Decode");
+        static LLCachedControl<F32> busy_frame_time(gSavedSettings, "ImageDecodeBusyFrameTime", 33.f);
+        if (busy_frame_time > 0.f)
+        {
+            // hand decode threads back to the main thread when frames run long,
+            // but go wide while the scene is rezzing after login or a teleport
+            bool main_thread_busy = gFrameIntervalSeconds.value() * 1000.f > busy_frame_time;
+            bool rez_burst = LLStartUp::getStartupState() < STATE_STARTED
+                || gAgent.getTeleportState() != LLAgent::TELEPORT_NONE;
+            LLAppViewer::getImageDecodeThread()->updateActiveLimit(main_thread_busy, rez_burst);
+        }
         work_pending += LLAppViewer::getImageDecodeThread()->update(max_time); // unpauses the image thread
     }
     {
@@ -2175,6 +2188,7 @@ bool LLAppViewer::cleanup()
     sPurgeDiskCacheThread->shutdown();
     if (mGeneralThreadPool)
     {
+        LLImageFilter::setThreadPool(NULL);
         mGeneralThreadPool->close();
     }
 
@@ -2313,6 +2327,9 @@ void LLAppViewer::initGeneralThread()
 
     mGeneralThreadPool = new LL::ThreadPool("General", 3);
     mGeneralThreadPool->start();
+
+    // snapshot filters split large passes with the general pool
+    LLImageFilter::setThreadPool(mGeneralThreadPool);
 }
 
 bool LLAppViewer::initThreads()
@@ -2340,20 +2357,38 @@ bool LLAppViewer::initThreads()
         cores = llmin(cores, (S32) max_cores);
     }
 
+    // The background pools below share one budget: every core but the
+    // main thread's.  Mesh and volume work take a small share each and
+    // image decoding gets the rest.
+    S32 budget = llmax(cores - 1, 1);
+
+    S32 volume_gen_count = gSavedSettings.getBOOL("RenderAsyncVolumeGeneration") ? llclamp(budget / 6, 1, 2) : 0;
+    S32 mesh_decode_count = llmin((S32)gSavedSettings.getU32("MeshDecodeThreads"), llclamp(budget / 6, 1, 4));
+    S32 mesh_optimize_count = llmin((S32)gSavedSettings.getU32("MeshOptimizeThreads"), llclamp(budget / 8, 0, 4));
+
     // always use at least 2 threads for image decoding to prevent
-    // a single texture blocking all other textures from decoding
-    S32 image_decode_count = llclamp(cores - 6, 2, 16);
+    // a single texture blocking all other textures from decoding.
+    // This is only the upper bound, LLImageDecodeThread::updateActiveLimit
+    // parks threads while the main thread is busy.
+    S32 image_decode_count = llclamp(budget - volume_gen_count - mesh_decode_count - mesh_optimize_count, 2, 16);
 
     threadCounts["ImageDecode"] = image_decode_count;
+    threadCounts["MeshDecode"] = mesh_decode_count;
+    threadCounts["MeshOptimize"] = mesh_optimize_count;
+    threadCounts["VolumeGen"] = volume_gen_count;
     gSavedSettings.setLLSD("ThreadPoolSizes", threadCounts);
 
     // Image decoding
     LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+    LLAppViewer::sImageDecodeThread->setCompressionQuality(llclamp(gSavedSettings.getS32("RenderTextureCPUCompression"), 0, (S32)LLImageDXT::COMPRESS_HIGH));
     LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
     LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(),
                                                     enable_threads && true,
                                                     app_metrics_qa_mode);
 
+    // Prim and sculpt LODs past the first are generated in the background
+    LLPrimitive::getVolumeManager()->startGenerateThreads(volume_gen_count);
+
     // general task background thread (LLPerfStats, etc)
     LLAppViewer::instance()->initGeneralThread();
 
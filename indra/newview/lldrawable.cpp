@@ -49,6 +49,7 @@
 #include "pipeline.h"
 #include "llspatialpartition.h"
 #include "llviewerobjectlist.h"
+#include "llviewercontrol.h"
 #include "llviewerwindow.h"
 #include "llvocache.h"
 #include "llcontrolavatar.h"
@@ -1805,6 +1806,10 @@ LLBridgePartition::LLBridgePartition(LLViewerRegion* regionp)
     mPartitionType = LLViewerRegion::PARTITION_BRIDGE;
     mLODPeriod = 16;
     mSlopRatio = 0.25f;
+
+    // Bridges move constantly, let them drift out of their node a bit
+    // before they are reinserted
+    mOctree->setLooseness(gSavedSettings.getF32("RenderOctreeLooseness"));
 }
 
 LLAvatarPartition::LLAvatarPartition(LLViewerRegion* regionp)
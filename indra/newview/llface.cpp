@@ -174,6 +174,7 @@ void LLFace::init(LLDrawable* drawablep, LLViewerObject* objp)
 
     mTexExtents[0].set(0, 0);
     mTexExtents[1].set(1, 1);
+    mUVRegion.set(0.f, 1.f, 1.f, 0.f);
     mHasMedia = false ;
     mIsMediaAllowed = true;
 }
@@ -2126,6 +2127,38 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
         mTexExtents[1][0] *= es ;
         mTexExtents[0][1] *= et ;
         mTexExtents[1][1] *= et ;
+
+        mUVRegion.set(0.f, 1.f, 1.f, 0.f);
+        if (!gltf_mat && tep->getTexGen() == LLTextureEntry::TEX_GEN_DEFAULT)
+        {
+            F32 uv_os, uv_ot, uv_ms, uv_mt;
+            tep->getOffset(&uv_os, &uv_ot);
+            tep->getScale(&uv_ms, &uv_mt);
+            F32 uv_cos = cosf(tep->getRotation());
+            F32 uv_sin = sinf(tep->getRotation());
+
+            const LLVector2& tc0 = vf.mTexCoordExtents[0];
+            const LLVector2& tc1 = vf.mTexCoordExtents[1];
+            LLVector2 corners[4] = { tc0, LLVector2(tc1.mV[0], tc0.mV[1]), LLVector2(tc0.mV[0], tc1.mV[1]), tc1 };
+            LLVector2 uv_min(F32_MAX, F32_MAX);
+            LLVector2 uv_max(-F32_MAX, -F32_MAX);
+            for (LLVector2& corner : corners)
+            {
+                xform(corner, uv_cos, uv_sin, uv_os, uv_ot, uv_ms, uv_mt);
+                uv_min.setVec(llmin(uv_min.mV[0], corner.mV[0]), llmin(uv_min.mV[1], corner.mV[1]));
+                uv_max.setVec(llmax(uv_max.mV[0], corner.mV[0]), llmax(uv_max.mV[1], corner.mV[1]));
+            }
+
+            // bring the window into [0,1], anything that still straddles
+            // the texture edge wraps around and needs the whole texture
+            LLVector2 wrap(floorf(uv_min.mV[0]), floorf(uv_min.mV[1]));
+            uv_min -= wrap;
+            uv_max -= wrap;
+            if (uv_max.mV[0] <= 1.f && uv_max.mV[1] <= 1.f)
+            {
+                mUVRegion.set(uv_min.mV[0], uv_max.mV[1], uv_max.mV[0], uv_min.mV[1]);
+            }
+        }
     }
 
 
@@ -34,6 +34,7 @@
 #include "v4math.h"
 #include "m4math.h"
 #include "v4coloru.h"
+#include "llrect.h"
 #include "llquaternion.h"
 #include "xform.h"
 #include "llvertexbuffer.h"
@@ -256,6 +257,9 @@ class alignas(16) LLFace
     LLVector3       mCenterAgent;
 
     LLVector2       mTexExtents[2];
+    // Part of the diffuse texture mapped onto this face in [0,1] texture
+    // space, the whole texture when it wraps or can not be determined
+    LLRectf         mUVRegion;
     F32             mDistance;
     F32         mLastUpdateTime;
     F32         mLastSkinTime;
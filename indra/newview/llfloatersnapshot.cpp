@@ -252,6 +252,13 @@ void LLFloaterSnapshot::draw()
 		return;
 	}
 
+	// Show how far a background save got
+	F32 save_progress = gViewerWindow->getSnapshotSaveProgress();
+	if (save_progress >= 0.f && getStatus() == STATUS_WORKING)
+	{
+		getChild<LLUICtrl>("working_lbl")->setValue(llformat("%s %d%%", getString("local_progress_str").c_str(), ll_round(save_progress * 100.f)));
+	}
+
 	LLFloater::draw();
 
 	if (previewp && !isMinimized() && mThumbnailPlaceholder->getVisible())
@@ -1565,7 +1572,24 @@ void LLFloaterSnapshot::saveLocal(LLUICtrl* ctrl)
 	}
 
 	setStatus(LLFloaterSnapshot::STATUS_WORKING, true);
-	saveLocal((boost::bind(&LLFloaterSnapshot::saveLocalFinished, this)), (boost::bind(&LLFloaterSnapshot::saveLocalFailed, this)));
+	// The save may finish in the background after the floater is gone
+	LLHandle<LLFloater> handle = getHandle();
+	saveLocal([handle]()
+		{
+			LLFloaterSnapshot* floater = static_cast<LLFloaterSnapshot*>(handle.get());
+			if (floater)
+			{
+				floater->saveLocalFinished();
+			}
+		},
+		[handle]()
+		{
+			LLFloaterSnapshot* floater = static_cast<LLFloaterSnapshot*>(handle.get());
+			if (floater)
+			{
+				floater->saveLocalFailed();
+			}
+		});
 }
 
 void LLFloaterSnapshot::saveLocalFinished()
@@ -0,0 +1,54 @@
+/**
+ * @file llmeshranges.cpp
+ * @brief Joining byte ranges of one mesh asset into fewer requests
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmeshranges.h"
+
+size_t LLMeshRanges::join(const std::vector<Range>& ranges, size_t first, U32& end)
+{
+    U32 start = ranges[first].mOffset;
+    end = start + ranges[first].mBytes;
+    size_t last = first + 1;
+    while (last < ranges.size()
+           && ranges[last].mOffset <= end + COALESCE_GAP
+           && llmax(end, ranges[last].mOffset + ranges[last].mBytes) - start < LARGE_FETCH_THRESHOLD)
+    {
+        end = llmax(end, ranges[last].mOffset + ranges[last].mBytes);
+        ++last;
+    }
+    return last;
+}
+
+S32 LLMeshRanges::sectionOffset(U32 request_offset, const Range& section, S32 data_size)
+{
+    S32 offset = (S32)(section.mOffset - request_offset);
+    if (offset + (S32)section.mBytes > data_size)
+    {
+        return -1;
+    }
+    return offset;
+}
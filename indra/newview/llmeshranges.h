@@ -0,0 +1,66 @@
+/**
+ * @file llmeshranges.h
+ * @brief Joining byte ranges of one mesh asset into fewer requests
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHRANGES_H
+#define LL_LLMESHRANGES_H
+
+#include <vector>
+
+namespace LLMeshRanges
+{
+    const U32 LARGE_FETCH_THRESHOLD = 1U << 21;     // Size at which requests go to the narrow/slow queue
+    const U32 COALESCE_GAP = 8192;                  // Unwanted bytes fetched to join two ranges of a mesh
+
+    struct Range
+    {
+        U32 mOffset;
+        U32 mBytes;
+    };
+
+    /**
+     * Find the ranges fetched in one request with ranges[first].
+     *
+     * Joins following ranges while the gap before each is at most
+     * COALESCE_GAP and the request stays under LARGE_FETCH_THRESHOLD,
+     * so a joined request never moves to the large fetch queue.
+     *
+     * @param[in]  ranges Ranges of one mesh sorted by offset.
+     * @param[in]  first  Index of the first range of the request.
+     * @param[out] end    End of the request, one past its last byte.
+     *
+     * @return One past the index of the last range in the request.
+     */
+    size_t join(const std::vector<Range>& ranges, size_t first, U32& end);
+
+    /**
+     * Where a section starts in the response to a joined request.
+     *
+     * @return Offset into the response, -1 if it stopped short of the section.
+     */
+    S32 sectionOffset(U32 request_offset, const Range& section, S32 data_size);
+}
+
+#endif // LL_LLMESHRANGES_H
@@ -44,12 +44,15 @@
 #include "llimagej2c.h"
 #include "llhost.h"
 #include "llmath.h"
+#include "llmeshranges.h"
 #include "llnotificationsutil.h"
 #include "llsd.h"
 #include "llsdutil_math.h"
 #include "llsdserialize.h"
 #include "llthread.h"
 #include "llfilesystem.h"
+#include "lltimer.h"
+#include "threadpool.h"
 #include "llviewercontrol.h"
 #include "llviewerinventory.h"
 #include "llviewermenufile.h"
@@ -116,6 +119,7 @@
 //
 //   main     Main rendering thread, very sensitive to locking and other stalls
 //   repo     Overseeing worker thread associated with the LLMeshRepoThread class
+//   decodeN  0-N mesh decode threads (MeshDecodeThreads); with none, repo decodes
 //   decom    Worker thread for mesh decomposition requests
 //   core     HTTP worker thread:  does the work but doesn't intrude here
 //   uploadN  0-N temporary mesh upload threads (0-1 in practice)
@@ -156,9 +160,17 @@
 //                             ...
 //                             onCompleted() invoked for GET
 //                               data copied
-//                               lodReceived() invoked
-//                                 unpack data into LLVolume
-//                                 append LoadedMesh to mLoadedQ
+//                               queueLODDecode() invoked
+//                             ...
+//                                                 decode thread
+//
+//                                                 lodReceived() invoked
+//                                                   unpack data into LLVolume
+//                                                   append LoadedMesh to mLoadedQ
+//                                                 post result to mWorkQueue
+//                             ...
+//                             mWorkQueue run
+//                               LOD written to cache
 //                             ...
 //         notifyLoadedMeshes() invoked again
 //           scan mLoadedQ
@@ -172,6 +184,8 @@
 //   LLMeshRepository::mMeshMutex
 //   LLMeshRepoThread::mMutex
 //   LLMeshRepoThread::mHeaderMutex
+//   LLMeshRepoThread::mSkinMapMutex
+//   LLMeshRepoThread::mDecodeMutex
 //   LLMeshRepoThread::mSignal (LLCondition)
 //   LLPhysicsDecomp::mSignal (LLCondition)
 //   LLPhysicsDecomp::mMutex
@@ -224,6 +238,7 @@
 //     sMeshRequestCount               "
 //     sHTTPRequestCount               "
 //     sHTTPLargeRequestCount          "
+//     sHTTPCoalescedCount             "
 //     sHTTPRetryCount                 "
 //     sHTTPErrorCount                 "
 //     sLODPending                     mMeshMutex [4]  rw.main.mMeshMutex
@@ -232,6 +247,15 @@
 //     sCacheBytesWritten              "
 //     sCacheReads                     "
 //     sCacheWrites                    "
+//     sLODDecodeCount                 Repo::mMutex    rw.decode.Repo::mMutex, ro.main.none [1]
+//     sLODDecodeFacesReused           "
+//     sLODDecodeSeconds               "
+//     sLODDecodeSecondsMax            "
+//     sLODDecodeWaitSeconds           "
+//     sLODInflateSeconds              "
+//     sLODUnpackSeconds               "
+//     sDecodeQueueDepth               atomic          rw.repo.none, rw.decode.none, ro.main.none
+//     sDecodeQueueDepthMax            Repo::mDecodeMutex  rw.repo.mDecodeMutex, ro.main.none [1]
 //     mLoadingMeshes                  mMeshMutex [4]  rw.main.none, rw.any.mMeshMutex
 //     mSkinMap                        none            rw.main.none
 //     mDecompositionMap               none            rw.main.none
@@ -264,10 +288,13 @@
 //     mUnavailableQ            mMutex        rw.repo.none [0], ro.main.none [5], rw.main.mMutex
 //     mLoadedQ                 mMutex        rw.repo.mMutex, ro.main.none [5], rw.main.mMutex
 //     mPendingLOD              mMutex        rw.repo.mMutex, rw.any.mMutex
+//     mSkinMap                 mSkinMapMutex rw.repo.mSkinMapMutex, rw.decode.mSkinMapMutex
+//     mDecodeQueues            mDecodeMutex  rw.repo.mDecodeMutex, rw.decode.mDecodeMutex
 //     mGetMeshCapability       mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
 //     mGetMesh2Capability      mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
 //     mGetMeshVersion          mMutex        rw.main.mMutex, ro.repo.mMutex
 //     mHttp*                   none          rw.repo.none
+//     mPendingRanges           none          rw.repo.none
 //
 //   LLMeshUploadThread:
 //
@@ -354,7 +381,7 @@ const S32 REQUEST2_HIGH_WATER_MAX = 100;
 const S32 REQUEST2_LOW_WATER_MIN = 16;
 const S32 REQUEST2_LOW_WATER_MAX = 50;
 
-const U32 LARGE_MESH_FETCH_THRESHOLD = 1U << 21;        // Size at which requests goes to narrow/slow queue
+const U32 MESH_DECODE_QUEUE_PER_THREAD = 16;            // Decodes queued per decode thread before LOD fetches wait
 const long SMALL_MESH_XFER_TIMEOUT = 120L;              // Seconds to complete xfer, small mesh downloads
 const long LARGE_MESH_XFER_TIMEOUT = 600L;              // Seconds to complete xfer, large downloads
 
@@ -383,6 +410,7 @@ U32 LLMeshRepository::sBytesReceived = 0;
 U32 LLMeshRepository::sMeshRequestCount = 0;
 U32 LLMeshRepository::sHTTPRequestCount = 0;
 U32 LLMeshRepository::sHTTPLargeRequestCount = 0;
+U32 LLMeshRepository::sHTTPCoalescedCount = 0;
 U32 LLMeshRepository::sHTTPRetryCount = 0;
 U32 LLMeshRepository::sHTTPErrorCount = 0;
 U32 LLMeshRepository::sLODProcessing = 0;
@@ -396,6 +424,15 @@ U32 LLMeshRepository::sCacheBytesDecomps = 0;
 U32 LLMeshRepository::sCacheReads = 0;
 U32 LLMeshRepository::sCacheWrites = 0;
 U32 LLMeshRepository::sMaxLockHoldoffs = 0;
+U32 LLMeshRepository::sLODDecodeCount = 0;
+U32 LLMeshRepository::sLODDecodeFacesReused = 0;
+F64 LLMeshRepository::sLODDecodeSeconds = 0.0;
+F64 LLMeshRepository::sLODDecodeSecondsMax = 0.0;
+F64 LLMeshRepository::sLODDecodeWaitSeconds = 0.0;
+F64 LLMeshRepository::sLODInflateSeconds = 0.0;
+F64 LLMeshRepository::sLODUnpackSeconds = 0.0;
+std::atomic<U32> LLMeshRepository::sDecodeQueueDepth{ 0 };
+U32 LLMeshRepository::sDecodeQueueDepthMax = 0;
 
 LLDeadmanTimer LLMeshRepository::sQuiescentTimer(15.0, false);  // true -> gather cpu metrics
 
@@ -411,6 +448,18 @@ namespace {
 
     void NoOpDeletor(LLCore::HttpHandler *)
     { /*NoOp*/ }
+
+    // Response bodies are received into these when their size is
+    // known and handed to processData() without a copy.
+    void * mesh_body_alloc(size_t len)
+    {
+        return new(std::nothrow) U8[len];
+    }
+
+    void mesh_body_free(void * mem)
+    {
+        delete [] static_cast<U8 *>(mem);
+    }
 }
 
 static S32 dump_num = 0;
@@ -455,7 +504,7 @@ U32 get_volume_memory_size(const LLVolume* volume)
 
     for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
     {
-        const LLVolumeFace& face = volume->getVolumeFace(i);
+        const LLVolumeFace& face = volume->peekVolumeFace(i);
         indices += face.mNumIndices;
         vertices += face.mNumVertices;
     }
@@ -574,6 +623,7 @@ S32 LLMeshRepoThread::sRequestWaterLevel = 0;
 //     LLMeshSkinInfoHandler
 //     LLMeshDecompositionHandler
 //     LLMeshPhysicsShapeHandler
+//     LLMeshRangeHandler
 //   LLMeshUploadThread
 
 class LLMeshHandlerBase : public LLCore::HttpHandler,
@@ -604,12 +654,20 @@ class LLMeshHandlerBase : public LLCore::HttpHandler,
     virtual void processData(LLCore::BufferArray * body, S32 body_offset, U8 * data, S32 data_size) = 0;
     virtual void processFailure(LLCore::HttpStatus status) = 0;
 
+    // Called when the request could not be issued at all.  Fetches
+    // with retries left go back on their queue instead of failing.
+    virtual void processIssueFailure(LLCore::HttpStatus status) { processFailure(status); }
+
 public:
     LLVolumeParams mMeshParams;
     bool mProcessed;
     LLCore::HttpHandle mHttpHandle;
     U32 mOffset;
     U32 mRequestedBytes;
+
+    // Owns the buffer handed to processData().  Handlers that decode
+    // after returning keep a reference instead of copying it.
+    std::shared_ptr<U8> mData;
 };
 
 
@@ -645,11 +703,12 @@ class LLMeshLODHandler : public LLMeshHandlerBase
 {
 public:
     LOG_CLASS(LLMeshLODHandler);
-    LLMeshLODHandler(const LLVolumeParams & mesh_params, S32 lod, U32 offset, U32 requested_bytes)
+    LLMeshLODHandler(const LLMeshRepoThread::LODRequest & req, U32 offset, U32 requested_bytes)
         : LLMeshHandlerBase(offset, requested_bytes),
-          mLOD(lod)
+          mLOD(req.mLOD),
+          mRequest(req)
     {
-            mMeshParams = mesh_params;
+            mMeshParams = req.mMeshParams;
             LLMeshRepoThread::incActiveLODRequests();
         }
     virtual ~LLMeshLODHandler();
@@ -661,9 +720,11 @@ class LLMeshLODHandler : public LLMeshHandlerBase
 public:
     virtual void processData(LLCore::BufferArray * body, S32 body_offset, U8 * data, S32 data_size);
     virtual void processFailure(LLCore::HttpStatus status);
+    virtual void processIssueFailure(LLCore::HttpStatus status);
 
 public:
     S32 mLOD;
+    LLMeshRepoThread::LODRequest mRequest;
 };
 
 
@@ -674,9 +735,10 @@ class LLMeshSkinInfoHandler : public LLMeshHandlerBase
 {
 public:
     LOG_CLASS(LLMeshSkinInfoHandler);
-    LLMeshSkinInfoHandler(const LLUUID& id, U32 offset, U32 requested_bytes)
+    LLMeshSkinInfoHandler(const LLMeshRepoThread::UUIDBasedRequest& req, U32 offset, U32 requested_bytes)
         : LLMeshHandlerBase(offset, requested_bytes),
-          mMeshID(id)
+          mMeshID(req.mId),
+          mRequest(req)
     {}
     virtual ~LLMeshSkinInfoHandler();
 
@@ -687,9 +749,11 @@ class LLMeshSkinInfoHandler : public LLMeshHandlerBase
 public:
     virtual void processData(LLCore::BufferArray * body, S32 body_offset, U8 * data, S32 data_size);
     virtual void processFailure(LLCore::HttpStatus status);
+    virtual void processIssueFailure(LLCore::HttpStatus status);
 
 public:
     LLUUID mMeshID;
+    LLMeshRepoThread::UUIDBasedRequest mRequest;
 };
 
 
@@ -745,6 +809,37 @@ class LLMeshPhysicsShapeHandler : public LLMeshHandlerBase
 };
 
 
+// Subclass for one fetch covering several sections of a mesh.
+// Hands each of the handlers it stands in for its own part of
+// the response.
+//
+// Thread:  repo
+class LLMeshRangeHandler : public LLMeshHandlerBase
+{
+public:
+    typedef std::vector<LLMeshHandlerBase::ptr_t> handler_list_t;
+
+    LOG_CLASS(LLMeshRangeHandler);
+    LLMeshRangeHandler(U32 offset, U32 requested_bytes,
+                       handler_list_t::const_iterator begin, handler_list_t::const_iterator end)
+        : LLMeshHandlerBase(offset, requested_bytes),
+          mHandlers(begin, end)
+    {}
+    virtual ~LLMeshRangeHandler();
+
+protected:
+    LLMeshRangeHandler(const LLMeshRangeHandler &);             // Not defined
+    void operator=(const LLMeshRangeHandler &);                 // Not defined
+
+public:
+    virtual void processData(LLCore::BufferArray * body, S32 body_offset, U8 * data, S32 data_size);
+    virtual void processFailure(LLCore::HttpStatus status);
+
+public:
+    handler_list_t mHandlers;
+};
+
+
 void log_upload_error(LLCore::HttpStatus status, const LLSD& content,
                       const char * const stage, const std::string & model_name)
 {
@@ -834,12 +929,15 @@ LLMeshRepoThread::LLMeshRepoThread()
   mHttpHeaders(),
   mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
   mHttpLargePolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+  mDecodeThreadPool(NULL),
   mWorkQueue("MeshRepoThread", 1024*1024)
 {
     LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
 
     mMutex = new LLMutex();
     mHeaderMutex = new LLMutex();
+    mSkinMapMutex = new LLMutex();
+    mDecodeMutex = new LLMutex();
     mSignal = new LLCondition();
     mHttpRequest = new LLCore::HttpRequest;
     mHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
@@ -848,6 +946,8 @@ LLMeshRepoThread::LLMeshRepoThread()
     mHttpLargeOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
     mHttpLargeOptions->setTransferTimeout(LARGE_MESH_XFER_TIMEOUT);
     mHttpLargeOptions->setUseRetryAfter(gSavedSettings.getBOOL("MeshUseHttpRetryAfter"));
+    mHttpOptions->setBodyAllocator(mesh_body_alloc, mesh_body_free);
+    mHttpLargeOptions->setBodyAllocator(mesh_body_alloc, mesh_body_free);
     mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
     mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_VND_LL_MESH);
     mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2);
@@ -859,8 +959,18 @@ LLMeshRepoThread::~LLMeshRepoThread()
 {
     LL_INFOS(LOG_MESH) << "Small GETs issued:  " << LLMeshRepository::sHTTPRequestCount
                        << ", Large GETs issued:  " << LLMeshRepository::sHTTPLargeRequestCount
+                       << ", GETs saved by coalescing:  " << LLMeshRepository::sHTTPCoalescedCount
                        << ", Max Lock Holdoffs:  " << LLMeshRepository::sMaxLockHoldoffs
                        << LL_ENDL;
+    LL_INFOS(LOG_MESH) << "LODs decoded:  " << LLMeshRepository::sLODDecodeCount
+                       << ", Faces reused:  " << LLMeshRepository::sLODDecodeFacesReused
+                       << ", Decode ms total:  " << LLMeshRepository::sLODDecodeSeconds * 1000.0
+                       << ", slowest:  " << LLMeshRepository::sLODDecodeSecondsMax * 1000.0
+                       << ", inflate ms:  " << LLMeshRepository::sLODInflateSeconds * 1000.0
+                       << ", unpack ms:  " << LLMeshRepository::sLODUnpackSeconds * 1000.0
+                       << ", queued ms:  " << LLMeshRepository::sLODDecodeWaitSeconds * 1000.0
+                       << ", most queued:  " << LLMeshRepository::sDecodeQueueDepthMax
+                       << LL_ENDL;
 
     mHttpRequestSet.clear();
     mHttpHeaders.reset();
@@ -883,6 +993,10 @@ LLMeshRepoThread::~LLMeshRepoThread()
     mMutex = NULL;
     delete mHeaderMutex;
     mHeaderMutex = NULL;
+    delete mSkinMapMutex;
+    mSkinMapMutex = NULL;
+    delete mDecodeMutex;
+    mDecodeMutex = NULL;
     delete mSignal;
     mSignal = NULL;
 }
@@ -933,10 +1047,17 @@ void LLMeshRepoThread::run()
         // in relatively similar manners, remake code to simplify/unify the process,
         // like processRequests(&requestQ, fetchFunction); which does same thing for each element
 
-        if (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater)
+        // Hold new LOD fetches back while the decode pool is behind
+        U32 decode_depth_limit = mDecodeThreadPool
+            ? MESH_DECODE_QUEUE_PER_THREAD * (U32)mDecodeThreadPool->getWidth()
+            : U32_MAX;
+
+        if (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater
+            && LLMeshRepository::sDecodeQueueDepth < decode_depth_limit)
         {
             std::list<LODRequest> incomplete;
-            while (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater)
+            while (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater
+                   && LLMeshRepository::sDecodeQueueDepth < decode_depth_limit)
             {
                 if (!mMutex)
                 {
@@ -953,7 +1074,7 @@ void LLMeshRepoThread::run()
                     // failed to load before, wait a bit
                     incomplete.push_front(req);
                 }
-                else if (!fetchMeshLOD(req.mMeshParams, req.mLOD, req.canRetry()))
+                else if (!fetchMeshLOD(req))
                 {
                     if (req.canRetry())
                     {
@@ -1053,7 +1174,7 @@ void LLMeshRepoThread::run()
                     {
                         incomplete.emplace_back(req);
                     }
-                    else if (!fetchMeshSkinInfo(req.mId, req.canRetry()))
+                    else if (!fetchMeshSkinInfo(req))
                     {
                         if (req.canRetry())
                         {
@@ -1155,6 +1276,8 @@ void LLMeshRepoThread::run()
             }
         }
 
+        flushRangeRequests();
+
         // For dev purposes only.  A dynamic change could make this false
         // and that shouldn't assert.
         // llassert_always(mHttpRequestSet.size() <= sRequestHighWater);
@@ -1293,7 +1416,7 @@ LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url,
 
     LLCore::HttpHandle handle(LLCORE_HTTP_HANDLE_INVALID);
 
-    if (len < LARGE_MESH_FETCH_THRESHOLD)
+    if (len < LLMeshRanges::LARGE_FETCH_THRESHOLD)
     {
         handle = mHttpRequest->requestGetByteRange( mHttpPolicyClass,
                                                     url,
@@ -1329,10 +1452,151 @@ LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url,
     return handle;
 }
 
+// Thread:  repo
+void LLMeshRepoThread::queueByteRange(const LLUUID & mesh_id, const std::string & url,
+                                      const LLMeshHandlerBase::ptr_t &handler)
+{
+    PendingRanges & pending = mPendingRanges[mesh_id];
+    pending.mUrl = url;
+    pending.mHandlers.push_back(handler);
+
+    // Counts against the high water mark from now on
+    mHttpRequestSet.insert(handler);
+}
+
+// Thread:  repo
+void LLMeshRepoThread::issueByteRange(const LLUUID & mesh_id, const std::string & url,
+                                      const LLMeshHandlerBase::ptr_t &handler)
+{
+    LLCore::HttpHandle handle = getByteRange(url, handler->mOffset, handler->mRequestedBytes, handler);
+    if (LLCORE_HTTP_HANDLE_INVALID == handle)
+    {
+        LL_WARNS(LOG_MESH) << "HTTP GET request failed for mesh " << mesh_id
+                           << " bytes " << handler->mOffset << ".." << (handler->mOffset + handler->mRequestedBytes - 1)
+                           << ".  Reason:  " << mHttpStatus.toString()
+                           << " (" << mHttpStatus.toTerseString() << ")"
+                           << LL_ENDL;
+        handler->mProcessed = true;
+        handler->processIssueFailure(mHttpStatus);
+        mHttpRequestSet.erase(handler);
+    }
+    else
+    {
+        handler->mHttpHandle = handle;
+    }
+}
+
+// Sections of a mesh asset are stored back to back, so the LODs,
+// skin info and physics wanted for a mesh usually come in one
+// request rather than one each.
+//
+// Thread:  repo
+void LLMeshRepoThread::flushRangeRequests()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    for (auto & pending : mPendingRanges)
+    {
+        const LLUUID & mesh_id = pending.first;
+        const std::string & url = pending.second.mUrl;
+        LLMeshRangeHandler::handler_list_t & handlers = pending.second.mHandlers;
+
+        std::sort(handlers.begin(), handlers.end(),
+                  [](const LLMeshHandlerBase::ptr_t & lhs, const LLMeshHandlerBase::ptr_t & rhs)
+                  {
+                      return lhs->mOffset < rhs->mOffset;
+                  });
+
+        std::vector<LLMeshRanges::Range> ranges;
+        ranges.reserve(handlers.size());
+        for (const LLMeshHandlerBase::ptr_t & handler : handlers)
+        {
+            ranges.push_back({ handler->mOffset, handler->mRequestedBytes });
+        }
+
+        size_t first = 0;
+        while (first < handlers.size())
+        {
+            U32 start = handlers[first]->mOffset;
+            U32 end;
+            size_t last = LLMeshRanges::join(ranges, first, end);
+
+            if (last - first == 1)
+            {
+                issueByteRange(mesh_id, url, handlers[first]);
+            }
+            else
+            {
+                LLMeshHandlerBase::ptr_t range(new LLMeshRangeHandler(start, end - start,
+                                                                      handlers.begin() + first,
+                                                                      handlers.begin() + last));
+                LLCore::HttpHandle handle = getByteRange(url, start, end - start, range);
+                for (size_t i = first; i < last; ++i)
+                {
+                    if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                    {
+                        // Try the sections on their own
+                        issueByteRange(mesh_id, url, handlers[i]);
+                    }
+                    else
+                    {
+                        handlers[i]->mHttpHandle = handle;
+                    }
+                }
+                if (LLCORE_HTTP_HANDLE_INVALID != handle)
+                {
+                    range->mHttpHandle = handle;
+                    LLMeshRepository::sHTTPCoalescedCount += (U32)(last - first - 1);
+                }
+                else
+                {
+                    // Already answered individually
+                    range->mProcessed = true;
+                }
+            }
+            first = last;
+        }
+    }
+    mPendingRanges.clear();
+}
+
+// Thread:  repo
+void LLMeshRepoThread::retryMeshLOD(LODRequest req)
+{
+    LLMutexLock lock(mMutex);
+    if (req.canRetry())
+    {
+        req.updateTime();
+        mLODReqQ.push(req);
+        ++LLMeshRepository::sLODProcessing;
+    }
+    else
+    {
+        mUnavailableQ.push_back(req);
+        LL_WARNS() << "Failed to load " << req.mMeshParams << " , skip" << LL_ENDL;
+    }
+}
+
+// Thread:  repo
+void LLMeshRepoThread::retryMeshSkinInfo(UUIDBasedRequest req)
+{
+    LLMutexLock lock(mMutex);
+    if (req.canRetry())
+    {
+        req.updateTime();
+        mSkinRequests.push_back(req);
+    }
+    else
+    {
+        mSkinUnavailableQ.push_back(req);
+        LL_DEBUGS() << "mSkinReqQ failed: " << req.mId << LL_ENDL;
+    }
+}
+
 
-bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
+bool LLMeshRepoThread::fetchMeshSkinInfo(const UUIDBasedRequest& req)
 {
     LL_PROFILE_ZONE_SCOPED;
+    const LLUUID& mesh_id = req.mId;
     if (!mHeaderMutex)
     {
         return false;
@@ -1397,6 +1661,21 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
 
                 if (!zero)
                 { //attempt to parse
+                    if (mDecodeThreadPool)
+                    {
+                        // Fetch from sim if the cached copy doesn't decode
+                        std::shared_ptr<U8> data(buffer, mesh_body_free);
+                        queueSkinInfoDecode(mesh_id, data, size, [=, this](bool success)
+                            {
+                                if (!success && !fetchMeshSkinInfoFromSim(req, offset, size))
+                                {
+                                    // Same as a failed fetch in the run loop
+                                    retryMeshSkinInfo(req);
+                                }
+                            });
+                        return true;
+                    }
+
                     if (skinInfoReceived(mesh_id, buffer, size))
                     {
                         delete[] buffer;
@@ -1408,31 +1687,47 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
             }
 
             //reading from cache failed for whatever reason, fetch from sim
-            std::string http_url;
-            constructUrl(mesh_id, &http_url);
+            ret = fetchMeshSkinInfoFromSim(req, offset, size);
+        }
+        else
+        {
+            LLMutexLock locker(mMutex);
+            mSkinUnavailableQ.emplace_back(mesh_id);
+        }
+    }
+    else
+    {
+        mHeaderMutex->unlock();
+    }
 
-            if (!http_url.empty())
+    //early out was not hit, effectively fetched
+    return ret;
+}
+
+bool LLMeshRepoThread::fetchMeshSkinInfoFromSim(const UUIDBasedRequest& req, S32 offset, S32 size)
+{
+    const LLUUID& mesh_id = req.mId;
+    bool ret = true;
+    std::string http_url;
+    constructUrl(mesh_id, &http_url);
+
+    if (!http_url.empty())
+    {
+        LLMeshHandlerBase::ptr_t handler(new LLMeshSkinInfoHandler(req, offset, size));
+        if (req.canRetry())
+        {
+            queueByteRange(mesh_id, http_url, handler);
+        }
+        else
+        {
+            LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
+            if (LLCORE_HTTP_HANDLE_INVALID == handle)
             {
-                LLMeshHandlerBase::ptr_t handler(new LLMeshSkinInfoHandler(mesh_id, offset, size));
-                LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
-                if (LLCORE_HTTP_HANDLE_INVALID == handle)
-                {
-                    LL_WARNS(LOG_MESH) << "HTTP GET request failed for skin info on mesh " << mID
-                                       << ".  Reason:  " << mHttpStatus.toString()
-                                       << " (" << mHttpStatus.toTerseString() << ")"
-                                       << LL_ENDL;
-                    ret = false;
-                }
-                else if(can_retry)
-                {
-                    handler->mHttpHandle = handle;
-                    mHttpRequestSet.insert(handler);
-                }
-                else
-                {
-                    LLMutexLock locker(mMutex);
-                    mSkinUnavailableQ.emplace_back(mesh_id);
-                }
+                LL_WARNS(LOG_MESH) << "HTTP GET request failed for skin info on mesh " << mID
+                                   << ".  Reason:  " << mHttpStatus.toString()
+                                   << " (" << mHttpStatus.toTerseString() << ")"
+                                   << LL_ENDL;
+                ret = false;
             }
             else
             {
@@ -1440,18 +1735,13 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
                 mSkinUnavailableQ.emplace_back(mesh_id);
             }
         }
-        else
-        {
-            LLMutexLock locker(mMutex);
-            mSkinUnavailableQ.emplace_back(mesh_id);
-        }
     }
     else
     {
-        mHeaderMutex->unlock();
+        LLMutexLock locker(mMutex);
+        mSkinUnavailableQ.emplace_back(mesh_id);
     }
 
-    //early out was not hit, effectively fetched
     return ret;
 }
 
@@ -1537,20 +1827,7 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
             if (!http_url.empty())
             {
                 LLMeshHandlerBase::ptr_t handler(new LLMeshDecompositionHandler(mesh_id, offset, size));
-                LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
-                if (LLCORE_HTTP_HANDLE_INVALID == handle)
-                {
-                    LL_WARNS(LOG_MESH) << "HTTP GET request failed for decomposition mesh " << mID
-                                       << ".  Reason:  " << mHttpStatus.toString()
-                                       << " (" << mHttpStatus.toTerseString() << ")"
-                                       << LL_ENDL;
-                    ret = false;
-                }
-                else
-                {
-                    handler->mHttpHandle = handle;
-                    mHttpRequestSet.insert(handler);
-                }
+                queueByteRange(mesh_id, http_url, handler);
             }
         }
     }
@@ -1644,20 +1921,7 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
             if (!http_url.empty())
             {
                 LLMeshHandlerBase::ptr_t handler(new LLMeshPhysicsShapeHandler(mesh_id, offset, size));
-                LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
-                if (LLCORE_HTTP_HANDLE_INVALID == handle)
-                {
-                    LL_WARNS(LOG_MESH) << "HTTP GET request failed for physics shape on mesh " << mID
-                                       << ".  Reason:  " << mHttpStatus.toString()
-                                       << " (" << mHttpStatus.toTerseString() << ")"
-                                       << LL_ENDL;
-                    ret = false;
-                }
-                else
-                {
-                    handler->mHttpHandle = handle;
-                    mHttpRequestSet.insert(handler);
-                }
+                queueByteRange(mesh_id, http_url, handler);
             }
         }
         else
@@ -1767,9 +2031,11 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, bool c
 }
 
 //return false if failed to get mesh lod.
-bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry)
+bool LLMeshRepoThread::fetchMeshLOD(const LODRequest& req)
 {
     LL_PROFILE_ZONE_SCOPED;
+    const LLVolumeParams& mesh_params = req.mMeshParams;
+    S32 lod = req.mLOD;
     if (!mHeaderMutex)
     {
         return false;
@@ -1833,6 +2099,25 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 
                 if (!zero)
                 { //attempt to parse
+                    if (mDecodeThreadPool)
+                    {
+                        // Fetch from sim if the cached copy doesn't decode
+                        std::shared_ptr<U8> data(buffer, mesh_body_free);
+                        queueLODDecode(mesh_params, lod, data, size, [=, this](EMeshProcessingResult result)
+                            {
+                                if (result == MESH_OK)
+                                {
+                                    LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the cache." << LL_ENDL;
+                                }
+                                else if (!fetchMeshLODFromSim(req, offset, size))
+                                {
+                                    // Same as a failed fetch in the run loop
+                                    retryMeshLOD(req);
+                                }
+                            });
+                        return true;
+                    }
+
                     if (lodReceived(mesh_params, lod, buffer, size) == MESH_OK)
                     {
                         delete[] buffer;
@@ -1847,34 +2132,51 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
             }
 
             //reading from cache failed for whatever reason, fetch from sim
-            std::string http_url;
-            constructUrl(mesh_id, &http_url);
+            retval = fetchMeshLODFromSim(req, offset, size);
+        }
+        else
+        {
+            LLMutexLock lock(mMutex);
+            mUnavailableQ.push_back(LODRequest(mesh_params, lod));
+        }
+    }
+    else
+    {
+        mHeaderMutex->unlock();
+    }
 
-            if (!http_url.empty())
-            {
-                LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the simulator." << LL_ENDL;
+    return retval;
+}
 
-                LLMeshHandlerBase::ptr_t handler(new LLMeshLODHandler(mesh_params, lod, offset, size));
-                LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
-                if (LLCORE_HTTP_HANDLE_INVALID == handle)
-                {
-                    LL_WARNS(LOG_MESH) << "HTTP GET request failed for LOD on mesh " << mID
-                                       << ".  Reason:  " << mHttpStatus.toString()
-                                       << " (" << mHttpStatus.toTerseString() << ")"
-                                       << LL_ENDL;
-                    retval = false;
-                }
-                else if (can_retry)
-                {
-                    handler->mHttpHandle = handle;
-                    mHttpRequestSet.insert(handler);
-                    // *NOTE:  Allowing a re-request, not marking as unavailable.  Is that correct?
-                }
-                else
-                {
-                    LLMutexLock lock(mMutex);
-                    mUnavailableQ.push_back(LODRequest(mesh_params, lod));
-                }
+bool LLMeshRepoThread::fetchMeshLODFromSim(const LODRequest& req, S32 offset, S32 size)
+{
+    const LLVolumeParams& mesh_params = req.mMeshParams;
+    S32 lod = req.mLOD;
+    const LLUUID& mesh_id = mesh_params.getSculptID();
+    bool retval = true;
+    std::string http_url;
+    constructUrl(mesh_id, &http_url);
+
+    if (!http_url.empty())
+    {
+        LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the simulator." << LL_ENDL;
+
+        LLMeshHandlerBase::ptr_t handler(new LLMeshLODHandler(req, offset, size));
+        if (req.canRetry())
+        {
+            queueByteRange(mesh_id, http_url, handler);
+            // *NOTE:  Allowing a re-request, not marking as unavailable.  Is that correct?
+        }
+        else
+        {
+            LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
+            if (LLCORE_HTTP_HANDLE_INVALID == handle)
+            {
+                LL_WARNS(LOG_MESH) << "HTTP GET request failed for LOD on mesh " << mID
+                                   << ".  Reason:  " << mHttpStatus.toString()
+                                   << " (" << mHttpStatus.toTerseString() << ")"
+                                   << LL_ENDL;
+                retval = false;
             }
             else
             {
@@ -1882,15 +2184,11 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
                 mUnavailableQ.push_back(LODRequest(mesh_params, lod));
             }
         }
-        else
-        {
-            LLMutexLock lock(mMutex);
-            mUnavailableQ.push_back(LODRequest(mesh_params, lod));
-        }
     }
     else
     {
-        mHeaderMutex->unlock();
+        LLMutexLock lock(mMutex);
+        mUnavailableQ.push_back(LODRequest(mesh_params, lod));
     }
 
     return retval;
@@ -1964,7 +2262,7 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
             }
         }
 
-        fetchMeshSkinInfo(mesh_id);
+        fetchMeshSkinInfo(UUIDBasedRequest(mesh_id));
 
         LLMutexLock lock(mMutex); // make sure only one thread access mPendingLOD at the same time.
 
@@ -1993,19 +2291,55 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
     }
 
     LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-    if (volume->unpackVolumeFaces(data, data_size))
+    LLTimer decode_timer;
+    LLSD mdl;
+    U32 uzip_result = LLUZipHelper::unzip_llsd(mdl, data, data_size);
+    F64 inflate_seconds = decode_timer.getElapsedTimeF64();
+    if (uzip_result != LLUZipHelper::ZR_OK)
     {
+        LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
+        return MESH_UNKNOWN;
+    }
+    bool unpacked = volume->unpackVolumeFaces(mdl);
+    F64 decode_seconds = decode_timer.getElapsedTimeF64();
+    if (unpacked)
+    {
+        {
+            LLMutexLock lock(mMutex);
+            ++LLMeshRepository::sLODDecodeCount;
+            LLMeshRepository::sLODDecodeFacesReused += volume->getNumReusedFaces();
+            LLMeshRepository::sLODDecodeSeconds += decode_seconds;
+            LLMeshRepository::sLODDecodeSecondsMax = llmax(LLMeshRepository::sLODDecodeSecondsMax, decode_seconds);
+            LLMeshRepository::sLODInflateSeconds += inflate_seconds;
+            LLMeshRepository::sLODUnpackSeconds += decode_seconds - inflate_seconds;
+        }
+        LL_DEBUGS(LOG_MESH) << "Decoded mesh " << mesh_params.getSculptID() << " LOD " << lod
+                            << ": " << volume->getNumVolumeFaces() << " faces, " << volume->getNumReusedFaces() << " reused, "
+                            << decode_seconds * 1000.0 << " ms" << LL_ENDL;
+
         if (volume->getNumFaces() > 0)
         {
             // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
-            LLMeshSkinInfo* skin_info = mSkinMap[mesh_params.getSculptID()];
-            if (skin_info && isAgentAvatarValid())
             {
-                for (S32 i = 0; i < volume->getNumFaces(); ++i)
+                // Copied rather than referenced, as the reference count
+                // isn't thread safe, so the lock isn't held for every face
+                LLPointer<LLMeshSkinInfo> skin_info;
                 {
-                    // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
-                    LLVolumeFace& face = volume->getVolumeFace(i);
-                    LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
+                    LLMutexLock lock(mSkinMapMutex);
+                    skin_map::iterator iter = mSkinMap.find(mesh_params.getSculptID());
+                    if (iter != mSkinMap.end())
+                    {
+                        skin_info = new LLMeshSkinInfo(*iter->second);
+                    }
+                }
+                if (skin_info.notNull() && isAgentAvatarValid())
+                {
+                    for (S32 i = 0; i < volume->getNumFaces(); ++i)
+                    {
+                        // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
+                        LLVolumeFace& face = volume->getVolumeFace(i);
+                        LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
+                    }
                 }
             }
 
@@ -2063,7 +2397,10 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 
         // copy the skin info for the background thread so we can use it
         // to calculate per-joint bounding boxes when volumes are loaded
-        mSkinMap[mesh_id] = new LLMeshSkinInfo(*info);
+        {
+            LLMutexLock lock(mSkinMapMutex);
+            mSkinMap[mesh_id] = new LLMeshSkinInfo(*info);
+        }
 
         {
             // Move the LLPointer in to the skin info queue to avoid reference
@@ -2076,6 +2413,104 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
     return true;
 }
 
+void LLMeshRepoThread::queueLODDecode(const LLVolumeParams& mesh_params, S32 lod, const std::shared_ptr<U8>& data, S32 data_size,
+                                      const std::function<void(EMeshProcessingResult)>& on_done)
+{
+    if (!mDecodeThreadPool)
+    {
+        on_done(lodReceived(mesh_params, lod, data.get(), data_size));
+        return;
+    }
+
+    F64 queued = LLTimer::getTotalSeconds();
+    postDecode(mesh_params.getSculptID(), [=, this]()
+        {
+            F64 wait_seconds = LLTimer::getTotalSeconds() - queued;
+            EMeshProcessingResult result = lodReceived(mesh_params, lod, data.get(), data_size);
+            {
+                LLMutexLock lock(mMutex);
+                LLMeshRepository::sLODDecodeWaitSeconds += wait_seconds;
+            }
+            mWorkQueue.post([=]() { on_done(result); });
+            mSignal->signal();
+        });
+}
+
+void LLMeshRepoThread::queueSkinInfoDecode(const LLUUID& mesh_id, const std::shared_ptr<U8>& data, S32 data_size,
+                                           const std::function<void(bool)>& on_done)
+{
+    if (!mDecodeThreadPool)
+    {
+        on_done(skinInfoReceived(mesh_id, data.get(), data_size));
+        return;
+    }
+
+    postDecode(mesh_id, [=, this]()
+        {
+            bool result = skinInfoReceived(mesh_id, data.get(), data_size);
+            mWorkQueue.post([=]() { on_done(result); });
+            mSignal->signal();
+        });
+}
+
+void LLMeshRepoThread::postDecode(const LLUUID& mesh_id, const std::function<void()>& work)
+{
+    LLMutexLock lock(mDecodeMutex);
+    U32 depth = ++LLMeshRepository::sDecodeQueueDepth;
+    LLMeshRepository::sDecodeQueueDepthMax = llmax(LLMeshRepository::sDecodeQueueDepthMax, depth);
+
+    std::deque<std::function<void()> >& queue = mDecodeQueues[mesh_id];
+    queue.push_back(work);
+    if (queue.size() == 1)
+    {
+        // Nothing else for this mesh is queued or running
+        runDecode(mesh_id);
+    }
+}
+
+// Mutex:  must be holding mDecodeMutex when called
+void LLMeshRepoThread::runDecode(const LLUUID& mesh_id)
+{
+    bool posted = mDecodeThreadPool->getQueue().post([this, mesh_id]()
+        {
+            if (LLApp::isExiting())
+            {
+                // Shutting down, drop what is left for this mesh
+                LLMutexLock lock(mDecodeMutex);
+                LLMeshRepository::sDecodeQueueDepth -= (U32)mDecodeQueues[mesh_id].size();
+                mDecodeQueues.erase(mesh_id);
+                return;
+            }
+
+            std::function<void()> work;
+            {
+                LLMutexLock lock(mDecodeMutex);
+                work = mDecodeQueues[mesh_id].front();
+            }
+
+            work();
+
+            LLMutexLock lock(mDecodeMutex);
+            --LLMeshRepository::sDecodeQueueDepth;
+            decode_queue_map::iterator iter = mDecodeQueues.find(mesh_id);
+            iter->second.pop_front();
+            if (iter->second.empty())
+            {
+                mDecodeQueues.erase(iter);
+            }
+            else
+            {
+                runDecode(mesh_id);
+            }
+        });
+    if (!posted)
+    {
+        // Shutting down, drop what is left for this mesh
+        LLMeshRepository::sDecodeQueueDepth -= (U32)mDecodeQueues[mesh_id].size();
+        mDecodeQueues.erase(mesh_id);
+    }
+}
+
 bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
 {
     LLSD decomp;
@@ -3203,15 +3638,22 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
                 goto common_exit;
             }
 
-            // *TODO: Try to get rid of data copying and add interfaces
-            // that support BufferArray directly.  Introduce a two-phase
-            // handler, optional first that takes a body, fallback second
-            // that requires a temporary allocation and data copy.
+            // Take the body over if it arrived in one piece of our
+            // memory, otherwise copy out the part we asked for.
             body_offset = mOffset - offset;
-            data = new(std::nothrow) U8[data_size - body_offset];
+            size_t detached_size(0);
+            data = body_offset ? NULL : (U8 *) body->detachContiguous(&detached_size);
+            if (! data)
+            {
+                data = (U8 *) mesh_body_alloc(data_size - body_offset);
+                if (data)
+                {
+                    body->read(body_offset, (char *) data, data_size - body_offset);
+                }
+            }
             if (data)
             {
-                body->read(body_offset, (char *) data, data_size - body_offset);
+                mData.reset(data, mesh_body_free);
                 LLMeshRepository::sBytesReceived += static_cast<U32>(data_size);
             }
             else
@@ -3223,7 +3665,7 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 
         processData(body, body_offset, data, static_cast<S32>(data_size) - body_offset);
 
-        delete [] data;
+        mData.reset();
     }
 
     // Release handler
@@ -3395,6 +3837,18 @@ void LLMeshLODHandler::processFailure(LLCore::HttpStatus status)
     gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
 }
 
+void LLMeshLODHandler::processIssueFailure(LLCore::HttpStatus status)
+{
+    if (mRequest.canRetry())
+    {
+        gMeshRepo.mThread->retryMeshLOD(mRequest);
+    }
+    else
+    {
+        processFailure(status);
+    }
+}
+
 void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
                                    U8 * data, S32 data_size)
 {
@@ -3402,34 +3856,39 @@ void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body
     if ((!MESH_LOD_PROCESS_FAILED)
         && ((data != NULL) == (data_size > 0))) // if we have data but no size or have size but no data, something is wrong
     {
-        EMeshProcessingResult result = gMeshRepo.mThread->lodReceived(mMeshParams, mLOD, data, data_size);
-        if (result == MESH_OK)
-        {
-            // good fetch from sim, write to cache
-            LLFileSystem file(mMeshParams.getSculptID(), LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
-
-            S32 offset = mOffset;
-            S32 size = mRequestedBytes;
-
-            if (file.getSize() >= offset+size)
+        // The handler is gone by the time the decode finishes
+        LLVolumeParams mesh_params = mMeshParams;
+        S32 lod = mLOD;
+        S32 offset = mOffset;
+        S32 size = mRequestedBytes;
+        std::shared_ptr<U8> buffer(mData, data);
+        gMeshRepo.mThread->queueLODDecode(mesh_params, lod, buffer, data_size, [=](EMeshProcessingResult result)
             {
-                file.seek(offset);
-                file.write(data, size);
-                LLMeshRepository::sCacheBytesWritten += size;
-                ++LLMeshRepository::sCacheWrites;
-            }
-        }
-        else
-        {
-            LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mMeshParams.getSculptID()
-                               << ", Reason: " << result
-                               << " LOD: " << mLOD
-                               << " Data size: " << data_size
-                               << " Not retrying."
-                               << LL_ENDL;
-            LLMutexLock lock(gMeshRepo.mThread->mMutex);
-            gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
-        }
+                if (result == MESH_OK)
+                {
+                    // good fetch from sim, write to cache
+                    LLFileSystem file(mesh_params.getSculptID(), LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
+
+                    if (file.getSize() >= offset+size)
+                    {
+                        file.seek(offset);
+                        file.write(buffer.get(), size);
+                        LLMeshRepository::sCacheBytesWritten += size;
+                        ++LLMeshRepository::sCacheWrites;
+                    }
+                }
+                else
+                {
+                    LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mesh_params.getSculptID()
+                                       << ", Reason: " << result
+                                       << " LOD: " << lod
+                                       << " Data size: " << data_size
+                                       << " Not retrying."
+                                       << LL_ENDL;
+                    LLMutexLock lock(gMeshRepo.mThread->mMutex);
+                    gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mesh_params, lod));
+                }
+            });
     }
     else
     {
@@ -3461,27 +3920,54 @@ void LLMeshSkinInfoHandler::processFailure(LLCore::HttpStatus status)
         gMeshRepo.mThread->mSkinUnavailableQ.emplace_back(mMeshID);
 }
 
+void LLMeshSkinInfoHandler::processIssueFailure(LLCore::HttpStatus status)
+{
+    if (mRequest.canRetry())
+    {
+        gMeshRepo.mThread->retryMeshSkinInfo(mRequest);
+    }
+    else
+    {
+        processFailure(status);
+    }
+}
+
 void LLMeshSkinInfoHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
                                         U8 * data, S32 data_size)
 {
     LL_PROFILE_ZONE_SCOPED;
     if ((!MESH_SKIN_INFO_PROCESS_FAILED)
-        && ((data != NULL) == (data_size > 0)) // if we have data but no size or have size but no data, something is wrong
-        && gMeshRepo.mThread->skinInfoReceived(mMeshID, data, data_size))
+        && ((data != NULL) == (data_size > 0))) // if we have data but no size or have size but no data, something is wrong
     {
-        // good fetch from sim, write to cache
-        LLFileSystem file(mMeshID, LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
-
+        // The handler is gone by the time the decode finishes
+        LLUUID mesh_id = mMeshID;
         S32 offset = mOffset;
         S32 size = mRequestedBytes;
+        std::shared_ptr<U8> buffer(mData, data);
+        gMeshRepo.mThread->queueSkinInfoDecode(mesh_id, buffer, data_size, [=](bool success)
+            {
+                if (success)
+                {
+                    // good fetch from sim, write to cache
+                    LLFileSystem file(mesh_id, LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
 
-        if (file.getSize() >= offset+size)
-        {
-            LLMeshRepository::sCacheBytesWritten += size;
-            ++LLMeshRepository::sCacheWrites;
-            file.seek(offset);
-            file.write(data, size);
-        }
+                    if (file.getSize() >= offset+size)
+                    {
+                        LLMeshRepository::sCacheBytesWritten += size;
+                        ++LLMeshRepository::sCacheWrites;
+                        file.seek(offset);
+                        file.write(buffer.get(), size);
+                    }
+                }
+                else
+                {
+                    LL_WARNS(LOG_MESH) << "Error during mesh skin info processing.  ID:  " << mesh_id
+                                       << ", Unknown reason.  Not retrying."
+                                       << LL_ENDL;
+                    LLMutexLock lock(gMeshRepo.mThread->mMutex);
+                    gMeshRepo.mThread->mSkinUnavailableQ.emplace_back(mesh_id);
+                }
+            });
     }
     else
     {
@@ -3590,6 +4076,51 @@ void LLMeshPhysicsShapeHandler::processData(LLCore::BufferArray * /* body */, S3
     }
 }
 
+LLMeshRangeHandler::~LLMeshRangeHandler()
+{
+    if (!mProcessed)
+    {
+        LL_WARNS(LOG_MESH) << "deleting unprocessed request handler (may be ok on exit)" << LL_ENDL;
+    }
+}
+
+void LLMeshRangeHandler::processFailure(LLCore::HttpStatus status)
+{
+    for (const LLMeshHandlerBase::ptr_t & handler : mHandlers)
+    {
+        handler->mProcessed = true;
+        handler->processFailure(status);
+        gMeshRepo.mThread->mHttpRequestSet.erase(handler);
+    }
+    mHandlers.clear();
+}
+
+void LLMeshRangeHandler::processData(LLCore::BufferArray * body, S32 body_offset,
+                                     U8 * data, S32 data_size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    for (const LLMeshHandlerBase::ptr_t & handler : mHandlers)
+    {
+        S32 offset = LLMeshRanges::sectionOffset(mOffset, { handler->mOffset, handler->mRequestedBytes }, data_size);
+        S32 size = handler->mRequestedBytes;
+
+        handler->mProcessed = true;
+        if (data && offset >= 0)
+        {
+            handler->mData = mData;
+            handler->processData(body, body_offset + offset, data + offset, size);
+            handler->mData.reset();
+        }
+        else
+        {
+            // Response stopped short of this section
+            handler->processFailure(LLCore::HttpStatus(LLCore::HttpStatus::LLCORE, LLCore::HE_INV_CONTENT_RANGE_HDR));
+        }
+        gMeshRepo.mThread->mHttpRequestSet.erase(handler);
+    }
+    mHandlers.clear();
+}
+
 LLMeshRepository::LLMeshRepository()
 : mMeshMutex(NULL),
   mDecompThread(NULL),
@@ -3620,7 +4151,28 @@ void LLMeshRepository::init()
 
     metrics_teleport_started_signal = LLViewerMessage::getInstance()->setTeleportStartedCallback(teleport_started);
 
+    // The thread decoding a LOD takes part in optimizing its faces, so
+    // this only needs the extra threads.  Pool widths come from the
+    // core budget LLAppViewer::initThreads() puts in "ThreadPoolSizes".
+    size_t optimize_threads = LL::ThreadPool::getConfiguredWidth("MeshOptimize");
+    if (optimize_threads > 0)
+    {
+        mOptimizeThreadPool.reset(new LL::ThreadPool("MeshOptimize", optimize_threads));
+        mOptimizeThreadPool->start();
+        LLVolume::setOptimizeThreadPool(mOptimizeThreadPool.get());
+    }
+    LLVolume::setOptimizeCacheSize((size_t)gSavedSettings.getU32("MeshOptimizeReuseMB") * 1024 * 1024);
+
     mThread = new LLMeshRepoThread();
+
+    size_t decode_threads = LL::ThreadPool::getConfiguredWidth("MeshDecode");
+    if (decode_threads > 0)
+    {
+        mDecodeThreadPool.reset(new LL::ThreadPool("MeshDecode", decode_threads));
+        mDecodeThreadPool->start();
+        mThread->mDecodeThreadPool = mDecodeThreadPool.get();
+    }
+
     mThread->start();
 }
 
@@ -3638,15 +4190,34 @@ void LLMeshRepository::shutdown()
         mUploads[i]->discard() ; //discard the uploading requests.
     }
 
+    // Decodes in flight post to the mesh thread's queue, so finish
+    // them while the thread is still there to take the results
+    if (mDecodeThreadPool)
+    {
+        mDecodeThreadPool->close();
+    }
+
     mThread->mSignal->broadcast();
 
     while (!mThread->isStopped())
     {
         apr_sleep(10);
     }
+
+    // The mesh thread may have posted to the closed pool up to now
+    mDecodeThreadPool.reset();
+
     delete mThread;
     mThread = NULL;
 
+    LLVolume::setOptimizeThreadPool(NULL);
+    LLVolume::setOptimizeCacheSize(0);
+    if (mOptimizeThreadPool)
+    {
+        mOptimizeThreadPool->close();
+        mOptimizeThreadPool.reset();
+    }
+
     for (U32 i = 0; i < mUploads.size(); ++i)
     {
         LL_INFOS(LOG_MESH) << "Waiting for pending mesh upload " << (i + 1) << "/" << mUploads.size() << LL_ENDL;
@@ -3921,6 +4492,7 @@ void LLMeshRepository::notifyLoadedMeshes()
             // erase from background thread
             mThread->mWorkQueue.post([=, this]()
                 {
+                    LLMutexLock lock(mThread->mSkinMapMutex);
                     mThread->mSkinMap.erase(id);
                 });
         }
@@ -5465,6 +6037,15 @@ void LLMeshRepository::metricsUpdate()
         metrics["teleports"] = LLSD::Integer(metrics_teleport_start_count);
         metrics["user_cpu"] = double(user_cpu) / 1.0e6;
         metrics["sys_cpu"] = double(sys_cpu) / 1.0e6;
+        metrics["lod_decodes"] = LLSD::Integer(sLODDecodeCount);
+        metrics["lod_decode_faces_reused"] = LLSD::Integer(sLODDecodeFacesReused);
+        metrics["lod_decode_ms"] = sLODDecodeSeconds * 1000.0;
+        metrics["lod_decode_max_ms"] = sLODDecodeSecondsMax * 1000.0;
+        metrics["lod_decode_inflate_ms"] = sLODInflateSeconds * 1000.0;
+        metrics["lod_decode_unpack_ms"] = sLODUnpackSeconds * 1000.0;
+        metrics["lod_decode_queued_ms"] = sLODDecodeWaitSeconds * 1000.0;
+        metrics["decode_queue_depth"] = LLSD::Integer(sDecodeQueueDepth);
+        metrics["decode_queue_max"] = LLSD::Integer(sDecodeQueueDepthMax);
         LL_INFOS(LOG_MESH) << "EventMarker " << metrics << LL_ENDL;
     }
 }
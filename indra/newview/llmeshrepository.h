@@ -27,6 +27,8 @@
 #ifndef LL_MESH_REPOSITORY_H
 #define LL_MESH_REPOSITORY_H
 
+#include <atomic>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include "llassettype.h"
@@ -41,6 +43,7 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 #include "llthread.h"
+#include "threadpool_fwd.h"
 
 #define LLCONVEXDECOMPINTER_STATIC 1
 
@@ -51,6 +54,7 @@ class LLVOVolume;
 class LLMutex;
 class LLCondition;
 class LLMeshRepository;
+class LLMeshHandlerBase;
 
 typedef enum e_mesh_processing_result_enum
 {
@@ -376,6 +380,15 @@ class LLMeshRepoThread : public LLThread
     /// NOTE: LLMeshRepository::mSkinMap is accessed very frequently, so maintain a copy here to avoid mutex overhead
     typedef std::unordered_map<LLUUID, LLPointer<LLMeshSkinInfo>> skin_map;
     skin_map mSkinMap;
+    LLMutex* mSkinMapMutex;
+
+    // Decoding of LODs and skin info runs here when set, so the repo
+    // thread only reads the cache and schedules requests.  Work for one
+    // mesh runs in the order it was queued.
+    LL::ThreadPool* mDecodeThreadPool;
+    LLMutex* mDecodeMutex;
+    typedef std::unordered_map<LLUUID, std::deque<std::function<void()> > > decode_queue_map;
+    decode_queue_map mDecodeQueues;
 
     // workqueue for processing generic requests
     LL::WorkQueue mWorkQueue;
@@ -392,6 +405,16 @@ class LLMeshRepoThread : public LLThread
     typedef std::unordered_set<LLCore::HttpHandler::ptr_t> http_request_set;
     http_request_set                    mHttpRequestSet;            // Outstanding HTTP requests
 
+    // Byte ranges wanted from one mesh asset during a pass of run().
+    // Their handlers are already counted in mHttpRequestSet.
+    struct PendingRanges
+    {
+        std::string mUrl;
+        std::vector<std::shared_ptr<LLMeshHandlerBase> > mHandlers;
+    };
+    typedef std::unordered_map<LLUUID, PendingRanges> pending_range_map;
+    pending_range_map                   mPendingRanges;
+
     std::string mGetMeshCapability;
 
     LLMeshRepoThread();
@@ -403,10 +426,20 @@ class LLMeshRepoThread : public LLThread
     void loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
 
     bool fetchMeshHeader(const LLVolumeParams& mesh_params, bool can_retry = true);
-    bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry = true);
+    bool fetchMeshLOD(const LODRequest& req);
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
+
+    // Run lodReceived() or skinInfoReceived() on the decode pool, or
+    // right away without one.  on_done gets the result on the repo thread.
+    // data is shared with the response or cache read, not copied.
+    //
+    // Threads:  Repo thread only
+    void queueLODDecode(const LLVolumeParams& mesh_params, S32 lod, const std::shared_ptr<U8>& data, S32 data_size,
+                        const std::function<void(EMeshProcessingResult)>& on_done);
+    void queueSkinInfoDecode(const LLUUID& mesh_id, const std::shared_ptr<U8>& data, S32 data_size,
+                             const std::function<void(bool)>& on_done);
     bool decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     EMeshProcessingResult physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     bool hasPhysicsShapeInHeader(const LLUUID& mesh_id);
@@ -422,7 +455,14 @@ class LLMeshRepoThread : public LLThread
 
     //send request for skin info, returns true if header info exists
     //  (should hold onto mesh_id and try again later if header info does not exist)
-    bool fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry = true);
+    bool fetchMeshSkinInfo(const UUIDBasedRequest& req);
+
+    // Put a LOD or skin info request that could not be sent back on
+    // its queue, or mark it unavailable once it is out of retries.
+    //
+    // Threads:  Repo thread only
+    void retryMeshLOD(LODRequest req);
+    void retryMeshSkinInfo(UUIDBasedRequest req);
 
     //send request for decomposition, returns true if header info exists
     //  (should hold onto mesh_id and try again later if header info does not exist)
@@ -456,6 +496,36 @@ class LLMeshRepoThread : public LLThread
     LLCore::HttpHandle getByteRange(const std::string & url,
                                     size_t offset, size_t len,
                                     const LLCore::HttpHandler::ptr_t &handler);
+
+    // Defer a range request on a mesh until flushRangeRequests()
+    // so that it can share a GET with other sections of the asset.
+    //
+    // Threads:  Repo thread only
+    void queueByteRange(const LLUUID & mesh_id, const std::string & url,
+                        const std::shared_ptr<LLMeshHandlerBase> &handler);
+
+    // Issue the queued range requests, merging those of a mesh that
+    // are adjacent or nearly so.  Requests that can't be issued are
+    // retried or failed through their handlers.
+    //
+    // Threads:  Repo thread only
+    void flushRangeRequests();
+    void issueByteRange(const LLUUID & mesh_id, const std::string & url,
+                        const std::shared_ptr<LLMeshHandlerBase> &handler);
+
+    // The sim half of fetchMeshLOD() and fetchMeshSkinInfo(), also used
+    // when a cached copy fails to decode
+    //
+    // Threads:  Repo thread only
+    bool fetchMeshLODFromSim(const LODRequest& req, S32 offset, S32 size);
+    bool fetchMeshSkinInfoFromSim(const UUIDBasedRequest& req, S32 offset, S32 size);
+
+    // Queue work for a mesh on mDecodeThreadPool behind any already
+    // queued for it
+    //
+    // Threads:  Any
+    void postDecode(const LLUUID& mesh_id, const std::function<void()>& work);
+    void runDecode(const LLUUID& mesh_id);
 };
 
 
@@ -615,6 +685,7 @@ class LLMeshRepository
     static U32 sMeshRequestCount;               // Total request count, http or cached, all component types
     static U32 sHTTPRequestCount;               // Http GETs issued (not large)
     static U32 sHTTPLargeRequestCount;          // Http GETs issued for large requests
+    static U32 sHTTPCoalescedCount;             // Range requests merged into another's GET
     static U32 sHTTPRetryCount;                 // Total request retries whether successful or failed
     static U32 sHTTPErrorCount;                 // Requests ending in error
     static U32 sLODPending;
@@ -627,6 +698,15 @@ class LLMeshRepository
     static U32 sCacheReads;
     static U32 sCacheWrites;
     static U32 sMaxLockHoldoffs;                // Maximum sequential locking failures
+    static U32 sLODDecodeCount;                 // Mesh LODs unpacked, with tangents and cache optimization
+    static U32 sLODDecodeFacesReused;           // Faces copied from an identical one rather than optimized
+    static F64 sLODDecodeSeconds;               // Time spent decoding mesh LODs, all of them
+    static F64 sLODDecodeSecondsMax;            // and the slowest one
+    static F64 sLODDecodeWaitSeconds;           // Time decodes spent queued for a decode thread
+    static F64 sLODInflateSeconds;              // Decode time spent inflating and parsing the LLSD
+    static F64 sLODUnpackSeconds;               // and unpacking it into faces
+    static std::atomic<U32> sDecodeQueueDepth;  // LOD and skin info decodes queued or running
+    static U32 sDecodeQueueDepthMax;            // and the most there have been at once
 
     static LLDeadmanTimer sQuiescentTimer;      // Time-to-complete-mesh-downloads after significant events
 
@@ -724,6 +804,12 @@ class LLMeshRepository
 
     LLPhysicsDecomp* mDecompThread;
 
+    // Decodes LODs and skin info for the mesh thread
+    std::unique_ptr<LL::ThreadPool> mDecodeThreadPool;
+
+    // Helps the decoding thread optimize the faces of a LOD in parallel
+    std::unique_ptr<LL::ThreadPool> mOptimizeThreadPool;
+
     LLFrameTimer     mSkinInfoCullTimer;
 
     class inventory_data
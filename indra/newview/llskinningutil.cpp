@@ -33,6 +33,7 @@
 #include "llmeshrepository.h"
 #include "llvolume.h"
 #include "llrigginginfo.h"
+#include "lltransformbatch.h"
 
 #define DEBUG_SKINNING  LL_DEBUG
 
@@ -135,7 +136,7 @@ void LLSkinningUtil::initSkinningMatrixPalette(
 
     initJointNums(const_cast<LLMeshSkinInfo*>(skin), avatar);
 
-    LLMatrix4a world[LL_CHARACTER_MAX_ANIMATED_JOINTS];
+    const LLMatrix4a* world[LL_CHARACTER_MAX_ANIMATED_JOINTS];
 
     for (S32 j = 0; j < count; ++j)
     {
@@ -144,11 +145,12 @@ void LLSkinningUtil::initSkinningMatrixPalette(
 
         if (joint)
         {
-            world[j] = joint->getWorldMatrix4a();
+            world[j] = &joint->getWorldMatrix4a();
         }
         else
         {
-            mat[j] = skin->mInvBindMatrix[j];
+            // Leaves the inverse bind matrix as is
+            world[j] = &LLMatrix4a::identity();
 #if DEBUG_SKINNING
             // This  shouldn't  happen   -  in  mesh  upload,  skinned
             // rendering  should  be disabled  unless  all joints  are
@@ -165,16 +167,7 @@ void LLSkinningUtil::initSkinningMatrixPalette(
         }
     }
 
-    //NOTE: pointer striders used here as a micro-optimization over vector/array lookups
-    const LLMatrix4a* invBind = &(skin->mInvBindMatrix[0]);
-    const LLMatrix4a* w = world;
-    LLMatrix4a* m = mat;
-    LLMatrix4a* end = m + count;
-
-    while (m < end)
-    {
-        matMulUnsafe(*(invBind++), *(w++), *(m++));
-    }
+    LLTransformBatch::mul(&(skin->mInvBindMatrix[0]), world, mat, count);
 }
 
 void LLSkinningUtil::checkSkinWeights(LLVector4a* weights, U32 num_vertices, const LLMeshSkinInfo* skin)
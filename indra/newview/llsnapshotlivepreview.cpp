@@ -86,6 +86,7 @@ LLSnapshotLivePreview::LLSnapshotLivePreview (const LLSnapshotLivePreview::Param
 	mSnapshotActive(false),
 	mSnapshotBufferType(LLSnapshotModel::SNAPSHOT_TYPE_COLOR),
     mFilterName(""),
+    mFilterApplied(false),
     mAllowRenderUI(true),
     mAllowFullScreenPreview(true),
     mViewContainer(NULL)
@@ -522,7 +523,8 @@ bool LLSnapshotLivePreview::onIdle( void* snapshot_preview )
 	if(!previewp->getSnapshotUpToDate())
 	{
 		// _LL_DEBUGS("Snapshot") << "producing snapshot" << LL_ENDL;
-		if (!previewp->mPreviewImage)
+		// A background save may still be reading the previous frame, don't write over it
+		if (!previewp->mPreviewImage || previewp->mPreviewImage->getNumRefs() > 1)
 		{
 			previewp->mPreviewImage = new LLImageRaw;
 		}
@@ -551,6 +553,7 @@ bool LLSnapshotLivePreview::onIdle( void* snapshot_preview )
             previewp->mPreviewImageEncoded = NULL;
             // Invalidate/delete any existing formatted image
             previewp->mFormattedImage = NULL;
+            previewp->mFilterApplied = false;
             // Update the data size
             previewp->estimateDataSize();
 
@@ -698,20 +701,7 @@ LLPointer<LLImageFormatted> LLSnapshotLivePreview::getFormattedImage()
 {
     if (!mFormattedImage)
     {
-        // Apply the filter to mPreviewImage
-        if (getFilter() != "")
-        {
-            std::string filter_path = LLImageFiltersManager::getInstance()->getFilterPath(getFilter());
-            if (filter_path != "")
-            {
-                LLImageFilter filter(filter_path);
-                filter.executeFilter(mPreviewImage);
-            }
-            else
-            {
-                LL_WARNS("Snapshot") << "Couldn't find a path to the following filter : " << getFilter() << LL_ENDL;
-            }
-        }
+        applyFilter();
 
         // Create the new formatted image of the appropriate format.
         LLSnapshotModel::ESnapshotFormat format = getSnapshotFormat();
@@ -738,6 +728,31 @@ LLPointer<LLImageFormatted> LLSnapshotLivePreview::getFormattedImage()
     return mFormattedImage;
 }
 
+void LLSnapshotLivePreview::applyFilter()
+{
+    // Filters are applied in place, make sure it only happens once per frame
+    if (mFilterApplied)
+    {
+        return;
+    }
+    mFilterApplied = true;
+
+    // Apply the filter to mPreviewImage
+    if (getFilter() != "")
+    {
+        std::string filter_path = LLImageFiltersManager::getInstance()->getFilterPath(getFilter());
+        if (filter_path != "")
+        {
+            LLImageFilter filter(filter_path);
+            filter.executeFilter(mPreviewImage);
+        }
+        else
+        {
+            LL_WARNS("Snapshot") << "Couldn't find a path to the following filter : " << getFilter() << LL_ENDL;
+        }
+    }
+}
+
 void LLSnapshotLivePreview::setSize(S32 w, S32 h)
 {
     LL_DEBUGS("Snapshot") << "setSize(" << w << ", " << h << ")" << LL_ENDL;
@@ -831,6 +846,29 @@ void LLSnapshotLivePreview::saveTexture(bool outfit_snapshot, std::string name)
 
 void LLSnapshotLivePreview::saveLocal(const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb)
 {
+    static LLCachedControl<bool> streaming_save(gSavedSettings, "SnapshotStreamingSave", true);
+
+    // PNG and JPEG can be compressed straight to disk in the background
+    // rather than encoded in memory here, unless the preview already did it.
+    LLSnapshotModel::ESnapshotFormat format = getSnapshotFormat();
+    if (streaming_save && !mFormattedImage
+        && (format == LLSnapshotModel::SNAPSHOT_FORMAT_PNG || format == LLSnapshotModel::SNAPSHOT_FORMAT_JPEG))
+    {
+        applyFilter();
+
+        LLPointer<LLImageFormatted> image;
+        if (format == LLSnapshotModel::SNAPSHOT_FORMAT_PNG)
+        {
+            image = new LLImagePNG();
+        }
+        else
+        {
+            image = new LLImageJPEG(mSnapshotQuality);
+        }
+        saveLocal(image, success_cb, failure_cb, mPreviewImage);
+        return;
+    }
+
     // Update mFormattedImage if necessary
     getFormattedImage();
 
@@ -839,9 +877,9 @@ void LLSnapshotLivePreview::saveLocal(const snapshot_saved_signal_t::slot_type&
 }
 
 //Check if failed due to insufficient memory
-void LLSnapshotLivePreview::saveLocal(LLPointer<LLImageFormatted> image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb)
+void LLSnapshotLivePreview::saveLocal(LLPointer<LLImageFormatted> image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLImageRaw* raw)
 {
     sSaveLocalImage = image;
 
-    gViewerWindow->saveImageNumbered(sSaveLocalImage, false, success_cb, failure_cb);
+    gViewerWindow->saveImageNumbered(sSaveLocalImage, false, success_cb, failure_cb, raw);
 }
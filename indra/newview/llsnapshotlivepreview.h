@@ -42,7 +42,7 @@ class LLSnapshotLivePreview : public LLView
 public:
     typedef boost::signals2::signal<void(void)> snapshot_saved_signal_t;
 
-    static void saveLocal(LLPointer<LLImageFormatted> image, const snapshot_saved_signal_t::slot_type& success_cb = snapshot_saved_signal_t(), const snapshot_saved_signal_t::slot_type& failure_cb = snapshot_saved_signal_t());
+    static void saveLocal(LLPointer<LLImageFormatted> image, const snapshot_saved_signal_t::slot_type& success_cb = snapshot_saved_signal_t(), const snapshot_saved_signal_t::slot_type& failure_cb = snapshot_saved_signal_t(), LLImageRaw* raw = NULL);
     struct Params : public LLInitParam::Block<Params, LLView::Params>
     {
         Params()
@@ -105,6 +105,7 @@ class LLSnapshotLivePreview : public LLView
     void saveLocal(const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb);
 
     LLPointer<LLImageFormatted> getFormattedImage();
+    void applyFilter();
     LLPointer<LLImageRaw>       getEncodedImage();
     bool createUploadFile(const std::string &out_file, const S32 max_image_dimentions, const S32 min_image_dimentions);
 
@@ -171,6 +172,7 @@ class LLSnapshotLivePreview : public LLView
 	bool						mSnapshotActive;
 	LLSnapshotModel::ESnapshotLayerType mSnapshotBufferType;
 	std::string					mFilterName;
+	bool						mFilterApplied;     // mPreviewImage already went through mFilterName
 
 	static LLPointer<LLImageFormatted> sSaveLocalImage;
 
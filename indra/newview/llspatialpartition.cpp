@@ -225,12 +225,7 @@ bool LLSpatialGroup::updateInGroup(LLDrawable *drawablep, bool immediate)
     LL_PROFILE_ZONE_SCOPED;
     drawablep->updateSpatialExtents();
 
-    OctreeNode* parent = mOctreeNode->getOctParent();
-
-    if (mOctreeNode->isInside(drawablep->getPositionGroup()) &&
-        (mOctreeNode->contains(drawablep->getEntry()) ||
-         (drawablep->getBinRadius() > mOctreeNode->getSize()[0] &&
-                parent && parent->getElementCount() >= gOctreeMaxCapacity)))
+    if (mOctreeNode->canRetain(drawablep->getEntry()))
     {
         unbound();
         setState(OBJECT_DIRTY);
@@ -1035,6 +1030,8 @@ class LLOctreeCull : public LLViewerOctreeCull
 public:
     LLOctreeCull(LLCamera* camera) : LLViewerOctreeCull(camera) {}
 
+    virtual EBatchFrustum getBatchFrustum() const { return BATCH_AGENT; }
+
     virtual bool earlyFail(LLViewerOctreeGroup* base_group)
     {
         if (LLPipeline::sReflectionRender)
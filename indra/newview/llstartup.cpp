@@ -655,6 +655,12 @@ bool idle_startup()
                 msg->mPacketRing.setUseOutThrottle(true);
 				msg->mPacketRing.setOutBandwidth(outBandwidth);
 			}
+
+			// Drain the socket and send datagrams in batches
+			msg->mPacketRing.setUseBatchIO(gSavedSettings.getBOOL("MessageBatchIO"));
+
+			// Keep reading the socket while the main thread is busy
+			msg->setUseReceiveThread(gSavedSettings.getBOOL("MessageReceiveThread"));
 		}
 
 		LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
@@ -36,6 +36,7 @@
 #include "lldir.h"
 #include "llhttpconstants.h"
 #include "llimage.h"
+#include "llimagedxt.h"
 #include "llimagej2c.h"
 #include "llimageworker.h"
 #include "llworkerthread.h"
@@ -348,6 +349,13 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
         {
         }
 
+        // Threads:  Tid
+        virtual void compressed(LLImageDXT* compressed_image, U32 request_id)
+        {
+            // handed to the worker together with the raw image in completed()
+            mCompressedImage = compressed_image;
+        }
+
         // Threads:  Tid
         virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id)
         {
@@ -355,12 +363,14 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
             LLTextureFetchWorker* worker = mFetcher->getWorker(mID);
             if (worker)
             {
-                worker->callbackDecoded(success, error_message, raw, aux, request_id);
+                worker->callbackDecoded(success, error_message, raw, aux, mCompressedImage, request_id);
             }
+            mCompressedImage = NULL;
         }
     private:
         LLTextureFetch* mFetcher;
         LLUUID mID;
+        LLPointer<LLImageDXT> mCompressedImage;
     };
 
     struct Compare
@@ -399,7 +409,7 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
     void callbackCacheWrite(bool success);
 
     // Threads:  Tid
-    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id);
+    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, LLImageDXT* compressed, S32 decode_id);
 
     // Threads:  T*
     void setGetStatus(LLCore::HttpStatus status, const std::string& reason)
@@ -465,6 +475,13 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
     // Locks:  Mw
     void setImagePriority(F32 priority);
 
+    // Pass a changed image priority on to a request waiting for
+    // a connection.  Waiting requests for images no longer wanted
+    // are given up.
+    // Threads:  Ttf
+    // Locks:  Mw
+    void updateHttpPriority();
+
     // Locks:  Mw (ctor invokes without lock)
     void setDesiredDiscard(S32 discard, S32 size);
 
@@ -530,6 +547,7 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
     LLPointer<LLImageFormatted> mFormattedImage;
     LLPointer<LLImageRaw>       mRawImage,
                                 mAuxImage;
+    LLPointer<LLImageDXT>       mCompressedImage;
     FTType mFTType;
     LLUUID mID;
     LLHost mHost;
@@ -541,6 +559,8 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
     S32 mRequestedDiscard;
     S32 mLoadedDiscard;
     S32 mDecodedDiscard;
+    LLRect mDecodeRegion;       // requested full detail region, empty for the whole image
+    LLRect mDecodedRegion;      // region actually applied to mRawImage
     LLFrameTimer mRequestedDeltaTimer;
     LLFrameTimer mFetchDeltaTimer;
     LLTimer mCacheReadTimer;
@@ -592,6 +612,7 @@ class LLTextureFetchWorker : public LLWorkerClass, public LLCore::HttpHandler
     LLCore::BufferArray *   mHttpBufferArray;           // Refcounted pointer to response data
     S32                     mHttpPolicyClass;
     bool                    mHttpActive;                // Active request to http library
+    LLCore::HttpRequest::priority_t mHttpPriority;      // Last priority given to the request
     U32                     mHttpReplySize,             // Actual received data size
                             mHttpReplyOffset;           // Actual received data offset
     bool                    mHttpHasResource;           // Counts against Fetcher's mHttpSemaphore
@@ -904,6 +925,7 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mHttpBufferArray(NULL),
       mHttpPolicyClass(mFetcher->mHttpPolicyClass),
       mHttpActive(false),
+      mHttpPriority(0U),
       mHttpReplySize(0U),
       mHttpReplyOffset(0U),
       mHttpHasResource(false),
@@ -1002,6 +1024,32 @@ void LLTextureFetchWorker::setImagePriority(F32 priority)
     mImagePriority = priority; //should map to max virtual size, abort if zero
 }
 
+// Threads:  Ttf
+// Locks:  Mw
+void LLTextureFetchWorker::updateHttpPriority()
+{
+    if (! mHttpActive || mState != WAIT_HTTP_REQ)
+    {
+        return;
+    }
+
+    // Image priorities are pixel areas, only pass on changes
+    // of more than 2x to keep the request traffic down.
+    const LLCore::HttpRequest::priority_t priority((LLCore::HttpRequest::priority_t) llclamp(mImagePriority, 0.f, 1.0e9f));
+    if (priority && priority <= 2 * mHttpPriority && 2 * priority >= mHttpPriority)
+    {
+        return;
+    }
+
+    // A deadline of now cancels the request if it hasn't started,
+    // it then completes as canceled and we go back to waiting.
+    mHttpPriority = priority;
+    mFetcher->mHttpRequest->requestSetPriority(mHttpHandle,
+                                               priority,
+                                               priority ? LLCore::HttpTime(0) : LLCore::HttpTime(totalTime()),
+                                               LLCore::HttpHandler::ptr_t());
+}
+
 // Locks:  Mw
 void LLTextureFetchWorker::resetFormattedData()
 {
@@ -1107,6 +1155,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
         mSkippedStatesTime = 0;
         mRawImage = NULL ;
+        mCompressedImage = NULL;
         mRequestedDiscard = -1;
         mLoadedDiscard = -1;
         mDecodedDiscard = -1;
@@ -1449,6 +1498,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
         // Will call callbackHttpGet when curl request completes
         // Only server bake images use the returned headers currently, for getting retry-after field.
         LLCore::HttpOptions::ptr_t options = (mFTType == FTT_SERVER_BAKE) ? mFetcher->mHttpOptionsWithHeaders: mFetcher->mHttpOptions;
+        // Issued with its priority, updateHttpPriority() only follows later changes
+        LLCore::HttpRequest::priority_t http_priority((LLCore::HttpRequest::priority_t) llclamp(mImagePriority, 0.f, 1.0e9f));
         if (disable_range_req)
         {
             // 'Range:' requests may be disabled in which case all HTTP
@@ -1471,7 +1522,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
                                                                       : mRequestedSize,
                                                                       options,
                                                                       mFetcher->mHttpHeaders,
-                                                                      LLCore::HttpHandler::ptr_t(this, &NoOpDeletor));
+                                                                      LLCore::HttpHandler::ptr_t(this, &NoOpDeletor),
+                                                                      http_priority);
         }
         if (LLCORE_HTTP_HANDLE_INVALID == mHttpHandle)
         {
@@ -1486,9 +1538,14 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
 
         mHttpActive = true;
+        mHttpPriority = disable_range_req ? 0U : http_priority;
         mFetcher->addToHTTPQueue(mID);
         recordTextureStart(true);
         setState(WAIT_HTTP_REQ);
+        if (disable_range_req)
+        {
+            updateHttpPriority();
+        }
 
         // fall through
     }
@@ -1645,7 +1702,18 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 mRequestedOffset += src_offset;
             }
 
-            U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+            // Bodies of known size arrive in memory the image can take
+            // over as is, see mHttpOptions.  Otherwise copy them out.
+            size_t detached_size(0);
+            U8 * buffer = (0 == cur_size && 0 == src_offset)
+                          ? (U8 *)mHttpBufferArray->detachContiguous(&detached_size)
+                          : NULL;
+            const bool detached(buffer != NULL);
+            llassert(! detached || detached_size == (size_t)total_size);
+            if (! detached)
+            {
+                buffer = (U8 *)ll_aligned_malloc_16(total_size);
+            }
             if (!buffer)
             {
                 // abort. If we have no space for packet, we have not enough space to decode image
@@ -1682,7 +1750,10 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 // Copy previously collected data into buffer
                 memcpy(buffer, mFormattedImage->getData(), cur_size);
             }
-            mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+            if (! detached)
+            {
+                mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+            }
 
             // NOTE: setData releases current data and owns new data (buffer)
             mFormattedImage->setData(buffer, total_size);
@@ -1762,6 +1833,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mDecodeTimer.reset();
         mRawImage = NULL;
         mAuxImage = NULL;
+        mCompressedImage = NULL;
         llassert_always(mFormattedImage.notNull());
 
         // if we have the entire image data (and the image is not J2C), decode the full res image
@@ -1775,10 +1847,22 @@ bool LLTextureFetchWorker::doWork(S32 param)
         // In case worked manages to request decode, be shut down,
         // then init and request decode again with first decode
         // still in progress, assign a sufficiently unique id
+        // Images with an aux channel (sculpts, bakes) are consumed as raw data
+        static LLCachedControl<S32> region_bias(gSavedSettings, "TextureRegionDecodeBias", 2);
+        mDecodedRegion = LLRect();
+        if (mDecodeRegion.notEmpty() && region_bias > 0 && !mNeedsAux &&
+            mFormattedImage->getCodec() == IMG_CODEC_J2C &&
+            ((LLImageJ2C*)mFormattedImage.get())->canDecodeRegion())
+        {
+            mDecodedRegion = mDecodeRegion;
+        }
         mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage,
                                                                        discard,
                                                                        mNeedsAux,
-                                                                       new DecodeResponder(mFetcher, mID, this));
+                                                                       new DecodeResponder(mFetcher, mID, this),
+                                                                       !mNeedsAux,
+                                                                       mDecodedRegion,
+                                                                       discard + region_bias);
         if (mDecodeHandle == 0)
         {
             // Abort, failed to put into queue.
@@ -1953,6 +2037,17 @@ void LLTextureFetchWorker::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRe
     bool success = true;
     bool partial = false;
     LLCore::HttpStatus status(response->getStatus());
+    static const LLCore::HttpStatus http_canceled(LLCore::HttpStatus::LLCORE, LLCore::HE_OP_CANCELED);
+    if (status == http_canceled && mState == WAIT_HTTP_REQ)
+    {
+        // Gave up waiting for a connection, see updateHttpPriority().
+        // Back to the network state which drops unwanted images.
+        LL_DEBUGS(LOG_TXT) << mID << " HTTP request canceled before starting" << LL_ENDL;
+        mFetcher->removeFromHTTPQueue(mID, S32Bytes(0));
+        releaseHttpSemaphore();
+        setState(LOAD_FROM_NETWORK);
+        return;
+    }
     if (!status && (mFTType == FTT_SERVER_BAKE))
     {
         LL_INFOS(LOG_TXT) << mID << " state " << e_state_name[mState] << LL_ENDL;
@@ -2167,9 +2262,7 @@ S32 LLTextureFetchWorker::callbackHttpGet(LLCore::HttpResponse * response,
         LL_DEBUGS(LOG_TXT) << "HTTP RECEIVED: " << mID.asString() << " Bytes: " << data_size << LL_ENDL;
         if (data_size > 0)
         {
-            // *TODO: set the formatted image data here directly to avoid the copy
-
-            // Hold on to body for later copy
+            // Hold on to body for later copy or handoff
             llassert_always(NULL == mHttpBufferArray);
             body->addRef();
             mHttpBufferArray = body;
@@ -2293,7 +2386,7 @@ void LLTextureFetchWorker::callbackCacheWrite(bool success)
 //////////////////////////////////////////////////////////////////////////////
 
 // Threads:  Tid
-void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id)
+void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, LLImageDXT* compressed, S32 decode_id)
 {
     LLMutexLock lock(&mWorkMutex);                                      // +Mw
     if (mDecodeHandle == 0)
@@ -2322,6 +2415,7 @@ void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &erro
         llassert_always(raw);
         mRawImage = raw;
         mAuxImage = aux;
+        mCompressedImage = compressed;
         mDecodedDiscard = mFormattedImage->getDiscardLevel();
         if (mDecodedDiscard < mDesiredDiscard)
         {
@@ -2443,6 +2537,8 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
     mHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
     mHttpOptionsWithHeaders = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
     mHttpOptionsWithHeaders->setWantHeaders(true);
+    mHttpOptions->setBodyAllocator(ll_aligned_malloc_16, ll_aligned_free_16);
+    mHttpOptionsWithHeaders->setBodyAllocator(ll_aligned_malloc_16, ll_aligned_free_16);
     mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
     mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_IMAGE_X_J2C);
     mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_TEXTURE);
@@ -2485,7 +2581,8 @@ LLTextureFetch::~LLTextureFetch()
 }
 
 S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const LLUUID& id, const LLHost& host, F32 priority,
-                                   S32 w, S32 h, S32 c, S32 desired_discard, bool needs_aux, bool can_use_http)
+                                   S32 w, S32 h, S32 c, S32 desired_discard, bool needs_aux, bool can_use_http,
+                                   const LLRect& decode_region)
 {
     LL_PROFILE_ZONE_SCOPED;
     if (mDebugPause)
@@ -2562,13 +2659,15 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
             return CREATE_REQUEST_ERROR_ABORTED; // need to wait for previous aborted request to complete
         }
         worker->lockWorkMutex();                                        // +Mw
-        if (worker->mState == LLTextureFetchWorker::DONE && worker->mDesiredSize == llmax(desired_size, TEXTURE_CACHE_ENTRY_SIZE) && worker->mDesiredDiscard == desired_discard) {
+        if (worker->mState == LLTextureFetchWorker::DONE && worker->mDesiredSize == llmax(desired_size, TEXTURE_CACHE_ENTRY_SIZE) && worker->mDesiredDiscard == desired_discard
+            && worker->mDecodeRegion == decode_region) {
             worker->unlockWorkMutex();                                  // -Mw
 
             return CREATE_REQUEST_ERROR_TRANSITION; // similar request has finished, failed or is in a transitional state
         }
         worker->mActiveCount++;
         worker->mNeedsAux = needs_aux;
+        worker->mDecodeRegion = decode_region;
         worker->setImagePriority(priority);
         worker->setDesiredDiscard(desired_discard, desired_size);
         worker->setCanUseHTTP(can_use_http);
@@ -2597,6 +2696,7 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         worker->lockWorkMutex();                                        // +Mw
         worker->mActiveCount++;
         worker->mNeedsAux = needs_aux;
+        worker->mDecodeRegion = decode_region;
         worker->setCanUseHTTP(can_use_http) ;
         worker->unlockWorkMutex();                                      // -Mw
     }
@@ -2749,6 +2849,7 @@ LLTextureFetchWorker* LLTextureFetch::getWorker(const LLUUID& id)
 // Threads:  T*
 bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S32& worker_state,
                                         LLPointer<LLImageRaw>& raw, LLPointer<LLImageRaw>& aux,
+                                        LLPointer<LLImageDXT>& compressed,
                                         LLCore::HttpStatus& last_http_get_status)
 {
     LL_PROFILE_ZONE_SCOPED;
@@ -2784,6 +2885,7 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
             discard_level = worker->mDecodedDiscard;
             raw = worker->mRawImage;
             aux = worker->mAuxImage;
+            compressed = worker->mCompressedImage;
 
             decode_time = worker->mDecodeTime;
             fetch_time = worker->mFetchTime;
@@ -2829,6 +2931,7 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
                 discard_level = worker->mDecodedDiscard;
                 raw = worker->mRawImage;
                 aux = worker->mAuxImage;
+                compressed = worker->mCompressedImage;
             }
             worker->unlockWorkMutex();                                  // -Mw
         }
@@ -2852,6 +2955,7 @@ bool LLTextureFetch::updateRequestPriority(const LLUUID& id, F32 priority)
             {
                 worker->lockWorkMutex();                                        // +Mw
                 worker->setImagePriority(priority);
+                worker->updateHttpPriority();
                 worker->unlockWorkMutex();                                      // -Mw
             }
         });
@@ -3195,6 +3299,20 @@ S32 LLTextureFetch::getLastRawImage(const LLUUID& id,
     return decoded_discard;
 }
 
+// Threads:  T*
+bool LLTextureFetch::getDecodedRegion(const LLUUID& id, LLRect& region)
+{
+    LLTextureFetchWorker* worker = getWorker(id);
+    if (!worker)
+    {
+        return false;
+    }
+    worker->lockWorkMutex();                                            // +Mw
+    region = worker->mDecodedRegion;
+    worker->unlockWorkMutex();                                          // -Mw
+    return true;
+}
+
 void LLTextureFetch::dump()
 {
     LL_INFOS(LOG_TXT) << "LLTextureFetch ACTIVE_HTTP:" << LL_ENDL;
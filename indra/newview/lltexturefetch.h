@@ -32,6 +32,7 @@
 
 #include "lldir.h"
 #include "llimage.h"
+#include "llimagedxt.h"
 #include "lluuid.h"
 #include "llworkerthread.h"
 #include "lltextureinfo.h"
@@ -85,8 +86,12 @@ class LLTextureFetch : public LLWorkerThread
     };
 
     // Threads:  T* (but Tmain mostly)
+    // A non empty decode_region (full resolution pixels) asks for only that
+    // part of a J2C image to be decoded at full detail, see
+    // LLImageJ2C::decodeRegion().
     S32 createRequest(FTType f_type, const std::string& url, const LLUUID& id, const LLHost& host, F32 priority,
-                       S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http);
+                       S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http,
+                       const LLRect& decode_region = LLRect());
 
     // Requests that a fetch operation be deleted from the queue.
     // If @cancel is true, also stops any I/O operations pending.
@@ -103,8 +108,10 @@ class LLTextureFetch : public LLWorkerThread
 
     // Threads:  T*
     // keep in mind that if fetcher isn't done, it still might need original raw image
+    // compressed is set when the decode stage produced a block compressed copy of raw
     bool getRequestFinished(const LLUUID& id, S32& discard_level, S32& worker_state,
                             LLPointer<LLImageRaw>& raw, LLPointer<LLImageRaw>& aux,
+                            LLPointer<LLImageDXT>& compressed,
                             LLCore::HttpStatus& last_http_get_status);
 
     // Threads:  T*
@@ -136,6 +143,11 @@ class LLTextureFetch : public LLWorkerThread
     // Threads:  T*
     S32 getLastRawImage(const LLUUID& id, LLPointer<LLImageRaw>& raw, LLPointer<LLImageRaw>& aux);
 
+    // @return  true if the request exists. region is the part of the last
+    // decoded raw image at full detail, empty when all of it is.
+    // Threads:  T*
+    bool getDecodedRegion(const LLUUID& id, LLRect& region);
+
     // Debug utility - generally not safe
     void dump();
 
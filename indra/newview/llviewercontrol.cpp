@@ -63,6 +63,8 @@
 #include "llkeyboard.h"
 #include "llerrorcontrol.h"
 #include "llappviewer.h"
+#include "llimagedxt.h"
+#include "llimageworker.h"
 #include "llvosurfacepatch.h"
 #include "llvowlsky.h"
 #include "llrender.h"
@@ -297,6 +299,15 @@ static bool handleAnisotropicChanged(const LLSD& newvalue)
     return true;
 }
 
+static bool handleTextureCPUCompressionChanged(const LLSD& newvalue)
+{
+    if (LLAppViewer::getImageDecodeThread())
+    {
+        LLAppViewer::getImageDecodeThread()->setCompressionQuality(llclamp((S32)newvalue.asInteger(), 0, (S32)LLImageDXT::COMPRESS_HIGH));
+    }
+    return true;
+}
+
 static bool handleVSyncChanged(const LLSD& newvalue)
 {
     LLPerfStats::tunables.vsyncEnabled = newvalue.asBoolean();
@@ -460,6 +471,12 @@ static bool handleRenderDynamicLODChanged(const LLSD& newvalue)
     return true;
 }
 
+static bool handleRenderRaycastBVHChanged(const LLSD& newvalue)
+{
+    LLVolume::sRaycastBVH = newvalue.asBoolean();
+    return true;
+}
+
 static bool handleReflectionProbeDetailChanged(const LLSD& newvalue)
 {
     if (gPipeline.isInit())
@@ -1204,6 +1221,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderFogRatio")->getSignal()->connect(boost::bind(&handleFogRatioChanged, _2));
 	gSavedSettings.getControl("RenderMaxPartCount")->getSignal()->connect(boost::bind(&handleMaxPartCountChanged, _2));
 	gSavedSettings.getControl("RenderDynamicLOD")->getSignal()->connect(boost::bind(&handleRenderDynamicLODChanged, _2));
+	gSavedSettings.getControl("RenderRaycastBVH")->getSignal()->connect(boost::bind(&handleRenderRaycastBVHChanged, _2));
 	gSavedSettings.getControl("RenderDebugTextureBind")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
 	gSavedSettings.getControl("RenderAutoMaskAlphaDeferred")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
 	gSavedSettings.getControl("RenderAutoMaskAlphaNonDeferred")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
@@ -1426,6 +1444,7 @@ void settings_setup_listeners()
     setting_setup_signal_listener(gSavedSettings, "RenderSpecularResY", handleLUTBufferChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderSpecularExponent", handleLUTBufferChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderAnisotropic", handleAnisotropicChanged);
+    setting_setup_signal_listener(gSavedSettings, "RenderTextureCPUCompression", handleTextureCPUCompressionChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderShadowResolutionScale", handleShadowsResized);
     setting_setup_signal_listener(gSavedSettings, "RenderGlow", handleReleaseGLBufferChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderGlow", handleSetShaderChanged);
@@ -100,9 +100,11 @@
 #include "llmoveview.h"
 #include "llnavigationbar.h"
 #include "llparcel.h"
+#include "llraycastscene.h"
 #include "llrootview.h"
 #include "llsceneview.h"
 #include "llscenemonitor.h"
+#include "llsdserialize.h"
 #include "llselectmgr.h"
 #include "llsidepanelappearance.h"
 #include "llspellcheckmenuhandler.h"
@@ -117,6 +119,7 @@
 #include "lltrans.h"
 #include "llviewerdisplay.h" //for gWindowResized
 #include "llviewergenericmessage.h"
+#include "llviewercamera.h"
 #include "llviewerhelp.h"
 #include "llviewermenufile.h"   // init_menu_file()
 #include "llviewermessage.h"
@@ -128,6 +131,7 @@
 #include "llvlcomposition.h"
 #include "llvoavatarself.h"
 #include "llvoicevivox.h"
+#include "llvovolume.h"
 #include "llworld.h"
 #include "llworldmap.h"
 #include "pipeline.h"
@@ -351,6 +355,7 @@ void handle_debug_avatar_textures();
 void handle_grab_baked_texture(EBakedTextureIndex baked_tex_index);
 bool enable_grab_baked_texture(EBakedTextureIndex baked_tex_index);
 void handle_dump_region_object_cache();
+void handle_capture_raycast_scene();
 void handle_reset_interest_lists();
 
 bool enable_save_into_task_inventory();
@@ -1360,6 +1365,15 @@ class LLAdvancedDumpRegionObjectCache : public view_listener_t
     }
 };
 
+class LLAdvancedCaptureRaycastScene : public view_listener_t
+{
+    bool handleEvent(const LLSD& userdata)
+    {
+        handle_capture_raycast_scene();
+        return true;
+    }
+};
+
 class LLAdvancedToggleInterestList360Mode : public view_listener_t
 {
 public:
@@ -4280,6 +4294,47 @@ void handle_dump_region_object_cache()
     }
 }
 
+// Save the volumes within draw distance, as they are showing now, for the
+// raycast benchmark in llprimitive's tests (see LLRaycastScene)
+void handle_capture_raycast_scene()
+{
+    LLRaycastScene scene;
+    LLVector3 camera = LLViewerCamera::getInstance()->getOrigin();
+    F32 far_clip = LLViewerCamera::getInstance()->getFar();
+
+    for (S32 i = 0; i < gObjectList.getNumObjects(); ++i)
+    {
+        LLViewerObject* object = gObjectList.getObject(i);
+        if (!object || object->isDead() || object->getPCode() != LL_PCODE_VOLUME || object->isAttachment())
+        {
+            continue;
+        }
+
+        LLVOVolume* vobj = (LLVOVolume*) object;
+        LLVolume* volume = vobj->getVolume();
+        if (!volume || vobj->isVolumeGlobal() || vobj->isFlexible() || volume->getNumVolumeFaces() == 0
+            || (vobj->getRenderPosition() - camera).magVec() > far_clip)
+        {
+            continue;
+        }
+
+        scene.addObject(volume, vobj->getRenderPosition(), vobj->getRenderRotation(), vobj->getScale());
+    }
+
+    std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "raycast_scene.llsd");
+    llofstream out(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+    if (out.good())
+    {
+        LLSDSerialize::toBinary(scene.asLLSD(), out);
+        out.close();
+        LL_INFOS() << "Saved " << scene.getNumObjects() << " objects to " << filename << LL_ENDL;
+    }
+    else
+    {
+        LL_WARNS() << "Could not write " << filename << LL_ENDL;
+    }
+}
+
 void handle_reset_interest_lists()
 {
     // Check all regions and reset their interest list
@@ -10262,6 +10317,7 @@ void initialize_menus()
     // Advanced > World
     view_listener_t::addMenu(new LLAdvancedDumpScriptedCamera(), "Advanced.DumpScriptedCamera");
     view_listener_t::addMenu(new LLAdvancedDumpRegionObjectCache(), "Advanced.DumpRegionObjectCache");
+    view_listener_t::addMenu(new LLAdvancedCaptureRaycastScene(), "Advanced.CaptureRaycastScene");
     view_listener_t::addMenu(new LLAdvancedToggleStatsRecorder(), "Advanced.ToggleStatsRecorder");
     view_listener_t::addMenu(new LLAdvancedCheckStatsRecorder(), "Advanced.CheckStatsRecorder");
     view_listener_t::addMenu(new LLAdvancedToggleInterestList360Mode(), "Advanced.ToggleInterestList360Mode");
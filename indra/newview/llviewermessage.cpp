@@ -40,6 +40,7 @@
 #include "llinventorydefines.h"
 #include "lllslconstants.h"
 #include "llmaterialtable.h"
+#include "llmessageviews.h"
 #include "llregionhandle.h"
 #include "llsd.h"
 #include "llsdserialize.h"
@@ -481,11 +482,9 @@ void process_layer_data(LLMessageSystem *mesgsys, void **user_data)
         LL_WARNS() << "Invalid region for layer data." << LL_ENDL;
         return;
     }
-    S32 size;
-    S8 type;
-
-    mesgsys->getS8Fast(_PREHASH_LayerID, _PREHASH_Type, type);
-    size = mesgsys->getSizeFast(_PREHASH_LayerData, _PREHASH_Data);
+    LLLayerDataView layer_data(mesgsys);
+    S8 type = layer_data.getType();
+    S32 size = layer_data.getDataSize();
     if (0 == size)
     {
         LL_WARNS("Messaging") << "Layer data has zero size." << LL_ENDL;
@@ -500,7 +499,7 @@ void process_layer_data(LLMessageSystem *mesgsys, void **user_data)
         return;
     }
     U8 *datap = new U8[size];
-    mesgsys->getBinaryDataFast(_PREHASH_LayerData, _PREHASH_Data, datap, size);
+    layer_data.getData(datap, size);
     LLVLData *vl_datap = new LLVLData(regionp, type, datap, size);
     if (mesgsys->getReceiveCompressedSize())
     {
@@ -30,6 +30,7 @@
 
 #include "message.h"
 #include "llfasttimer.h"
+#include "llmessageviews.h"
 #include "llrender.h"
 #include "llwindow.h"       // decBusyCount()
 
@@ -413,11 +414,17 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
     LLUUID      fullid;
     S32         i;
 
+    // ObjectUpdate and ImprovedTerseObjectUpdate are read straight from their
+    // flat decode tables, the compressed and cached variants by name.
+    LLObjectUpdateView full_update(mesgsys);
+    LLTerseObjectUpdateView terse_update(mesgsys);
+    const bool terse = (update_type == OUT_TERSE_IMPROVED);
+
     // figure out which simulator these are from and get it's index
     // Coordinates in simulators are region-local
     // Until we get region-locality working on viewer we
     // have to transform to absolute coordinates.
-    num_objects = mesgsys->getNumberOfBlocksFast(_PREHASH_ObjectData);
+    num_objects = terse ? terse_update.getNumObjects() : full_update.getNumObjects();
 
     // I don't think this case is ever hit.  TODO* Test this.
     if (!compressed && update_type != OUT_FULL)
@@ -455,8 +462,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         gFullObjectUpdates += num_objects;
     }
 
-    U64 region_handle;
-    mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+    U64 region_handle = terse ? terse_update.getRegionHandle() : full_update.getRegionHandle();
 
     LLViewerRegion *regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
 
@@ -479,15 +485,15 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         {
             compressed_dp.reset();
 
-            S32 uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+            // ObjectUpdateCompressed has the same Data field
+            S32 uncompressed_length = terse_update.getDataSize(i);
             LL_DEBUGS("ObjectUpdate") << "got binary data from message to compressed_dpbuffer" << LL_ENDL;
-            mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i, 2048);
+            terse_update.getData(i, compressed_dpbuffer, 2048);
             compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
 
             if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
             {
-                U32 flags = 0;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+                U32 flags = full_update.getUpdateFlags(i);
 
                 compressed_dp.unpackUUID(fullid, "ID");
                 compressed_dp.unpackU32(local_id, "LocalID");
@@ -528,7 +534,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         }
         else if (update_type != OUT_FULL) // !compressed, !OUT_FULL ==> OUT_FULL_CACHED only?
         {
-            mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+            local_id = full_update.getID(i);
 
             getUUIDFromLocal(fullid,
                             local_id,
@@ -547,8 +553,8 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         else // OUT_FULL only?
         {
             update_cache = true;
-            mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
-            mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+            fullid = full_update.getFullID(i);
+            local_id = full_update.getID(i);
             LL_DEBUGS("ObjectUpdate") << "Full Update, obj " << local_id << ", global ID " << fullid << " from " << mesgsys->getSender() << LL_ENDL;
         }
         objectp = findObject(fullid);
@@ -622,7 +628,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
                     continue;
                 }
 
-                mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
+                pcode = full_update.getPCode(i);
 
             }
 #ifdef IGNORE_DEAD
@@ -1359,7 +1359,11 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
     {
         mRes = frustumCheck(group);
 
-        if (mRes)
+        if (mRes == 1 && n->getChildCount() > 1 && getBatchFrustum() != BATCH_NONE)
+        { //partially in, test the children together on the way down
+            traverseBatched(n);
+        }
+        else if (mRes)
         { //at least partially in, run on down
             OctreeTraveler::traverse(n);
         }
@@ -1368,10 +1372,57 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
     }
 }
 
+void LLViewerOctreeCull::traverseBatched(const OctreeNode* n)
+{
+    n->accept(this);
+
+    const bool region = getBatchFrustum() == BATCH_REGION;
+    const U32 child_count = n->getChildCount();
+    for (U32 base = 0; base < child_count; base += LLCameraBoxBatch::MAX_BOXES)
+    {
+        LLCameraBoxBatch batch;
+        const OctreeNode* children[LLCameraBoxBatch::MAX_BOXES];
+        for (U32 i = base; i < child_count && batch.mCount < LLCameraBoxBatch::MAX_BOXES; i++)
+        {
+            const OctreeNode* child = n->getChild(i);
+            const LLViewerOctreeGroup* child_group = (LLViewerOctreeGroup*) child->getListener(0);
+            children[batch.mCount] = child;
+            batch.add(child_group->mBounds[0], child_group->mBounds[1]);
+        }
+
+        S32 res[LLCameraBoxBatch::MAX_BOXES];
+        S32 no_far_clip_res[LLCameraBoxBatch::MAX_BOXES];
+        if (region)
+        {
+            mCamera->AABBInRegionFrustumBatch(batch, res, no_far_clip_res);
+        }
+        else
+        {
+            mCamera->AABBInFrustumBatch(batch, res, no_far_clip_res);
+        }
+
+        for (U32 i = 0; i < batch.mCount; i++)
+        {
+            //picked up by the *GroupBounds tests in the child's frustumCheck()
+            mBatchGroup = (LLViewerOctreeGroup*) children[i]->getListener(0);
+            mBatchRegion = region;
+            mBatchRes = res[i];
+            mBatchNoFarClipRes = no_far_clip_res[i];
+            traverse(children[i]);
+        }
+    }
+
+    mBatchGroup = NULL;
+}
+
 //------------------------------------------
 //agent space group culling
 S32 LLViewerOctreeCull::AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
+    if (group == mBatchGroup && !mBatchRegion)
+    {
+        return mBatchNoFarClipRes;
+    }
     return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
 }
 
@@ -1382,6 +1433,10 @@ S32 LLViewerOctreeCull::AABBSphereIntersectGroupExtents(const LLViewerOctreeGrou
 
 S32 LLViewerOctreeCull::AABBInFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
+    if (group == mBatchGroup && !mBatchRegion)
+    {
+        return mBatchRes;
+    }
     return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
 }
 //------------------------------------------
@@ -1408,11 +1463,19 @@ S32 LLViewerOctreeCull::AABBInFrustumObjectBounds(const LLViewerOctreeGroup* gro
 //local regional space group culling
 S32 LLViewerOctreeCull::AABBInRegionFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
+    if (group == mBatchGroup && mBatchRegion)
+    {
+        return mBatchNoFarClipRes;
+    }
     return mCamera->AABBInRegionFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
 }
 
 S32 LLViewerOctreeCull::AABBInRegionFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
+    if (group == mBatchGroup && mBatchRegion)
+    {
+        return mBatchRes;
+    }
     return mCamera->AABBInRegionFrustum(group->mBounds[0], group->mBounds[1]);
 }
 
@@ -370,11 +370,23 @@ class LLViewerOctreeCull : public OctreeTraveler
 {
 public:
     LLViewerOctreeCull(LLCamera* camera)
-        : mCamera(camera), mRes(0) { }
+        : mCamera(camera), mRes(0), mBatchGroup(NULL), mBatchRegion(false), mBatchRes(0), mBatchNoFarClipRes(0) { }
 
     virtual void traverse(const OctreeNode* n);
 
 protected:
+    // Frustum that frustumCheck() tests group bounds against.  Lets the
+    // children of a partly visible node be tested as one batch before
+    // they are visited.
+    enum EBatchFrustum
+    {
+        BATCH_NONE,
+        BATCH_AGENT,
+        BATCH_REGION
+    };
+    virtual EBatchFrustum getBatchFrustum() const { return BATCH_NONE; }
+    void traverseBatched(const OctreeNode* n);
+
     virtual bool earlyFail(LLViewerOctreeGroup* group);
 
     //agent space group cull
@@ -409,6 +421,12 @@ class LLViewerOctreeCull : public OctreeTraveler
 protected:
     LLCamera *mCamera;
     S32 mRes;
+
+    // Batched frustum test results for the child about to be visited
+    const LLViewerOctreeGroup* mBatchGroup;
+    bool mBatchRegion;
+    S32 mBatchRes;
+    S32 mBatchNoFarClipRes;
 };
 
 //scan the octree, output the info of each node for debug use.
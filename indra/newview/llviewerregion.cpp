@@ -34,6 +34,7 @@
 #include "llavatarnamecache.h"      // name lookup cap url
 #include "llfloaterreg.h"
 #include "llmath.h"
+#include "llmessageviews.h"
 #include "llregionflags.h"
 #include "llregionhandle.h"
 #include "llsurface.h"
@@ -2340,22 +2341,22 @@ void LLViewerRegion::updateCoarseLocations(LLMessageSystem* msg)
 
     U32 pos = 0x0;
 
-    S16 agent_index;
-    S16 target_index;
-    msg->getS16Fast(_PREHASH_Index, _PREHASH_You, agent_index);
-    msg->getS16Fast(_PREHASH_Index, _PREHASH_Prey, target_index);
+    LLCoarseLocationUpdateView update(msg);
+    S16 agent_index = update.getYou();
+    S16 target_index = update.getPrey();
 
-    bool has_agent_data = msg->has(_PREHASH_AgentData);
-    S32 count = msg->getNumberOfBlocksFast(_PREHASH_Location);
+    S32 agent_count = update.getNumAgents();
+    bool has_agent_data = agent_count > 0;
+    S32 count = update.getNumLocations();
     for(S32 i = 0; i < count; i++)
     {
-        msg->getU8Fast(_PREHASH_Location, _PREHASH_X, x_pos, i);
-        msg->getU8Fast(_PREHASH_Location, _PREHASH_Y, y_pos, i);
-        msg->getU8Fast(_PREHASH_Location, _PREHASH_Z, z_pos, i);
+        x_pos = update.getX(i);
+        y_pos = update.getY(i);
+        z_pos = update.getZ(i);
         LLUUID agent_id = LLUUID::null;
-        if(has_agent_data)
+        if(i < agent_count)
         {
-            msg->getUUIDFast(_PREHASH_AgentData, _PREHASH_AgentID, agent_id, i);
+            agent_id = update.getAgentID(i);
         }
 
         //LL_INFOS() << "  object X: " << (S32)x_pos << " Y: " << (S32)y_pos
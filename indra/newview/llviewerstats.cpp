@@ -121,6 +121,8 @@ LLTrace::CountStatHandle<>  FPS("FPS", "Frames rendered"),
                             PACKETS_IN("Packets In", "Packets received"),
                             PACKETS_LOST("packetsloststat", "Packets lost"),
                             PACKETS_OUT("packetsoutstat", "Packets sent"),
+                            PACKETS_QUEUED("packetsqueuedstat", "Packets queued by the UDP receive thread"),
+                            PACKETS_QUEUE_DROPPED("packetsqueuedroppedstat", "Packets the UDP receive thread dropped, queue full"),
                             TEXTURE_PACKETS("texturepacketsstat", "Texture data packets received"),
                             CHAT_COUNT("chatcount", "Chat messages sent"),
                             IM_COUNT("imcount", "IMs sent"),
@@ -190,7 +192,9 @@ LLTrace::SampleStatHandle<> FPS_SAMPLE("fpssample"),
                             SHADER_OBJECTS("shaderobjects", "Object Shaders"),
                             DRAW_DISTANCE("drawdistance", "Draw Distance"),
                             WINDOW_WIDTH("windowwidth", "Window width"),
-                            WINDOW_HEIGHT("windowheight", "Window height");
+                            WINDOW_HEIGHT("windowheight", "Window height"),
+                            HTTP_TEXTURE_CONCURRENCY("httptextureconcurrency", "Texture fetches allowed in flight"),
+                            HTTP_MESH_CONCURRENCY("httpmeshconcurrency", "Mesh fetches allowed in flight");
 
 LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> >
                             PACKETS_LOST_PERCENT("packetslostpercentstat");
@@ -382,6 +386,12 @@ void update_statistics()
 	gTransferManager.resetTransferBitsIn(LLTCT_ASSET);
 
 	sample(LLStatViewer::VISIBLE_AVATARS, LLVOAvatar::sNumVisibleAvatars);
+
+	const LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
+	sample(LLStatViewer::HTTP_TEXTURE_CONCURRENCY,
+		   (F64)LLCore::HttpRequest::getActiveLimit(app_core_http.getPolicy(LLAppCoreHttp::AP_TEXTURE)));
+	sample(LLStatViewer::HTTP_MESH_CONCURRENCY,
+		   (F64)LLCore::HttpRequest::getActiveLimit(app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2)));
     LLWorld *world = LLWorld::getInstance(); // not LLSingleton
     if (world)
     {
@@ -651,6 +661,7 @@ void send_viewer_stats(bool include_preferences)
 
     fail["send_packet"] = (S32) gMessageSystem->mSendPacketFailureCount;
     fail["dropped"] = (S32) gMessageSystem->mDroppedPackets;
+    fail["receive_queue_dropped"] = (S32) gMessageSystem->mPacketRing.getPacketsDropped();
     fail["resent"] = (S32) gMessageSystem->mResentPackets;
     fail["failed_resends"] = (S32) gMessageSystem->mFailedResendPackets;
     fail["off_circuit"] = (S32) gMessageSystem->mOffCircuitPackets;
@@ -119,6 +119,8 @@ extern LLTrace::CountStatHandle<>           FPS,
                                             PACKETS_IN,
                                             PACKETS_LOST,
                                             PACKETS_OUT,
+                                            PACKETS_QUEUED,
+                                            PACKETS_QUEUE_DROPPED,
                                             TEXTURE_PACKETS,
                                             CHAT_COUNT,
                                             IM_COUNT,
@@ -183,7 +185,9 @@ extern LLTrace::SampleStatHandle<>      FPS_SAMPLE,
                                         SHADER_OBJECTS,
                                         DRAW_DISTANCE,
                                         WINDOW_WIDTH,
-                                        WINDOW_HEIGHT;
+                                        WINDOW_HEIGHT,
+                                        HTTP_TEXTURE_CONCURRENCY,
+                                        HTTP_MESH_CONCURRENCY;
 
 extern LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> > PACKETS_LOST_PERCENT;
 
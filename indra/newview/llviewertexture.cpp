@@ -1103,6 +1103,9 @@ void LLViewerFetchedTexture::init(bool firstinit)
     mNeedsAux = false;
     mRequestedDiscardLevel = -1;
     mRequestedDownloadPriority = 0.f;
+    mVisibleUVRegion = LLRectf();
+    mDecodedRegion = LLRect();
+    mFetchedRegion = LLRect();
     mFullyLoaded = false;
     mCanUseHTTP = true;
     mDesiredDiscardLevel = MAX_DISCARD_LEVEL + 1;
@@ -1215,6 +1218,7 @@ void LLViewerFetchedTexture::loadFromFastCache()
     add(LLTextureFetch::sCacheAttempt, 1.0);
 
     LLTimer fastCacheTimer;
+    mCompressedImage = nullptr;
     mRawImage = LLAppViewer::getTextureCache()->readFromFastCache(getID(), mRawDiscardLevel);
     if(mRawImage.notNull())
     {
@@ -1521,7 +1525,16 @@ bool LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
         return false;
     }
 
-    bool res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, true, mBoostLevel);
+    bool res;
+    if (mCompressedImage.notNull())
+    {
+        // falls back to mRawImage if the raw image was rescaled after decode
+        res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, mCompressedImage, usename, mBoostLevel);
+    }
+    else
+    {
+        res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, true, mBoostLevel);
+    }
 
     return res;
 }
@@ -1796,6 +1809,39 @@ S32 LLViewerFetchedTexture::getCurrentDiscardLevelForFetching()
     return current_discard;
 }
 
+// Part of the full resolution image worth decoding at full detail, empty to
+// decode all of it. Only large textures of which a small part is mapped onto
+// visible faces qualify, everything else keeps decoding whole.
+LLRect LLViewerFetchedTexture::getDecodeRegion() const
+{
+    static LLCachedControl<U32> min_size(gSavedSettings, "TextureRegionDecodeMinSize", 2048);
+    // visible part that can still be decoded as a region
+    const F32 MAX_REGION_AREA = 0.5f;
+    // margin around the visible part so small camera moves do not refetch
+    const F32 REGION_PAD = 1.f / 16.f;
+
+    if (min_size == 0 ||
+        llmax(mFullWidth, mFullHeight) < (S32)min_size ||
+        mVisibleUVRegion.isEmpty() ||
+        mNeedsAux || mForSculpt || mForceToSaveRawImage ||
+        !mLoadedCallbackList.empty() ||
+        mBoostLevel >= LLGLTexture::BOOST_HIGH)
+    {
+        return LLRect();
+    }
+
+    LLRectf uv(mVisibleUVRegion);
+    uv.stretch(REGION_PAD);
+    uv.intersectWith(LLRectf(0.f, 1.f, 1.f, 0.f));
+    if (uv.getWidth() * uv.getHeight() > MAX_REGION_AREA)
+    {
+        return LLRect();
+    }
+
+    return LLRect(llfloor(uv.mLeft * mFullWidth), llceil(uv.mTop * mFullHeight),
+                  llceil(uv.mRight * mFullWidth), llfloor(uv.mBottom * mFullHeight));
+}
+
 bool LLViewerFetchedTexture::isActiveFetching()
 {
     static LLCachedControl<bool> monitor_enabled(gSavedSettings,"DebugShowTextureInfo");
@@ -1826,10 +1872,13 @@ bool LLViewerFetchedTexture::processFetchResults(S32& desired_discard, S32 curre
             tester->updateTextureLoadingStats(this, mRawImage, LLAppViewer::getTextureFetch()->isFromLocalCache(mID));
         }
         mRawDiscardLevel = fetch_discard;
+        // a redecode at the same level is only wanted when it moved the sharp region
+        bool region_changed = mRawDiscardLevel == current_discard && mFetchedRegion != mDecodedRegion;
         if ((mRawImage->getDataSize() > 0 && mRawDiscardLevel >= 0) &&
-            (current_discard < 0 || mRawDiscardLevel < current_discard))
+            (current_discard < 0 || mRawDiscardLevel < current_discard || region_changed))
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - data good");
+            mDecodedRegion = mFetchedRegion;
 
             // This is going to conflict with Develop, just pick from develop
             // where it uses setDimensions instead of setTexelsPerImage
@@ -2012,9 +2061,13 @@ bool LLViewerFetchedTexture::updateFetch()
         if (mRawImage.notNull()) sRawCount--;
         if (mAuxRawImage.notNull()) sAuxCount--;
         // keep in mind that fetcher still might need raw image, don't modify original
-        bool finished = LLAppViewer::getTextureFetch()->getRequestFinished(getID(), fetch_discard, mFetchState, mRawImage, mAuxRawImage,
+        bool finished = LLAppViewer::getTextureFetch()->getRequestFinished(getID(), fetch_discard, mFetchState, mRawImage, mAuxRawImage, mCompressedImage,
                                                                            mLastHttpGetStatus);
-        if (mRawImage.notNull()) sRawCount++;
+        if (mRawImage.notNull())
+        {
+            sRawCount++;
+            LLAppViewer::getTextureFetch()->getDecodedRegion(getID(), mFetchedRegion);
+        }
         if (mAuxRawImage.notNull())
         {
             mHasAux = true;
@@ -2050,6 +2103,11 @@ bool LLViewerFetchedTexture::updateFetch()
 
     desired_discard = llmin(desired_discard, getMaxDiscardLevel());
 
+    // the sharp part of a region decoded image no longer covers what is visible
+    LLRect decode_region = getDecodeRegion();
+    bool region_stale = mDecodedRegion.notEmpty() &&
+        (decode_region.isEmpty() || !mDecodedRegion.contains(decode_region));
+
     bool make_request = true;
     if (decode_priority <= 0)
     {
@@ -2066,7 +2124,7 @@ bool LLViewerFetchedTexture::updateFetch()
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - create or missing");
         make_request = false;
     }
-    else if (current_discard >= 0 && current_discard <= mMinDiscardLevel)
+    else if (current_discard >= 0 && current_discard <= mMinDiscardLevel && !region_stale)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - current < min");
         make_request = false;
@@ -2088,8 +2146,16 @@ bool LLViewerFetchedTexture::updateFetch()
             // already at a higher resolution mip, don't discard
             if (current_discard >= 0 && current_discard <= desired_discard)
             {
-                LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - current <= desired");
-                make_request = false;
+                if (region_stale)
+                {
+                    // decode again at the current level around the new region
+                    desired_discard = current_discard;
+                }
+                else
+                {
+                    LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vftuf - current <= desired");
+                    make_request = false;
+                }
             }
         }
     }
@@ -2115,7 +2181,7 @@ bool LLViewerFetchedTexture::updateFetch()
         S32 fetch_request_response = -1;
         S32 worker_discard = -1;
         fetch_request_response = LLAppViewer::getTextureFetch()->createRequest(mFTType, mUrl, getID(), getTargetHost(), decode_priority,
-            w, h, c, desired_discard, needsAux(), mCanUseHTTP);
+            w, h, c, desired_discard, needsAux(), mCanUseHTTP, decode_region);
 
         if (fetch_request_response >= 0) // positive values and 0 are discard values
         {
@@ -2145,7 +2211,9 @@ bool LLViewerFetchedTexture::updateFetch()
                 // worker actually has the image
                 if (mRawImage.notNull()) sRawCount--;
                 if (mAuxRawImage.notNull()) sAuxCount--;
+                mCompressedImage = nullptr;
                 decoded_discard = LLAppViewer::getTextureFetch()->getLastRawImage(getID(), mRawImage, mAuxRawImage);
+                LLAppViewer::getTextureFetch()->getDecodedRegion(getID(), mFetchedRegion);
                 if (mRawImage.notNull()) sRawCount++;
                 if (mAuxRawImage.notNull())
                 {
@@ -2731,6 +2799,7 @@ void LLViewerFetchedTexture::destroyRawImage()
         }
 
         mRawImage = nullptr;
+        mCompressedImage = nullptr;
 
         mIsRawImageValid = false;
         mRawDiscardLevel = INVALID_DISCARD_LEVEL;
@@ -2850,6 +2919,7 @@ void LLViewerFetchedTexture::readbackRawImage()
         {
             sRawCount++;
         }
+        mCompressedImage = nullptr;
         mRawImage = new LLImageRaw();
         if (!mGLTexturep->readBackRaw(-1, mRawImage, false))
         {
@@ -33,6 +33,7 @@
 #include "llframetimer.h"
 #include "llhost.h"
 #include "llgltypes.h"
+#include "llrect.h"
 #include "llrender.h"
 #include "llmetricperformancetester.h"
 #include "httpcommon.h"
@@ -335,6 +336,10 @@ class LLViewerFetchedTexture : public LLViewerTexture
 
     void updateVirtualSize() ;
 
+    // Part of the texture mapped onto faces in the view frustum, in [0,1]
+    // texture space. Set by LLViewerTextureList.
+    void setVisibleUVRegion(const LLRectf& region) { mVisibleUVRegion = region; }
+
     S32  getDesiredDiscardLevel()            { return mDesiredDiscardLevel; }
     void setMinDiscardLevel(S32 discard)    { mMinDesiredDiscardLevel = llmin(mMinDesiredDiscardLevel,(S8)discard); }
 
@@ -425,6 +430,7 @@ class LLViewerFetchedTexture : public LLViewerTexture
     void cleanup() ;
 
     bool processFetchResults(S32& desired_discard, S32 current_discard, S32 fetch_discard, F32 decode_priority);
+    LLRect getDecodeRegion() const;
 
     void saveRawImage() ;
 
@@ -477,6 +483,15 @@ class LLViewerFetchedTexture : public LLViewerTexture
     LLPointer<LLImageRaw> mRawImage;
     S32 mRawDiscardLevel = -1;
 
+    // Block compressed copy of mRawImage made by the decode thread, if any
+    LLPointer<LLImageDXT> mCompressedImage;
+
+    // Region decoding of large textures: only mDecodedRegion (full resolution
+    // pixels) of the current image is at full detail, empty when all of it is.
+    LLRectf mVisibleUVRegion;
+    LLRect mDecodedRegion;
+    LLRect mFetchedRegion;
+
     // Used ONLY for cloth meshes right now.  Make SURE you know what you're
     // doing if you use it for anything else! - djs
     LLPointer<LLImageRaw> mAuxRawImage;
@@ -897,6 +897,8 @@ void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imag
 
         F32 max_vsize = 0.f;
         bool on_screen = false;
+        bool any_in_frustum = false;
+        LLRectf visible_uv;
 
         U32 face_count = 0;
 
@@ -932,6 +934,21 @@ void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imag
 
                     on_screen = face->mInFrustum;
 
+                    if (face->mInFrustum)
+                    {
+                        // only the diffuse channel follows the face's texture transform
+                        LLRectf face_uv = (i == LLRender::DIFFUSE_MAP) ? face->mUVRegion : LLRectf(0.f, 1.f, 1.f, 0.f);
+                        if (any_in_frustum)
+                        {
+                            visible_uv.unionWith(face_uv);
+                        }
+                        else
+                        {
+                            visible_uv = face_uv;
+                            any_in_frustum = true;
+                        }
+                    }
+
                     // Scale desired texture resolution higher or lower depending on texture scale
                     //
                     // Minimum usage examples: a 1024x1024 texture with aplhabet, runing string
@@ -983,6 +1000,13 @@ void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imag
         }
 
         imagep->addTextureStats(max_vsize);
+
+        if (any_in_frustum)
+        {
+            // keep the last visible region while nothing is on screen so
+            // region decoded textures do not refetch when looked away from
+            imagep->setVisibleUVRegion(visible_uv);
+        }
     }
 
 #if 0
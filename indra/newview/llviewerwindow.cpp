@@ -211,6 +211,7 @@
 #include "llviewerwindowlistener.h"
 
 #include "llcleanup.h"
+#include "workqueue.h"
 
 //BD
 #include "bdsidebar.h"
@@ -4797,7 +4798,7 @@ bool LLViewerWindow::mousePointOnLandGlobal(const S32 x, const S32 y, LLVector3d
 }
 
 // Saves an image to the harddrive as "SnapshotX" where X >= 1.
-void LLViewerWindow::saveImageNumbered(LLImageFormatted *image, bool force_picker, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb)
+void LLViewerWindow::saveImageNumbered(LLImageFormatted *image, bool force_picker, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLImageRaw* raw)
 {
     if (!image)
     {
@@ -4827,23 +4828,34 @@ void LLViewerWindow::saveImageNumbered(LLImageFormatted *image, bool force_picke
         else
             pick_type = LLFilePicker::FFSAVE_ALL;
 
-        LLFilePickerReplyThread::startPicker(boost::bind(&LLViewerWindow::onDirectorySelected, this, _1, formatted_image, success_cb, failure_cb), pick_type, proposed_name,
+        LLFilePickerReplyThread::startPicker(boost::bind(&LLViewerWindow::onDirectorySelected, this, _1, formatted_image, success_cb, failure_cb, LLPointer<LLImageRaw>(raw)), pick_type, proposed_name,
                                         boost::bind(&LLViewerWindow::onSelectionFailure, this, failure_cb));
     }
     else
     {
-        saveImageLocal(formatted_image, success_cb, failure_cb);
+        saveImageLocal(formatted_image, success_cb, failure_cb, raw);
     }
 }
 
-void LLViewerWindow::onDirectorySelected(const std::vector<std::string>& filenames, LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb)
+void LLViewerWindow::onDirectorySelected(const std::vector<std::string>& filenames, LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLPointer<LLImageRaw> raw)
 {
     // Copy the directory + file name
     std::string filepath = filenames[0];
 
     gSavedPerAccountSettings.setString("SnapshotBaseName", gDirUtilp->getBaseFileName(filepath, true));
     gSavedPerAccountSettings.setString("SnapshotBaseDir", gDirUtilp->getDirName(filepath));
-    saveImageLocal(image, success_cb, failure_cb);
+    saveImageLocal(image, success_cb, failure_cb, raw);
+}
+
+F32 LLViewerWindow::getSnapshotSaveProgress() const
+{
+    F32 progress = -1.f;
+    for (const std::shared_ptr<std::atomic<F32> >& save_progress : mSnapshotSaves)
+    {
+        F32 fraction = *save_progress;
+        progress = progress < 0.f ? fraction : llmin(progress, fraction);
+    }
+    return progress;
 }
 
 void LLViewerWindow::onSelectionFailure(const snapshot_saved_signal_t::slot_type& failure_cb)
@@ -4852,7 +4864,7 @@ void LLViewerWindow::onSelectionFailure(const snapshot_saved_signal_t::slot_type
 }
 
 
-void LLViewerWindow::saveImageLocal(LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb)
+void LLViewerWindow::saveImageLocal(LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLImageRaw* raw)
 {
 	std::string lastSnapshotDir = LLViewerWindow::getLastSnapshotDir();
 	if (lastSnapshotDir.empty())
@@ -4879,13 +4891,15 @@ void LLViewerWindow::saveImageLocal(LLImageFormatted *image, const snapshot_save
         return;
     }
     boost::filesystem::space_info b_space = boost::filesystem::space(b_path);
-    if (b_space.free < image->getDataSize())
+    // Not encoded yet when streaming from raw, the raw size is a safe upper bound
+    S32 needed_bytes = raw ? raw->getDataSize() : image->getDataSize();
+    if (b_space.free < needed_bytes)
     {
         LLSD args;
         args["PATH"] = lastSnapshotDir;
 
         std::string needM_bytes_string;
-        LLResMgr::getInstance()->getIntegerString(needM_bytes_string, (image->getDataSize()) >> 10);
+        LLResMgr::getInstance()->getIntegerString(needM_bytes_string, needed_bytes >> 10);
         args["NEED_MEMORY"] = needM_bytes_string;
 
         std::string freeM_bytes_string;
@@ -4924,6 +4938,49 @@ void LLViewerWindow::saveImageLocal(LLImageFormatted *image, const snapshot_save
             && is_snapshot_name_loc_set); // Or stop if we are rewriting.
 
     LL_INFOS() << "Saving snapshot to " << filepath << LL_ENDL;
+    if (raw)
+    {
+        // Large snapshots take seconds to compress: stream them to disk from
+        // the General thread pool and report back on the main loop.
+        LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        llassert_always(main_queue);
+        llassert_always(general_queue);
+
+        std::shared_ptr<std::atomic<F32> > save_progress = std::make_shared<std::atomic<F32> >(0.f);
+        mSnapshotSaves.push_back(save_progress);
+        LLPointer<LLImageFormatted> formatted = image;
+        LLPointer<LLImageRaw> source = raw;
+        snapshot_saved_signal_t::slot_type on_success = success_cb;
+        snapshot_saved_signal_t::slot_type on_failure = failure_cb;
+        main_queue->postTo(
+            general_queue,
+            [formatted, source, filepath, save_progress]() mutable // Work done on general queue
+            {
+                LL_PROFILE_ZONE_NAMED("snapshot encode to file");
+                return formatted->encodeToFile(source, filepath,
+                    [save_progress](F32 progress)
+                    {
+                        *save_progress = progress;
+                    });
+            },
+            [this, on_success, on_failure, filepath, save_progress](bool success) // Done on main thread
+            {
+                mSnapshotSaves.remove(save_progress);
+                if (success)
+                {
+                    playSnapshotAnimAndSound();
+                    on_success();
+                }
+                else
+                {
+                    LL_WARNS() << "Failed to encode snapshot to " << filepath << LL_ENDL;
+                    on_failure();
+                }
+            });
+        return;
+    }
+
     if (image->save(filepath))
     {
         playSnapshotAnimAndSound();
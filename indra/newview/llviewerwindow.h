@@ -49,6 +49,8 @@
 #include "llsnapshotmodel.h"
 #include "llviewercamera.h"
 
+#include <atomic>
+#include <list>
 #include <boost/function.hpp>
 #include <boost/signals2.hpp>
 
@@ -393,9 +395,13 @@ class LLViewerWindow : public LLWindowCallbacks
 
     typedef boost::signals2::signal<void(void)> snapshot_saved_signal_t;
 
-    void            saveImageNumbered(LLImageFormatted *image, bool force_picker, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb);
-    void            onDirectorySelected(const std::vector<std::string>& filenames, LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb);
-    void            saveImageLocal(LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb);
+    // When raw is given, image is only used for its format: raw gets encoded straight
+    // into the file on the General thread pool and the callbacks fire once it's done.
+    void            saveImageNumbered(LLImageFormatted *image, bool force_picker, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLImageRaw* raw = NULL);
+    void            onDirectorySelected(const std::vector<std::string>& filenames, LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLPointer<LLImageRaw> raw = NULL);
+    void            saveImageLocal(LLImageFormatted *image, const snapshot_saved_signal_t::slot_type& success_cb, const snapshot_saved_signal_t::slot_type& failure_cb, LLImageRaw* raw = NULL);
+    // Fraction written so far by the least advanced background save, -1 when none is running
+    F32             getSnapshotSaveProgress() const;
     void            onSelectionFailure(const snapshot_saved_signal_t::slot_type& failure_cb);
 
     // Reset the directory where snapshots are saved.
@@ -550,6 +556,9 @@ class LLViewerWindow : public LLWindowCallbacks
     bool            mResDirty;
     bool            mStatesDirty;
 
+    // Progress of each background snapshot save still running
+    std::list<std::shared_ptr<std::atomic<F32> > > mSnapshotSaves;
+
     std::unique_ptr<LLWindowListener> mWindowListener;
     std::unique_ptr<LLViewerWindowListener> mViewerWindowListener;
 
@@ -787,6 +787,8 @@ class LLVOCacheOctreeCull : public LLViewerOctreeCull
         mNearRadius = LLVOCacheEntry::sNearRadius;
     }
 
+    virtual EBatchFrustum getBatchFrustum() const { return BATCH_REGION; }
+
     virtual bool earlyFail(LLViewerOctreeGroup* base_group)
     {
         if( mUseObjectCacheOcclusion &&
@@ -104,6 +104,7 @@ F32 LLVOVolume::sLODFactor = 1.f;
 F32 LLVOVolume::sLODSlopDistanceFactor = 0.5f; //Changing this to zero, effectively disables the LOD transition slop
 F32 LLVOVolume::sDistanceFactor = 1.0f;
 S32 LLVOVolume::sNumLODChanges = 0;
+std::vector<LLPointer<LLVOVolume> > LLVOVolume::sPendingVolumes;
 S32 LLVOVolume::mRenderComplexity_last = 0;
 S32 LLVOVolume::mRenderComplexity_current = 0;
 LLPointer<LLObjectMediaDataClient> LLVOVolume::sObjectMediaClient = NULL;
@@ -231,6 +232,7 @@ LLVOVolume::LLVOVolume(const LLUUID &id, const LLPCode pcode, LLViewerRegion *re
     mNumFaces = 0;
     mLODChanged = false;
     mSculptChanged = false;
+    mVolumePending = false;
     mColorChanged = false;
     mSpotLightPriority = 0.f;
 
@@ -334,6 +336,7 @@ void LLVOVolume::cleanupClass()
 {
     sObjectMediaClient = NULL;
     sObjectMediaNavigateClient = NULL;
+    sPendingVolumes.clear();
 }
 
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
@@ -904,7 +907,8 @@ void LLVOVolume::updateTextureVirtualSize(bool forced)
 
             if (texture_discard >= 0 && //texture has some data available
                 (texture_discard < current_discard || //texture has more data than last rebuild
-                current_discard < 0)) //no previous rebuild
+                current_discard < 0) && //no previous rebuild
+                !(getVolume() && LLPrimitive::getVolumeManager()->isSculptPending(getVolume()))) //not already being sculpted
             {
                 gPipeline.markRebuild(mDrawable, LLDrawable::REBUILD_VOLUME);
                 mSculptChanged = true;
@@ -1108,6 +1112,12 @@ bool LLVOVolume::setVolume(const LLVolumeParams &params_in, const S32 detail, bo
 
     }
 
+    if (deferVolumeLOD(volume_params, lod))
+    {
+        // keep the current LOD until the new one has been generated
+        return false;
+    }
+
     if ((LLPrimitive::setVolume(volume_params, lod, (mVolumeImpl && mVolumeImpl->isVolumeUnique()))) || mSculptChanged)
     {
         mFaceMappingChanged = true;
@@ -1280,39 +1290,149 @@ void LLVOVolume::notifySkinInfoUnavailable()
     mSkinInfo = nullptr;
 }
 
-// sculpt replaces generate() for sculpted surfaces
-void LLVOVolume::sculpt()
+// Start generating a new LOD of the current shape in the background and
+// keep the current LOD until it is ready.  Returns false if the LOD should
+// be switched to right away.
+bool LLVOVolume::deferVolumeLOD(const LLVolumeParams &volume_params, const S32 lod)
+{
+    LLVolumeMgr* volume_mgr = LLPrimitive::getVolumeManager();
+    if (!volume_mgr->isGenerateAsync() ||
+        NO_LOD == lod ||
+        mVolumep.isNull() ||
+        mVolumep->isUnique() ||
+        mSculptChanged ||
+        (mVolumeImpl && mVolumeImpl->isVolumeUnique()) ||
+        volume_params != mVolumep->getParams() ||
+        LLVolumeLODGroup::getVolumeScaleFromDetail(lod) == mVolumep->getDetail())
+    { // nothing to keep showing, or not a LOD change
+        return false;
+    }
+
+    LLVolumeSculptMap sculpt_map;
+    bool sculpted = isSculpted();
+    if (sculpted)
+    {
+        LLImageRaw* raw_image = NULL;
+        S32 discard_level = 0;
+        if (isMesh() || mSculptTexture.isNull() || !getSculptImage(raw_image, discard_level))
+        {
+            return false;
+        }
+        copySculptMap(raw_image, discard_level, sculpt_map);
+    }
+
+    if (volume_mgr->requestVolume(volume_params, lod, sculpted ? &sculpt_map : NULL))
+    {
+        return false;
+    }
+
+    if (!mVolumePending)
+    {
+        mVolumePending = true;
+        sPendingVolumes.push_back(this);
+    }
+    return true;
+}
+
+//static
+void LLVOVolume::updatePendingVolumes()
 {
-    if (mSculptTexture.notNull())
+    if (!LLPrimitive::getVolumeManager()->updateGenerated())
     {
-        U16 sculpt_height = 0;
-        U16 sculpt_width = 0;
-        S8 sculpt_components = 0;
-        const U8* sculpt_data = NULL;
+        return;
+    }
 
-        S32 discard_level = mSculptTexture->getRawImageLevel() ;
-        LLImageRaw* raw_image = mSculptTexture->getRawImage() ;
+    // Something finished, let everyone waiting look again.  Those
+    // still waiting queue themselves up again from setVolume() or sculpt().
+    std::vector<LLPointer<LLVOVolume> > pending;
+    pending.swap(sPendingVolumes);
+    for (LLVOVolume* volumep : pending)
+    {
+        volumep->mVolumePending = false;
+        if (volumep->isDead() || volumep->mDrawable.isNull())
+        {
+            continue;
+        }
 
-        if (!raw_image)
+        if (volumep->isSculpted())
         {
-            raw_image = mSculptTexture->getSavedRawImage();
-            discard_level = mSculptTexture->getSavedRawImageLevel();
+            volumep->mSculptChanged = true;
         }
+        else
+        {
+            volumep->mLODChanged = true;
+        }
+        gPipeline.markRebuild(volumep->mDrawable, LLDrawable::REBUILD_VOLUME);
+    }
+}
+
+// Pick the best copy of the sculpt texture there is.  Returns false if
+// no usable level has arrived yet.
+bool LLVOVolume::getSculptImage(LLImageRaw*& raw_image, S32& discard_level)
+{
+    discard_level = mSculptTexture->getRawImageLevel() ;
+    raw_image = mSculptTexture->getRawImage() ;
+
+    if (!raw_image)
+    {
+        raw_image = mSculptTexture->getSavedRawImage();
+        discard_level = mSculptTexture->getSavedRawImageLevel();
+    }
 
-        if (!raw_image || raw_image->getWidth() < mSculptTexture->getWidth() || raw_image->getHeight() < mSculptTexture->getHeight())
+    if (!raw_image || raw_image->getWidth() < mSculptTexture->getWidth() || raw_image->getHeight() < mSculptTexture->getHeight())
+    {
+        // last resort, read back from GL
+        mSculptTexture->readbackRawImage();
+        raw_image = mSculptTexture->getRawImage();
+        discard_level = mSculptTexture->getRawImageLevel();
+    }
+
+    S32 max_discard = mSculptTexture->getMaxDiscardLevel();
+    if (discard_level > max_discard)
+    {
+        discard_level = max_discard;    // clamp to the best we can do
+    }
+    if(discard_level > MAX_DISCARD_LEVEL)
+    {
+        return false; //we think data is not ready yet.
+    }
+
+    return true;
+}
+
+void LLVOVolume::copySculptMap(LLImageRaw* raw_image, S32 discard_level, LLVolumeSculptMap& sculpt_map)
+{
+    if(!raw_image)
+    {
+        sculpt_map.set(0, 0, 0, NULL, discard_level, mSculptTexture->isMissingAsset());
+
+        if(LLViewerTextureManager::sTesterp)
         {
-            // last resort, read back from GL
-            mSculptTexture->readbackRawImage();
-            raw_image = mSculptTexture->getRawImage();
-            discard_level = mSculptTexture->getRawImageLevel();
+            LLViewerTextureManager::sTesterp->updateGrayTextureBinding();
         }
+    }
+    else
+    {
+        LLImageDataSharedLock lock(raw_image);
+
+        sculpt_map.set(raw_image->getWidth(), raw_image->getHeight(), raw_image->getComponents(), raw_image->getData(),
+                       discard_level, mSculptTexture->isMissingAsset());
 
-        S32 max_discard = mSculptTexture->getMaxDiscardLevel();
-        if (discard_level > max_discard)
+        if(LLViewerTextureManager::sTesterp)
         {
-            discard_level = max_discard;    // clamp to the best we can do
+            mSculptTexture->updateBindStatsForTester() ;
         }
-        if(discard_level > MAX_DISCARD_LEVEL)
+    }
+}
+
+// sculpt replaces generate() for sculpted surfaces
+void LLVOVolume::sculpt()
+{
+    if (mSculptTexture.notNull())
+    {
+        S32 discard_level = 0;
+        LLImageRaw* raw_image = NULL;
+        if (!getSculptImage(raw_image, discard_level))
         {
             return; //we think data is not ready yet.
         }
@@ -1360,34 +1480,21 @@ void LLVOVolume::sculpt()
         if (current_discard == discard_level)  // no work to do here
             return;
 
-        if(!raw_image)
-        {
-            sculpt_width = 0;
-            sculpt_height = 0;
-            sculpt_data = NULL ;
+        LLVolumeSculptMap sculpt_map;
+        copySculptMap(raw_image, discard_level, sculpt_map);
 
-            if(LLViewerTextureManager::sTesterp)
+        if (LLPrimitive::getVolumeManager()->requestSculpt(getVolume(), sculpt_map))
+        { // the current shape stays until the new one is swapped in
+            if (!mVolumePending)
             {
-                LLViewerTextureManager::sTesterp->updateGrayTextureBinding();
+                mVolumePending = true;
+                sPendingVolumes.push_back(this);
             }
         }
         else
         {
-            LLImageDataSharedLock lock(raw_image);
-
-            sculpt_height = raw_image->getHeight();
-            sculpt_width = raw_image->getWidth();
-            sculpt_components = raw_image->getComponents();
-
-            sculpt_data = raw_image->getData();
-
-            if(LLViewerTextureManager::sTesterp)
-            {
-                mSculptTexture->updateBindStatsForTester() ;
-            }
+            sculpt_map.sculpt(getVolume());
         }
-
-        getVolume()->sculpt(sculpt_width, sculpt_height, sculpt_components, sculpt_data, discard_level, mSculptTexture->isMissingAsset());
     }
 }
 
@@ -4462,6 +4569,17 @@ void LLVOVolume::forceLOD(S32 lod)
 void LLVOVolume::preUpdateGeom()
 {
     sNumLODChanges = 0;
+    updatePendingVolumes();
+
+    // Mesh LODs left alone for a whole period are kept quantized until
+    // they are looked at again
+    static LLCachedControl<U32> quantize_idle_seconds(gSavedSettings, "MeshQuantizeIdleSeconds", 0);
+    static LLFrameTimer quantize_timer;
+    if (quantize_idle_seconds > 0 && quantize_timer.getElapsedTimeF32() > (F32)quantize_idle_seconds)
+    {
+        quantize_timer.reset();
+        LLPrimitive::getVolumeManager()->quantizeIdleVolumes();
+    }
 }
 
 void LLVOVolume::parameterChanged(U16 param_type, bool local_origin)
@@ -5137,12 +5255,24 @@ void LLRiggedVolume::update(
                 dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
                 dst_face.mCenter->mul(0.5f);
 
+                // Both raycast trees hold the old positions.  Picking
+                // builds whichever it uses when it is missing.
+                dst_face.destroyOctree();
+                dst_face.destroyBVH();
             }
 
             if (rebuild_face_octrees)
             {
                 dst_face.destroyOctree();
-                dst_face.createOctree();
+                dst_face.destroyBVH();
+                if (LLVolume::sRaycastBVH)
+                {
+                    dst_face.createBVH();
+                }
+                else
+                {
+                    dst_face.createOctree();
+                }
             }
         }
     }
@@ -46,6 +46,8 @@ class LLObjectMediaDataClient;
 class LLObjectMediaNavigateClient;
 class LLVOAvatar;
 class LLMeshSkinInfo;
+class LLImageRaw;
+struct LLVolumeSculptMap;
 
 typedef std::vector<viewer_media_t> media_list_t;
 
@@ -111,6 +113,7 @@ class LLVOVolume : public LLViewerObject
     static      void    initClass();
     static      void    cleanupClass();
     static      void    preUpdateGeom();
+    static      void    updatePendingVolumes();
 
     enum
     {
@@ -231,9 +234,12 @@ class LLVOVolume : public LLViewerObject
                 void    setTexture(const S32 face);
                 S32     getIndexInTex(U32 ch) const {return mIndexInTex[ch];}
     /*virtual*/ bool    setVolume(const LLVolumeParams &volume_params, const S32 detail, bool unique_volume = false) override;
+                bool    deferVolumeLOD(const LLVolumeParams &volume_params, const S32 lod);
                 void    updateSculptTexture();
                 void    setIndexInTex(U32 ch, S32 index) { mIndexInTex[ch] = index ;}
                 void    sculpt();
+                bool    getSculptImage(LLImageRaw*& raw_image, S32& discard_level);
+                void    copySculptMap(LLImageRaw* raw_image, S32 discard_level, LLVolumeSculptMap& sculpt_map);
      static     void    rebuildMeshAssetCallback(const LLUUID& asset_uuid,
                                                  LLAssetType::EType type,
                                                  void* user_data, S32 status, LLExtStat ext_status);
@@ -481,6 +487,7 @@ class LLVOVolume : public LLViewerObject
     S32         mLOD;
     bool        mLODChanged;
     bool        mSculptChanged;
+    bool        mVolumePending;     // waiting on a volume generated in the background
     bool        mColorChanged;
     F32         mSpotLightPriority;
     LLMatrix4   mRelativeXform;
@@ -519,6 +526,7 @@ class LLVOVolume : public LLViewerObject
     static LLPointer<LLObjectMediaNavigateClient> sObjectMediaNavigateClient;
 protected:
     static S32 sNumLODChanges;
+    static std::vector<LLPointer<LLVOVolume> > sPendingVolumes;
 
     friend class LLVolumeImplFlexible;
 };
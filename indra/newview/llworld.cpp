@@ -93,6 +93,8 @@ LLWorld::LLWorld() :
     mLastPacketsIn(0),
     mLastPacketsOut(0),
     mLastPacketsLost(0),
+    mLastPacketsQueued(0),
+    mLastPacketsQueueDropped(0),
     mSpaceTimeUSec(0)
 {
     for (S32 i = 0; i < EDGE_WATER_OBJECTS_COUNT; i++)
@@ -806,6 +808,15 @@ void LLWorld::updateNetStats()
     add(LLStatViewer::PACKETS_OUT, packets_out);
     add(LLStatViewer::PACKETS_LOST, packets_lost);
 
+    // UDP receive thread, packets it queued for checkMessages() versus the
+    // ones it had to throw away because the main thread fell behind
+    U32 packets_queued = gMessageSystem->mPacketRing.getPacketsQueued();
+    U32 packets_queue_dropped = gMessageSystem->mPacketRing.getPacketsDropped();
+    add(LLStatViewer::PACKETS_QUEUED, packets_queued - mLastPacketsQueued);
+    add(LLStatViewer::PACKETS_QUEUE_DROPPED, packets_queue_dropped - mLastPacketsQueueDropped);
+    mLastPacketsQueued = packets_queued;
+    mLastPacketsQueueDropped = packets_queue_dropped;
+
     F32 total_packets_in = (F32)LLViewerStats::instance().getRecording().getSum(LLStatViewer::PACKETS_IN);
     if (total_packets_in > 0.f)
     {
@@ -198,6 +198,8 @@ class LLWorld : public LLSimpleton<LLWorld>
     S32 mLastPacketsIn;
     S32 mLastPacketsOut;
     S32 mLastPacketsLost;
+    U32 mLastPacketsQueued;
+    U32 mLastPacketsQueueDropped;
     U32 mNumOfActiveCachedObjects;
     U64MicrosecondsImplicit mSpaceTimeUSec;
 
@@ -0,0 +1,142 @@
+/**
+ * @file llmeshranges_test.cpp
+ * @brief LLMeshRanges test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llmeshranges.h"
+
+namespace tut
+{
+    struct meshranges_data
+    {
+        typedef std::vector<LLMeshRanges::Range> ranges_t;
+
+        // Requests as [first, last) indices, each range in one of them
+        static std::vector<std::pair<size_t, size_t> > requests(const ranges_t& ranges)
+        {
+            std::vector<std::pair<size_t, size_t> > result;
+            for (size_t first = 0; first < ranges.size(); )
+            {
+                U32 end;
+                size_t last = LLMeshRanges::join(ranges, first, end);
+                ensure("request not empty", last > first);
+                ensure("request below large fetch threshold",
+                       last - first == 1 || end - ranges[first].mOffset < LLMeshRanges::LARGE_FETCH_THRESHOLD);
+                result.emplace_back(first, last);
+                first = last;
+            }
+            return result;
+        }
+    };
+    typedef test_group<meshranges_data> meshranges_test;
+    typedef meshranges_test::object meshranges_object;
+    tut::meshranges_test meshranges_testcase("LLMeshRanges");
+
+    template<> template<>
+    void meshranges_object::test<1>()
+    {
+        set_test_name("Ranges join across small gaps only");
+
+        const U32 gap = LLMeshRanges::COALESCE_GAP;
+        ranges_t ranges = {
+            { 0,                      1000 },
+            { 1000,                   500 },    // Back to back
+            { 1500 + gap,             200 },    // Largest gap joined
+            { 1700 + 2 * gap + 1,     300 },    // One byte too far
+            { 2000 + 2 * gap + 1,     100 },
+        };
+
+        U32 end;
+        ensure_equals("joined", LLMeshRanges::join(ranges, 0, end), (size_t)3);
+        ensure_equals("joined end", end, 1700 + gap);
+        ensure_equals("split", LLMeshRanges::join(ranges, 3, end), (size_t)5);
+        ensure_equals("split end", end, 2100 + 2 * gap + 1);
+
+        // Overlapping sections don't shrink the request
+        ranges_t overlapping = { { 0, 4000 }, { 100, 200 }, { 3000, 2000 } };
+        ensure_equals("overlapping", LLMeshRanges::join(overlapping, 0, end), (size_t)3);
+        ensure_equals("overlapping end", end, 5000U);
+    }
+
+    template<> template<>
+    void meshranges_object::test<2>()
+    {
+        set_test_name("Joined requests stay below the large fetch threshold");
+
+        const U32 large = LLMeshRanges::LARGE_FETCH_THRESHOLD;
+        ranges_t ranges = {
+            { 0,                 large / 2 },
+            { large / 2,         large / 2 - 1 },   // One byte under
+            { large - 1,         1 },               // Would reach it
+            { large,             large },           // Large on its own
+            { 2 * large,         100 },
+        };
+
+        // What follows a large section gets its own request too
+        std::vector<std::pair<size_t, size_t> > result = requests(ranges);
+        ensure_equals("requests", result.size(), (size_t)4);
+        ensure_equals("first request", result[0].second, (size_t)2);
+        ensure_equals("second request", result[1].second, (size_t)3);
+        ensure_equals("large alone", result[2].second, (size_t)4);
+        ensure_equals("after large", result[3].second, (size_t)5);
+    }
+
+    template<> template<>
+    void meshranges_object::test<3>()
+    {
+        set_test_name("Joined response splits back into sections");
+
+        const U32 request_offset = 4096;
+        ranges_t sections = { { 4096, 100 }, { 4196, 50 }, { 5000, 300 } };
+        U32 end;
+        ensure_equals("one request", LLMeshRanges::join(sections, 0, end), sections.size());
+
+        // Each section's bytes carry its index
+        std::vector<U8> response(end - request_offset, 0xff);
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            memset(&response[sections[i].mOffset - request_offset], (int)i, sections[i].mBytes);
+        }
+
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            S32 offset = LLMeshRanges::sectionOffset(request_offset, sections[i], (S32)response.size());
+            ensure("section in response", offset >= 0);
+            for (U32 b = 0; b < sections[i].mBytes; ++b)
+            {
+                ensure_equals("section byte", (S32)response[offset + b], (S32)i);
+            }
+        }
+
+        // A short response fails only the sections it doesn't cover
+        S32 short_size = 200;
+        ensure_equals("first in short", LLMeshRanges::sectionOffset(request_offset, sections[0], short_size), 0);
+        ensure_equals("second in short", LLMeshRanges::sectionOffset(request_offset, sections[1], short_size), 100);
+        ensure_equals("last past short", LLMeshRanges::sectionOffset(request_offset, sections[2], short_size), -1);
+    }
+}
@@ -0,0 +1,256 @@
+/**
+ * @file llflatmessage_tut.cpp
+ * @brief Tests for decoding template messages into flat tables.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+#include "linden_common.h"
+#include "lltut.h"
+
+#include <iostream>
+
+#include "llapr.h"
+#include "llmessagelayout.h"
+#include "llmessagetemplate.h"
+#include "lltemplatemessagebuilder.h"
+#include "lltemplatemessagereader.h"
+#include "lltimer.h"
+#include "message_prehash.h"
+
+namespace tut
+{
+    struct LLFlatMessageTestData
+    {
+        enum { NUM_OBJECTS = 20, DATA_SIZE = 60 };
+
+        LLFlatMessageTestData()
+        {
+            static bool init = false;
+            if(! init)
+            {
+                ll_init_apr();
+                const F32 circuit_heartbeat_interval=5;
+                const F32 circuit_timeout=100;
+
+                start_messaging_system("notafile", 13035,
+                                       1,
+                                       0,
+                                       0,
+                                       false,
+                                       "notasharedsecret",
+                                       NULL,
+                                       false,
+                                       circuit_heartbeat_interval,
+                                       circuit_timeout);
+                init = true;
+            }
+        }
+
+        // Shaped like ImprovedTerseObjectUpdate: a single header block
+        // followed by a variable block of objects.
+        static LLMessageTemplate* createTemplate()
+        {
+            LLMessageTemplate* messageTemplate = new LLMessageTemplate(_PREHASH_TestMessage, 1, MFT_HIGH);
+            LLMessageBlock* header = new LLMessageBlock(const_cast<char*>(_PREHASH_Test0), MBT_SINGLE);
+            header->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U64, 8);
+            header->addVariable(const_cast<char*>(_PREHASH_Test1), MVT_U16, 2);
+            messageTemplate->addBlock(header);
+            LLMessageBlock* objects = new LLMessageBlock(const_cast<char*>(_PREHASH_Test1), MBT_VARIABLE);
+            objects->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+            objects->addVariable(const_cast<char*>(_PREHASH_Test1), MVT_LLUUID, 16);
+            objects->addVariable(const_cast<char*>(_PREHASH_Test2), MVT_VARIABLE, 1);
+            messageTemplate->addBlock(objects);
+            return messageTemplate;
+        }
+
+        static U32 buildPacket(LLMessageTemplate* messageTemplate, U8* buffer, U32 buffer_size)
+        {
+            LLTemplateMessageBuilder::message_template_name_map_t nameMap;
+            nameMap[_PREHASH_TestMessage] = messageTemplate;
+            LLTemplateMessageBuilder builder(nameMap);
+            builder.newMessage(_PREHASH_TestMessage);
+            builder.nextBlock(_PREHASH_Test0);
+            builder.addU64(_PREHASH_Test0, 0x0001000200030004ULL);
+            builder.addU16(_PREHASH_Test1, 42);
+            U8 data[DATA_SIZE];
+            for (S32 i = 0; i < NUM_OBJECTS; ++i)
+            {
+                memset(data, i, DATA_SIZE);
+                builder.nextBlock(_PREHASH_Test1);
+                builder.addU32(_PREHASH_Test0, 1000 + i);
+                builder.addUUID(_PREHASH_Test1, objectID(i));
+                builder.addBinaryData(_PREHASH_Test2, data, DATA_SIZE - i);
+            }
+            memset(buffer, 0, LL_PACKET_ID_SIZE);
+            return builder.buildMessage(buffer, buffer_size, 0);
+        }
+
+        static LLUUID objectID(S32 i)
+        {
+            LLUUID id;
+            memset(id.mData, i + 1, UUID_BYTES);
+            return id;
+        }
+
+        // Reads every field of the message like a handler would, by name.
+        static U32 readFields(LLTemplateMessageReader& reader)
+        {
+            U64 handle;
+            U16 dilation;
+            reader.getU64(_PREHASH_Test0, _PREHASH_Test0, handle);
+            reader.getU16(_PREHASH_Test0, _PREHASH_Test1, dilation);
+            U32 sum = (U32)handle + dilation;
+            U8 data[DATA_SIZE];
+            S32 count = reader.getNumberOfBlocks(_PREHASH_Test1);
+            for (S32 i = 0; i < count; ++i)
+            {
+                U32 local_id;
+                LLUUID id;
+                reader.getU32(_PREHASH_Test1, _PREHASH_Test0, local_id, i);
+                reader.getUUID(_PREHASH_Test1, _PREHASH_Test1, id, i);
+                S32 size = reader.getSize(_PREHASH_Test1, i, _PREHASH_Test2);
+                reader.getBinaryData(_PREHASH_Test1, _PREHASH_Test2, data, size, i, DATA_SIZE);
+                sum += local_id + id.mData[0] + size + data[0];
+            }
+            return sum;
+        }
+
+        // Decodes and reads the packet count times, returns messages per second.
+        static F64 replay(LLMessageTemplate* messageTemplate, const U8* buffer, U32 size, S32 count, U32& sum)
+        {
+            LLTemplateMessageReader::message_template_number_map_t numberMap;
+            numberMap[1] = messageTemplate;
+            LLTemplateMessageReader reader(numberMap);
+            LLTimer timer;
+            sum = 0;
+            for (S32 i = 0; i < count; ++i)
+            {
+                reader.validateMessage(buffer, size, LLHost());
+                reader.readMessage(buffer, LLHost());
+                sum += readFields(reader);
+                reader.clearMessage();
+            }
+            F64 seconds = timer.getElapsedTimeF64();
+            return seconds > 0.0 ? count / seconds : 0.0;
+        }
+    };
+
+    typedef test_group<LLFlatMessageTestData>   LLFlatMessageTestGroup;
+    typedef LLFlatMessageTestGroup::object      LLFlatMessageTestObject;
+    LLFlatMessageTestGroup flatMessageTestGroup("LLFlatMessage");
+
+    template<> template<>
+    void LLFlatMessageTestObject::test<1>()
+        // flat decode reads the same values as LLMsgData
+    {
+        LLMessageTemplate* messageTemplate = createTemplate();
+        messageTemplate->compileLayout();
+        ensure("layout", messageTemplate->getLayout() != NULL);
+
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket(messageTemplate, buffer, MAX_BUFFER_SIZE);
+
+        LLTemplateMessageReader::message_template_number_map_t numberMap;
+        numberMap[1] = messageTemplate;
+        LLTemplateMessageReader reader(numberMap);
+        ensure("validate", reader.validateMessage(buffer, size, LLHost()));
+        ensure("read", reader.readMessage(buffer, LLHost()));
+        ensure("flat decode", reader.getFlatMessage() != NULL && reader.getFlatMessage()->isDecoded());
+
+        U64 handle;
+        U16 dilation;
+        reader.getU64(_PREHASH_Test0, _PREHASH_Test0, handle);
+        reader.getU16(_PREHASH_Test0, _PREHASH_Test1, dilation);
+        ensure_equals("U64", handle, (U64)0x0001000200030004ULL);
+        ensure_equals("U16", dilation, (U16)42);
+        ensure_equals("blocks", reader.getNumberOfBlocks(_PREHASH_Test1), (S32)NUM_OBJECTS);
+
+        U8 data[DATA_SIZE];
+        for (S32 i = 0; i < NUM_OBJECTS; ++i)
+        {
+            U32 local_id;
+            LLUUID id;
+            reader.getU32(_PREHASH_Test1, _PREHASH_Test0, local_id, i);
+            reader.getUUID(_PREHASH_Test1, _PREHASH_Test1, id, i);
+            ensure_equals("U32", local_id, (U32)(1000 + i));
+            ensure_equals("UUID", id, objectID(i));
+            S32 data_size = reader.getSize(_PREHASH_Test1, i, _PREHASH_Test2);
+            ensure_equals("variable size", data_size, (S32)(DATA_SIZE - i));
+            reader.getBinaryData(_PREHASH_Test1, _PREHASH_Test2, data, data_size, i, DATA_SIZE);
+            ensure_equals("variable data", (S32)data[data_size - 1], i);
+        }
+        ensure_equals("missing block", reader.getSize(_PREHASH_Test1, NUM_OBJECTS, _PREHASH_Test2),
+                      (S32)LL_BLOCK_NOT_IN_MESSAGE);
+        delete messageTemplate;
+    }
+
+    template<> template<>
+    void LLFlatMessageTestObject::test<2>()
+        // LLMsgData and flat tables read the same values
+    {
+        LLMessageTemplate* mapTemplate = createTemplate();
+        LLMessageTemplate* flatTemplate = createTemplate();
+        flatTemplate->compileLayout();
+
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket(flatTemplate, buffer, MAX_BUFFER_SIZE);
+
+        U32 map_sum, flat_sum;
+        replay(mapTemplate, buffer, size, 1, map_sum);
+        replay(flatTemplate, buffer, size, 1, flat_sum);
+        ensure_equals("same values", flat_sum, map_sum);
+
+        delete mapTemplate;
+        delete flatTemplate;
+    }
+
+    template<> template<>
+    void LLFlatMessageTestObject::test<3>()
+        // packet replay, LLMsgData against flat tables
+    {
+        // Timing only, test<2> already checks both paths read the same values
+        if (!getenv("LL_TEST_BENCHMARKS"))
+        {
+            skip("set LL_TEST_BENCHMARKS to time message replay");
+        }
+
+        LLMessageTemplate* mapTemplate = createTemplate();
+        LLMessageTemplate* flatTemplate = createTemplate();
+        flatTemplate->compileLayout();
+
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket(flatTemplate, buffer, MAX_BUFFER_SIZE);
+
+        const S32 count = 20000;
+        U32 map_sum, flat_sum;
+        F64 map_rate = replay(mapTemplate, buffer, size, count, map_sum);
+        F64 flat_rate = replay(flatTemplate, buffer, size, count, flat_sum);
+        std::cout << "\nTemplate message replay of " << count << " packets: "
+                  << (S32)map_rate << " msgs/s LLMsgData, "
+                  << (S32)flat_rate << " msgs/s flat" << std::endl;
+
+        delete mapTemplate;
+        delete flatTemplate;
+    }
+}
@@ -0,0 +1,380 @@
+/**
+ * @file llmessageviews_tut.cpp
+ * @brief Tests for the typed views over hot template messages.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "llapr.h"
+#include "llmessagelayout.h"
+#include "llmessagetemplate.h"
+#include "llmessagetemplateparser.h"
+#include "llmessageviews.h"
+#include "lltemplatemessagebuilder.h"
+#include "lltemplatemessagereader.h"
+#include "message_prehash.h"
+
+namespace tut
+{
+    // As in scripts/messages/message_template.msg, the views are bound
+    // against these so every field past a variable one lands at an offset
+    // that depends on the sizes before it.
+    const char* const MESSAGE_TEMPLATES[] =
+    {
+        "{\n"
+        "    CoarseLocationUpdate Medium 6 Trusted Unencoded\n"
+        "    { Location Variable { X U8 } { Y U8 } { Z U8 } }\n"
+        "    { Index Single { You S16 } { Prey S16 } }\n"
+        "    { AgentData Variable { AgentID LLUUID } }\n"
+        "}\n",
+
+        "{\n"
+        "    LayerData High 11 Trusted Unencoded\n"
+        "    { LayerID Single { Type U8 } }\n"
+        "    { LayerData Single { Data Variable 2 } }\n"
+        "}\n",
+
+        "{\n"
+        "    ObjectUpdate High 12 Trusted Zerocoded\n"
+        "    { RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+        "    {\n"
+        "        ObjectData Variable\n"
+        "        { ID U32 } { State U8 }\n"
+        "        { FullID LLUUID } { CRC U32 } { PCode U8 } { Material U8 } { ClickAction U8 }\n"
+        "        { Scale LLVector3 } { ObjectData Variable 1 }\n"
+        "        { ParentID U32 } { UpdateFlags U32 }\n"
+        "        { PathCurve U8 } { ProfileCurve U8 } { PathBegin U16 } { PathEnd U16 }\n"
+        "        { PathScaleX U8 } { PathScaleY U8 } { PathShearX U8 } { PathShearY U8 }\n"
+        "        { PathTwist S8 } { PathTwistBegin S8 } { PathRadiusOffset S8 }\n"
+        "        { PathTaperX S8 } { PathTaperY S8 } { PathRevolutions U8 } { PathSkew S8 }\n"
+        "        { ProfileBegin U16 } { ProfileEnd U16 } { ProfileHollow U16 }\n"
+        "        { TextureEntry Variable 2 } { TextureAnim Variable 1 }\n"
+        "        { NameValue Variable 2 } { Data Variable 2 } { Text Variable 1 }\n"
+        "        { TextColor Fixed 4 } { MediaURL Variable 1 }\n"
+        "        { PSBlock Variable 1 } { ExtraParams Variable 1 }\n"
+        "        { Sound LLUUID } { OwnerID LLUUID } { Gain F32 } { Flags U8 } { Radius F32 }\n"
+        "        { JointType U8 } { JointPivot LLVector3 } { JointAxisOrAnchor LLVector3 }\n"
+        "    }\n"
+        "}\n",
+
+        "{\n"
+        "    ImprovedTerseObjectUpdate High 15 Trusted Unencoded\n"
+        "    { RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+        "    { ObjectData Variable { Data Variable 1 } { TextureEntry Variable 2 } }\n"
+        "}\n",
+    };
+
+    struct LLMessageViewsTestData
+    {
+        typedef LLTemplateMessageBuilder::message_template_name_map_t name_map_t;
+        typedef LLTemplateMessageReader::message_template_number_map_t number_map_t;
+
+        // Same messages twice: mFlat compiled and bound to the views,
+        // mNamed left alone so its reader decodes the old way.
+        name_map_t mFlat;
+        name_map_t mNamed;
+        number_map_t mFlatNumbers;
+        number_map_t mNamedNumbers;
+
+        LLMessageViewsTestData()
+        {
+            static bool init = false;
+            if(! init)
+            {
+                ll_init_apr();
+                const F32 circuit_heartbeat_interval=5;
+                const F32 circuit_timeout=100;
+
+                start_messaging_system("notafile", 13035,
+                                       1,
+                                       0,
+                                       0,
+                                       false,
+                                       "notasharedsecret",
+                                       NULL,
+                                       false,
+                                       circuit_heartbeat_interval,
+                                       circuit_timeout);
+                init = true;
+            }
+
+            for (const char* message : MESSAGE_TEMPLATES)
+            {
+                LLTemplateTokenizer flat_tokens(message);
+                LLMessageTemplate* flat = LLTemplateParser::parseMessage(flat_tokens);
+                mFlat[flat->mName] = flat;
+                mFlatNumbers[flat->mMessageNumber] = flat;
+
+                LLTemplateTokenizer named_tokens(message);
+                LLMessageTemplate* named = LLTemplateParser::parseMessage(named_tokens);
+                mNamed[named->mName] = named;
+                mNamedNumbers[named->mMessageNumber] = named;
+            }
+            LLMessageFieldTable::bindAll(mFlat);
+        }
+
+        ~LLMessageViewsTestData()
+        {
+            // Unbind before the layouts go away
+            LLMessageFieldTable::bindAll(name_map_t());
+            for (auto& entry : mFlat)
+            {
+                delete entry.second;
+            }
+            for (auto& entry : mNamed)
+            {
+                delete entry.second;
+            }
+        }
+
+        // Length given to a variable field, over 255 for two byte prefixes
+        static S32 variableSize(S32 blocknum, S32 variable, S32 prefix)
+        {
+            S32 size = 1 + (blocknum * 13 + variable * 5) % 60;
+            return prefix > 1 ? size + 256 : size;
+        }
+
+        // Fills every field of count blocks, each byte different per block,
+        // field and position.
+        static void addBlocks(LLTemplateMessageBuilder& builder, const LLMessageLayout& layout,
+                              const char* blockname, S32 count)
+        {
+            S32 block = layout.findBlock(blockname);
+            for (S32 blocknum = 0; blocknum < count; ++blocknum)
+            {
+                builder.nextBlock(blockname);
+                for (S32 variable = 0; variable < layout.getBlock(block).mNumVariables; ++variable)
+                {
+                    const LLMessageLayout::Variable& var = layout.getVariable(block, variable);
+                    S32 size = var.mType == MVT_VARIABLE ? variableSize(blocknum, variable, var.mSize) : var.mSize;
+                    U8 data[512];
+                    for (S32 i = 0; i < size; ++i)
+                    {
+                        data[i] = (U8)(1 + block * 61 + blocknum * 29 + variable * 7 + i);
+                    }
+                    builder.addBinaryData(var.mName, data, size);
+                }
+            }
+        }
+
+        // Builds the message with blocks of each name, count of each
+        U32 buildPacket(const char* name, std::initializer_list<std::pair<const char*, S32> > blocks, U8* buffer)
+        {
+            LLMessageStringTable* strings = LLMessageStringTable::getInstance();
+            name = strings->getString(name);
+            LLTemplateMessageBuilder builder(mNamed);
+            builder.newMessage(name);
+            for (const auto& [blockname, count] : blocks)
+            {
+                addBlocks(builder, *mFlat[name]->getLayout(), strings->getString(blockname), count);
+            }
+            memset(buffer, 0, LL_PACKET_ID_SIZE);
+            return builder.buildMessage(buffer, MAX_BUFFER_SIZE, 0);
+        }
+
+        static void read(LLTemplateMessageReader& reader, const U8* buffer, U32 size)
+        {
+            ensure("validate", reader.validateMessage(buffer, size, LLHost()));
+            ensure("read", reader.readMessage(buffer, LLHost()));
+        }
+    };
+
+    typedef test_group<LLMessageViewsTestData>  LLMessageViewsTestGroup;
+    typedef LLMessageViewsTestGroup::object     LLMessageViewsTestObject;
+    LLMessageViewsTestGroup messageViewsTestGroup("LLMessageViews");
+
+    template<> template<>
+    void LLMessageViewsTestObject::test<1>()
+        // ObjectUpdate fields after ObjectData land where the named reader finds them
+    {
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket("ObjectUpdate", { { "RegionData", 1 }, { "ObjectData", 2 } }, buffer);
+
+        LLTemplateMessageReader flat_reader(mFlatNumbers);
+        LLTemplateMessageReader named_reader(mNamedNumbers);
+        read(flat_reader, buffer, size);
+        read(named_reader, buffer, size);
+
+        LLObjectUpdateView flat(&flat_reader);
+        LLObjectUpdateView named(&named_reader);
+        ensure("flat", flat.isFlat());
+        ensure("named", !named.isFlat());
+
+        ensure_equals("region handle", flat.getRegionHandle(), named.getRegionHandle());
+        ensure_equals("time dilation", flat.getTimeDilation(), named.getTimeDilation());
+        ensure_equals("objects", flat.getNumObjects(), 2);
+        ensure_equals("named objects", named.getNumObjects(), 2);
+        for (S32 i = 0; i < 2; ++i)
+        {
+            ensure_equals("ID", flat.getID(i), named.getID(i));
+            ensure_equals("FullID", flat.getFullID(i), named.getFullID(i));
+            ensure_equals("CRC", flat.getCRC(i), named.getCRC(i));
+            ensure_equals("PCode", flat.getPCode(i), named.getPCode(i));
+            ensure_equals("ParentID", flat.getParentID(i), named.getParentID(i));
+            ensure_equals("UpdateFlags", flat.getUpdateFlags(i), named.getUpdateFlags(i));
+        }
+        ensure("objects differ", flat.getParentID(0) != flat.getParentID(1));
+    }
+
+    template<> template<>
+    void LLMessageViewsTestObject::test<2>()
+        // ImprovedTerseObjectUpdate variable sizes with one and two byte lengths
+    {
+        U8 buffer[MAX_BUFFER_SIZE];
+        const S32 count = 3;
+        U32 size = buildPacket("ImprovedTerseObjectUpdate", { { "RegionData", 1 }, { "ObjectData", count } }, buffer);
+
+        LLTemplateMessageReader flat_reader(mFlatNumbers);
+        LLTemplateMessageReader named_reader(mNamedNumbers);
+        read(flat_reader, buffer, size);
+        read(named_reader, buffer, size);
+
+        LLTerseObjectUpdateView flat(&flat_reader);
+        LLTerseObjectUpdateView named(&named_reader);
+        ensure("flat", flat.isFlat());
+
+        ensure_equals("region handle", flat.getRegionHandle(), named.getRegionHandle());
+        ensure_equals("time dilation", flat.getTimeDilation(), named.getTimeDilation());
+        ensure_equals("objects", flat.getNumObjects(), count);
+        for (S32 i = 0; i < count; ++i)
+        {
+            ensure_equals("data size", flat.getDataSize(i), variableSize(i, 0, 1));
+            ensure_equals("named data size", named.getDataSize(i), variableSize(i, 0, 1));
+            ensure_equals("texture entry size", flat.getTextureEntrySize(i), variableSize(i, 1, 2));
+            ensure_equals("named texture entry size", named.getTextureEntrySize(i), variableSize(i, 1, 2));
+
+            U8 flat_data[512], named_data[512];
+            flat.getData(i, flat_data, sizeof(flat_data));
+            named.getData(i, named_data, sizeof(named_data));
+            ensure("data", !memcmp(flat_data, named_data, flat.getDataSize(i)));
+            flat.getTextureEntry(i, flat_data, sizeof(flat_data));
+            named.getTextureEntry(i, named_data, sizeof(named_data));
+            ensure("texture entry", !memcmp(flat_data, named_data, flat.getTextureEntrySize(i)));
+        }
+        ensure_equals("missing block", flat.getDataSize(count), (S32)LL_BLOCK_NOT_IN_MESSAGE);
+    }
+
+    template<> template<>
+    void LLMessageViewsTestObject::test<3>()
+        // CoarseLocationUpdate, a single block between two variable ones
+    {
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket("CoarseLocationUpdate", { { "Location", 5 }, { "Index", 1 }, { "AgentData", 4 } }, buffer);
+
+        LLTemplateMessageReader flat_reader(mFlatNumbers);
+        LLTemplateMessageReader named_reader(mNamedNumbers);
+        read(flat_reader, buffer, size);
+        read(named_reader, buffer, size);
+
+        LLCoarseLocationUpdateView flat(&flat_reader);
+        LLCoarseLocationUpdateView named(&named_reader);
+        ensure("flat", flat.isFlat());
+
+        ensure_equals("locations", flat.getNumLocations(), 5);
+        for (S32 i = 0; i < 5; ++i)
+        {
+            ensure_equals("X", flat.getX(i), named.getX(i));
+            ensure_equals("Y", flat.getY(i), named.getY(i));
+            ensure_equals("Z", flat.getZ(i), named.getZ(i));
+        }
+        ensure_equals("You", flat.getYou(), named.getYou());
+        ensure_equals("Prey", flat.getPrey(), named.getPrey());
+        ensure_equals("agents", flat.getNumAgents(), 4);
+        for (S32 i = 0; i < 4; ++i)
+        {
+            ensure_equals("AgentID", flat.getAgentID(i), named.getAgentID(i));
+        }
+    }
+
+    template<> template<>
+    void LLMessageViewsTestObject::test<4>()
+        // LayerData, the two byte length of a patch
+    {
+        U8 buffer[MAX_BUFFER_SIZE];
+        U32 size = buildPacket("LayerData", { { "LayerID", 1 }, { "LayerData", 1 } }, buffer);
+
+        LLTemplateMessageReader flat_reader(mFlatNumbers);
+        LLTemplateMessageReader named_reader(mNamedNumbers);
+        read(flat_reader, buffer, size);
+        read(named_reader, buffer, size);
+
+        LLLayerDataView flat(&flat_reader);
+        LLLayerDataView named(&named_reader);
+        ensure("flat", flat.isFlat());
+
+        ensure_equals("type", flat.getType(), named.getType());
+        ensure_equals("data size", flat.getDataSize(), variableSize(0, 0, 2));
+        ensure_equals("named data size", named.getDataSize(), variableSize(0, 0, 2));
+
+        U8 flat_data[512], named_data[512];
+        flat.getData(flat_data, sizeof(flat_data));
+        named.getData(named_data, sizeof(named_data));
+        ensure("data", !memcmp(flat_data, named_data, flat.getDataSize()));
+    }
+
+    template<> template<>
+    void LLMessageViewsTestObject::test<5>()
+        // a template that doesn't match the table reads by name
+    {
+        const char* changed =
+            "{\n"
+            "    LayerData High 11 Trusted Unencoded\n"
+            "    { LayerID Single { Type U16 } }\n"
+            "    { LayerData Single { Data Variable 2 } }\n"
+            "}\n";
+        LLTemplateTokenizer tokens(changed);
+        LLMessageTemplate* messageTemplate = LLTemplateParser::parseMessage(tokens);
+        name_map_t changed_map;
+        changed_map[messageTemplate->mName] = messageTemplate;
+        LLMessageFieldTable::bindAll(changed_map);
+
+        // Compiled, so the reader decodes it flat, but not for this view
+        number_map_t numbers;
+        numbers[messageTemplate->mMessageNumber] = messageTemplate;
+        LLTemplateMessageBuilder builder(changed_map);
+        builder.newMessage(_PREHASH_LayerData);
+        builder.nextBlock(_PREHASH_LayerID);
+        builder.addU16(_PREHASH_Type, 76);
+        builder.nextBlock(_PREHASH_LayerData);
+        U8 data[300];
+        memset(data, 9, sizeof(data));
+        builder.addBinaryData(_PREHASH_Data, data, sizeof(data));
+        U8 buffer[MAX_BUFFER_SIZE];
+        memset(buffer, 0, LL_PACKET_ID_SIZE);
+        U32 size = builder.buildMessage(buffer, MAX_BUFFER_SIZE, 0);
+
+        LLTemplateMessageReader reader(numbers);
+        read(reader, buffer, size);
+        ensure("decoded flat", reader.getFlatMessage() != NULL);
+
+        LLLayerDataView view(&reader);
+        ensure("read by name", !view.isFlat());
+        ensure_equals("data size", view.getDataSize(), (S32)sizeof(data));
+
+        LLMessageFieldTable::bindAll(mFlat);
+        delete messageTemplate;
+    }
+}